@@ -132,6 +132,7 @@ def generate_schema_cc_library(
                         "@mathfu//:mathfu",
                         "//lullaby/util:logging",
                         "//lullaby/util:common_types",
+                        "//lullaby/util:flatbuffer_native_types",
                         "//lullaby/util:optional",
                     ],
                     includes = [out_prefix if out_prefix else "."],
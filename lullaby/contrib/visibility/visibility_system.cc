@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/contrib/visibility/visibility_system.h"
 
+#include <algorithm>
+
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/modules/flatbuffers/mathfu_fb_conversions.h"
@@ -84,8 +86,8 @@ void VisibilitySystem::Destroy(Entity entity) {
 
   WindowGroup* group = groups_.Get(entity);
   if (group) {
-    for (const Entity iter : group->contents) {
-      Content* content = contents_.Get(iter);
+    for (const GroupContent& iter : group->contents) {
+      Content* content = contents_.Get(iter.entity);
       content->group = kNullEntity;
     }
     groups_.Destroy(entity);
@@ -101,6 +103,10 @@ void VisibilitySystem::ResetWindow(Entity entity) {
   for (Window& window : group->windows) {
     window.states.clear();
   }
+  for (GroupContent& content : group->contents) {
+    content.revision = 0;
+  }
+  group->revision = 0;
 }
 
 VisibilitySystem::WindowGroup* VisibilitySystem::GetContainingGroup(
@@ -119,7 +125,10 @@ VisibilitySystem::WindowGroup* VisibilitySystem::GetContainingGroup(
 
 void VisibilitySystem::RemoveContentFromGroup(WindowGroup* group,
                                               Entity entity) {
-  auto iter = std::find(group->contents.begin(), group->contents.end(), entity);
+  auto iter = std::find_if(group->contents.begin(), group->contents.end(),
+                           [entity](const GroupContent& content) {
+                             return content.entity == entity;
+                           });
   if (iter != group->contents.end()) {
     group->contents.erase(iter);
     for (Window& window : group->windows) {
@@ -143,6 +152,7 @@ void VisibilitySystem::UpdateContentWithGroup(Content* content,
   if (new_group) {
     content->group = new_group->GetEntity();
     new_group->contents.emplace_back(content->GetEntity());
+    new_group->revision = 0;
   }
 }
 
@@ -225,7 +235,13 @@ void VisibilitySystem::UpdateContentState(Window* window, Entity target,
   }
 }
 
-void VisibilitySystem::UpdateGroup(WindowGroup* group) {
+void VisibilitySystem::UpdateGroup(WindowGroup* group,
+                                   uint64_t world_revision) {
+  if (group->revision == world_revision) {
+    // No transforms have changed since the group was last updated.
+    return;
+  }
+
   auto* transform_system = registry_->Get<TransformSystem>();
   if (!transform_system->IsEnabled(group->GetEntity())) {
     return;
@@ -237,29 +253,44 @@ void VisibilitySystem::UpdateGroup(WindowGroup* group) {
     return;
   }
 
-  const mathfu::mat4 window_from_world_matrix =
-      world_from_window_matrix->Inverse();
+  // Contents are descendants of the group, so if the group itself moved, their
+  // world revisions have changed too.  The inverse is only calculated if some
+  // content actually needs to be tested.
+  bool has_window_from_world_matrix = false;
+  mathfu::mat4 window_from_world_matrix;
 
-  for (const Entity target : group->contents) {
-    const mathfu::mat4* world_from_content_matrix =
-        transform_system->GetWorldFromEntityMatrix(target);
-    if (!world_from_content_matrix) {
+  for (GroupContent& content : group->contents) {
+    const uint64_t revision = transform_system->GetWorldRevision(content.entity);
+    if (revision == 0 || revision == content.revision) {
       continue;
     }
+    content.revision = revision;
+
+    const mathfu::mat4* world_from_content_matrix =
+        transform_system->GetWorldFromEntityMatrix(content.entity);
+    if (!has_window_from_world_matrix) {
+      window_from_world_matrix = world_from_window_matrix->Inverse();
+      has_window_from_world_matrix = true;
+    }
 
     const mathfu::mat4 window_from_content_matrix =
         window_from_world_matrix * (*world_from_content_matrix);
     const mathfu::vec3 pos = window_from_content_matrix.TranslationVector3D();
 
     for (Window& window : group->windows) {
-      UpdateContentState(&window, target, pos);
+      UpdateContentState(&window, content.entity, pos);
     }
   }
+  group->revision = world_revision;
 }
 
 void VisibilitySystem::Update() {
   LULLABY_CPU_TRACE_CALL();
-  groups_.ForEach([this](WindowGroup& group) { UpdateGroup(&group); });
+  const uint64_t world_revision =
+      registry_->Get<TransformSystem>()->GetWorldRevision();
+  groups_.ForEach([this, world_revision](WindowGroup& group) {
+    UpdateGroup(&group, world_revision);
+  });
 }
 
 }  // namespace lull
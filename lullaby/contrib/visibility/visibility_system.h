@@ -33,8 +33,9 @@ namespace lull {
 // are descendents of an entity which have a VisibilityWindowDef.  This can be
 // used to hide content that moves out of the window, and show content that
 // moves into it.
+// Contents are only re-tested against the windows when their world transforms
+// have changed since the last Update(), so idle groups cost almost nothing.
 // Note: This system does not take deformations into account.
-// TODO(b/73001382): add unit tests
 class VisibilitySystem : public System {
  public:
   explicit VisibilitySystem(Registry* registry);
@@ -57,10 +58,21 @@ class VisibilitySystem : public System {
     CollisionAxes collision_axes = CollisionAxes_XY;
   };
 
+  struct GroupContent {
+    explicit GroupContent(Entity entity) : entity(entity) {}
+    Entity entity = kNullEntity;
+    // The TransformSystem world revision of the entity when it was last tested
+    // against the windows, or 0 if it needs to be tested.
+    uint64_t revision = 0;
+  };
+
   struct WindowGroup : Component {
     explicit WindowGroup(Entity entity) : Component(entity) {}
-    std::vector<Entity> contents;
+    std::vector<GroupContent> contents;
     std::vector<Window> windows;
+    // The TransformSystem world revision when the group was last updated, or 0
+    // if the group needs to be updated regardless of transform changes.
+    uint64_t revision = 0;
   };
 
   struct Content : Component {
@@ -79,7 +91,7 @@ class VisibilitySystem : public System {
   void OnParentChanged(Entity target);
   void UpdateContentState(Window* window, Entity target,
                           const mathfu::vec3& position);
-  void UpdateGroup(WindowGroup* group);
+  void UpdateGroup(WindowGroup* group, uint64_t world_revision);
 
   ComponentPool<WindowGroup> groups_;
   ComponentPool<Content> contents_;
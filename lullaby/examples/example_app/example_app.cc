@@ -22,6 +22,7 @@ limitations under the License.
 #include "lullaby/modules/config/config.h"
 #include "lullaby/modules/script/function_binder.h"
 #include "lullaby/modules/input_processor/input_processor.h"
+#include "lullaby/util/frame_allocator.h"
 
 #if LULLABY_ENABLE_EDITOR
 #include "lullaby/editor/src/editor.h"
@@ -39,6 +40,7 @@ void ExampleApp::Initialize(void* native_window) {
   registry_->Create<AssetLoader>(registry_.get());
   registry_->Create<InputManager>();
   registry_->Create<EntityFactory>(registry_.get());
+  registry_->Create<FrameAllocator>();
 
   native_window_ = native_window;
   OnInitialize();
@@ -50,6 +52,8 @@ void ExampleApp::Initialize(void* native_window) {
 }
 
 void ExampleApp::Update() {
+  // Memory handed out by the FrameAllocator is only valid for a single frame.
+  registry_->Get<FrameAllocator>()->Reset();
   registry_->Get<AssetLoader>()->Finalize(1);
   ++frame_count_;
 
@@ -25,9 +25,7 @@ void SetConfigFromVariantMap(Config* config, const VariantMap* variant_map) {
   if (!config || !variant_map) {
     return;
   }
-  for (const auto& iter : *variant_map) {
-    config->Set(iter.first, iter.second);
-  }
+  config->SetAll(*variant_map);
 }
 
 void SetConfigFromFlatbuffer(Config* config, const ConfigDef* config_def) {
@@ -40,6 +38,8 @@ void SetConfigFromFlatbuffer(Config* config, const ConfigDef* config_def) {
     return;
   }
 
+  // Set all the values at once so that only a single snapshot is published.
+  VariantMap variant_map;
   for (auto iter = values->begin(); iter != values->end(); ++iter) {
     const auto* key = iter->key();
     const void* variant_def = iter->value();
@@ -51,9 +51,10 @@ void SetConfigFromFlatbuffer(Config* config, const ConfigDef* config_def) {
     Variant var;
     if (VariantFromFbVariant(iter->value_type(), variant_def, &var)) {
       const HashValue key_hash = Hash(key->c_str());
-      config->Set(key_hash, var);
+      variant_map[key_hash] = std::move(var);
     }
   }
+  config->SetAll(variant_map);
 }
 
 void LoadConfigFromFile(Registry* registry, Config* config,
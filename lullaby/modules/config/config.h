@@ -17,6 +17,9 @@ limitations under the License.
 #ifndef LULLABY_MODULES_CONFIG_CONFIG_H_
 #define LULLABY_MODULES_CONFIG_CONFIG_H_
 
+#include <stdint.h>
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 #include "lullaby/generated/config_def_generated.h"
@@ -31,8 +34,39 @@ namespace lull {
 //
 // Generally, a single instance of this class will be made available in the
 // registry to allow for app-wide configuration settings.
+//
+// The values are published as immutable, versioned Snapshots.  Every write
+// publishes a new snapshot, so readers never wait for writers and a snapshot
+// never changes once it has been obtained.  Hot paths should read values
+// through a ConfigValue, which only re-reads the value after the config has
+// been modified.
 class Config {
  public:
+  // An immutable set of values, as they were at the time it was published.
+  class Snapshot {
+   public:
+    // Returns the version of the config this snapshot was published as.
+    uint64_t GetVersion() const { return version_; }
+
+    // Returns the value associated with the |key| if it is of type |T|.  If
+    // no such value exists, returns the specified |default_value| instead.
+    template <typename T>
+    T Get(HashValue key, const T& default_value) const;
+
+   private:
+    friend class Config;
+
+    uint64_t version_ = 0;
+    VariantMap values_;
+  };
+
+  using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+  Config();
+
+  Config(const Config&) = delete;
+  Config& operator=(const Config&) = delete;
+
   // Associates the |value| with the |key|.
   template <typename T>
   void Set(HashValue key, const T& value);
@@ -40,6 +74,9 @@ class Config {
   // Associates the |value| with the |key|.
   void Set(HashValue key, Variant value);
 
+  // Associates all the |values| with their keys, publishing a single snapshot.
+  void SetAll(const VariantMap& values);
+
   // Returns the value associated with the |key| if it is of type |T|.  If no
   // such value exists, returns the specified |default_value| instead.
   template <typename T>
@@ -48,36 +85,131 @@ class Config {
   // Removes the value associated with the |key|.
   void Remove(HashValue key);
 
+  // Returns the current snapshot of all values.
+  SnapshotPtr GetSnapshot() const;
+
+  // Returns the version of the current snapshot, which is incremented every
+  // time the config is modified.
+  uint64_t GetVersion() const {
+    return version_.load(std::memory_order_acquire);
+  }
+
  private:
-  using Database = std::unordered_map<HashValue, Variant>;
-  mutable std::mutex mutex_;
-  Database values_;
+  // Publishes a copy of the current snapshot modified by |fn|.
+  template <typename Fn>
+  void Modify(const Fn& fn);
+
+  // Serializes writers.  Readers never lock it.
+  std::mutex write_mutex_;
+  // Only accessed through std::atomic_load and std::atomic_store.
+  SnapshotPtr snapshot_;
+  std::atomic<uint64_t> version_;
 };
 
+// A typed handle to a single config value, for use on hot paths.
+//
+// The value is read from the config the first time Get() is called and cached.
+// Subsequent calls only compare the config's version with that of the cached
+// value, so they take no lock and do no hashing until the config is modified.
+// Since it caches the value, a ConfigValue must not be shared between threads;
+// give each thread its own instead.
+template <typename T>
+class ConfigValue {
+ public:
+  // Creates a handle that always returns |default_value|.
+  ConfigValue() : ConfigValue(nullptr, 0, T()) {}
+
+  // Creates a handle to the value associated with |key| in |config|, which
+  // may be null.  If no value of type |T| is associated with the key,
+  // |default_value| is returned instead.
+  ConfigValue(const Config* config, HashValue key, T default_value)
+      : config_(config),
+        key_(key),
+        default_value_(std::move(default_value)),
+        value_(default_value_) {}
+
+  // Returns the current value.
+  const T& Get() const;
+
+ private:
+  const Config* config_;
+  HashValue key_;
+  T default_value_;
+  mutable T value_;
+  // The version of the config |value_| was read from.  Config versions start
+  // at 1, so the value is read on the first call to Get().
+  mutable uint64_t version_ = 0;
+};
+
+template <typename T>
+T Config::Snapshot::Get(HashValue key, const T& default_value) const {
+  auto iter = values_.find(key);
+  if (iter == values_.end()) {
+    return default_value;
+  }
+  const T* ptr = iter->second.Get<T>();
+  return ptr ? *ptr : default_value;
+}
+
+inline Config::Config()
+    : snapshot_(std::make_shared<Snapshot>()), version_(0) {
+  // Publish an empty snapshot as version 1 so that no snapshot has the
+  // version a ConfigValue starts with.
+  Modify([](VariantMap*) {});
+}
+
 template <typename T>
 void Config::Set(HashValue key, const T& value) {
   Set(key, Variant(value));
 }
 
 inline void Config::Set(HashValue key, Variant value) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  values_[key] = std::move(value);
+  Modify([&](VariantMap* values) { (*values)[key] = std::move(value); });
+}
+
+inline void Config::SetAll(const VariantMap& values) {
+  Modify([&](VariantMap* current) {
+    for (const auto& iter : values) {
+      (*current)[iter.first] = iter.second;
+    }
+  });
 }
 
 inline void Config::Remove(HashValue key) {
-  std::unique_lock<std::mutex> lock(mutex_);
-  values_.erase(key);
+  Modify([&](VariantMap* values) { values->erase(key); });
 }
 
 template <typename T>
 T Config::Get(HashValue key, const T& default_value) const {
-  std::unique_lock<std::mutex> lock(mutex_);
-  auto iter = values_.find(key);
-  if (iter == values_.end()) {
-    return default_value;
+  return GetSnapshot()->Get(key, default_value);
+}
+
+inline Config::SnapshotPtr Config::GetSnapshot() const {
+  return std::atomic_load(&snapshot_);
+}
+
+template <typename Fn>
+void Config::Modify(const Fn& fn) {
+  std::unique_lock<std::mutex> lock(write_mutex_);
+  // Readers may still be using the current snapshot, so modify a copy.
+  auto snapshot = std::make_shared<Snapshot>(*std::atomic_load(&snapshot_));
+  fn(&snapshot->values_);
+  snapshot->version_ = version_.load(std::memory_order_relaxed) + 1;
+  std::atomic_store(&snapshot_, SnapshotPtr(std::move(snapshot)));
+  // Bump the version after publishing the snapshot, so that a reader that sees
+  // the new version is guaranteed to get a snapshot at least that new.
+  version_.store(version_.load(std::memory_order_relaxed) + 1,
+                 std::memory_order_release);
+}
+
+template <typename T>
+const T& ConfigValue<T>::Get() const {
+  if (config_ && config_->GetVersion() != version_) {
+    const Config::SnapshotPtr snapshot = config_->GetSnapshot();
+    value_ = snapshot->Get(key_, default_value_);
+    version_ = snapshot->GetVersion();
   }
-  const T* ptr = iter->second.Get<T>();
-  return ptr ? *ptr : default_value;
+  return value_;
 }
 
 void LoadConfigFromFile(Registry* registry, Config* config,
@@ -48,7 +48,7 @@ class DebugRenderDrawInterface {
       const mathfu::vec4& color,
       const mathfu::vec2& pixel_pos0, const mathfu::vec2& uv0,
       const mathfu::vec2& pixel_pos1, const mathfu::vec2& uv1,
-      const TexturePtr& texture) const = 0;
+      const TexturePtr& texture) = 0;
 };
 
 }  // namespace debug
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/modules/debug/debug_render_impl.h"
 
+#include <string.h>
+
 #include "lullaby/modules/render/mesh_data.h"
 #include "lullaby/modules/render/mesh_util.h"
 
@@ -28,12 +30,28 @@ constexpr const char* kFontShader = "shaders/texture.fplshader";
 constexpr const char* kFontTexture = "textures/debug_font.webp";
 constexpr float kUVBounds[4] = {0.0f, 0.0f, 1.0f, 1.0f};
 constexpr float kFontSize = 0.12f;
+// Quads are batched in normalized device coordinates, so the texture_2d shader
+// is given an identity transform.
+constexpr float kIdentityPositionOffset[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+constexpr float kIdentityPositionScale[4] = {1.0f, 1.0f, 1.0f, 0.0f};
+// Batches use 16-bit indices, so are drawn early if they would grow beyond
+// this many vertices.
+constexpr size_t kMaxBatchVertices = 65536;
 
 struct NormalizedCoordinates {
   mathfu::vec3 pos0;
   mathfu::vec3 pos1;
 };
 
+template <typename T>
+static DataContainer WrapVectorAsReadOnly(const std::vector<T>& v) {
+  return DataContainer::WrapDataAsReadOnly(v.data(), v.size() * sizeof(T));
+}
+
+static bool IsSameColor(const mathfu::vec4& lhs, const mathfu::vec4& rhs) {
+  return lhs.x == rhs.x && lhs.y == rhs.y && lhs.z == rhs.z && lhs.w == rhs.w;
+}
+
 // Convert from screen coordinates to normalized device coordinates [-1.0, 1.0].
 static NormalizedCoordinates NormalizeScreenCoordinates(
     const mathfu::vec2& pixel_pos0, const mathfu::vec2& pixel_pos1,
@@ -60,7 +78,6 @@ DebugRenderImpl::DebugRenderImpl(Registry* registry) : registry_(registry) {
   texture_2d_shader_ = render_system_->LoadShader(kTexture2DShader);
   font_shader_ = render_system_->LoadShader(kFontShader);
   font_texture_ = render_system_->LoadTexture(kFontTexture);
-  quad_mesh_ = CreateQuadMesh<VertexPT>(1.0f, 1.0f, 2, 2, 0.0f, 0);
   font_.reset(new SimpleFont(font_shader_, font_texture_));
 }
 
@@ -69,12 +86,20 @@ DebugRenderImpl::~DebugRenderImpl() {}
 void DebugRenderImpl::Begin(const RenderSystem::View* views, size_t num_views) {
   views_ = views;
   num_views_ = num_views;
+  lines_.clear();
+  boxes_.vertices.clear();
+  boxes_.indices.clear();
+  num_text_batches_ = 0;
+  num_quad_batches_ = 0;
+  pending_kind_ = BatchKind::kNone;
   render_system_->SetDepthTest(false);
   render_system_->SetDepthWrite(false);
   render_system_->SetBlendMode(fplbase::kBlendModeAlpha);
 }
 
 void DebugRenderImpl::End() {
+  Flush();
+
   // TODO(b/66690010) Reset depth test and depth write to original state.
   render_system_->SetDepthTest(true);
   render_system_->SetDepthWrite(true);
@@ -83,41 +108,26 @@ void DebugRenderImpl::End() {
 void DebugRenderImpl::DrawLine(const mathfu::vec3& start_point,
                                const mathfu::vec3& end_point,
                                const Color4ub color) {
-  verts_.clear();
-  verts_.emplace_back(start_point.x, start_point.y, start_point.z, color);
-  verts_.emplace_back(end_point.x, end_point.y, end_point.z, color);
-  MeshData mesh(
-      MeshData::PrimitiveType::kLines, VertexPC::kFormat,
-      DataContainer::WrapDataAsReadOnly(verts_.data(), verts_.size()));
-
-  for (size_t i = 0; i < num_views_; ++i) {
-    render_system_->SetViewport(views_[i]);
-    render_system_->SetClipFromModelMatrix(views_[i].clip_from_world_matrix);
-    render_system_->BindShader(shape_shader_);
-    render_system_->DrawMesh(mesh);
-  }
+  BeginBatch(BatchKind::kShapes);
+  // Lines are not indexed, so never need to be drawn early.
+  lines_.emplace_back(start_point.x, start_point.y, start_point.z, color);
+  lines_.emplace_back(end_point.x, end_point.y, end_point.z, color);
 }
 
 void DebugRenderImpl::DrawText3D(const mathfu::vec3& pos, const Color4ub color,
                                  const char* text) {
   font_->SetSize(kFontSize);
-  const mathfu::vec4 cv = Color4ub::ToVec4(color);
-  const float cf[4] = {cv.x, cv.y, cv.z, cv.w};
   for (size_t i = 0; i < num_views_; ++i) {
-    render_system_->SetViewport(views_[i]);
-    render_system_->SetClipFromModelMatrix(views_[i].clip_from_eye_matrix);
-    mathfu::vec3 eye_space_pos =
+    const mathfu::vec3 eye_space_pos =
         views_[i].world_from_eye_matrix.Inverse() * pos;
-    MeshData mesh = font_->CreateMeshForString(text, eye_space_pos);
-    render_system_->BindShader(font_->GetShader());
-    render_system_->BindTexture(0, font_->GetTexture());
-    render_system_->BindUniform("uv_bounds", kUVBounds, 4);
-    render_system_->BindUniform("color", cf, 4);
-    registry_->Get<RenderSystem>()->DrawMesh(mesh);
+    AddText(i, color, text, eye_space_pos);
   }
 }
 
 void DebugRenderImpl::DrawText2D(const Color4ub color, const char* text) {
+  if (num_views_ == 0) {
+    return;
+  }
   const float kTopOfTextScreenScale = 0.40f;
   const float kFontScreenScale = .075f;
   const float z = -1.0f;
@@ -126,20 +136,11 @@ void DebugRenderImpl::DrawText2D(const Color4ub color, const char* text) {
   font_->SetSize(font_size);
   const mathfu::vec3 start_pos =
       mathfu::vec3(-.5f, kTopOfTextScreenScale * -z * tan_half_fov, z);
-  const mathfu::vec4 cv = Color4ub::ToVec4(color);
-  const float cf[4] = {cv.x, cv.y, cv.z, cv.w};
   for (size_t i = 0; i < num_views_; ++i) {
-    render_system_->SetViewport(views_[i]);
-    render_system_->SetClipFromModelMatrix(views_[i].clip_from_eye_matrix);
-    mathfu::vec3 eye_space_pos =
+    const mathfu::vec3 eye_space_pos =
         views_[i].world_from_eye_matrix.Inverse() *
         (views_[0].world_from_eye_matrix * start_pos);
-    MeshData mesh = font_->CreateMeshForString(text, eye_space_pos);
-    render_system_->BindShader(font_->GetShader());
-    render_system_->BindTexture(0, font_->GetTexture());
-    render_system_->BindUniform("uv_bounds", kUVBounds, 4);
-    render_system_->BindUniform("color", cf, 4);
-    registry_->Get<RenderSystem>()->DrawMesh(mesh);
+    AddText(i, color, text, eye_space_pos);
   }
 }
 
@@ -149,10 +150,14 @@ void DebugRenderImpl::DrawBox3D(const mathfu::mat4& world_from_object_matrix,
   mathfu::vec3 corners[kNumCorners];
   GetTransformedBoxCorners(box, world_from_object_matrix, corners);
 
-  verts_.clear();
-  verts_.reserve(kNumCorners);
+  BeginBatch(BatchKind::kShapes);
+  if (boxes_.vertices.size() + kNumCorners > kMaxBatchVertices) {
+    FlushShapes();
+  }
+
+  const uint16_t base = static_cast<uint16_t>(boxes_.vertices.size());
   for (int i = 0; i < kNumCorners; ++i) {
-    verts_.emplace_back(corners[i], color);
+    boxes_.vertices.emplace_back(corners[i], color);
   }
 
   constexpr int kNumIndices = 6 * 2 * 3;  // 6 faces * 2 triangles * 3 indices
@@ -170,16 +175,8 @@ void DebugRenderImpl::DrawBox3D(const mathfu::mat4& world_from_object_matrix,
       // +z face
       1, 5, 7, 1, 7, 3,
   };
-
-  MeshData mesh(MeshData::PrimitiveType::kTriangles, VertexPC::kFormat,
-                DataContainer::WrapDataAsReadOnly(verts_.data(), verts_.size()),
-                MeshData::kIndexU16,
-                DataContainer::WrapDataAsReadOnly(indices, kNumIndices));
-  for (size_t i = 0; i < num_views_; ++i) {
-    render_system_->SetViewport(views_[i]);
-    render_system_->SetClipFromModelMatrix(views_[i].clip_from_world_matrix);
-    render_system_->BindShader(shape_shader_);
-    render_system_->DrawMesh(mesh);
+  for (uint16_t index : indices) {
+    boxes_.indices.push_back(static_cast<uint16_t>(base + index));
   }
 }
 
@@ -190,9 +187,7 @@ void DebugRenderImpl::DrawQuad2D(const Color4ub color, float x, float y,
   const mathfu::vec3 pos1(x + w, y + h, z);
   const mathfu::vec4 cv = Color4ub::ToVec4(color);
   for (size_t i = 0; i < num_views_; ++i) {
-    const RenderSystem::View& view = views_[i];
-    render_system_->SetViewport(view);
-    SubmitQuad2D(cv, pos0, mathfu::kZeros2f, pos1, mathfu::kOnes2f, texture);
+    AddQuad2D(i, cv, pos0, mathfu::kZeros2f, pos1, mathfu::kOnes2f, texture);
   }
 }
 
@@ -200,35 +195,184 @@ void DebugRenderImpl::DrawQuad2DAbsolute(
     const mathfu::vec4& color,
     const mathfu::vec2& pixel_pos0, const mathfu::vec2& uv0,
     const mathfu::vec2& pixel_pos1, const mathfu::vec2& uv1,
-    const TexturePtr& texture) const {
+    const TexturePtr& texture) {
   for (size_t i = 0; i < num_views_; ++i) {
-    const RenderSystem::View& view = views_[i];
-    render_system_->SetViewport(view);
     const NormalizedCoordinates coords = NormalizeScreenCoordinates(
-        pixel_pos0, pixel_pos1, view.dimensions);
-    SubmitQuad2D(color, coords.pos0, uv0, coords.pos1, uv1, texture);
+        pixel_pos0, pixel_pos1, views_[i].dimensions);
+    AddQuad2D(i, color, coords.pos0, uv0, coords.pos1, uv1, texture);
   }
 }
 
-void DebugRenderImpl::SubmitQuad2D(
-    const mathfu::vec4& color,
-    const mathfu::vec3& pos0, const mathfu::vec2& uv0,
-    const mathfu::vec3& pos1, const mathfu::vec2& uv1,
-    const TexturePtr& texture) const {
-  const mathfu::vec3 center = 0.5f * (pos0 + pos1);
-  const mathfu::vec3 dpos = pos1 - pos0;
-  const mathfu::vec2 duv = uv1 - uv0;
-  const float uv_bounds[] = {uv0.x, uv0.y, duv.x, duv.y};
-  const float position_scale[] = {dpos.x, dpos.y, dpos.z, 0.0f};
-  const float position_offset[] = {center.x, center.y, center.z, 1.0f};
+DebugRenderImpl::TextBatch* DebugRenderImpl::GetTextBatch(size_t view,
+                                                          Color4ub color,
+                                                          size_t num_glyphs) {
+  const size_t num_vertices = 4 * num_glyphs;
+  for (size_t i = 0; i < num_text_batches_; ++i) {
+    TextBatch* batch = &text_batches_[i];
+    if (batch->view == view && batch->color == color) {
+      if (batch->mesh.GetNumVertices() + num_vertices > kMaxBatchVertices) {
+        FlushText(batch);
+      }
+      return batch;
+    }
+  }
+
+  // Batches are reused across frames to keep their allocated memory.
+  if (num_text_batches_ == text_batches_.size()) {
+    text_batches_.emplace_back();
+  }
+  TextBatch* batch = &text_batches_[num_text_batches_++];
+  batch->view = view;
+  batch->color = color;
+  batch->mesh.Clear();
+  return batch;
+}
+
+DebugRenderImpl::QuadBatch* DebugRenderImpl::GetQuadBatch(
+    size_t view, const mathfu::vec4& color, const TexturePtr& texture) {
+  for (size_t i = 0; i < num_quad_batches_; ++i) {
+    QuadBatch* batch = &quad_batches_[i];
+    if (batch->view == view && batch->texture == texture &&
+        IsSameColor(batch->color, color)) {
+      if (batch->mesh.vertices.size() + 4 > kMaxBatchVertices) {
+        FlushQuads(batch);
+      }
+      return batch;
+    }
+  }
+
+  if (num_quad_batches_ == quad_batches_.size()) {
+    quad_batches_.emplace_back();
+  }
+  QuadBatch* batch = &quad_batches_[num_quad_batches_++];
+  batch->view = view;
+  batch->color = color;
+  batch->texture = texture;
+  batch->mesh.vertices.clear();
+  batch->mesh.indices.clear();
+  return batch;
+}
+
+void DebugRenderImpl::AddText(size_t view, Color4ub color, const char* text,
+                              const mathfu::vec3& eye_space_pos) {
+  BeginBatch(BatchKind::kText);
+  const size_t num_glyphs = text ? strlen(text) : 0;
+  TextBatch* batch = GetTextBatch(view, color, num_glyphs);
+  mathfu::vec3 cursor = eye_space_pos;
+  font_->AddStringToMesh(text, &batch->mesh, &cursor);
+}
+
+void DebugRenderImpl::AddQuad2D(size_t view, const mathfu::vec4& color,
+                                const mathfu::vec3& pos0,
+                                const mathfu::vec2& uv0,
+                                const mathfu::vec3& pos1,
+                                const mathfu::vec2& uv1,
+                                const TexturePtr& texture) {
+  BeginBatch(BatchKind::kQuads);
+  QuadBatch* batch = GetQuadBatch(view, color, texture);
+  std::vector<VertexPT>& vertices = batch->mesh.vertices;
+  std::vector<uint16_t>& indices = batch->mesh.indices;
+
+  // Matches the layout and winding of a 2x2 quad from CreateQuadMesh(), where
+  // v increases downwards.
+  const float z = 0.5f * (pos0.z + pos1.z);
+  const uint16_t base = static_cast<uint16_t>(vertices.size());
+  vertices.emplace_back(pos0.x, pos0.y, z, uv0.x, uv1.y);
+  vertices.emplace_back(pos0.x, pos1.y, z, uv0.x, uv0.y);
+  vertices.emplace_back(pos1.x, pos0.y, z, uv1.x, uv1.y);
+  vertices.emplace_back(pos1.x, pos1.y, z, uv1.x, uv0.y);
+
+  const uint16_t quad_indices[] = {1, 0, 2, 3, 1, 2};
+  for (uint16_t index : quad_indices) {
+    indices.push_back(static_cast<uint16_t>(base + index));
+  }
+}
+
+void DebugRenderImpl::BeginBatch(BatchKind kind) {
+  if (pending_kind_ != kind) {
+    Flush();
+    pending_kind_ = kind;
+  }
+}
+
+void DebugRenderImpl::Flush() {
+  FlushShapes();
+  for (size_t i = 0; i < num_text_batches_; ++i) {
+    FlushText(&text_batches_[i]);
+  }
+  for (size_t i = 0; i < num_quad_batches_; ++i) {
+    FlushQuads(&quad_batches_[i]);
+  }
+  num_text_batches_ = 0;
+  num_quad_batches_ = 0;
+  pending_kind_ = BatchKind::kNone;
+}
+
+void DebugRenderImpl::FlushShapes() {
+  if (lines_.empty() && boxes_.vertices.empty()) {
+    return;
+  }
+
+  const MeshData lines(MeshData::PrimitiveType::kLines, VertexPC::kFormat,
+                       WrapVectorAsReadOnly(lines_));
+  const MeshData boxes(MeshData::PrimitiveType::kTriangles, VertexPC::kFormat,
+                       WrapVectorAsReadOnly(boxes_.vertices),
+                       MeshData::kIndexU16,
+                       WrapVectorAsReadOnly(boxes_.indices));
+  for (size_t i = 0; i < num_views_; ++i) {
+    render_system_->SetViewport(views_[i]);
+    render_system_->SetClipFromModelMatrix(views_[i].clip_from_world_matrix);
+    render_system_->BindShader(shape_shader_);
+    if (!lines_.empty()) {
+      render_system_->DrawMesh(lines);
+    }
+    if (!boxes_.vertices.empty()) {
+      render_system_->DrawMesh(boxes);
+    }
+  }
+
+  lines_.clear();
+  boxes_.vertices.clear();
+  boxes_.indices.clear();
+}
+
+void DebugRenderImpl::FlushText(TextBatch* batch) {
+  if (batch->mesh.GetNumVertices() == 0) {
+    return;
+  }
+
+  const RenderSystem::View& view = views_[batch->view];
+  const mathfu::vec4 cv = Color4ub::ToVec4(batch->color);
+  const float cf[4] = {cv.x, cv.y, cv.z, cv.w};
+  render_system_->SetViewport(view);
+  render_system_->SetClipFromModelMatrix(view.clip_from_eye_matrix);
+  render_system_->BindShader(font_->GetShader());
+  render_system_->BindTexture(0, font_->GetTexture());
+  render_system_->BindUniform("uv_bounds", kUVBounds, 4);
+  render_system_->BindUniform("color", cf, 4);
+  render_system_->DrawMesh(batch->mesh.GetMesh());
+  batch->mesh.Clear();
+}
+
+void DebugRenderImpl::FlushQuads(QuadBatch* batch) {
+  if (batch->mesh.vertices.empty()) {
+    return;
+  }
 
+  const MeshData mesh(MeshData::PrimitiveType::kTriangles, VertexPT::kFormat,
+                      WrapVectorAsReadOnly(batch->mesh.vertices),
+                      MeshData::kIndexU16,
+                      WrapVectorAsReadOnly(batch->mesh.indices));
+  render_system_->SetViewport(views_[batch->view]);
   render_system_->BindShader(texture_2d_shader_);
-  render_system_->BindTexture(0, texture);
-  render_system_->BindUniform("uv_bounds", uv_bounds, 4);
-  render_system_->BindUniform("position_offset", position_offset, 4);
-  render_system_->BindUniform("position_scale", position_scale, 4);
-  render_system_->BindUniform("color", &color.x, 4);
-  render_system_->DrawMesh(quad_mesh_);
+  render_system_->BindTexture(0, batch->texture);
+  render_system_->BindUniform("uv_bounds", kUVBounds, 4);
+  render_system_->BindUniform("position_offset", kIdentityPositionOffset, 4);
+  render_system_->BindUniform("position_scale", kIdentityPositionScale, 4);
+  render_system_->BindUniform("color", &batch->color.x, 4);
+  render_system_->DrawMesh(mesh);
+  batch->mesh.vertices.clear();
+  batch->mesh.indices.clear();
 }
 
 }  // namespace lull
@@ -17,6 +17,8 @@ limitations under the License.
 #ifndef LULLABY_MODULES_DEBUG_DEBUG_RENDER_IMPL_H_
 #define LULLABY_MODULES_DEBUG_DEBUG_RENDER_IMPL_H_
 
+#include <vector>
+
 #include "lullaby/modules/debug/debug_render_draw_interface.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/render/simple_font.h"
@@ -24,6 +26,13 @@ limitations under the License.
 
 namespace lull {
 
+// Draws debug primitives using the RenderSystem's immediate-mode functions.
+//
+// Primitives drawn between Begin() and End() are accumulated into vertex
+// streams grouped by shader, view, and uniforms, and are drawn with a handful
+// of draw calls.  Since debug primitives are drawn without depth testing, the
+// streams are drawn whenever the kind of primitive (shapes, text, or 2D quads)
+// changes so that later primitives still draw on top of earlier ones.
 class DebugRenderImpl : public debug::DebugRenderDrawInterface {
  public:
   explicit DebugRenderImpl(Registry* registry);
@@ -51,30 +60,79 @@ class DebugRenderImpl : public debug::DebugRenderDrawInterface {
       const mathfu::vec4& color,
       const mathfu::vec2& pixel_pos0, const mathfu::vec2& uv0,
       const mathfu::vec2& pixel_pos1, const mathfu::vec2& uv1,
-      const TexturePtr& texture) const override;
+      const TexturePtr& texture) override;
 
  private:
+  // Indexed vertices that are drawn with a single draw call.
+  template <typename Vertex>
+  struct Batch {
+    std::vector<Vertex> vertices;
+    std::vector<uint16_t> indices;
+  };
+
+  // Glyphs of a single color in a single view's eye space.
+  struct TextBatch {
+    size_t view = 0;
+    Color4ub color;
+    SimpleFontMesh mesh;
+  };
+
+  // Quads in normalized device coordinates with the same texture and color in
+  // a single view.
+  struct QuadBatch {
+    size_t view = 0;
+    mathfu::vec4 color;
+    TexturePtr texture;
+    Batch<VertexPT> mesh;
+  };
+
+  // The kinds of primitives that are batched separately.
+  enum class BatchKind {
+    kNone,
+    kShapes,
+    kText,
+    kQuads,
+  };
+
   Registry* registry_;
   RenderSystem* render_system_;
-  const RenderSystem::View* views_;
-  size_t num_views_;
+  const RenderSystem::View* views_ = nullptr;
+  size_t num_views_ = 0;
   std::unique_ptr<SimpleFont> font_;
   ShaderPtr font_shader_;
   TexturePtr font_texture_;
   ShaderPtr texture_shader_;
   ShaderPtr texture_2d_shader_;
   ShaderPtr shape_shader_;
-  MeshData quad_mesh_;
-  std::vector<VertexPC> verts_;
+  std::vector<VertexPC> lines_;
+  Batch<VertexPC> boxes_;
+  std::vector<TextBatch> text_batches_;
+  std::vector<QuadBatch> quad_batches_;
+  size_t num_text_batches_ = 0;
+  size_t num_quad_batches_ = 0;
+  // The kind of the primitives that haven't been drawn yet.
+  BatchKind pending_kind_ = BatchKind::kNone;
 
   DebugRenderImpl(const DebugRenderImpl&) = delete;
   DebugRenderImpl& operator=(const DebugRenderImpl&) = delete;
 
-  void SubmitQuad2D(
-      const mathfu::vec4& color,
-      const mathfu::vec3& pos0, const mathfu::vec2& uv0,
-      const mathfu::vec3& pos1, const mathfu::vec2& uv1,
-      const TexturePtr& texture) const;
+  TextBatch* GetTextBatch(size_t view, Color4ub color, size_t num_glyphs);
+  QuadBatch* GetQuadBatch(size_t view, const mathfu::vec4& color,
+                          const TexturePtr& texture);
+  void AddText(size_t view, Color4ub color, const char* text,
+               const mathfu::vec3& eye_space_pos);
+  void AddQuad2D(size_t view, const mathfu::vec4& color,
+                 const mathfu::vec3& pos0, const mathfu::vec2& uv0,
+                 const mathfu::vec3& pos1, const mathfu::vec2& uv1,
+                 const TexturePtr& texture);
+
+  // Draws all pending primitives if they are of a different kind than |kind|,
+  // and then tracks |kind| as pending.
+  void BeginBatch(BatchKind kind);
+  void Flush();
+  void FlushShapes();
+  void FlushText(TextBatch* batch);
+  void FlushQuads(QuadBatch* batch);
 };
 }  // namespace lull
 
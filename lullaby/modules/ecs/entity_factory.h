@@ -32,6 +32,7 @@ limitations under the License.
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/modules/file/asset.h"
 #include "lullaby/util/dependency_checker.h"
+#include "lullaby/util/hash.h"
 #include "lullaby/util/registry.h"
 #include "lullaby/util/resource_manager.h"
 #include "lullaby/util/string_view.h"
@@ -209,6 +210,16 @@ class EntityFactory {
   // created.
   const BlueprintMap& GetEntityToBlueprintMap() const;
 
+  // Saves or restores the set of created Entities (ie. the Entity ID generator
+  // and the Entity to blueprint map).  Used by the WorldSnapshot to restore
+  // Entities without recreating them from their blueprints.
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    Lock lock(mutex_);
+    archive(&entity_generator_, ConstHash("entity_generator"));
+    archive(&entity_to_blueprint_map_, ConstHash("entity_to_blueprint_map"));
+  }
+
   // Gets or loads off disk a blueprint asset with the given |name|.
   std::shared_ptr<SimpleAsset> GetBlueprintAsset(const std::string& name);
 
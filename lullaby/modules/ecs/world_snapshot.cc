@@ -0,0 +1,184 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/ecs/world_snapshot.h"
+
+#include <string.h>
+
+#include "lullaby/modules/ecs/entity_factory.h"
+
+namespace lull {
+namespace {
+
+// Identifies a blob as a world snapshot.  The value is set to "LSNP".
+constexpr uint32_t kMagic = 0x504e534c;
+
+// The version of the snapshot container format (ie. the header and section
+// table), independent of the versions of the individual sections.
+constexpr uint32_t kFormatVersion = 1;
+
+// The version of the EntityFactory section.
+constexpr uint32_t kEntityFactoryVersion = 1;
+
+template <typename T>
+void Write(WorldSnapshot::Buffer* buffer, const T& value) {
+  const size_t offset = buffer->size();
+  buffer->resize(offset + sizeof(T));
+  memcpy(buffer->data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+bool Read(const WorldSnapshot::Buffer& buffer, size_t* offset, T* value) {
+  if (buffer.size() - *offset < sizeof(T)) {
+    return false;
+  }
+  memcpy(value, buffer.data() + *offset, sizeof(T));
+  *offset += sizeof(T);
+  return true;
+}
+
+}  // namespace
+
+WorldSnapshot::WorldSnapshot(Registry* registry) : registry_(registry) {
+  Register(GetTypeId<EntityFactory>(), kEntityFactoryVersion,
+           [this](SaveToBuffer* serializer) {
+             auto* entity_factory = registry_->Get<EntityFactory>();
+             if (entity_factory) {
+               Serialize(serializer, entity_factory, 0);
+             }
+           },
+           [this](LoadFromBuffer* serializer) {
+             auto* entity_factory = registry_->Get<EntityFactory>();
+             if (entity_factory) {
+               Serialize(serializer, entity_factory, 0);
+             }
+           });
+}
+
+void WorldSnapshot::Register(HashValue id, uint32_t version, SaveFn save,
+                             RestoreFn restore) {
+  if (FindSection(id)) {
+    LOG(DFATAL) << "Snapshot section already registered: " << id;
+    return;
+  }
+  Section section;
+  section.id = id;
+  section.version = version;
+  section.save = std::move(save);
+  section.restore = std::move(restore);
+  sections_.emplace_back(std::move(section));
+}
+
+void WorldSnapshot::Unregister(HashValue id) {
+  for (auto iter = sections_.begin(); iter != sections_.end(); ++iter) {
+    if (iter->id == id) {
+      sections_.erase(iter);
+      return;
+    }
+  }
+}
+
+const WorldSnapshot::Section* WorldSnapshot::FindSection(HashValue id) const {
+  for (const Section& section : sections_) {
+    if (section.id == id) {
+      return &section;
+    }
+  }
+  return nullptr;
+}
+
+WorldSnapshot::Buffer WorldSnapshot::Save() const {
+  Buffer buffer;
+  Write(&buffer, kMagic);
+  Write(&buffer, kFormatVersion);
+  Write(&buffer, static_cast<uint32_t>(sections_.size()));
+
+  Buffer section_data;
+  for (const Section& section : sections_) {
+    section_data.clear();
+    SaveToBuffer serializer(&section_data);
+    section.save(&serializer);
+
+    Write(&buffer, section.id);
+    Write(&buffer, section.version);
+    Write(&buffer, static_cast<uint64_t>(section_data.size()));
+    buffer.insert(buffer.end(), section_data.begin(), section_data.end());
+  }
+  return buffer;
+}
+
+bool WorldSnapshot::Restore(const Buffer& buffer) {
+  size_t offset = 0;
+  uint32_t magic = 0;
+  uint32_t format_version = 0;
+  uint32_t num_sections = 0;
+  if (!Read(buffer, &offset, &magic) || magic != kMagic) {
+    LOG(ERROR) << "Buffer is not a world snapshot.";
+    return false;
+  }
+  if (!Read(buffer, &offset, &format_version) ||
+      format_version != kFormatVersion) {
+    LOG(ERROR) << "Unsupported world snapshot format: " << format_version;
+    return false;
+  }
+  if (!Read(buffer, &offset, &num_sections)) {
+    LOG(ERROR) << "Truncated world snapshot.";
+    return false;
+  }
+
+  // Validate the entire section table before touching any state so that a
+  // stale or corrupt snapshot leaves the world untouched.
+  struct PendingSection {
+    const Section* section;
+    size_t offset;
+    size_t size;
+  };
+  std::vector<PendingSection> pending;
+  pending.reserve(num_sections);
+  for (uint32_t i = 0; i < num_sections; ++i) {
+    HashValue id = 0;
+    uint32_t version = 0;
+    uint64_t size = 0;
+    if (!Read(buffer, &offset, &id) || !Read(buffer, &offset, &version) ||
+        !Read(buffer, &offset, &size) || buffer.size() - offset < size) {
+      LOG(ERROR) << "Truncated world snapshot.";
+      return false;
+    }
+
+    const Section* section = FindSection(id);
+    if (!section) {
+      LOG(WARNING) << "Skipping unregistered snapshot section: " << id;
+    } else if (section->version != version) {
+      LOG(ERROR) << "Snapshot section " << id << " has version " << version
+                 << ", expected " << section->version;
+      return false;
+    } else {
+      pending.push_back({section, offset, static_cast<size_t>(size)});
+    }
+    offset += static_cast<size_t>(size);
+  }
+
+  Buffer section_data;
+  for (const PendingSection& entry : pending) {
+    const uint8_t* begin = buffer.data() + entry.offset;
+    section_data.assign(begin, begin + entry.size);
+    LoadFromBuffer serializer(&section_data);
+    entry.section->restore(&serializer);
+  }
+  return true;
+}
+
+}  // namespace lull
@@ -0,0 +1,119 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_MODULES_ECS_WORLD_SNAPSHOT_H_
+#define LULLABY_MODULES_ECS_WORLD_SNAPSHOT_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "lullaby/modules/serialize/buffer_serializer.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/logging.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+// Captures the state of the Entities and Components in the world into a
+// single versioned binary blob, and restores that state without going through
+// the EntityFactory's blueprint creation process.  This allows an app to
+// quickly resume after its process has been killed.
+//
+// The snapshot is made up of sections, each of which is written and read by a
+// pair of functions registered with the WorldSnapshot.  The EntityFactory's
+// state (ie. the Entity ID generator and the Entity to blueprint map) is
+// always saved as the first section.  Systems participate by implementing:
+//
+//   void SaveSnapshot(SaveToBuffer* serializer) const;
+//   void RestoreSnapshot(LoadFromBuffer* serializer);
+//
+// and being registered with RegisterSystem<S>(version).  A section's version
+// should be bumped whenever the layout of its data changes.
+//
+// Restore() should be called on a world in which the same Systems have been
+// created and initialized, but no Entities have been created.  Only the data
+// owned by participating Systems is restored.  No events are sent during the
+// restore.
+class WorldSnapshot {
+ public:
+  using Buffer = std::vector<uint8_t>;
+  using SaveFn = std::function<void(SaveToBuffer*)>;
+  using RestoreFn = std::function<void(LoadFromBuffer*)>;
+
+  explicit WorldSnapshot(Registry* registry);
+
+  WorldSnapshot(const WorldSnapshot&) = delete;
+  WorldSnapshot& operator=(const WorldSnapshot&) = delete;
+
+  // Registers a section with the given |id| and |version|.  Sections are saved
+  // and restored in the order in which they are registered.
+  void Register(HashValue id, uint32_t version, SaveFn save, RestoreFn restore);
+
+  // Registers the System of type |S| which must already exist in the Registry.
+  template <typename S>
+  void RegisterSystem(uint32_t version);
+
+  // Removes the section with the given |id|.
+  void Unregister(HashValue id);
+
+  // Saves all registered sections into a binary blob.
+  Buffer Save() const;
+
+  // Restores the world from a blob created by Save().  The entire blob is
+  // validated before any section is restored.  Returns false (without
+  // modifying the world) if the blob is malformed or if any section's version
+  // does not match the registered version, in which case the caller should
+  // fall back to recreating the world from blueprints.
+  bool Restore(const Buffer& buffer);
+
+ private:
+  struct Section {
+    HashValue id = 0;
+    uint32_t version = 0;
+    SaveFn save;
+    RestoreFn restore;
+  };
+
+  const Section* FindSection(HashValue id) const;
+
+  Registry* registry_;
+  std::vector<Section> sections_;
+};
+
+template <typename S>
+void WorldSnapshot::RegisterSystem(uint32_t version) {
+  S* system = registry_->Get<S>();
+  if (!system) {
+    LOG(DFATAL) << "Cannot register snapshot for missing system: "
+                << GetTypeName<S>();
+    return;
+  }
+  Register(GetTypeId<S>(), version,
+           [system](SaveToBuffer* serializer) {
+             system->SaveSnapshot(serializer);
+           },
+           [system](LoadFromBuffer* serializer) {
+             system->RestoreSnapshot(serializer);
+           });
+}
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::WorldSnapshot);
+
+#endif  // LULLABY_MODULES_ECS_WORLD_SNAPSHOT_H_
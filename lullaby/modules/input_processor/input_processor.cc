@@ -17,6 +17,7 @@ limitations under the License.
 #include "lullaby/modules/input_processor/input_processor.h"
 
 #include <limits>  // std::numeric_limits
+#include <utility>
 
 #include "lullaby/events/input_events.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
@@ -33,6 +34,17 @@ namespace {
 constexpr float kRayDragSlop = 2.0f * kDegreesToRadians;
 constexpr float kRayCancelSlop = 35.0f * kDegreesToRadians;
 constexpr const char* kAnyPrefix = "Any";
+// The prefixed, "Any" and legacy events.
+constexpr size_t kMaxEventSetsPerEvent = 3;
+
+// Returns true if |button| is pressed or was just released.  Buttons that stay
+// released can't cause any events.
+bool IsButtonActive(InputManager::ButtonState button) {
+  return CheckBit(button, static_cast<InputManager::ButtonState>(
+                              InputManager::kPressed |
+                              InputManager::kJustPressed |
+                              InputManager::kJustReleased));
+}
 
 template <typename PressEvent, typename ReleaseEvent, typename ClickEvent,
           typename LongPressEvent, typename LongClickEvent>
@@ -95,30 +107,29 @@ InputProcessor::InputProcessor(Registry* registry, LegacyMode legacy_mode)
 
 const InputFocus* InputProcessor::GetInputFocus(
     InputManager::DeviceType device) const {
-  if (device == InputManager::kMaxNumDeviceTypes) {
-    return nullptr;
-  }
-  auto iter = input_foci_.find(device);
-  if (iter == input_foci_.end()) {
+  if (device >= InputManager::kMaxNumDeviceTypes ||
+      !devices_[device].has_focus) {
     return nullptr;
   }
-  return &iter->second.current;
+  return &devices_[device].focus.current;
 }
 
 const InputFocus* InputProcessor::GetPreviousFocus(
     InputManager::DeviceType device) const {
-  if (device == InputManager::kMaxNumDeviceTypes) {
-    return nullptr;
-  }
-  auto iter = input_foci_.find(device);
-  if (iter == input_foci_.end()) {
+  if (device >= InputManager::kMaxNumDeviceTypes ||
+      !devices_[device].has_focus) {
     return nullptr;
   }
-  return &iter->second.previous;
+  return &devices_[device].focus.previous;
 }
 
 void InputProcessor::UpdateDevice(const Clock::duration& delta_time,
                                   const InputFocus& input_focus) {
+  if (input_focus.device >= InputManager::kMaxNumDeviceTypes) {
+    LOG(DFATAL) << "Invalid device: " << input_focus.device;
+    return;
+  }
+
   SwapBuffers(input_focus);
   if (legacy_mode_ == kNoEvents) {
     return;
@@ -134,13 +145,14 @@ void InputProcessor::UpdateDevice(const Clock::duration& delta_time,
 }
 
 void InputProcessor::SwapBuffers(const InputFocus& input_focus) {
-  FocusPair& focus = input_foci_[input_focus.device];
-  focus.previous = focus.current;
-  focus.current = input_focus;
+  DeviceState& state = devices_[input_focus.device];
+  state.focus.previous = state.focus.current;
+  state.focus.current = input_focus;
+  state.has_focus = true;
 }
 
 void InputProcessor::UpdateFocus(InputManager::DeviceType device) {
-  FocusPair& focus = input_foci_[device];
+  const FocusPair& focus = devices_[device].focus;
   // Target is changing, send focus events.
   const Entity current =
       focus.current.interactive ? focus.current.target : kNullEntity;
@@ -161,14 +173,22 @@ void InputProcessor::UpdateFocus(InputManager::DeviceType device) {
 void InputProcessor::UpdateButtons(const Clock::duration& delta_time,
                                    InputManager::DeviceType device) {
   auto input_manager = registry_->Get<InputManager>();
-  const InputFocus& focus = input_foci_[device].current;
+  DeviceState& state = devices_[device];
+  const InputFocus& focus = state.focus.current;
   // Send events based on Button state (click, release, etc).
   const size_t num_buttons = input_manager->GetNumButtons(device);
+  if (state.buttons.size() < num_buttons) {
+    state.buttons.resize(num_buttons);
+  }
   for (size_t i = 0; i < num_buttons; i++) {
     const auto button_id = static_cast<InputManager::ButtonId>(i);
     const InputManager::ButtonState button =
         input_manager->GetButtonState(device, button_id);
-    auto& button_state = button_states_[std::make_pair(device, button_id)];
+    ButtonState& button_state = state.buttons[i];
+    if (button_state.state == kReleased && !IsButtonActive(button)) {
+      // Nothing can change for a button that stays released.
+      continue;
+    }
     if (CheckBit(button, InputManager::kJustPressed)) {
       button_state.state = kInsideSlop;
       HandlePress(device, button_id, &button_state);
@@ -248,12 +268,16 @@ void InputProcessor::UpdateButtons(const Clock::duration& delta_time,
 void InputProcessor::UpdateButtonsLegacy(const Clock::duration& delta_time,
                                          InputManager::DeviceType device) {
   auto input_manager = registry_->Get<InputManager>();
+  DeviceState& state = devices_[device];
 
   // Send events based on Button state (click, release, etc).
   const size_t num_buttons = input_manager->GetNumButtons(device);
+  if (state.buttons.size() < num_buttons) {
+    state.buttons.resize(num_buttons);
+  }
   for (size_t i = 0; i < num_buttons; i++) {
     const auto button_id = static_cast<InputManager::ButtonId>(i);
-    auto& button_state = button_states_[std::make_pair(device, button_id)];
+    ButtonState& button_state = state.buttons[i];
     const InputManager::ButtonState button =
         input_manager->GetButtonState(device, button_id);
     if (CheckBit(button, InputManager::kJustPressed)) {
@@ -274,7 +298,7 @@ void InputProcessor::UpdateButtonsLegacy(const Clock::duration& delta_time,
 void InputProcessor::HandlePress(InputManager::DeviceType device,
                                  InputManager::ButtonId button_id,
                                  ButtonState* button_state) {
-  FocusPair& focus = input_foci_[device];
+  const FocusPair& focus = devices_[device].focus;
   button_state->pressed_entity =
       focus.current.interactive ? focus.current.target : kNullEntity;
   button_state->ms_since_press = 0;
@@ -288,7 +312,7 @@ void InputProcessor::HandlePress(InputManager::DeviceType device,
 void InputProcessor::HandleDragStart(InputManager::DeviceType device,
                                      InputManager::ButtonId button_id,
                                      ButtonState* /*button_state*/) {
-  FocusPair& focus = input_foci_[device];
+  const FocusPair& focus = devices_[device].focus;
   const Entity current =
       focus.current.interactive ? focus.current.target : kNullEntity;
 
@@ -311,7 +335,7 @@ void InputProcessor::HandleRelease(InputManager::DeviceType device,
                                    InputManager::ButtonId button_id,
                                    const InputManager::ButtonState& button,
                                    ButtonState* button_state) {
-  FocusPair& focus = input_foci_[device];
+  const FocusPair& focus = devices_[device].focus;
   const Entity current =
       focus.current.interactive ? focus.current.target : kNullEntity;
 
@@ -347,7 +371,7 @@ void InputProcessor::HandleCancel(InputManager::DeviceType device,
 void InputProcessor::HandleReleaseLegacy(
     InputManager::DeviceType device, InputManager::ButtonId button_id,
     const InputManager::ButtonState& button, ButtonState* button_state) {
-  FocusPair& focus = input_foci_[device];
+  const FocusPair& focus = devices_[device].focus;
   const Entity current =
       focus.current.interactive ? focus.current.target : kNullEntity;
 
@@ -384,7 +408,7 @@ void InputProcessor::HandleReleaseLegacy(
 void InputProcessor::HandleLongPressLegacy(InputManager::DeviceType device,
                                            InputManager::ButtonId button_id,
                                            ButtonState* button_state) {
-  FocusPair& focus = input_foci_[device];
+  const FocusPair& focus = devices_[device].focus;
   const Entity current =
       focus.current.interactive ? focus.current.target : kNullEntity;
   if (button_state->focused_entity == current) {
@@ -394,7 +418,7 @@ void InputProcessor::HandleLongPressLegacy(InputManager::DeviceType device,
 
 void InputProcessor::SetButtonTarget(InputManager::DeviceType device,
                                      ButtonState* button_state) {
-  FocusPair& focus = input_foci_[device];
+  const FocusPair& focus = devices_[device].focus;
   button_state->focused_entity =
       focus.current.interactive ? focus.current.target : kNullEntity;
 
@@ -452,104 +476,150 @@ InputManager::DeviceType InputProcessor::GetPrimaryDevice() const {
 
 void InputProcessor::SetPrefix(InputManager::DeviceType device,
                                string_view prefix) {
-  DeviceEvents& events = device_events_[device];
-  SetupDeviceEvents(prefix, &events);
+  if (device >= InputManager::kMaxNumDeviceTypes) {
+    LOG(DFATAL) << "Invalid device: " << device;
+    return;
+  }
+  std::unique_ptr<DeviceEvents>& events = devices_[device].events;
+  if (!events) {
+    events.reset(new DeviceEvents());
+  }
+  SetupDeviceEvents(prefix, events.get());
 }
 
 void InputProcessor::SetPrefix(InputManager::DeviceType device,
                                InputManager::ButtonId button,
                                string_view prefix) {
-  ButtonEvents& events = button_events_[std::make_pair(device, button)];
-  SetupButtonEvents(prefix, &events);
+  if (device >= InputManager::kMaxNumDeviceTypes ||
+      button == InputManager::kInvalidButton) {
+    LOG(DFATAL) << "Invalid device/button: " << device << "/" << button;
+    return;
+  }
+  auto& button_events = devices_[device].button_events;
+  if (button_events.size() <= button) {
+    button_events.resize(button + 1);
+  }
+  std::unique_ptr<ButtonEvents>& events = button_events[button];
+  if (!events) {
+    events.reset(new ButtonEvents());
+  }
+  SetupButtonEvents(prefix, events.get());
 }
 
 void InputProcessor::ClearPrefix(InputManager::DeviceType device) {
-  device_events_.erase(device);
+  if (device < InputManager::kMaxNumDeviceTypes) {
+    devices_[device].events.reset();
+  }
 }
 
 void InputProcessor::ClearPrefix(InputManager::DeviceType device,
                                  InputManager::ButtonId button) {
-  button_events_.erase(std::make_pair(device, button));
+  if (device < InputManager::kMaxNumDeviceTypes &&
+      button < devices_[device].button_events.size()) {
+    devices_[device].button_events[button].reset();
+  }
 }
 
 void InputProcessor::SendDeviceEvent(InputManager::DeviceType device,
                                      DeviceEventType event_type, Entity target,
                                      const VariantMap* values) {
-  auto iter = device_events_.find(device);
-  if (iter != device_events_.end()) {
-    // Send events with a specific prefix.
-    SendEvent(iter->second, event_type, target, device,
-              InputManager::kInvalidButton, values);
+  const DeviceEvents* event_sets[kMaxEventSetsPerEvent];
+  size_t num_event_sets = 0;
+
+  // Send events with a specific prefix.
+  const DeviceState& state = devices_[device];
+  if (state.events) {
+    event_sets[num_event_sets++] = state.events.get();
   }
 
   // Send generic events.
-  SendEvent(any_device_events_, event_type, target, device,
-            InputManager::kInvalidButton, values);
+  event_sets[num_event_sets++] = &any_device_events_;
 
   if (legacy_mode_ != kNoLegacy && device == GetPrimaryDevice() &&
       legacy_device_events_.events[event_type] != 0) {
-    SendEvent(legacy_device_events_, event_type, target, device,
-              InputManager::kInvalidButton, values);
+    event_sets[num_event_sets++] = &legacy_device_events_;
   }
+
+  SendEvents(event_sets, num_event_sets, event_type, target, device,
+             InputManager::kInvalidButton, values);
 }
 
 void InputProcessor::SendButtonEvent(InputManager::DeviceType device,
                                      InputManager::ButtonId button,
                                      ButtonEventType event_type, Entity target,
                                      const VariantMap* values) {
-  auto iter = button_events_.find(std::make_pair(device, button));
-  if (iter != button_events_.end()) {
-    // Send events with a specific prefix.
-    SendEvent(iter->second, event_type, target, device, button, values);
+  const ButtonEvents* event_sets[kMaxEventSetsPerEvent];
+  size_t num_event_sets = 0;
+
+  // Send events with a specific prefix.
+  const DeviceState& state = devices_[device];
+  if (button < state.button_events.size() && state.button_events[button]) {
+    event_sets[num_event_sets++] = state.button_events[button].get();
   }
 
   // Send generic events.
-  SendEvent(any_button_events_, event_type, target, device, button, values);
+  event_sets[num_event_sets++] = &any_button_events_;
 
-  if (legacy_mode_ != kNoLegacy && device == GetPrimaryDevice() &&
-      button == InputManager::kPrimaryButton &&
-      legacy_button_events_.events[event_type] != 0) {
-    if (event_type == kLongPress) {
-      // TODO(b/68854711) remove this special case when old global events are
-      // supported here.
-      // Need to only send this locally, due to it already being sent by the old
-      // input_processor logic.
-      auto dispatcher_system = registry_->Get<DispatcherSystem>();
-      if (dispatcher_system && target != kNullEntity) {
-        dispatcher_system->Send(target, PrimaryButtonLongPress());
-      }
-    } else {
-      SendEvent(legacy_button_events_, event_type, target, device, button,
-                values);
+  const bool send_legacy = legacy_mode_ != kNoLegacy &&
+                           device == GetPrimaryDevice() &&
+                           button == InputManager::kPrimaryButton &&
+                           legacy_button_events_.events[event_type] != 0;
+  if (send_legacy && event_type != kLongPress) {
+    event_sets[num_event_sets++] = &legacy_button_events_;
+  }
+
+  SendEvents(event_sets, num_event_sets, event_type, target, device, button,
+             values);
+
+  if (send_legacy && event_type == kLongPress) {
+    // TODO(b/68854711) remove this special case when old global events are
+    // supported here.
+    // Need to only send this locally, due to it already being sent by the old
+    // input_processor logic.
+    auto dispatcher_system = registry_->Get<DispatcherSystem>();
+    if (dispatcher_system && target != kNullEntity) {
+      dispatcher_system->Send(target, PrimaryButtonLongPress());
     }
   }
 }
 
 template <typename EventSet, typename EventType>
-void InputProcessor::SendEvent(const EventSet& event_set, EventType event_type,
-                               Entity target, InputManager::DeviceType device,
-                               InputManager::ButtonId button,
-                               const VariantMap* values) {
-#if LULLABY_TRACK_EVENT_NAMES
-  EventWrapper event(event_set.events[event_type], event_set.names[event_type]);
-#else
-  EventWrapper event(event_set.events[event_type]);
-#endif
+void InputProcessor::SendEvents(const EventSet* const* event_sets,
+                                size_t num_event_sets, EventType event_type,
+                                Entity target, InputManager::DeviceType device,
+                                InputManager::ButtonId button,
+                                const VariantMap* values) {
+  auto dispatcher = registry_->Get<Dispatcher>();
+  auto dispatcher_system =
+      target != kNullEntity ? registry_->Get<DispatcherSystem>() : nullptr;
+
+  // The values are the same for each event set, so they are only built once.
+  VariantMap event_values;
   if (values != nullptr) {
-    event.SetValues(*values);
+    event_values = *values;
   }
-  event.SetValue(kEntityHash, target);
-  event.SetValue(kTargetHash, target);
-  event.SetValue<InputManager::DeviceType>(kDeviceHash, device);
+  event_values[kEntityHash] = target;
+  event_values[kTargetHash] = target;
+  event_values[kDeviceHash] = device;
   if (button != InputManager::kInvalidButton) {
-    event.SetValue<InputManager::ButtonId>(kButtonHash, button);
+    event_values[kButtonHash] = button;
   }
 
-  auto dispatcher = registry_->Get<Dispatcher>();
-  dispatcher->Send(event);
+  for (size_t i = 0; i < num_event_sets; ++i) {
+    const EventSet& event_set = *event_sets[i];
+#if LULLABY_TRACK_EVENT_NAMES
+    EventWrapper event(event_set.events[event_type],
+                       event_set.names[event_type]);
+#else
+    EventWrapper event(event_set.events[event_type]);
+#endif
+    if (i + 1 < num_event_sets) {
+      event.SetValues(event_values);
+    } else {
+      event.SetValues(std::move(event_values));
+    }
 
-  if (target != kNullEntity) {
-    auto dispatcher_system = registry_->Get<DispatcherSystem>();
+    dispatcher->Send(event);
     if (dispatcher_system) {
       dispatcher_system->Send(target, event);
     }
@@ -17,14 +17,15 @@ limitations under the License.
 #ifndef LULLABY_UTIL_INPUT_PROCESSOR_H_
 #define LULLABY_UTIL_INPUT_PROCESSOR_H_
 
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "lullaby/events/input_events.h"
 #include "lullaby/util/entity.h"
 #include "lullaby/modules/input/input_focus.h"
 #include "lullaby/modules/input/input_manager.h"
 #include "lullaby/util/clock.h"
-#include "lullaby/util/enum_hash.h"
 #include "lullaby/util/math.h"
 #include "lullaby/util/registry.h"
 #include "lullaby/util/variant.h"
@@ -134,18 +135,6 @@ class InputProcessor {
   // clang-format on
 #undef LULLABY_GENERATE_ENUM
 
-  using DeviceButtonPair =
-      std::pair<InputManager::DeviceType, InputManager::ButtonId>;
-  // Hash function to allow DeviceButtonPair to be used as a key in a map.
-  struct DeviceButtonPairHash {
-    std::size_t operator()(const DeviceButtonPair& pair) const {
-      uint64_t combine = pair.first;
-      combine = combine << 32;
-      combine += pair.second;
-      return std::hash<uint64_t>{}(combine);
-    }
-  };
-
   template <int N>
   struct EventHashes {
     HashValue events[N];
@@ -192,6 +181,21 @@ class InputProcessor {
     int64_t ms_since_press = 0;
   };
 
+  /// The state and event routing of a device and its buttons, which is indexed
+  /// directly by DeviceType and ButtonId rather than looked up in maps for each
+  /// event.
+  struct DeviceState {
+    FocusPair focus;
+    // Whether UpdateDevice() has been called for the device.
+    bool has_focus = false;
+    // The events with the device's prefix, or null if it has no prefix.
+    std::unique_ptr<DeviceEvents> events;
+    // The current state of each button.
+    std::vector<ButtonState> buttons;
+    // The events with each button's prefix, or null if it has no prefix.
+    std::vector<std::unique_ptr<ButtonEvents>> button_events;
+  };
+
   /// Update the stored InputFocus.  Must be called before UpdateFocus or
   /// UpdateButtons.
   void SwapBuffers(const InputFocus& input_focus);
@@ -243,10 +247,13 @@ class InputProcessor {
                        ButtonEventType event_type, Entity target,
                        const VariantMap* values);
 
+  /// Sends the |event_type| event of each of the |event_sets|, all with the
+  /// same values.
   template <typename EventSet, typename EventType>
-  void SendEvent(const EventSet& event_set, EventType event_type, Entity target,
-                 InputManager::DeviceType device, InputManager::ButtonId button,
-                 const VariantMap* values);
+  void SendEvents(const EventSet* const* event_sets, size_t num_event_sets,
+                  EventType event_type, Entity target,
+                  InputManager::DeviceType device,
+                  InputManager::ButtonId button, const VariantMap* values);
 
   void SetupDeviceEvents(const string_view prefix,
                          InputProcessor::DeviceEvents* events);
@@ -267,15 +274,7 @@ class InputProcessor {
 
   Registry* registry_;
 
-  std::unordered_map<InputManager::DeviceType, FocusPair, EnumHash> input_foci_;
-  std::unordered_map<DeviceButtonPair, ButtonState, DeviceButtonPairHash>
-      button_states_;
-
-  // Maps from device (& button) to a hash of the prefix, if set.
-  std::unordered_map<InputManager::DeviceType, DeviceEvents, EnumHash>
-      device_events_;
-  std::unordered_map<DeviceButtonPair, ButtonEvents, DeviceButtonPairHash>
-      button_events_;
+  DeviceState devices_[InputManager::kMaxNumDeviceTypes];
 
   // Names and hashes for events with the "Any" prefix.
   DeviceEvents any_device_events_;
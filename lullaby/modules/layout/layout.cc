@@ -304,8 +304,7 @@ class OuterElement {
 // InnerElements.
 class ApplyLayoutContext {
  public:
-  ApplyLayoutContext(const LayoutParams& params,
-                     const std::vector<LayoutElement>& elements,
+  ApplyLayoutContext(const LayoutParams& params, Span<LayoutElement> elements,
                      LayoutBoxSystem* layout_box_system,
                      std::vector<DesiredSize>* desired_sizes)
       : fill_order_(params.fill_order),
@@ -373,7 +372,7 @@ class ApplyLayoutContext {
   }
 
   const LayoutFillOrder fill_order_;
-  const std::vector<LayoutElement>& elements_;
+  const Span<LayoutElement> elements_;
   bool horizontal_first_;
   size_t elements_per_wrap_;
   size_t outer_count_;
@@ -553,7 +552,7 @@ void ApplyLayoutOuterDesired(const float outer_spacing,
   // We successfully allocated sizes to weighted children, done.
 }
 
-void ApplyLayoutSetDesired(const std::vector<LayoutElement>& elements,
+void ApplyLayoutSetDesired(Span<LayoutElement> elements,
                            const std::vector<DesiredSize>& desired_sizes,
                            Entity desired_source,
                            LayoutBoxSystem* layout_box_system) {
@@ -764,7 +763,7 @@ Aabb ApplyLayout(Registry* registry, const LayoutParams& params,
 // Uses the LayoutManager to arrange the specified entities in
 // |elements| based on the Layout |params|.
 Aabb ApplyLayout(Registry* registry, const LayoutParams& params,
-                 const std::vector<LayoutElement>& elements,
+                 Span<LayoutElement> elements,
                  const SetLayoutPositionFn& set_pos_fn, Entity desired_source,
                  CachedPositions* cached_positions) {
   // The minimum and maximum points making up the area used for this layout.
@@ -24,6 +24,7 @@ limitations under the License.
 #include "lullaby/util/clock.h"
 #include "lullaby/util/math.h"
 #include "lullaby/util/registry.h"
+#include "lullaby/util/span.h"
 #include "mathfu/constants.h"
 #include "mathfu/glsl_mappings.h"
 
@@ -143,7 +144,7 @@ Aabb ApplyLayout(Registry* registry, const LayoutParams& params,
 // with that source.
 // Returns the total AABB that is filled up by the entities.
 Aabb ApplyLayout(Registry* registry, const LayoutParams& params,
-                 const std::vector<LayoutElement>& elements,
+                 Span<LayoutElement> elements,
                  const SetLayoutPositionFn& set_pos_fn,
                  Entity desired_source = kNullEntity,
                  CachedPositions* cached_positions = nullptr);
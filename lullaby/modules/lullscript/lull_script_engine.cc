@@ -17,6 +17,15 @@ limitations under the License.
 #include "lullaby/modules/lullscript/lull_script_engine.h"
 
 namespace lull {
+namespace {
+
+// Scripts may either be source code or precompiled byte code.
+Span<uint8_t> ToBytes(const std::string& code) {
+  return Span<uint8_t>(reinterpret_cast<const uint8_t*>(code.data()),
+                       code.size());
+}
+
+}  // namespace
 
 void LullScriptEngine::SetFunctionCallHandler(FunctionCall::Handler handler) {
   handler_ = std::move(handler);
@@ -28,14 +37,14 @@ uint64_t LullScriptEngine::LoadScript(const std::string& code,
   Script& script = scripts_[id];
   script.env.SetFunctionCallHandler(handler_);
   script.debug_name = debug_name;
-  script.script = script.env.Read(code);
+  script.script = script.env.LoadOrRead(ToBytes(code));
   return id;
 }
 
 void LullScriptEngine::ReloadScript(uint64_t id, const std::string& code) {
   auto iter = scripts_.find(id);
   if (iter != scripts_.end()) {
-    iter->second.script = iter->second.env.Read(code);
+    iter->second.script = iter->second.env.LoadOrRead(ToBytes(code));
   }
 }
 
@@ -36,7 +36,8 @@ class LullScriptEngine {
   // a FunctionCall object.
   void SetFunctionCallHandler(FunctionCall::Handler handler);
 
-  // Load a script from inline code. The debug_name is used when reporting error
+  // Load a script from inline code, which may be either source or byte code
+  // compiled by the ScriptCompiler. The debug_name is used when reporting error
   // messages.
   uint64_t LoadScript(const std::string& code, const std::string& debug_name);
 
@@ -15,6 +15,9 @@ limitations under the License.
 */
 
 #include "lullaby/modules/lullscript/script_compiler.h"
+
+#include <string.h>
+
 #include "lullaby/modules/lullscript/script_env.h"
 #include "lullaby/modules/lullscript/script_types.h"
 
@@ -22,8 +25,76 @@ namespace lull {
 
 static const uint8_t kByteCodeMarker = 0;
 
-ScriptCompiler::ScriptCompiler(ScriptByteCode* code)
-    : code_(code), writer_(code) {}
+namespace {
+
+// The header at the start of every image.  Byte code written before images
+// were versioned starts with the marker followed by the first token type, so
+// the magic bytes are used to tell the two formats apart.
+struct Header {
+  uint8_t marker;
+  uint8_t magic[3];
+  uint32_t version;
+  uint32_t num_tokens;
+  uint32_t strings_size;
+};
+
+const uint8_t kMagic[3] = {'L', 'S', 'B'};
+
+// The size of each token record: a uint32 type, a uint32 string offset and a
+// uint64 value.
+const size_t kTokenSize = 16;
+
+bool HasHeader(Span<uint8_t> bytes) {
+  return bytes.size() >= sizeof(Header) && bytes[0] == kByteCodeMarker &&
+         memcmp(bytes.data() + 1, kMagic, sizeof(kMagic)) == 0;
+}
+
+// Returns the number of bytes used by the value of a scalar token, or 0 if the
+// token does not store a scalar.
+size_t GetScalarSize(ParserCallbacks::TokenType type) {
+  switch (type) {
+    case ParserCallbacks::kBool:
+      return sizeof(bool);
+    case ParserCallbacks::kInt8:
+      return sizeof(int8_t);
+    case ParserCallbacks::kUint8:
+      return sizeof(uint8_t);
+    case ParserCallbacks::kInt16:
+      return sizeof(int16_t);
+    case ParserCallbacks::kUint16:
+      return sizeof(uint16_t);
+    case ParserCallbacks::kInt32:
+      return sizeof(int32_t);
+    case ParserCallbacks::kUint32:
+      return sizeof(uint32_t);
+    case ParserCallbacks::kInt64:
+      return sizeof(int64_t);
+    case ParserCallbacks::kUint64:
+      return sizeof(uint64_t);
+    case ParserCallbacks::kFloat:
+      return sizeof(float);
+    case ParserCallbacks::kDouble:
+      return sizeof(double);
+    case ParserCallbacks::kHashValue:
+      return sizeof(HashValue);
+    default:
+      return 0;
+  }
+}
+
+template <typename Value>
+void ProcessScalar(ParserCallbacks::TokenType type, uint64_t bits,
+                   ParserCallbacks* builder) {
+  Value value;
+  memcpy(&value, &bits, sizeof(value));
+  builder->Process(type, &value, "");
+}
+
+}  // namespace
+
+const uint32_t ScriptCompiler::kVersion;
+
+ScriptCompiler::ScriptCompiler(ScriptByteCode* code) : code_(code) {}
 
 void ScriptCompiler::Process(TokenType type, const void* ptr,
                              string_view token) {
@@ -31,68 +102,74 @@ void ScriptCompiler::Process(TokenType type, const void* ptr,
     return;
   }
 
-  if (code_->empty()) {
-    writer_(&kByteCodeMarker, 0);
-  }
-
-  int code = type;
-  writer_(&code, 0);
+  Token record;
+  record.type = static_cast<uint32_t>(type);
+  record.offset = 0;
+  record.value = 0;
 
   switch (type) {
-    case kBool:
-      writer_(reinterpret_cast<const bool*>(ptr), 0);
-      break;
-    case kInt8:
-      writer_(reinterpret_cast<const int8_t*>(ptr), 0);
-      break;
-    case kUint8:
-      writer_(reinterpret_cast<const uint8_t*>(ptr), 0);
-      break;
-    case kInt16:
-      writer_(reinterpret_cast<const int16_t*>(ptr), 0);
-      break;
-    case kUint16:
-      writer_(reinterpret_cast<const uint16_t*>(ptr), 0);
-      break;
-    case kInt32:
-      writer_(reinterpret_cast<const int32_t*>(ptr), 0);
-      break;
-    case kUint32:
-      writer_(reinterpret_cast<const uint32_t*>(ptr), 0);
-      break;
-    case kInt64:
-      writer_(reinterpret_cast<const int64_t*>(ptr), 0);
-      break;
-    case kUint64:
-      writer_(reinterpret_cast<const uint64_t*>(ptr), 0);
-      break;
-    case kFloat:
-      writer_(reinterpret_cast<const float*>(ptr), 0);
-      break;
-    case kDouble:
-      writer_(reinterpret_cast<const double*>(ptr), 0);
-      break;
-    case kHashValue:
-      writer_(reinterpret_cast<const HashValue*>(ptr), 0);
-      break;
     case kSymbol: {
       const Symbol* symbol = reinterpret_cast<const Symbol*>(ptr);
-      writer_(&symbol->name, 0);
+      record.offset = AddString(symbol->name);
+      record.value = (static_cast<uint64_t>(symbol->name.size()) << 32) |
+                     static_cast<uint64_t>(symbol->value);
+    } break;
+    case kString: {
+      const string_view* str = reinterpret_cast<const string_view*>(ptr);
+      record.offset = AddString(*str);
+      record.value = str->size();
     } break;
-    case kString:
-      writer_(reinterpret_cast<const string_view*>(ptr), 0);
-      break;
-    case kEof:
-    case kPush:
-    case kPop:
-    case kPushArray:
-    case kPopArray:
-    case kPushMap:
-    case kPopMap:
-      break;
+    default: {
+      const size_t size = GetScalarSize(type);
+      if (size > 0) {
+        memcpy(&record.value, ptr, size);
+      }
+    } break;
+  }
+  tokens_.push_back(record);
+
+  if (type == kEof) {
+    Finish();
   }
 }
 
+uint32_t ScriptCompiler::AddString(string_view str) {
+  const std::string key = str.to_string();
+  auto iter = string_offsets_.find(key);
+  if (iter != string_offsets_.end()) {
+    return iter->second;
+  }
+  const uint32_t offset = static_cast<uint32_t>(strings_.size());
+  strings_.append(str.data(), str.size());
+  string_offsets_.emplace(key, offset);
+  return offset;
+}
+
+void ScriptCompiler::Finish() {
+  static_assert(sizeof(Token) == kTokenSize,
+                "Token records must be tightly packed.");
+
+  Header header;
+  header.marker = kByteCodeMarker;
+  memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.num_tokens = static_cast<uint32_t>(tokens_.size());
+  header.strings_size = static_cast<uint32_t>(strings_.size());
+
+  const size_t tokens_size = tokens_.size() * sizeof(Token);
+  code_->resize(sizeof(header) + tokens_size + strings_.size());
+  uint8_t* out = code_->data();
+  memcpy(out, &header, sizeof(header));
+  out += sizeof(header);
+  memcpy(out, tokens_.data(), tokens_size);
+  out += tokens_size;
+  memcpy(out, strings_.data(), strings_.size());
+
+  tokens_.clear();
+  strings_.clear();
+  string_offsets_.clear();
+}
+
 template <typename Value>
 static void DoProcess(ParserCallbacks::TokenType type, ParserCallbacks* builder,
                       LoadFromBuffer* reader, Value value) {
@@ -107,21 +184,15 @@ static void DoProcess(ParserCallbacks::TokenType type, ParserCallbacks* builder,
   builder->Process(type, &value, "");
 }
 
-void ScriptCompiler::Build(ParserCallbacks* builder) {
-  LoadFromBuffer reader(code_);
-
-  if (code_->empty()) {
-    LOG(ERROR) << "Bytecode is empty.";
-    return;
-  }
+// Builds byte code written before images were versioned.
+static void BuildUnversioned(const ScriptByteCode& code,
+                             ParserCallbacks* builder) {
+  LoadFromBuffer reader(&code);
 
   uint8_t marker = kByteCodeMarker;
   reader(&marker, 0);
-  if (marker != kByteCodeMarker) {
-    LOG(ERROR) << "Missing marker at start of bytecode.";
-    return;
-  }
 
+  using TokenType = ParserCallbacks::TokenType;
   bool done = false;
   while (!done) {
     int code = 0;
@@ -129,105 +200,403 @@ void ScriptCompiler::Build(ParserCallbacks* builder) {
 
     const TokenType type = static_cast<TokenType>(code);
     switch (type) {
-      case kBool: {
+      case ParserCallbacks::kBool: {
         DoProcess(type, builder, &reader, false);
         break;
       }
-      case kInt8: {
+      case ParserCallbacks::kInt8: {
         DoProcess(type, builder, &reader, int8_t(0));
         break;
       }
-      case kUint8: {
+      case ParserCallbacks::kUint8: {
         DoProcess(type, builder, &reader, uint8_t(0));
         break;
       }
-      case kInt16: {
+      case ParserCallbacks::kInt16: {
         DoProcess(type, builder, &reader, int16_t(0));
         break;
       }
-      case kUint16: {
+      case ParserCallbacks::kUint16: {
         DoProcess(type, builder, &reader, uint16_t(0));
         break;
       }
-      case kInt32: {
+      case ParserCallbacks::kInt32: {
         DoProcess(type, builder, &reader, int32_t(0));
         break;
       }
-      case kUint32: {
+      case ParserCallbacks::kUint32: {
         DoProcess(type, builder, &reader, uint32_t(0));
         break;
       }
-      case kInt64: {
+      case ParserCallbacks::kInt64: {
         DoProcess(type, builder, &reader, int64_t(0));
         break;
       }
-      case kUint64: {
+      case ParserCallbacks::kUint64: {
         DoProcess(type, builder, &reader, uint64_t(0));
         break;
       }
-      case kFloat: {
+      case ParserCallbacks::kFloat: {
         DoProcess(type, builder, &reader, 0.f);
         break;
       }
-      case kDouble: {
+      case ParserCallbacks::kDouble: {
         DoProcess(type, builder, &reader, 0.0);
         break;
       }
-      case kHashValue: {
+      case ParserCallbacks::kHashValue: {
         DoProcess<HashValue>(type, builder, &reader, 0);
         break;
       }
-      case kSymbol: {
+      case ParserCallbacks::kSymbol: {
         DoProcess(type, builder, &reader, Symbol());
         break;
       }
-      case kString: {
+      case ParserCallbacks::kString: {
         DoProcess(type, builder, &reader, string_view());
         break;
       }
-      case kPush: {
+      case ParserCallbacks::kPush:
+      case ParserCallbacks::kPop:
+      case ParserCallbacks::kPushArray:
+      case ParserCallbacks::kPopArray:
+      case ParserCallbacks::kPushMap:
+      case ParserCallbacks::kPopMap: {
         builder->Process(type, nullptr, "");
         break;
       }
-      case kPop: {
+      case ParserCallbacks::kEof: {
         builder->Process(type, nullptr, "");
+        done = true;
         break;
       }
-      case kPushArray: {
-        builder->Process(type, nullptr, "");
+    }
+  }
+}
+
+// Checks that the image in |bytes| can be built without reading out of bounds
+// or producing an unbalanced AST.
+static bool Validate(Span<uint8_t> bytes) {
+  Header header;
+  memcpy(&header, bytes.data(), sizeof(header));
+  if (header.version != ScriptCompiler::kVersion) {
+    LOG(ERROR) << "Unsupported bytecode version: " << header.version;
+    return false;
+  }
+
+  const uint64_t expected_size =
+      sizeof(header) +
+      static_cast<uint64_t>(header.num_tokens) * kTokenSize +
+      header.strings_size;
+  if (expected_size != bytes.size()) {
+    LOG(ERROR) << "Bytecode size does not match its header.";
+    return false;
+  }
+
+  const uint8_t* tokens = bytes.data() + sizeof(header);
+  int depth = 0;
+  for (uint32_t i = 0; i < header.num_tokens; ++i) {
+    uint32_t type = 0;
+    uint32_t offset = 0;
+    uint64_t value = 0;
+    const uint8_t* record = tokens + i * kTokenSize;
+    memcpy(&type, record, sizeof(type));
+    memcpy(&offset, record + 4, sizeof(offset));
+    memcpy(&value, record + 8, sizeof(value));
+
+    uint64_t length = 0;
+    switch (type) {
+      case ParserCallbacks::kPush:
+      case ParserCallbacks::kPushArray:
+      case ParserCallbacks::kPushMap:
+        ++depth;
         break;
-      }
-      case kPopArray: {
+      case ParserCallbacks::kPop:
+      case ParserCallbacks::kPopArray:
+      case ParserCallbacks::kPopMap:
+        if (--depth < 0) {
+          LOG(ERROR) << "Unbalanced scope in bytecode.";
+          return false;
+        }
+        break;
+      case ParserCallbacks::kEof:
+        if (i + 1 != header.num_tokens || depth != 0) {
+          LOG(ERROR) << "Unexpected end of bytecode.";
+          return false;
+        }
+        return true;
+      case ParserCallbacks::kBool:
+        if (value > 1) {
+          LOG(ERROR) << "Invalid bool in bytecode.";
+          return false;
+        }
+        break;
+      case ParserCallbacks::kSymbol:
+        length = value >> 32;
+        break;
+      case ParserCallbacks::kString:
+        length = value;
+        break;
+      default:
+        if (type > ParserCallbacks::kSymbol) {
+          LOG(ERROR) << "Invalid token in bytecode: " << type;
+          return false;
+        }
+        break;
+    }
+    if (static_cast<uint64_t>(offset) + length > header.strings_size) {
+      LOG(ERROR) << "String out of bounds in bytecode.";
+      return false;
+    }
+  }
+  LOG(ERROR) << "Missing end of bytecode.";
+  return false;
+}
+
+void ScriptCompiler::Build(ParserCallbacks* builder) {
+  Build(Span<uint8_t>(*code_), builder);
+}
+
+bool ScriptCompiler::Build(Span<uint8_t> bytes, ParserCallbacks* builder) {
+  if (bytes.empty()) {
+    LOG(ERROR) << "Bytecode is empty.";
+    return false;
+  }
+  if (bytes[0] != kByteCodeMarker) {
+    LOG(ERROR) << "Missing marker at start of bytecode.";
+    return false;
+  }
+  if (!HasHeader(bytes)) {
+    BuildUnversioned(ScriptByteCode(bytes.begin(), bytes.end()), builder);
+    return true;
+  }
+  if (!Validate(bytes)) {
+    return false;
+  }
+
+  Header header;
+  memcpy(&header, bytes.data(), sizeof(header));
+  const uint8_t* record = bytes.data() + sizeof(header);
+  const char* strings = reinterpret_cast<const char*>(
+      record + header.num_tokens * sizeof(Token));
+
+  Symbol symbol;
+  for (uint32_t i = 0; i < header.num_tokens; ++i, record += sizeof(Token)) {
+    Token token;
+    memcpy(&token, record, sizeof(token));
+
+    const TokenType type = static_cast<TokenType>(token.type);
+    switch (type) {
+      case kBool:
+        ProcessScalar<bool>(type, token.value, builder);
+        break;
+      case kInt8:
+        ProcessScalar<int8_t>(type, token.value, builder);
+        break;
+      case kUint8:
+        ProcessScalar<uint8_t>(type, token.value, builder);
+        break;
+      case kInt16:
+        ProcessScalar<int16_t>(type, token.value, builder);
+        break;
+      case kUint16:
+        ProcessScalar<uint16_t>(type, token.value, builder);
+        break;
+      case kInt32:
+        ProcessScalar<int32_t>(type, token.value, builder);
+        break;
+      case kUint32:
+        ProcessScalar<uint32_t>(type, token.value, builder);
+        break;
+      case kInt64:
+        ProcessScalar<int64_t>(type, token.value, builder);
+        break;
+      case kUint64:
+        ProcessScalar<uint64_t>(type, token.value, builder);
+        break;
+      case kFloat:
+        ProcessScalar<float>(type, token.value, builder);
+        break;
+      case kDouble:
+        ProcessScalar<double>(type, token.value, builder);
+        break;
+      case kHashValue:
+        ProcessScalar<HashValue>(type, token.value, builder);
+        break;
+      case kSymbol: {
+        symbol.name.assign(strings + token.offset,
+                           static_cast<size_t>(token.value >> 32));
+        symbol.value = static_cast<HashValue>(token.value);
+        builder->Process(type, &symbol, "");
+      } break;
+      case kString: {
+        const string_view str(strings + token.offset,
+                              static_cast<size_t>(token.value));
+        builder->Process(type, &str, "");
+      } break;
+      case kPush:
+      case kPop:
+      case kPushArray:
+      case kPopArray:
+      case kPushMap:
+      case kPopMap:
+      case kEof:
         builder->Process(type, nullptr, "");
         break;
-      }
+    }
+  }
+  return true;
+}
+
+template <typename Value>
+static ScriptValue CreateScalar(uint64_t bits) {
+  Value value;
+  memcpy(&value, &bits, sizeof(value));
+  return ScriptValue::Create(value);
+}
+
+bool ScriptCompiler::BuildAst(Span<uint8_t> bytes, AstNode* root) {
+  if (!HasHeader(bytes)) {
+    LOG(ERROR) << "Bytecode is not a versioned image.";
+    return false;
+  }
+  if (!Validate(bytes)) {
+    return false;
+  }
+
+  Header header;
+  memcpy(&header, bytes.data(), sizeof(header));
+  const uint8_t* records = bytes.data() + sizeof(header);
+  const char* strings = reinterpret_cast<const char*>(
+      records + header.num_tokens * sizeof(Token));
+
+  // Each list is built back to front, so every new node simply becomes the
+  // head of the list with the previous head as its |rest|.  The back of the
+  // stack holds the head of the innermost list being built.
+  std::vector<ScriptValue> lists(1);
+
+  struct SharedSymbol {
+    uint64_t bits = 0;
+    ScriptValue value;
+  };
+  std::unordered_map<uint32_t, SharedSymbol> symbols;
+  for (uint32_t i = header.num_tokens; i > 0; --i) {
+    Token token;
+    memcpy(&token, records + (i - 1) * sizeof(Token), sizeof(token));
+
+    ScriptValue value;
+    const TokenType type = static_cast<TokenType>(token.type);
+    switch (type) {
+      case kEof:
+        continue;
+      case kPop:
+      case kPopArray:
+      case kPopMap:
+        lists.emplace_back();
+        continue;
+      case kPush:
+      case kPushArray:
       case kPushMap: {
-        builder->Process(type, nullptr, "");
+        if (type != kPush) {
+          static const Symbol kMakeArray("make-array");
+          static const Symbol kMakeMap("make-map");
+          ScriptValue fn =
+              ScriptValue::Create(type == kPushArray ? kMakeArray : kMakeMap);
+          lists.back() = ScriptValue::Create(
+              AstNode(std::move(fn), std::move(lists.back())));
+        }
+        value = std::move(lists.back());
+        lists.pop_back();
+      } break;
+      case kBool:
+        value = CreateScalar<bool>(token.value);
         break;
-      }
-      case kPopMap: {
-        builder->Process(type, nullptr, "");
+      case kInt8:
+        value = CreateScalar<int8_t>(token.value);
         break;
-      }
-      case kEof: {
-        builder->Process(type, nullptr, "");
-        done = true;
+      case kUint8:
+        value = CreateScalar<uint8_t>(token.value);
+        break;
+      case kInt16:
+        value = CreateScalar<int16_t>(token.value);
+        break;
+      case kUint16:
+        value = CreateScalar<uint16_t>(token.value);
+        break;
+      case kInt32:
+        value = CreateScalar<int32_t>(token.value);
+        break;
+      case kUint32:
+        value = CreateScalar<uint32_t>(token.value);
+        break;
+      case kInt64:
+        value = CreateScalar<int64_t>(token.value);
+        break;
+      case kUint64:
+        value = CreateScalar<uint64_t>(token.value);
+        break;
+      case kFloat:
+        value = CreateScalar<float>(token.value);
+        break;
+      case kDouble:
+        value = CreateScalar<double>(token.value);
+        break;
+      case kHashValue:
+        value = CreateScalar<HashValue>(token.value);
+        break;
+      case kSymbol: {
+        // Symbols are never modified once loaded, so all occurrences of the
+        // same symbol can share a single value.
+        SharedSymbol& shared = symbols[token.offset];
+        if (shared.value.IsNil() || shared.bits != token.value) {
+          Symbol symbol;
+          symbol.name.assign(strings + token.offset,
+                             static_cast<size_t>(token.value >> 32));
+          symbol.value = static_cast<HashValue>(token.value);
+          value = ScriptValue::Create(std::move(symbol));
+          if (shared.value.IsNil()) {
+            shared.bits = token.value;
+            shared.value = value;
+          }
+        } else {
+          value = shared.value;
+        }
+      } break;
+      case kString:
+        value = ScriptValue::Create(std::string(
+            strings + token.offset, static_cast<size_t>(token.value)));
         break;
-      }
     }
+    lists.back() =
+        ScriptValue::Create(AstNode(std::move(value), std::move(lists.back())));
   }
+
+  const AstNode* node = lists.front().Get<AstNode>();
+  *root = node ? *node : AstNode();
+  return true;
 }
 
 void ScriptCompiler::Error(string_view token, string_view message) {
   LOG(WARNING) << "Error parsing " << token.to_string() << ": " <<
       message.to_string();
   code_->clear();
+  tokens_.clear();
+  strings_.clear();
+  string_offsets_.clear();
   error_ = true;
 }
 
-
 bool ScriptCompiler::IsByteCode(Span<uint8_t> bytes) {
   return !bytes.empty() && bytes[0] == kByteCodeMarker;
 }
 
+uint32_t ScriptCompiler::GetVersion(Span<uint8_t> bytes) {
+  if (!HasHeader(bytes)) {
+    return 0;
+  }
+  Header header;
+  memcpy(&header, bytes.data(), sizeof(header));
+  return header.version;
+}
+
 }  // namespace lull
@@ -17,6 +17,9 @@ limitations under the License.
 #ifndef LULLABY_MODULES_LULLSCRIPT_SCRIPT_COMPILER_H_
 #define LULLABY_MODULES_LULLSCRIPT_SCRIPT_COMPILER_H_
 
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "lullaby/modules/serialize/buffer_serializer.h"
 #include "lullaby/modules/lullscript/script_parser.h"
@@ -35,26 +38,65 @@ class ScriptEnv;
 // The byte array can then be converted (again using the ScriptCompiler) to
 // the appropriate runtime structure by calling ScriptCompiler::Build and
 // passing it another set of ParserCallbacks.
+//
+// The byte array is a versioned image consisting of a header, a table of
+// fixed-size token records and a table of the (de-duplicated) string data
+// referenced by symbols and strings.  Symbols store their precomputed hash.
+// Build validates the entire image up front and then reads the tokens in place,
+// so loading neither copies the byte array nor re-hashes any symbol names.
+// Because the records have a fixed size, BuildAst can also walk them backwards
+// and create each AstNode directly in front of its already built siblings.
+// Byte arrays written by older versions of the compiler (an unversioned,
+// serialized token stream) can still be built.
 class ScriptCompiler : public ParserCallbacks {
  public:
+  // The version of the image written by the ScriptCompiler.  Bump whenever the
+  // layout of the header or token records changes.
+  static const uint32_t kVersion = 1;
+
   explicit ScriptCompiler(ScriptByteCode* code);
 
-  // Stores the |type| and associated data into the byte array buffer.
+  // Stores the |type| and associated data into the byte array buffer.  The
+  // image is written when the kEof token is processed.
   void Process(TokenType type, const void* ptr, string_view token) override;
 
   // Processes the stored byte array buffer into another sequence of
   // ParserCallbacks.
   void Build(ParserCallbacks* builder);
 
+  // Processes the |bytes| into a sequence of ParserCallbacks.  Returns false
+  // (without invoking the |builder|) if the bytes are not valid byte code.
+  static bool Build(Span<uint8_t> bytes, ParserCallbacks* builder);
+
+  // Builds the AST for the versioned image in |bytes| directly into |root|,
+  // without going through ParserCallbacks.  Returns false if the bytes are not
+  // a valid image.  Unversioned byte code must be built with Build instead.
+  static bool BuildAst(Span<uint8_t> bytes, AstNode* root);
+
   // Sets the internal state to an error state.
   void Error(string_view token, string_view message) override;
 
   // Determines if the specified array of bytes is actually ScriptByteCode.
   static bool IsByteCode(Span<uint8_t> bytes);
 
+  // Returns the image version of the ScriptByteCode in |bytes|, or 0 if it was
+  // written by a compiler that predates versioning.
+  static uint32_t GetVersion(Span<uint8_t> bytes);
+
  private:
+  struct Token {
+    uint32_t type;
+    uint32_t offset;
+    uint64_t value;
+  };
+
+  uint32_t AddString(string_view str);
+  void Finish();
+
   ScriptByteCode* code_;
-  SaveToBuffer writer_;
+  std::vector<Token> tokens_;
+  std::string strings_;
+  std::unordered_map<std::string, uint32_t> string_offsets_;
   bool error_ = false;
 };
 
@@ -0,0 +1,143 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <string>
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/lullscript/script_compiler.h"
+#include "lullaby/modules/lullscript/script_env.h"
+#include "lullaby/modules/serialize/buffer_serializer.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+
+// Writes byte code in the format used before images were versioned, ie. a
+// serialized stream of tokens.
+class UnversionedCompiler : public ParserCallbacks {
+ public:
+  explicit UnversionedCompiler(ScriptByteCode* code) : writer_(code) {
+    const uint8_t marker = 0;
+    writer_(&marker, 0);
+  }
+
+  void Process(TokenType type, const void* ptr, string_view token) override {
+    int code = type;
+    writer_(&code, 0);
+    switch (type) {
+      case kInt32:
+        writer_(reinterpret_cast<const int32_t*>(ptr), 0);
+        break;
+      case kFloat:
+        writer_(reinterpret_cast<const float*>(ptr), 0);
+        break;
+      case kSymbol:
+        writer_(&reinterpret_cast<const Symbol*>(ptr)->name, 0);
+        break;
+      case kString:
+        writer_(reinterpret_cast<const string_view*>(ptr), 0);
+        break;
+      default:
+        break;
+    }
+  }
+
+  void Error(string_view token, string_view message) override {}
+
+ private:
+  SaveToBuffer writer_;
+};
+
+// Generates a script with |count| functions similar to those found in
+// script-heavy blueprints.
+std::string GenerateScript(int count) {
+  std::string src = "(do ";
+  for (int i = 0; i < count; ++i) {
+    const std::string n = std::to_string(i);
+    src += "(def on-event-" + n + " (entity value) (do ";
+    src += "(= name 'handler-" + n + "') ";
+    src += "(= scale (* value 1.5f)) ";
+    src += "(if (> scale " + n + ") (? name scale) (? 'skipped' entity)) ";
+    src += "(+ scale " + n + ")";
+    src += ")) ";
+  }
+  src += "(on-event-0 1 2))";
+  return src;
+}
+
+const int kNumFunctions = 200;
+
+void BM_LoadFromSource(benchmark::State& state) {
+  const std::string src = GenerateScript(kNumFunctions);
+  ScriptEnv env;
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(env.Read(src));
+  }
+  state.SetBytesProcessed(state.iterations() * src.size());
+}
+BENCHMARK(BM_LoadFromSource);
+
+void BM_LoadUnversionedByteCode(benchmark::State& state) {
+  ScriptByteCode code;
+  UnversionedCompiler compiler(&code);
+  ParseScript(GenerateScript(kNumFunctions), &compiler);
+
+  ScriptEnv env;
+  while (state.KeepRunning()) {
+    // Before byte code could be read in place, LoadOrRead copied the bytes.
+    benchmark::DoNotOptimize(
+        env.Load(ScriptByteCode(code.data(), code.data() + code.size())));
+  }
+  state.SetBytesProcessed(state.iterations() * code.size());
+}
+BENCHMARK(BM_LoadUnversionedByteCode);
+
+void BM_LoadByteCode(benchmark::State& state) {
+  ScriptEnv env;
+  const ScriptByteCode code = env.Compile(GenerateScript(kNumFunctions));
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(env.LoadOrRead(code));
+  }
+  state.SetBytesProcessed(state.iterations() * code.size());
+}
+BENCHMARK(BM_LoadByteCode);
+
+// This test verifies that the benchmark code actually behaves correctly.
+TEST(ScriptCompilerBenchmarkTest, BenchmarkTestVerification) {
+  const std::string src = GenerateScript(4);
+  ScriptByteCode unversioned;
+  UnversionedCompiler compiler(&unversioned);
+  ParseScript(src, &compiler);
+
+  ScriptEnv env;
+  const ScriptByteCode code = env.Compile(src);
+  EXPECT_THAT(ScriptCompiler::GetVersion(unversioned), Eq(0u));
+  EXPECT_THAT(ScriptCompiler::GetVersion(code), Eq(ScriptCompiler::kVersion));
+
+  ScriptValue scripts[] = {env.Read(src), env.Load(unversioned),
+                           env.LoadOrRead(code)};
+  for (ScriptValue& script : scripts) {
+    ScriptEnv eval_env;
+    const ScriptValue result = eval_env.Eval(script);
+    ASSERT_THAT(result.Is<float>(), Eq(true));
+    EXPECT_THAT(*result.Get<float>(), Eq(3.f));
+  }
+}
+
+}  // namespace
+}  // namespace lull
@@ -195,5 +195,111 @@ TEST(ScriptCompilerTest, CompileAndBuild) {
   EXPECT_THAT(callbacks.parsed, Eq(callbacks.expected));
 }
 
+TEST(ScriptCompilerTest, Version) {
+  std::vector<uint8_t> buffer;
+  ScriptCompiler compiler(&buffer);
+  ParseScript("(a b)", &compiler);
+
+  EXPECT_THAT(ScriptCompiler::IsByteCode(buffer), Eq(true));
+  EXPECT_THAT(ScriptCompiler::GetVersion(buffer),
+              Eq(ScriptCompiler::kVersion));
+}
+
+TEST(ScriptCompilerTest, DeduplicatesStrings) {
+  std::vector<uint8_t> once;
+  ScriptCompiler compiler1(&once);
+  ParseScript("(symbol)", &compiler1);
+
+  std::vector<uint8_t> twice;
+  ScriptCompiler compiler2(&twice);
+  ParseScript("(symbol symbol)", &compiler2);
+
+  // The second image only needs an additional token, not a second copy of the
+  // symbol name.
+  EXPECT_THAT(twice.size() - once.size(), Eq(size_t(16)));
+
+  TestParserCallbacks callbacks;
+  EXPECT_THAT(ScriptCompiler::Build(twice, &callbacks), Eq(true));
+  callbacks.Expect(ParserCallbacks::kPush);
+  callbacks.Expect(ParserCallbacks::kSymbol, Symbol("symbol"));
+  callbacks.Expect(ParserCallbacks::kSymbol, Symbol("symbol"));
+  callbacks.Expect(ParserCallbacks::kPop);
+  callbacks.Expect(ParserCallbacks::kEof);
+  EXPECT_THAT(callbacks.parsed, Eq(callbacks.expected));
+}
+
+TEST(ScriptCompilerTest, BuildUnversioned) {
+  // Byte code as written by the compiler before images were versioned.
+  std::vector<uint8_t> buffer;
+  SaveToBuffer writer(&buffer);
+  const uint8_t marker = 0;
+  writer(&marker, 0);
+  int code = ParserCallbacks::kPush;
+  writer(&code, 0);
+  code = ParserCallbacks::kInt32;
+  writer(&code, 0);
+  const int32_t value = 123;
+  writer(&value, 0);
+  code = ParserCallbacks::kSymbol;
+  writer(&code, 0);
+  const std::string name = "world";
+  writer(&name, 0);
+  code = ParserCallbacks::kPop;
+  writer(&code, 0);
+  code = ParserCallbacks::kEof;
+  writer(&code, 0);
+
+  EXPECT_THAT(ScriptCompiler::IsByteCode(buffer), Eq(true));
+  EXPECT_THAT(ScriptCompiler::GetVersion(buffer), Eq(0u));
+
+  TestParserCallbacks callbacks;
+  EXPECT_THAT(ScriptCompiler::Build(buffer, &callbacks), Eq(true));
+  callbacks.Expect(ParserCallbacks::kPush);
+  callbacks.Expect(ParserCallbacks::kInt32, 123);
+  callbacks.Expect(ParserCallbacks::kSymbol, Symbol("world"));
+  callbacks.Expect(ParserCallbacks::kPop);
+  callbacks.Expect(ParserCallbacks::kEof);
+  EXPECT_THAT(callbacks.parsed, Eq(callbacks.expected));
+}
+
+TEST(ScriptCompilerTest, RejectsInvalidByteCode) {
+  std::vector<uint8_t> buffer;
+  ScriptCompiler compiler(&buffer);
+  ParseScript("(1 (2 'hello') world)", &compiler);
+  ASSERT_THAT(buffer.empty(), Eq(false));
+
+  TestParserCallbacks callbacks;
+
+  // Truncated.
+  std::vector<uint8_t> truncated(buffer.begin(), buffer.end() - 1);
+  EXPECT_THAT(ScriptCompiler::Build(truncated, &callbacks), Eq(false));
+
+  // Unsupported version.
+  std::vector<uint8_t> version = buffer;
+  version[4] = static_cast<uint8_t>(ScriptCompiler::kVersion + 1);
+  EXPECT_THAT(ScriptCompiler::Build(version, &callbacks), Eq(false));
+
+  // Token type out of range.
+  std::vector<uint8_t> type = buffer;
+  type[16] = 0xff;
+  EXPECT_THAT(ScriptCompiler::Build(type, &callbacks), Eq(false));
+
+  // Unbalanced scope: replace the first push with a pop.
+  std::vector<uint8_t> scope = buffer;
+  scope[16] = ParserCallbacks::kPop;
+  EXPECT_THAT(ScriptCompiler::Build(scope, &callbacks), Eq(false));
+
+  // String offset out of bounds: the string is the 5th token.
+  std::vector<uint8_t> offset = buffer;
+  offset[16 + 4 * 16 + 7] = 0xff;
+  EXPECT_THAT(ScriptCompiler::Build(offset, &callbacks), Eq(false));
+
+  // None of the invalid images should have been processed.
+  EXPECT_THAT(callbacks.parsed.empty(), Eq(true));
+
+  EXPECT_THAT(ScriptCompiler::Build(buffer, &callbacks), Eq(true));
+  EXPECT_THAT(callbacks.parsed.empty(), Eq(false));
+}
+
 }  // namespace
 }  // namespace lull
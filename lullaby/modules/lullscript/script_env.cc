@@ -126,15 +126,28 @@ ScriptByteCode ScriptEnv::Compile(string_view src) {
 }
 
 ScriptValue ScriptEnv::Load(const ScriptByteCode& code) {
-  ScriptCompiler compiler(const_cast<ScriptByteCode*>(&code));
-  ScriptAstBuilder builder(this);
-  compiler.Build(&builder);
-  return Create(builder.GetRoot());
+  return Load(Span<uint8_t>(code));
+}
+
+ScriptValue ScriptEnv::Load(Span<uint8_t> code) {
+  if (ScriptCompiler::GetVersion(code) == 0) {
+    ScriptAstBuilder builder(this);
+    if (!ScriptCompiler::Build(code, &builder)) {
+      return Create(AstNode());
+    }
+    return Create(builder.GetRoot());
+  }
+
+  AstNode root;
+  if (!ScriptCompiler::BuildAst(code, &root)) {
+    return Create(AstNode());
+  }
+  return Create(std::move(root));
 }
 
 ScriptValue ScriptEnv::LoadOrRead(Span<uint8_t> code) {
   if (ScriptCompiler::IsByteCode(code)) {
-    return Load(ScriptByteCode(code.data(), code.data() + code.size()));
+    return Load(code);
   } else {
     const char* str = reinterpret_cast<const char*>(code.data());
     return Read(string_view(str, code.size()));
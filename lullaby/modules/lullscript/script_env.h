@@ -61,10 +61,15 @@ class ScriptEnv {
   // Converts byte code into an AST stored in a ScriptValue.
   ScriptValue Load(const ScriptByteCode& code);
 
+  // Converts byte code into an AST stored in a ScriptValue.  The |code| is read
+  // in place, so it can point directly into a loaded (or mapped) file.
+  ScriptValue Load(Span<uint8_t> code);
+
   // Converts source code into an AST stored in a ScriptValue.
   ScriptValue Read(string_view src);
 
-  // Evaluates the AST represented by the ScriptValue.
+  // Converts either byte code or source code into an AST stored in a
+  // ScriptValue.
   ScriptValue LoadOrRead(Span<uint8_t> code);
 
   // Evaluates the AST represented by the ScriptValue.
@@ -19,6 +19,7 @@ limitations under the License.
 #include "gtest/gtest.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/script/function_binder.h"
+#include "lullaby/modules/lullscript/functions/functions.h"
 #include "lullaby/modules/lullscript/script_frame.h"
 #include "lullaby/util/math.h"
 #include "lullaby/util/registry.h"
@@ -55,6 +56,49 @@ TEST(ScriptEnvTest, ReadEval) {
   EXPECT_THAT(*res.Get<int>(), Eq(2));
 }
 
+// Returns true if the ASTs |lhs| and |rhs| have the same structure and values.
+bool IsSameAst(const ScriptValue& lhs, const ScriptValue& rhs) {
+  if (lhs.GetTypeId() != rhs.GetTypeId()) {
+    return false;
+  }
+  const AstNode* lhs_node = lhs.Get<AstNode>();
+  const AstNode* rhs_node = rhs.Get<AstNode>();
+  if (lhs_node && rhs_node) {
+    return IsSameAst(lhs_node->first, rhs_node->first) &&
+           IsSameAst(lhs_node->rest, rhs_node->rest);
+  }
+  const Symbol* lhs_symbol = lhs.Get<Symbol>();
+  const Symbol* rhs_symbol = rhs.Get<Symbol>();
+  if (lhs_symbol && rhs_symbol) {
+    return *lhs_symbol == *rhs_symbol;
+  }
+  return Stringify(lhs) == Stringify(rhs);
+}
+
+TEST(ScriptEnvTest, LoadMatchesRead) {
+  const char* src =
+      "(do (= a [1 2u 3l 4.5f 6.0]) (= b {(:key 'str') (:other true)}) "
+      "(? 'hello' :sym a ()) (+ 1 2))";
+
+  ScriptEnv env;
+  const ScriptByteCode code = env.Compile(src);
+  const ScriptValue read = env.Read(src);
+  const ScriptValue loaded = env.LoadOrRead(code);
+
+  EXPECT_THAT(IsSameAst(loaded, read), Eq(true));
+  EXPECT_THAT(IsSameAst(loaded, env.Read("(do (+ 1 2))")), Eq(false));
+  EXPECT_THAT(*env.Eval(loaded).Get<int>(), Eq(3));
+}
+
+TEST(ScriptEnvTest, LoadInvalidByteCode) {
+  ScriptEnv env;
+  ScriptByteCode code = env.Compile("(+ 1 1)");
+  code.pop_back();
+
+  const ScriptValue script = env.Load(code);
+  EXPECT_THAT(env.Eval(script).IsNil(), Eq(true));
+}
+
 TEST(ScriptEnvText, Exec) {
   ScriptEnv env;
   ScriptValue res = env.Exec("(+ 1 1)");
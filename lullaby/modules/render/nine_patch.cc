@@ -23,6 +23,41 @@ limitations under the License.
 
 namespace lull {
 
+bool NinePatch::operator==(const NinePatch& rhs) const {
+  return size == rhs.size && left_slice == rhs.left_slice &&
+         right_slice == rhs.right_slice && bottom_slice == rhs.bottom_slice &&
+         top_slice == rhs.top_slice && original_size == rhs.original_size &&
+         subdivisions == rhs.subdivisions &&
+         texture_alt_min == rhs.texture_alt_min &&
+         texture_alt_max == rhs.texture_alt_max;
+}
+
+namespace {
+template <typename T>
+HashValue HashCombine(HashValue basis, const T& value) {
+  return Hash(basis, reinterpret_cast<const char*>(&value), sizeof(value));
+}
+}  // namespace
+
+HashValue Hash(const NinePatch& nine_patch) {
+  HashValue hash = kHashOffsetBasis;
+  hash = HashCombine(hash, nine_patch.size.x);
+  hash = HashCombine(hash, nine_patch.size.y);
+  hash = HashCombine(hash, nine_patch.left_slice);
+  hash = HashCombine(hash, nine_patch.right_slice);
+  hash = HashCombine(hash, nine_patch.bottom_slice);
+  hash = HashCombine(hash, nine_patch.top_slice);
+  hash = HashCombine(hash, nine_patch.original_size.x);
+  hash = HashCombine(hash, nine_patch.original_size.y);
+  hash = HashCombine(hash, nine_patch.subdivisions.x);
+  hash = HashCombine(hash, nine_patch.subdivisions.y);
+  hash = HashCombine(hash, nine_patch.texture_alt_min.x);
+  hash = HashCombine(hash, nine_patch.texture_alt_min.y);
+  hash = HashCombine(hash, nine_patch.texture_alt_max.x);
+  hash = HashCombine(hash, nine_patch.texture_alt_max.y);
+  return hash;
+}
+
 void NinePatchFromDef(const NinePatchDef* def, NinePatch* nine_patch) {
   MathfuVec2FromFbVec2(def->size(), &nine_patch->size);
   nine_patch->left_slice = def->left_slice();
@@ -106,6 +141,15 @@ void ComputeVertexValues(float size, float original_size, float low_slice,
 }
 
 void GenerateNinePatchMesh(const NinePatch& nine_patch, MeshData* mesh) {
+  // Save the current number of vertices to use as a base index during index
+  // generation.  This allows a nine patch mesh to be tacked on to the end of an
+  // existing mesh.
+  const uint32_t num_verts = static_cast<uint32_t>(mesh->GetNumVertices());
+  GenerateNinePatchVertices(nine_patch, mesh);
+  GenerateNinePatchIndices(nine_patch, num_verts, mesh);
+}
+
+void GenerateNinePatchVertices(const NinePatch& nine_patch, MeshData* mesh) {
   const mathfu::vec2 half_size = nine_patch.size * .5f;
 
   // The + 2 + 1 here is to add 2 extra rows/columns for the slices and one more
@@ -170,11 +214,6 @@ void GenerateNinePatchMesh(const NinePatch& nine_patch, MeshData* mesh) {
       2 + static_cast<int>(indices_per_height *
                            (bottom_patch_width + middle_patch_size.y));
 
-  // Save the current number of vertices to use later as a base index during
-  // index generation.  This allows a nine patch mesh to be tacked on to the end
-  // of an existing mesh.
-  const uint32_t num_verts = static_cast<uint32_t>(mesh->GetNumVertices());
-
   // Now generate the mesh.  It is nothing more than a tessellated quad with
   // some fancy positioning of vertices and UVs.
   float interval_y = 0.0f;
@@ -215,19 +254,23 @@ void GenerateNinePatchMesh(const NinePatch& nine_patch, MeshData* mesh) {
                                  1.0f - v0, u1, v1);
     }
   }
+}
 
-  // Generate indices for the nine-patch mesh.
+void GenerateNinePatchIndices(const NinePatch& nine_patch, uint32_t base_vertex,
+                              MeshData* mesh) {
+  const int col_vert_count = nine_patch.subdivisions.x + 2 + 1;
+  const int row_vert_count = nine_patch.subdivisions.y + 2 + 1;
   for (int y_index = 1; y_index < row_vert_count; ++y_index) {
     const int row = col_vert_count * y_index;
     const int last_row = row - col_vert_count;
 
     for (int x_index = 1; x_index < col_vert_count; ++x_index) {
-      mesh->AddIndex(num_verts + last_row + x_index - 1);
-      mesh->AddIndex(num_verts + last_row + x_index);
-      mesh->AddIndex(num_verts + row + x_index - 1);
-      mesh->AddIndex(num_verts + last_row + x_index);
-      mesh->AddIndex(num_verts + row + x_index);
-      mesh->AddIndex(num_verts + row + x_index - 1);
+      mesh->AddIndex(base_vertex + last_row + x_index - 1);
+      mesh->AddIndex(base_vertex + last_row + x_index);
+      mesh->AddIndex(base_vertex + row + x_index - 1);
+      mesh->AddIndex(base_vertex + last_row + x_index);
+      mesh->AddIndex(base_vertex + row + x_index);
+      mesh->AddIndex(base_vertex + row + x_index - 1);
     }
   }
 }
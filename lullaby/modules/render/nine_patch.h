@@ -18,6 +18,7 @@ limitations under the License.
 #define LULLABY_UTIL_NINE_PATCH_H_
 
 #include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/util/hash.h"
 #include "lullaby/generated/nine_patch_def_generated.h"
 #include "mathfu/constants.h"
 #include "mathfu/glsl_mappings.h"
@@ -48,6 +49,19 @@ struct NinePatch {
     // * 2 for 2 triangles per quad.
     return (subdivisions.x + 2) * (subdivisions.y + 2) * 3 * 2;
   }
+
+  bool operator==(const NinePatch& rhs) const;
+  bool operator!=(const NinePatch& rhs) const { return !(*this == rhs); }
+};
+
+/// Hashes all the parameters of a NinePatch, allowing identical nine patches to
+/// share a single mesh.
+HashValue Hash(const NinePatch& nine_patch);
+
+struct NinePatchHash {
+  size_t operator()(const NinePatch& nine_patch) const {
+    return Hash(nine_patch);
+  }
 };
 
 void NinePatchFromDef(const NinePatchDef* def, NinePatch* nine_patch);
@@ -55,6 +69,16 @@ void NinePatchFromDef(const NinePatchDef* def, NinePatch* nine_patch);
 /// Computes the |mesh| given the data in |nine_patch|.
 void GenerateNinePatchMesh(const NinePatch& nine_patch, MeshData* mesh);
 
+/// Adds the vertices for |nine_patch| to the |mesh|.  The vertex positions and
+/// texture coordinates depend on the size of the nine patch.
+void GenerateNinePatchVertices(const NinePatch& nine_patch, MeshData* mesh);
+
+/// Adds the indices for |nine_patch| to the |mesh|, where |base_vertex| is the
+/// index of the first vertex of the nine patch.  The indices only depend on the
+/// subdivisions of the nine patch, so they can be reused when it is resized.
+void GenerateNinePatchIndices(const NinePatch& nine_patch, uint32_t base_vertex,
+                              MeshData* mesh);
+
 }  // namespace lull
 
 #endif  // LULLABY_UTIL_NINE_PATCH_H_
@@ -16,10 +16,34 @@ limitations under the License.
 
 #include "lullaby/systems/animation/animation_channel.h"
 
+#include <cmath>
+
 #include "lullaby/systems/animation/animation_system.h"
 #include "lullaby/util/logging.h"
 
 namespace lull {
+namespace {
+
+void InitRigMotivator(motive::RigMotivator* motivator,
+                      motive::MotiveEngine* engine,
+                      const motive::RigAnim* rig_anim) {
+  const motive::RigInit init(*rig_anim, rig_anim->bone_parents(),
+                             rig_anim->NumBones());
+  motivator->Initialize(init, engine);
+}
+
+motive::SplinePlayback GetRigPlayback(const PlaybackParameters& params) {
+  motive::SplinePlayback playback;
+  playback.repeat = params.looping;
+  playback.playback_rate = params.speed;
+  playback.blend_x = static_cast<float>(
+      AnimationSystem::GetMotiveTimeFromSeconds(params.blend_time_s));
+  playback.start_x = -static_cast<float>(
+      AnimationSystem::GetMotiveTimeFromSeconds(params.start_delay_s));
+  return playback;
+}
+
+}  // namespace
 
 AnimationChannel::AnimationChannel(Registry* registry, int num_dimensions,
                                    size_t pool_size)
@@ -38,16 +62,19 @@ AnimationChannel::Animation* AnimationChannel::DoInitialize(
     Entity entity, motive::MotiveEngine* engine, const void* init_data) {
   auto anim = anims_.Get(entity);
   if (anim) {
+    if (anim->shared_key != 0 && init_data != nullptr) {
+      // The Entity is switching from a shared rig motivator to its own.
+      ReleaseSharedRig(anim);
+      InitRigMotivator(&anim->rig_motivator, engine,
+                       reinterpret_cast<const motive::RigAnim*>(init_data));
+    }
     return anim;
   }
 
   if (IsRigChannel()) {
-    const motive::RigAnim* rig_anim =
-        reinterpret_cast<const motive::RigAnim*>(init_data);
-    const motive::RigInit init(*rig_anim, rig_anim->bone_parents(),
-                               rig_anim->NumBones());
     anim = anims_.Emplace(entity);
-    anim->rig_motivator.Initialize(init, engine);
+    InitRigMotivator(&anim->rig_motivator, engine,
+                     reinterpret_cast<const motive::RigAnim*>(init_data));
   } else {
     // Get the current values for the channel.
     float target_values[kMaxDimensions] = {0.f};
@@ -75,18 +102,39 @@ bool AnimationChannel::Get(Entity entity, float* values, size_t len) const {
   return false;
 }
 
-void AnimationChannel::Update(std::vector<AnimationId>* completed) {
+void AnimationChannel::Update(FrameVector<AnimationId>* completed) {
   // Track which animations need to be cancelled since we do not want to remove
   // them during iteration.
-  std::vector<Entity> anims_to_cancel;
+  FrameVector<Entity> anims_to_cancel(completed->get_allocator());
+
+  for (auto& iter : shared_rigs_) {
+    iter.second.posed_entity = kNullEntity;
+  }
 
   anims_.ForEach([&](Animation& anim) {
     const Entity entity = anim.GetEntity();
+    const motive::RigMotivator& rig_motivator = GetRigMotivator(anim);
 
-    if (anim.rig_motivator.Valid()) {
+    if (rig_motivator.Valid()) {
       // Update the Component data to match the motivator's transforms.
-      const int num_bones = anim.rig_motivator.DefiningAnim()->NumBones();
-      SetRig(entity, anim.rig_motivator.GlobalTransforms(), num_bones);
+      const int num_bones = rig_motivator.DefiningAnim()->NumBones();
+      const mathfu::AffineTransform* transforms =
+          rig_motivator.GlobalTransforms();
+      SharedRig* shared = nullptr;
+      if (anim.shared_key != 0) {
+        auto shared_iter = shared_rigs_.find(anim.shared_key);
+        if (shared_iter != shared_rigs_.end()) {
+          shared = &shared_iter->second;
+        }
+      }
+      if (shared && shared->posed_entity != kNullEntity) {
+        SetSharedRig(entity, shared->posed_entity, transforms, num_bones);
+      } else {
+        SetRig(entity, transforms, num_bones);
+        if (shared) {
+          shared->posed_entity = entity;
+        }
+      }
     } else if (anim.motivator.Valid()) {
       // Update the Component data to match the motivator's current values.
       float values[kMaxDimensions];
@@ -115,6 +163,9 @@ AnimationId AnimationChannel::Cancel(Entity entity) {
   Animation* anim = anims_.Get(entity);
   if (anim) {
     const AnimationId id = anim->id;
+    if (anim->shared_key != 0) {
+      ReleaseSharedRig(anim);
+    }
     anims_.Destroy(entity);
     return id;
   }
@@ -249,21 +300,117 @@ AnimationId AnimationChannel::Play(Entity entity, motive::MotiveEngine* engine,
     return kNullAnimation;
   }
 
-  motive::SplinePlayback playback;
-  playback.repeat = params.looping;
-  playback.playback_rate = params.speed;
-  playback.blend_x = static_cast<float>(
-      AnimationSystem::GetMotiveTimeFromSeconds(params.blend_time_s));
-  playback.start_x = -static_cast<float>(
-      AnimationSystem::GetMotiveTimeFromSeconds(params.start_delay_s));
-
   anim->total_time =
       params.looping ? motive::kMotiveTimeEndless : rig_anim->end_time();
 
-  anim->rig_motivator.BlendToAnim(*rig_anim, playback);
+  anim->rig_motivator.BlendToAnim(*rig_anim, GetRigPlayback(params));
   return UpdateId(anim, id);
 }
 
+AnimationId AnimationChannel::PlayShared(Entity entity,
+                                         motive::MotiveEngine* engine,
+                                         AnimationId id, HashValue key,
+                                         const motive::RigAnim* init_anim,
+                                         const motive::RigAnim* rig_anim,
+                                         const PlaybackParameters& params,
+                                         motive::MotiveTime time) {
+  if (!IsRigChannel()) {
+    LOG(DFATAL) << "Shared playback is only supported by rig channels.";
+    return kNullAnimation;
+  }
+
+  auto iter = shared_rigs_.find(key);
+  if (iter != shared_rigs_.end() && (iter->second.rig_anim != rig_anim ||
+                                     iter->second.init_anim != init_anim)) {
+    // A different playback hashed to the same key, so play this one on the
+    // Entity's own motivator instead.
+    Unshare(entity, engine, time);
+    Init(entity, engine, init_anim);
+    return Play(entity, engine, id, rig_anim, params);
+  }
+
+  SharedRig& shared = shared_rigs_[key];
+  if (!shared.rig_motivator.Valid()) {
+    InitRigMotivator(&shared.rig_motivator, engine, init_anim);
+    shared.init_anim = init_anim;
+    shared.rig_anim = rig_anim;
+    shared.playback = GetRigPlayback(params);
+    shared.start_time = time;
+    shared.rig_motivator.BlendToAnim(*rig_anim, shared.playback);
+  }
+
+  Animation* anim = anims_.Get(entity);
+  if (anim == nullptr) {
+    anim = anims_.Emplace(entity);
+  }
+  if (anim->shared_key != key) {
+    ++shared.num_entities;
+    if (anim->shared_key != 0) {
+      ReleaseSharedRig(anim);
+    }
+    anim->rig_motivator.Invalidate();
+    anim->shared_key = key;
+  }
+
+  anim->total_time =
+      params.looping ? motive::kMotiveTimeEndless : rig_anim->end_time();
+  return UpdateId(anim, id);
+}
+
+void AnimationChannel::Unshare(Entity entity, motive::MotiveEngine* engine,
+                               motive::MotiveTime time) {
+  Animation* anim = anims_.Get(entity);
+  if (anim == nullptr || anim->shared_key == 0) {
+    return;
+  }
+
+  auto iter = shared_rigs_.find(anim->shared_key);
+  if (iter == shared_rigs_.end()) {
+    anim->shared_key = 0;
+    return;
+  }
+
+  // Start the Entity's own motivator where the shared one currently is.
+  const SharedRig& shared = iter->second;
+  motive::SplinePlayback playback = shared.playback;
+  float x = playback.start_x + static_cast<float>(time - shared.start_time) *
+                                   playback.playback_rate;
+  const float end_x = static_cast<float>(shared.rig_anim->end_time());
+  if (playback.repeat && end_x > 0.f && x > end_x) {
+    x = std::fmod(x, end_x);
+  }
+  playback.start_x = x;
+  playback.blend_x = 0.f;
+
+  InitRigMotivator(&anim->rig_motivator, engine, shared.init_anim);
+  anim->rig_motivator.BlendToAnim(*shared.rig_anim, playback);
+  ReleaseSharedRig(anim);
+}
+
+bool AnimationChannel::IsShared(Entity entity) const {
+  const Animation* anim = anims_.Get(entity);
+  return anim && anim->shared_key != 0;
+}
+
+const motive::RigMotivator& AnimationChannel::GetRigMotivator(
+    const Animation& anim) const {
+  if (anim.shared_key != 0) {
+    auto iter = shared_rigs_.find(anim.shared_key);
+    if (iter != shared_rigs_.end()) {
+      return iter->second.rig_motivator;
+    }
+  }
+  return anim.rig_motivator;
+}
+
+void AnimationChannel::ReleaseSharedRig(Animation* anim) {
+  auto iter = shared_rigs_.find(anim->shared_key);
+  anim->shared_key = 0;
+  if (iter != shared_rigs_.end() && --iter->second.num_entities <= 0) {
+    shared_rigs_.erase(iter);
+  }
+}
+
 void AnimationChannel::SetPlaybackRate(Entity entity, float rate) {
   Animation* anim = anims_.Get(entity);
   if (!anim) {
@@ -271,6 +418,10 @@ void AnimationChannel::SetPlaybackRate(Entity entity, float rate) {
   }
 
   if (IsRigChannel()) {
+    if (anim->shared_key != 0) {
+      LOG(DFATAL) << "Unshare the rig motivator before changing its rate.";
+      return;
+    }
     anim->rig_motivator.SetPlaybackRate(rate);
   } else {
     anim->motivator.SetSplinePlaybackRate(rate);
@@ -287,7 +438,7 @@ bool AnimationChannel::IsComplete(const Animation& anim) const {
   if (anim.total_time == motive::kMotiveTimeEndless) {
     return false;
   } else if (IsRigChannel()) {
-    return anim.rig_motivator.TimeRemaining() <= 0;
+    return GetRigMotivator(anim).TimeRemaining() <= 0;
   } else {
     return anim.motivator.SplineTime() > anim.total_time;
   }
@@ -302,7 +453,7 @@ motive::MotiveTime AnimationChannel::TimeRemaining(Entity entity) const {
     return motive::kMotiveTimeEndless;
   }
   if (IsRigChannel()) {
-    return anim->rig_motivator.TimeRemaining();
+    return GetRigMotivator(*anim).TimeRemaining();
   }
   return anim->total_time - anim->motivator.SplineTime();
 }
@@ -315,7 +466,7 @@ const motive::RigAnim* AnimationChannel::CurrentRigAnim(Entity entity) const {
   if (anim == nullptr) {
     return nullptr;
   }
-  return anim->rig_motivator.CurrentAnim();
+  return GetRigMotivator(*anim).CurrentAnim();
 }
 
 void AnimationChannel::SetRig(Entity entity,
@@ -324,4 +475,10 @@ void AnimationChannel::SetRig(Entity entity,
   LOG(DFATAL) << "SetRig called on unsupported channel.";
 }
 
+void AnimationChannel::SetSharedRig(Entity entity, Entity source,
+                                    const mathfu::AffineTransform* values,
+                                    size_t len) {
+  SetRig(entity, values, len);
+}
+
 }  // namespace lull
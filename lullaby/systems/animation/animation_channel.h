@@ -18,11 +18,14 @@ limitations under the License.
 #define LULLABY_SYSTEMS_ANIMATION_ANIMATION_CHANNEL_H_
 
 #include <memory>
+#include <unordered_map>
+
 #include "lullaby/events/animation_events.h"
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/systems/animation/playback_parameters.h"
 #include "lullaby/systems/animation/spline_modifiers.h"
 #include "lullaby/util/clock.h"
+#include "lullaby/util/frame_allocator.h"
 #include "lullaby/util/hash.h"
 #include "lullaby/util/registry.h"
 #include "motive/matrix_op.h"
@@ -58,7 +61,7 @@ class AnimationChannel {
 
   // Copies all the data from the Motivator into the Component.  Updates the
   // |completed| vector with information about Animations that have completed.
-  void Update(std::vector<AnimationId>* completed);
+  void Update(FrameVector<AnimationId>* completed);
 
   // Plays a new animation (with the given |id|) on the |entity|.  The animation
   // sets the motivator to animate towards the specified |target_value| array
@@ -90,6 +93,29 @@ class AnimationChannel {
                    const motive::RigAnim* rig_anim,
                    const PlaybackParameters& params);
 
+  // Plays a new animation (with the given |id|) on the |entity| using a rig
+  // motivator shared with all other Entities played with the same |key|.  The
+  // shared motivator is created from |init_anim| and |rig_anim| for the first
+  // such Entity at |time|, and is destroyed along with the last one.  If the
+  // |key| is already used by a motivator for different animations, the Entity
+  // plays |rig_anim| on its own motivator instead.  Returns the AnimationId of
+  // the previously running animation, or kNullAnimation if no animation was
+  // active.
+  AnimationId PlayShared(Entity e, motive::MotiveEngine* engine,
+                         AnimationId id, HashValue key,
+                         const motive::RigAnim* init_anim,
+                         const motive::RigAnim* rig_anim,
+                         const PlaybackParameters& params,
+                         motive::MotiveTime time);
+
+  // Gives the |entity| its own rig motivator if it is sharing one, continuing
+  // the animation from where the shared motivator is at |time|.
+  void Unshare(Entity entity, motive::MotiveEngine* engine,
+               motive::MotiveTime time);
+
+  // Returns true if the |entity| is using a shared rig motivator.
+  bool IsShared(Entity entity) const;
+
   // Stops animation playback on this channel for the specified |entity| and
   // returns its AnimationId, or kNullAnimation if no animation was active.
   AnimationId Cancel(Entity entity);
@@ -128,8 +154,32 @@ class AnimationChannel {
     float multiplier[kMaxDimensions] = {0.f};
     motive::MotiveTime total_time = 0;
     AnimationId id = kNullAnimation;
+    // The key of the shared rig motivator used instead of |rig_motivator|, or
+    // 0 if the Entity has its own.
+    HashValue shared_key = 0;
+  };
+
+  // A rig motivator driving all the Entities that started playing the same
+  // rig animation with the same parameters at the same time.
+  struct SharedRig {
+    motive::RigMotivator rig_motivator;
+    const motive::RigAnim* init_anim = nullptr;
+    const motive::RigAnim* rig_anim = nullptr;
+    motive::SplinePlayback playback;
+    motive::MotiveTime start_time = 0;
+    int num_entities = 0;
+    // The first Entity given this frame's pose, whose results can be reused
+    // for the others.
+    Entity posed_entity = kNullEntity;
   };
 
+  // Returns the rig motivator driving the |anim|.
+  const motive::RigMotivator& GetRigMotivator(const Animation& anim) const;
+
+  // Stops the |anim| from using its shared rig motivator, destroying the
+  // motivator if no other Entity uses it.
+  void ReleaseSharedRig(Animation* anim);
+
   // Updates the |anim| with the new |id|, returning the previously set
   // AnimationId.
   AnimationId UpdateId(Animation* anim, AnimationId id);
@@ -156,8 +206,15 @@ class AnimationChannel {
   virtual void SetRig(Entity entity, const mathfu::AffineTransform* values,
                       size_t len);
 
+  // Sets the rig data associated with the Entity, which is the same data that
+  // was just passed to SetRig for the |source| Entity.  Channels can override
+  // this to reuse work done for the |source|.
+  virtual void SetSharedRig(Entity entity, Entity source,
+                            const mathfu::AffineTransform* values, size_t len);
+
   Registry* registry_;
   ComponentPool<Animation> anims_;
+  std::unordered_map<HashValue, SharedRig> shared_rigs_;
   int dimensions_;
 };
 
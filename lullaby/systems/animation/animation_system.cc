@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/systems/animation/animation_system.h"
 
+#include <algorithm>
+
 #include "lullaby/events/animation_events.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/file/asset_loader.h"
@@ -42,6 +44,27 @@ inline bool IsMotiveListFile(const std::string& filename, size_t start_pos,
                            kMotiveListExtension) == 0);
 }
 
+// Fills |splines| and |constants| from |asset|, starting at |dimension| of a
+// channel with |dimensions| dimensions and the given |ops|.  Returns the number
+// of dimensions used: one per CompactSpline in the asset, or all remaining
+// dimensions for a RigAnim.  Assets without any data still use one dimension
+// so that the files following them line up with the right dimensions.
+int GetSplinesAndConstantsAt(const AnimationAsset& asset, int list_index,
+                             int dimension, int dimensions,
+                             const motive::MatrixOperationType* ops,
+                             const motive::CompactSpline** splines,
+                             float* constants) {
+  const int remaining = dimensions - dimension;
+  int count = remaining;
+  if (asset.GetRigAnim(list_index) == nullptr) {
+    count = std::max(1, std::min(asset.GetNumCompactSplines(), remaining));
+  }
+  asset.GetSplinesAndConstants(list_index, count,
+                               ops ? ops + dimension : nullptr,
+                               splines + dimension, constants + dimension);
+  return count;
+}
+
 }  // namespace
 
 using MotiveTimeUnit = std::chrono::duration<motive::MotiveTime, std::milli>;
@@ -155,8 +178,9 @@ void AnimationSystem::AdvanceFrame(Clock::duration delta_time) {
   LULLABY_CPU_TRACE_CALL();
   const motive::MotiveTime timestep = GetMotiveTimeFromDuration(delta_time);
   engine_.AdvanceFrame(timestep);
+  time_ += timestep;
 
-  std::vector<AnimationId> completed;
+  FrameVector<AnimationId> completed(registry_->Get<FrameAllocator>());
   for (auto& channel : channels_) {
     channel.second->Update(&completed);
   }
@@ -281,8 +305,7 @@ AnimationId AnimationSystem::PlayAnimation(Entity e, HashValue channel,
   if (channel_ptr->IsRigChannel()) {
     id = PlayRigAnimationInternal(e, channel_ptr, anim, params);
   } else {
-    // TODO(b/64588043): Add support for spline animations.
-    LOG(DFATAL) << "Only rig animations supported for now.";
+    id = PlaySplineAnimationInternal(e, channel_ptr, anim, params);
   }
 
   if (id == kNullAnimation) {
@@ -324,10 +347,6 @@ AnimationId AnimationSystem::PlayRigAnimation(Entity e,
 AnimationId AnimationSystem::PlaySplineAnimation(Entity e,
                                                  AnimationChannel* channel,
                                                  const AnimInstanceDef* anim) {
-  float constants[AnimationChannel::kMaxDimensions] = {0.0f};
-  const motive::CompactSpline* splines[AnimationChannel::kMaxDimensions] = {
-      nullptr};
-
   const int dimensions = static_cast<int>(channel->GetDimensions());
   const int num_filenames = static_cast<int>(anim->filenames()->size());
   if (num_filenames > dimensions) {
@@ -335,7 +354,24 @@ AnimationId AnimationSystem::PlaySplineAnimation(Entity e,
     return kNullAnimation;
   }
 
+  const motive::MatrixOperationType* ops = channel->GetOperations();
+  float constants[AnimationChannel::kMaxDimensions];
+  const motive::CompactSpline* splines[AnimationChannel::kMaxDimensions] = {
+      nullptr};
+  for (int k = 0; k < dimensions; ++k) {
+    constants[k] = ops ? motive::OperationDefaultValue(ops[k]) : 0.f;
+  }
+
+  // Each file drives the dimensions following those of the previous file, so
+  // a file with multiple splines is merged with the others rather than having
+  // its later splines overwritten.
+  int dimension = 0;
   for (int i = 0; i < num_filenames; ++i) {
+    if (dimension >= dimensions) {
+      LOG(DFATAL) << "Animations have more splines than channel dimensions!";
+      break;
+    }
+
     AnimationAssetPtr asset;
     std::string filename = anim->filenames()->Get(i)->str();
     int list_index = 0;
@@ -347,19 +383,50 @@ AnimationId AnimationSystem::PlaySplineAnimation(Entity e,
       }
     }
     if (asset) {
-      // TODO(b/30696097): Correctly merge multiple animation assets so that we
-      // don't overwrite assets with multiple splines here. Here we allow the
-      // ith spline to populate dimensions - i channels. Subsequent files will
-      // overwrite all but the first spline in each file.
-      asset->GetSplinesAndConstants(list_index, dimensions - i,
-                                    channel->GetOperations(), splines + i,
-                                    constants + i);
+      dimension += GetSplinesAndConstantsAt(*asset, list_index, dimension,
+                                            dimensions, ops, splines,
+                                            constants);
+    } else {
+      ++dimension;
     }
   }
 
-  const AnimationId id = GenerateAnimationId();
   const PlaybackParameters params = GetPlaybackParameters(anim);
   const SplineModifiers modifiers = GetSplineModifiers(anim);
+  return PlaySplineAnimationInternal(e, channel, splines, constants, params,
+                                     modifiers);
+}
+
+AnimationId AnimationSystem::PlaySplineAnimationInternal(
+    Entity e, AnimationChannel* channel, const AnimationAssetPtr& anim,
+    const PlaybackParameters& params) {
+  if (channel == nullptr || channel->IsRigChannel()) {
+    LOG(DFATAL) << "Invalid channel.";
+    return kNullAnimation;
+  } else if (anim == nullptr) {
+    LOG(DFATAL) << "No animation specified!";
+    return kNullAnimation;
+  }
+
+  const motive::MatrixOperationType* ops = channel->GetOperations();
+  const int dimensions = static_cast<int>(channel->GetDimensions());
+  float constants[AnimationChannel::kMaxDimensions];
+  const motive::CompactSpline* splines[AnimationChannel::kMaxDimensions] = {
+      nullptr};
+  // The asset may have fewer splines than the channel has dimensions.
+  for (int k = 0; k < dimensions; ++k) {
+    constants[k] = ops ? motive::OperationDefaultValue(ops[k]) : 0.f;
+  }
+  GetSplinesAndConstantsAt(*anim, 0, 0, dimensions, ops, splines, constants);
+  return PlaySplineAnimationInternal(e, channel, splines, constants, params,
+                                     SplineModifiers());
+}
+
+AnimationId AnimationSystem::PlaySplineAnimationInternal(
+    Entity e, AnimationChannel* channel,
+    const motive::CompactSpline* const* splines, const float* constants,
+    const PlaybackParameters& params, const SplineModifiers& modifiers) {
+  const AnimationId id = GenerateAnimationId();
   const AnimationId prev_id =
       channel->Play(e, &engine_, id, splines, constants,
                     channel->GetDimensions(), params, modifiers);
@@ -384,14 +451,45 @@ AnimationId AnimationSystem::PlayRigAnimationInternal(
     return kNullAnimation;
   }
 
-  PrepareDefiningAnimation(e, channel);
+  const motive::RigAnim* defining_anim = GetDefiningAnimation(e, channel);
+  const motive::RigAnim* init_anim = defining_anim ? defining_anim : rig_anim;
+  const HashValue shared_key =
+      GetSharedPlaybackKey(e, channel, init_anim, rig_anim, params);
 
   const AnimationId id = GenerateAnimationId();
-  const AnimationId prev_id = channel->Play(e, &engine_, id, rig_anim, params);
+  AnimationId prev_id = kNullAnimation;
+  if (shared_key != 0) {
+    prev_id = channel->PlayShared(e, &engine_, id, shared_key, init_anim,
+                                  rig_anim, params, time_);
+  } else {
+    // Continue from the shared pose so it can be blended from.
+    channel->Unshare(e, &engine_, time_);
+    PrepareDefiningAnimation(e, channel);
+    prev_id = channel->Play(e, &engine_, id, rig_anim, params);
+  }
   UntrackAnimation(prev_id, AnimationCompletionReason::kInterrupted);
   return id;
 }
 
+HashValue AnimationSystem::GetSharedPlaybackKey(
+    Entity e, AnimationChannel* channel, const motive::RigAnim* init_anim,
+    const motive::RigAnim* rig_anim, const PlaybackParameters& params) const {
+  if (params.blend_time_s > 0.f && channel->CurrentRigAnim(e) != nullptr) {
+    // Blending from the Entity's current pose makes its playback unique.
+    return 0;
+  }
+
+  HashValue key = Hash("lull.Animation.SharedRig");
+  key = HashBytes(key, init_anim);
+  key = HashBytes(key, rig_anim);
+  key = HashBytes(key, params.looping);
+  key = HashBytes(key, params.speed);
+  key = HashBytes(key, params.start_delay_s);
+  key = HashBytes(key, params.blend_time_s);
+  key = HashBytes(key, time_);
+  return key;
+}
+
 AnimationId AnimationSystem::SetTargetInternal(Entity e,
                                                AnimationChannel* channel,
                                                const float* data, size_t len,
@@ -412,24 +510,29 @@ AnimationId AnimationSystem::SetTargetInternal(Entity e,
 
 void AnimationSystem::PrepareDefiningAnimation(Entity e,
                                                AnimationChannel* channel) {
+  const motive::RigAnim* defining_anim = GetDefiningAnimation(e, channel);
+  if (defining_anim == nullptr) {
+    return;
+  }
+  channel->Init(e, &engine_, defining_anim);
+}
+
+const motive::RigAnim* AnimationSystem::GetDefiningAnimation(
+    Entity e, AnimationChannel* channel) const {
   auto iter = defining_animations_.find(e);
   if (iter == defining_animations_.end()) {
-    return;
+    return nullptr;
   }
   if (iter->second.channel != channel) {
-    return;
+    return nullptr;
   }
   if (iter->second.channel == nullptr) {
-    return;
+    return nullptr;
   }
   if (iter->second.asset == nullptr) {
-    return;
-  }
-  const motive::RigAnim* defining_anim = iter->second.asset->GetRigAnim(0);
-  if (defining_anim == nullptr) {
-    return;
+    return nullptr;
   }
-  channel->Init(e, &engine_, defining_anim);
+  return iter->second.asset->GetRigAnim(0);
 }
 
 AnimationId AnimationSystem::GenerateAnimationId() {
@@ -560,6 +663,8 @@ void AnimationSystem::SetPlaybackRate(Entity entity, HashValue channel,
     return;
   }
 
+  // The rate of a shared motivator would affect every Entity using it.
+  iter->second->Unshare(entity, &engine_, time_);
   iter->second->SetPlaybackRate(entity, rate);
 }
 
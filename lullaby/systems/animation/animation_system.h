@@ -60,6 +60,10 @@ namespace lull {
 // JSON files using flatbuffers flatc compiler.)  Alternatively, animations
 // can be driven towards arbitrary target values.  This is done by generating
 // the appropriate curves at runtime.
+//
+// Entities that start playing the same rig animation with the same parameters
+// on the same frame (and without blending from a previous animation) share a
+// single motivator, so the pose is only evaluated once for all of them.
 class AnimationSystem : public System {
  public:
   explicit AnimationSystem(Registry* registry);
@@ -92,9 +96,11 @@ class AnimationSystem : public System {
   // dispatched when this animation finishes or is interrupted.
   AnimationId PlayAnimation(Entity e, const AnimationDef* data);
 
-  // Plays the specified animation on the channel with the given params. Returns
-  // a unique AnimationId, which will be included in the AnimationCompleteEvent
-  // dispatched when this animation finishes or is interrupted.
+  // Plays the specified animation on the channel with the given params.  Rig
+  // channels play the asset's RigAnim, while other channels play its
+  // CompactSplines, one per dimension.  Returns a unique AnimationId, which
+  // will be included in the AnimationCompleteEvent dispatched when this
+  // animation finishes or is interrupted.
   AnimationId PlayAnimation(Entity e, HashValue channel,
                             const AnimationAssetPtr& anim,
                             const PlaybackParameters& params);
@@ -182,12 +188,31 @@ class AnimationSystem : public System {
   // any rig animations for an Entity on the specified channel.
   void PrepareDefiningAnimation(Entity e, AnimationChannel* channel);
 
+  // Returns the defining animation specified for the Entity |e| on the
+  // |channel|, or nullptr if there is none.
+  const motive::RigAnim* GetDefiningAnimation(Entity e,
+                                              AnimationChannel* channel) const;
+
+  // Returns the key identifying playback of |rig_anim| on |e| that can share
+  // its motivator with other Entities, or 0 if it can't be shared.
+  HashValue GetSharedPlaybackKey(Entity e, AnimationChannel* channel,
+                                 const motive::RigAnim* init_anim,
+                                 const motive::RigAnim* rig_anim,
+                                 const PlaybackParameters& params) const;
+
   AnimationId PlayAnimation(Entity e, const AnimTargetDef* target);
   AnimationId PlayAnimation(Entity e, const AnimInstanceDef* anim);
   AnimationId PlayRigAnimation(Entity e, AnimationChannel* channel,
                                const AnimInstanceDef* anim);
   AnimationId PlaySplineAnimation(Entity e, AnimationChannel* channel,
                                   const AnimInstanceDef* anim);
+  AnimationId PlaySplineAnimationInternal(Entity e, AnimationChannel* channel,
+                                          const AnimationAssetPtr& anim,
+                                          const PlaybackParameters& params);
+  AnimationId PlaySplineAnimationInternal(
+      Entity e, AnimationChannel* channel,
+      const motive::CompactSpline* const* splines, const float* constants,
+      const PlaybackParameters& params, const SplineModifiers& modifiers);
   AnimationId PlayRigAnimationInternal(Entity e, AnimationChannel* channel,
                                        const AnimationAssetPtr& anim,
                                        const PlaybackParameters& params,
@@ -203,6 +228,8 @@ class AnimationSystem : public System {
 
   AnimationId current_id_;
   motive::MotiveEngine engine_;
+  // The total time the engine has been advanced by.
+  motive::MotiveTime time_ = 0;
   ResourceManager<AnimationAsset> assets_;
   std::unordered_map<Entity, DefiningAnimation> defining_animations_;
   std::unordered_map<HashValue, AnimationChannelPtr> channels_;
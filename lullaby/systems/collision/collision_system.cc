@@ -127,7 +127,19 @@ void CollisionSystem::Destroy(Entity entity) {
 
 CollisionSystem::CollisionResult CollisionSystem::CheckForCollision(
     const Ray& ray) const {
-  CollisionResult result = {kNullEntity, kNoHitDistance};
+  CollisionResult result;
+  CheckForCollisions(Span<Ray>(&ray, 1), &result);
+  return result;
+}
+
+void CollisionSystem::CheckForCollisions(Span<Ray> rays,
+                                         CollisionResult* results) const {
+  for (size_t i = 0; i < rays.size(); ++i) {
+    results[i] = {kNullEntity, kNoHitDistance};
+  }
+  if (rays.empty()) {
+    return;
+  }
 
   transform_system_->ForAll([&](Entity entity,
                                 const mathfu::mat4& world_from_entity_mat,
@@ -136,33 +148,43 @@ CollisionSystem::CollisionResult CollisionSystem::CheckForCollision(
       return;
     }
 
-    const bool check_exit = CheckBit(flags, on_exit_flag_);
-    const float distance =
-        CheckRayOBBCollision(ray, world_from_entity_mat, box, check_exit);
-    if (distance == kNoHitDistance) {
-      return;
-    }
-
-    if (result.entity != kNullEntity && distance >= result.distance) {
+    mathfu::mat4 entity_from_world_mat;
+    if (!world_from_entity_mat.InverseWithDeterminantCheck(
+            &entity_from_world_mat)) {
       return;
     }
 
+    const bool check_exit = CheckBit(flags, on_exit_flag_);
     const bool clip_outside_bounds = CheckBit(flags, clip_flag_);
-    if (clip_outside_bounds &&
-        IsCollisionClipped(entity, ray.GetPointAt(distance))) {
-      return;
-    }
+    for (size_t i = 0; i < rays.size(); ++i) {
+      const Ray& ray = rays[i];
+      CollisionResult& result = results[i];
+
+      const float distance =
+          CheckRayOBBCollision(ray, world_from_entity_mat,
+                               entity_from_world_mat, box, check_exit);
+      if (distance == kNoHitDistance) {
+        continue;
+      }
 
-    result.entity = entity;
-    result.distance = distance;
-  });
+      if (result.entity != kNullEntity && distance >= result.distance) {
+        continue;
+      }
 
-  return result;
+      if (clip_outside_bounds &&
+          IsCollisionClipped(entity, ray.GetPointAt(distance))) {
+        continue;
+      }
+
+      result.entity = entity;
+      result.distance = distance;
+    }
+  });
 }
 
-std::vector<Entity> CollisionSystem::CheckForPointCollisions(
+FrameVector<Entity> CollisionSystem::CheckForPointCollisions(
     const mathfu::vec3& point) {
-  std::vector<Entity> collisions;
+  FrameVector<Entity> collisions(registry_->Get<FrameAllocator>());
 
   transform_system_->ForAll([&](Entity entity,
                                 const mathfu::mat4& world_from_entity_mat,
@@ -247,6 +269,30 @@ void CollisionSystem::EnableClipping(Entity entity) {
   transform_system_->SetFlag(entity, clip_flag_);
 }
 
+void CollisionSystem::SaveSnapshot(SaveToBuffer* serializer) const {
+  size_t count = clip_bounds_.size();
+  Serialize(serializer, &count, ConstHash("count"));
+  for (const auto& entry : clip_bounds_) {
+    Serialize(serializer, &entry.first, ConstHash("entity"));
+    Serialize(serializer, &entry.second.min, ConstHash("min"));
+    Serialize(serializer, &entry.second.max, ConstHash("max"));
+  }
+}
+
+void CollisionSystem::RestoreSnapshot(LoadFromBuffer* serializer) {
+  clip_bounds_.clear();
+  size_t count = 0;
+  Serialize(serializer, &count, ConstHash("count"));
+  for (size_t i = 0; i < count; ++i) {
+    Entity entity = kNullEntity;
+    Aabb bounds;
+    Serialize(serializer, &entity, ConstHash("entity"));
+    Serialize(serializer, &bounds.min, ConstHash("min"));
+    Serialize(serializer, &bounds.max, ConstHash("max"));
+    clip_bounds_.emplace(entity, bounds);
+  }
+}
+
 Entity CollisionSystem::GetContainingBounds(Entity entity) const {
   Entity parent = transform_system_->GetParent(entity);
   while (parent != kNullEntity) {
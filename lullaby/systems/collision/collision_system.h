@@ -21,8 +21,11 @@ limitations under the License.
 
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/modules/serialize/buffer_serializer.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/frame_allocator.h"
 #include "lullaby/util/math.h"
+#include "lullaby/util/span.h"
 
 namespace lull {
 
@@ -51,8 +54,18 @@ class CollisionSystem : public System {
   // and the distance to the hit point from the ray's origin.
   CollisionResult CheckForCollision(const Ray& ray) const;
 
-  // Returns a vector of entities that a point lies within
-  std::vector<Entity> CheckForPointCollisions(const mathfu::vec3& point);
+  // Casts all the specified |rays| and stores the closest Entity hit by each
+  // one in the corresponding element of |results|, which must have room for
+  // rays.size() elements.  The scene is only traversed once, and each Entity's
+  // inverse world matrix is computed once and shared by all the rays, so this
+  // is cheaper than calling CheckForCollision for each ray.  The results are
+  // identical to those of CheckForCollision.
+  void CheckForCollisions(Span<Ray> rays, CollisionResult* results) const;
+
+  // Returns a vector of entities that a point lies within.  The vector is
+  // allocated from the FrameAllocator (if one exists) and so must not be kept
+  // past the end of the current frame.
+  FrameVector<Entity> CheckForPointCollisions(const mathfu::vec3& point);
 
   // Disables |entity|'s collision.
   void DisableCollision(Entity entity);
@@ -95,6 +108,13 @@ class CollisionSystem : public System {
   // nearest ancestor's bound's aabb if one can be found.
   void EnableClipping(Entity entity);
 
+  // Writes the clip bounds of all entities for use with the WorldSnapshot.  The
+  // remaining collision state is stored as TransformSystem flags.
+  void SaveSnapshot(SaveToBuffer* serializer) const;
+
+  // Replaces all clip bounds with those written by SaveSnapshot.
+  void RestoreSnapshot(LoadFromBuffer* serializer);
+
  private:
   Entity GetContainingBounds(Entity entity) const;
   bool IsCollisionClipped(Entity entity, const mathfu::vec3& point) const;
@@ -118,7 +118,12 @@ void DispatcherSystem::ConnectEventImpl(
 
 void DispatcherSystem::SendImpl(Entity entity, const EventWrapper& event) {
   if (enable_queued_dispatch_) {
-    queue_.Enqueue(EntityEvent(entity, event));
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    auto result = queue_indices_.emplace(entity, queue_.size());
+    if (result.second) {
+      queue_.emplace_back(entity);
+    }
+    queue_[result.first->second].events.emplace_back(event);
   } else {
     SendImmediatelyImpl(entity, event);
   }
@@ -126,24 +131,62 @@ void DispatcherSystem::SendImpl(Entity entity, const EventWrapper& event) {
 
 void DispatcherSystem::SendImmediatelyImpl(Entity entity,
                                            const EventWrapper& event) {
+  Dispatcher* dispatcher = FindDispatcher(entity);
+  if (dispatcher == nullptr && universal_dispatcher_.GetHandlerCount() == 0) {
+    return;
+  }
+
   ++dispatch_count_;
+  Deliver(entity, dispatcher, event);
+  --dispatch_count_;
+  DestroyQueued();
+}
+
+void DispatcherSystem::Deliver(Entity entity, Dispatcher* dispatcher,
+                               const EventWrapper& event) {
   // When an entity has been queued for destruction, treat it as already
   // destroyed.
-  if (queued_destruction_.count(entity) == 0) {
-    auto iter = dispatchers_.find(entity);
-    if (iter != dispatchers_.end()) {
-      iter->second.Send(event);
-    }
+  if (!queued_destruction_.empty() && queued_destruction_.count(entity) != 0) {
+    return;
+  }
+  if (dispatcher) {
+    dispatcher->Send(event);
+  }
+  // Handlers for all events receive a copy of the event, so only make one if
+  // there are any.
+  if (universal_dispatcher_.GetHandlerCount() > 0) {
     universal_dispatcher_.Send(EntityEvent(entity, event));
   }
-  --dispatch_count_;
-  DestroyQueued();
 }
 
 void DispatcherSystem::Dispatch() {
-  EntityEvent event;
-  while (queue_.Dequeue(&event)) {
-    SendImmediatelyImpl(event.entity, event.event);
+  std::vector<QueuedEvents> batch;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      if (queue_.empty()) {
+        break;
+      }
+      batch.swap(queue_);
+      queue_indices_.clear();
+    }
+
+    // Dispatchers aren't destroyed until |dispatch_count_| returns to 0, so
+    // each Entity's Dispatcher only needs to be found once.
+    ++dispatch_count_;
+    for (const QueuedEvents& queued : batch) {
+      Dispatcher* dispatcher = FindDispatcher(queued.entity);
+      for (const EventWrapper& event : queued.events) {
+        if (dispatcher == nullptr) {
+          // An earlier event may have connected a handler to the Entity.
+          dispatcher = FindDispatcher(queued.entity);
+        }
+        Deliver(queued.entity, dispatcher, event);
+      }
+    }
+    --dispatch_count_;
+    DestroyQueued();
+    batch.clear();
   }
 }
 
@@ -154,6 +197,11 @@ Dispatcher* DispatcherSystem::GetDispatcher(Entity entity) {
   return &dispatchers_[entity];
 }
 
+Dispatcher* DispatcherSystem::FindDispatcher(Entity entity) {
+  auto iter = dispatchers_.find(entity);
+  return iter != dispatchers_.end() ? &iter->second : nullptr;
+}
+
 void DispatcherSystem::Disconnect(Entity entity, TypeId type,
                                   const void* owner) {
   auto iter = dispatchers_.find(entity);
@@ -17,14 +17,25 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_DISPATCHER_DISPATCHER_SYSTEM_H_
 #define LULLABY_SYSTEMS_DISPATCHER_DISPATCHER_SYSTEM_H_
 
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "lullaby/generated/dispatcher_def_generated.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/ecs/system.h"
-#include "lullaby/util/thread_safe_queue.h"
 
 namespace lull {
 
 /// Provides a Dispatcher as a Component for each Entity.
+///
+/// Statically typed events are sent to the Entity's handlers without being
+/// copied or converted to a VariantMap; handlers that take an EventWrapper
+/// (eg. those connected by EventDefs or scripts) still receive them.  When
+/// queued dispatch is enabled, queued events are grouped by Entity and each
+/// group is delivered in turn, in the order the Entities were first sent an
+/// event.
 class DispatcherSystem : public System {
  public:
   /// Pair of Entity and EventWrapper. Publicly this is only used to listen for
@@ -58,7 +69,8 @@ class DispatcherSystem : public System {
 
   /// Sends |event| to all functions registered with the dispatcher associated
   /// with |entity|.  The |Event| type must be registered with
-  /// LULLABY_SETUP_TYPEID.
+  /// LULLABY_SETUP_TYPEID.  The event is only copied if it needs to be queued
+  /// or there are handlers connected with ConnectToAll.
   template <typename Event>
   void Send(Entity entity, const Event& event) {
     SendImpl(entity, EventWrapper(event));
@@ -79,7 +91,9 @@ class DispatcherSystem : public System {
     SendImmediatelyImpl(entity, event_wrapper);
   }
 
-  /// Dispatches all events currently queued in the DispatcherSystem.
+  /// Dispatches all events currently queued in the DispatcherSystem, grouped by
+  /// Entity.  Events sent to the same Entity are dispatched in the order they
+  /// were sent.
   void Dispatch();
 
   /// Connects an event handler to the Dispatcher associated with |entity|.
@@ -133,7 +147,13 @@ class DispatcherSystem : public System {
   size_t GetUniversalHandlerCount() const;
 
  private:
-  using EventQueue = ThreadSafeQueue<EntityEvent>;
+  /// The events queued for a single Entity.
+  struct QueuedEvents {
+    explicit QueuedEvents(Entity e) : entity(e) {}
+    Entity entity = kNullEntity;
+    std::vector<EventWrapper> events;
+  };
+
   using EntityDispatcherMap = std::unordered_map<Entity, Dispatcher>;
   using EntityConnections =
       std::unordered_map<Entity, std::vector<Dispatcher::ScopedConnection>>;
@@ -143,9 +163,22 @@ class DispatcherSystem : public System {
 
   Dispatcher* GetDispatcher(Entity entity);
 
+  /// Returns the Dispatcher associated with |entity| without creating one.
+  Dispatcher* FindDispatcher(Entity entity);
+
+  /// Sends |event| to the |dispatcher| associated with |entity| (if any) and
+  /// to the universal handlers.  Must be called while |dispatch_count_| is
+  /// non-zero.
+  void Deliver(Entity entity, Dispatcher* dispatcher,
+               const EventWrapper& event);
+
   void DestroyQueued();
 
-  EventQueue queue_;
+  /// Events queued for dispatch, grouped by Entity.  Guarded by
+  /// |queue_mutex_| since events may be sent from other threads.
+  std::mutex queue_mutex_;
+  std::vector<QueuedEvents> queue_;
+  std::unordered_map<Entity, size_t> queue_indices_;
   EntityConnections connections_;
   EntityDispatcherMap dispatchers_;
   static bool enable_queued_dispatch_;
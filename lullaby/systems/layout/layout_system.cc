@@ -27,6 +27,7 @@ limitations under the License.
 #include "lullaby/systems/dispatcher/event.h"
 #include "lullaby/systems/layout/layout_box_system.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/frame_allocator.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/util/math.h"
 #include "lullaby/util/time.h"
@@ -510,7 +511,7 @@ void LayoutSystem::LayoutImpl(const DirtyLayout& dirty_layout) {
   }
 
   if (layout->layout) {
-    std::vector<LayoutElement> elements;
+    FrameVector<LayoutElement> elements(registry_->Get<FrameAllocator>());
     elements.reserve(children->size());
     for (const Entity& child : *children) {
       if (layout->ignore_mode == LayoutIgnoreMode_Disabled &&
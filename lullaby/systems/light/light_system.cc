@@ -188,8 +188,9 @@ void LightSystem::AdvanceFrame() {
   UpdateLightTransforms(transform_system, points_);
 
   auto* render_system = registry_->Get<RenderSystem>();
+  auto* frame_allocator = registry_->Get<FrameAllocator>();
   for (auto& iter : groups_) {
-    iter.second.Update(transform_system, render_system);
+    iter.second.Update(transform_system, render_system, frame_allocator);
   }
 }
 
@@ -304,7 +305,8 @@ void LightSystem::LightGroup::Remove(Registry* registry, Entity entity) {
 }
 
 void LightSystem::LightGroup::Update(TransformSystem* transform_system,
-                                     RenderSystem* render_system) {
+                                     RenderSystem* render_system,
+                                     FrameAllocator* frame_allocator) {
   if (dirty_) {
     for (auto& shadow_pass_data : shadow_passes_) {
       UpdateRenderViewTransform(transform_system,
@@ -312,14 +314,16 @@ void LightSystem::LightGroup::Update(TransformSystem* transform_system,
                                 &shadow_pass_data.view);
     }
     for (auto& lightable : lightables_) {
-      UpdateLightable(render_system, lightable.first, lightable.second);
+      UpdateLightable(render_system, frame_allocator, lightable.first,
+                      lightable.second);
     }
     dirty_ = false;
   } else {
     for (Entity dirty_lightable : dirty_lightables_) {
       auto lightable = lightables_.find(dirty_lightable);
       if (lightable != lightables_.end()) {
-        UpdateLightable(render_system, lightable->first, lightable->second);
+        UpdateLightable(render_system, frame_allocator, lightable->first,
+                        lightable->second);
       }
     }
   }
@@ -370,9 +374,10 @@ void LightSystem::UpdateUniforms(UniformData* uniforms,
 }
 
 void LightSystem::LightGroup::UpdateLightable(RenderSystem* render_system,
+                                              FrameAllocator* frame_allocator,
                                               Entity entity,
                                               const LightableDefT& data) {
-  UniformData uniforms;
+  UniformData uniforms(frame_allocator);
   UpdateUniforms(&uniforms, ambients_, data.max_ambient_lights, 0);
   UpdateUniforms(
       &uniforms, directionals_, data.max_directional_lights,
@@ -443,11 +448,29 @@ void LightSystem::LightGroup::DestroyShadowPass(RenderSystem* render_system,
   shadow_passes_.erase(iter);
 }
 
+LightSystem::UniformData::UniformData(FrameAllocator* allocator)
+    : allocator(allocator), buffers(allocator) {}
+
 void LightSystem::UniformData::Clear() { buffers.clear(); }
 
+LightSystem::UniformData::Buffer& LightSystem::UniformData::GetBuffer(
+    const char* name, int dimension) {
+  const HashValue hash = Hash(name);
+  for (Buffer& buffer : buffers) {
+    if (buffer.hash == hash) {
+      return buffer;
+    }
+  }
+  buffers.emplace_back(allocator);
+  Buffer& buffer = buffers.back();
+  buffer.name = name;
+  buffer.hash = hash;
+  buffer.dimension = dimension;
+  return buffer;
+}
+
 void LightSystem::UniformData::Add(const AmbientLightDefT& light) {
-  auto& colors = buffers["light_ambient_color"];
-  colors.dimension = 3;
+  auto& colors = GetBuffer("light_ambient_color", 3);
 
   const mathfu::vec4 data = Color4ub::ToVec4(light.color);
   colors.data.push_back(data.x);
@@ -458,59 +481,51 @@ void LightSystem::UniformData::Add(const AmbientLightDefT& light) {
 void LightSystem::UniformData::Add(const DirectionalLightDefT& light) {
   const bool has_shadow = HasShadows(light);
   auto& colors =
-      buffers[has_shadow ? kShadowColorUniformName : kColorUniformName];
-  colors.dimension = 3;
+      GetBuffer(has_shadow ? kShadowColorUniformName : kColorUniformName, 3);
 
   const mathfu::vec4 data = Color4ub::ToVec4(light.color);
   colors.data.push_back(data.x);
   colors.data.push_back(data.y);
   colors.data.push_back(data.z);
 
-  auto& directions =
-      buffers[has_shadow ? kShadowDirectionUniformName : kDirectionUniformName];
-  directions.dimension = 3;
+  auto& directions = GetBuffer(
+      has_shadow ? kShadowDirectionUniformName : kDirectionUniformName, 3);
 
   const mathfu::vec3 light_dir = light.rotation * -mathfu::kAxisZ3f;
   directions.data.push_back(light_dir.x);
   directions.data.push_back(light_dir.y);
   directions.data.push_back(light_dir.z);
 
-  auto& exponents =
-      buffers[has_shadow ? kShadowExponentUniformName : kExponentUniformName];
-  exponents.dimension = 1;
+  auto& exponents = GetBuffer(
+      has_shadow ? kShadowExponentUniformName : kExponentUniformName, 1);
   exponents.data.push_back(light.exponent);
 }
 
 void LightSystem::UniformData::Add(const PointLightDefT& light) {
-  auto& colors = buffers["light_point_color"];
-  colors.dimension = 3;
+  auto& colors = GetBuffer("light_point_color", 3);
 
   const mathfu::vec4 data = Color4ub::ToVec4(light.color);
   colors.data.push_back(data.x);
   colors.data.push_back(data.y);
   colors.data.push_back(data.z);
 
-  auto& positions = buffers["light_point_pos"];
-  positions.dimension = 3;
+  auto& positions = GetBuffer("light_point_pos", 3);
   positions.data.push_back(light.position.x);
   positions.data.push_back(light.position.y);
   positions.data.push_back(light.position.z);
 
-  auto& exponents = buffers["light_point_exponent"];
-  exponents.dimension = 1;
+  auto& exponents = GetBuffer("light_point_exponent", 1);
   exponents.data.push_back(light.exponent);
 
-  auto& intensities = buffers["light_point_intensity"];
-  intensities.dimension = 1;
+  auto& intensities = GetBuffer("light_point_intensity", 1);
   intensities.data.push_back(light.intensity);
 }
 
 void LightSystem::UniformData::Apply(RenderSystem* render_system,
                                      Entity entity) const {
-  for (const auto& it : buffers) {
-    const auto& buffer = it.second;
+  for (const Buffer& buffer : buffers) {
     const int count = static_cast<int>(buffer.data.size()) / buffer.dimension;
-    render_system->SetUniform(entity, it.first.c_str(), buffer.data.data(),
+    render_system->SetUniform(entity, buffer.name, buffer.data.data(),
                               buffer.dimension, count);
   }
 }
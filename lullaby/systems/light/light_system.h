@@ -27,6 +27,8 @@ limitations under the License.
 #include "lullaby/systems/dispatcher/dispatcher_system.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/frame_allocator.h"
+#include "lullaby/util/hash.h"
 #include "lullaby/util/math.h"
 
 namespace lull {
@@ -95,6 +97,9 @@ class LightSystem : public System {
   /// Stores arrays of floating point values that will be used to populate
   /// uniform arrays.
   struct UniformData {
+    /// Allocates the uniform data from the |allocator| (if non-null).
+    explicit UniformData(FrameAllocator* allocator);
+
     /// Clears all the uniform data stored.
     void Clear();
 
@@ -109,10 +114,21 @@ class LightSystem : public System {
 
    private:
     struct Buffer {
+      explicit Buffer(FrameAllocator* allocator) : data(allocator) {}
+
+      const char* name = nullptr;
+      HashValue hash = 0;
       int dimension = 0;
-      std::vector<float> data;
+      FrameVector<float> data;
     };
-    std::unordered_map<std::string, Buffer> buffers;
+
+    /// Returns the buffer for the uniform |name|, creating it if needed.  There
+    /// are only a handful of light uniforms so a linear search is used.  The
+    /// returned reference is invalidated by the next call.
+    Buffer& GetBuffer(const char* name, int dimension);
+
+    FrameAllocator* allocator;
+    FrameVector<Buffer> buffers;
   };
 
   /// Helper structure to hold lights and lightables associated together.
@@ -138,7 +154,8 @@ class LightSystem : public System {
     void UpdateLight(TransformSystem* transform_system, Entity entity);
 
     /// Updates the render system data of objects within this group.
-    void Update(TransformSystem* transform_system, RenderSystem* render_system);
+    void Update(TransformSystem* transform_system, RenderSystem* render_system,
+                FrameAllocator* frame_allocator);
 
     /// Remove an entity from the group.
     void Remove(Registry* registry, Entity entity);
@@ -157,7 +174,8 @@ class LightSystem : public System {
     };
 
     void UpdateLightable(RenderSystem* render_system, Entity entity);
-    void UpdateLightable(RenderSystem* render_system, Entity entity,
+    void UpdateLightable(RenderSystem* render_system,
+                         FrameAllocator* frame_allocator, Entity entity,
                          const LightableDefT& data);
     void DestroyShadowPass(RenderSystem* render_system, HashValue pass);
     void AddLightableToShadowPass(RenderSystem* render_system,
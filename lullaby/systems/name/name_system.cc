@@ -45,6 +45,10 @@ NameSystem::NameSystem(Registry* registry, bool allow_duplicate_names)
     dispatcher->Connect(this, [this](const SetNameEvent& e) {
       SetName(e.entity, e.name);
     });
+    dispatcher->Connect(this, [this](const ParentChangedImmediateEvent& e) {
+      OnParentChanged(e);
+    });
+    track_hierarchy_ = true;
   }
 }
 
@@ -80,7 +84,7 @@ void NameSystem::Create(Entity entity, HashValue type, const Def* def) {
 void NameSystem::Destroy(Entity entity) {
   auto iter = entity_to_hash_.find(entity);
   if (iter != entity_to_hash_.end()) {
-    hash_to_entity_.erase(iter->second);
+    RemoveFromIndex(entity, iter->second);
     entity_to_hash_.erase(iter);
   }
   entity_to_name_.erase(entity);
@@ -107,11 +111,15 @@ void NameSystem::SetName(Entity entity, const std::string& name) {
       LOG(DFATAL) << "Entity " << name << " already exists!";
       return;
     }
-    hash_to_entity_.erase(Hash(existing_name.c_str()));
-    hash_to_entity_[hash] = entity;
+  }
+
+  const auto iter = entity_to_hash_.find(entity);
+  if (iter != entity_to_hash_.end()) {
+    RemoveFromIndex(entity, iter->second);
   }
   entity_to_name_[entity] = name;
   entity_to_hash_[entity] = hash;
+  AddToIndex(entity, hash);
 }
 
 std::string NameSystem::GetName(Entity entity) const {
@@ -122,16 +130,25 @@ std::string NameSystem::GetName(Entity entity) const {
 
 Entity NameSystem::FindEntity(const std::string& name) const {
   const auto hash = Hash(name.c_str());
-  if (allow_duplicate_names_) {
-    for (const auto& entry : entity_to_hash_) {
-      if (entry.second == hash) {
-        return entry.first;
-      }
-    }
-    return kNullEntity;
-  } else {
-    const auto iter = hash_to_entity_.find(hash);
-    return iter != hash_to_entity_.end() ? iter->second : kNullEntity;
+  const auto iter = index_.find(GetIndexKey(kNullEntity, hash));
+  return iter != index_.end() ? *iter->second.begin() : kNullEntity;
+}
+
+void NameSystem::SaveSnapshot(SaveToBuffer* serializer) const {
+  Serialize(serializer, &entity_to_name_, ConstHash("entity_to_name"));
+}
+
+void NameSystem::RestoreSnapshot(LoadFromBuffer* serializer) {
+  Serialize(serializer, &entity_to_name_, ConstHash("entity_to_name"));
+
+  // The hashes are derived from the names, so rebuild them rather than storing
+  // them in the snapshot.
+  entity_to_hash_.clear();
+  index_.clear();
+  for (const auto& entry : entity_to_name_) {
+    const HashValue hash = Hash(entry.second.c_str());
+    entity_to_hash_[entry.first] = hash;
+    AddToIndex(entry.first, hash);
   }
 }
 
@@ -148,20 +165,88 @@ Entity NameSystem::FindDescendant(Entity root, const std::string& name) const {
   }
 
   const HashValue hash = Hash(name.c_str());
-  if (allow_duplicate_names_) {
+  if (track_hierarchy_) {
+    const auto iter = index_.find(GetIndexKey(root, hash));
+    if (iter == index_.end()) {
+      return kNullEntity;
+    } else if (iter->second.size() == 1) {
+      return *iter->second.begin();
+    }
+    // Several descendants share the name, so search the hierarchy to return
+    // the first one in pre-order.
+    return FindDescendantWithDuplicateNames(transform_system, root, hash);
+  } else if (allow_duplicate_names_) {
     return FindDescendantWithDuplicateNames(transform_system, root, hash);
   } else {
-    const auto iter = hash_to_entity_.find(hash);
-    if (iter != hash_to_entity_.end()) {
-      const Entity entity = iter->second;
-      if (root == entity || transform_system->IsAncestorOf(root, entity)) {
-        return entity;
-      }
+    const Entity entity = FindEntity(name);
+    if (entity != kNullEntity &&
+        (root == entity || transform_system->IsAncestorOf(root, entity))) {
+      return entity;
     }
     return kNullEntity;
   }
 }
 
+void NameSystem::AddToIndex(Entity entity, HashValue hash) {
+  // kNullEntity isn't an ancestor of anything, so list it separately.
+  AddIndexEntry(GetIndexKey(kNullEntity, hash), entity);
+  IndexUnderAncestors(entity, entity, hash, true);
+}
+
+void NameSystem::RemoveFromIndex(Entity entity, HashValue hash) {
+  RemoveIndexEntry(GetIndexKey(kNullEntity, hash), entity);
+  IndexUnderAncestors(entity, entity, hash, false);
+}
+
+void NameSystem::IndexUnderAncestors(Entity ancestor, Entity entity,
+                                     HashValue hash, bool add) {
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  while (ancestor != kNullEntity) {
+    const IndexKey key = GetIndexKey(ancestor, hash);
+    if (add) {
+      AddIndexEntry(key, entity);
+    } else {
+      RemoveIndexEntry(key, entity);
+    }
+    ancestor =
+        transform_system ? transform_system->GetParent(ancestor) : kNullEntity;
+  }
+}
+
+void NameSystem::AddIndexEntry(IndexKey key, Entity entity) {
+  // Entities can be reported as added to a parent that they were already
+  // indexed under (eg. when they are named in between being attached and the
+  // event being sent), which the set ignores.
+  index_[key].insert(entity);
+}
+
+void NameSystem::RemoveIndexEntry(IndexKey key, Entity entity) {
+  const auto iter = index_.find(key);
+  if (iter == index_.end()) {
+    return;
+  }
+  iter->second.erase(entity);
+  if (iter->second.empty()) {
+    index_.erase(iter);
+  }
+}
+
+void NameSystem::OnParentChanged(const ParentChangedImmediateEvent& event) {
+  auto* transform_system = registry_->Get<TransformSystem>();
+  if (!transform_system || entity_to_hash_.empty()) {
+    return;
+  }
+  transform_system->ForAllDescendants(event.target, [&](Entity descendant) {
+    const auto iter = entity_to_hash_.find(descendant);
+    if (iter == entity_to_hash_.end()) {
+      return;
+    }
+    // Remove before adding since the old and new parents can share ancestors.
+    IndexUnderAncestors(event.old_parent, descendant, iter->second, false);
+    IndexUnderAncestors(event.new_parent, descendant, iter->second, true);
+  });
+}
+
 Entity NameSystem::FindDescendantWithDuplicateNames(
     TransformSystem* transform_system, Entity root, HashValue hash) const {
   const auto iter = entity_to_hash_.find(root);
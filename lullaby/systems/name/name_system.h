@@ -17,16 +17,27 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_NAME_NAME_SYSTEM_H_
 #define LULLABY_SYSTEMS_NAME_NAME_SYSTEM_H_
 
+#include <stdint.h>
+#include <set>
 #include <unordered_map>
 
+#include "lullaby/events/entity_events.h"
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/modules/serialize/buffer_serializer.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/hash.h"
 
 namespace lull {
 
 // Associates a name with an entity.
+//
+// Named entities are indexed by each of their ancestors, so FindEntity() and
+// FindDescendant() are a single hash lookup regardless of the depth of the
+// hierarchy, unless several descendants share the name.  The index follows
+// reparenting through ParentChangedImmediateEvent, so FindDescendant() only
+// uses it if a Dispatcher exists when the NameSystem is created, and searches
+// the hierarchy otherwise.
 class NameSystem : public System {
  public:
   // If |allow_duplicate_names| is true, multiple entities are allowed to be
@@ -54,27 +65,57 @@ class NameSystem : public System {
   // Finds the entity associated with |name|. Returns kNullEntity if no entity
   // is found.
   // If |allow_duplicate_names| is true and more than one entity with the name
-  // is present, which of those entities will be returned is not well defined.
-  // The use of this method is discouraged when |allow_duplicate_names| is true
-  // since it involves a linear search across all entities. Use |FindDescendant|
-  // instead.
+  // is present, which of those entities will be returned is not well defined,
+  // so the use of this method is discouraged. Use |FindDescendant| instead.
   Entity FindEntity(const std::string& name) const;
 
   // Finds the entity associated with |name| within the descendants of |root|,
   // including |root|. Returns kNullEntity if no entity is found.
   // If |allow_duplicate_names| is true and more than one entity with the name
-  // is present, which of those entities will be returned is not well defined.
+  // is present, the first one in a pre-order traversal from |root| is returned.
   Entity FindDescendant(Entity root, const std::string& name) const;
 
+  // Writes all entity names for use with the WorldSnapshot.
+  void SaveSnapshot(SaveToBuffer* serializer) const;
+
+  // Replaces all entity names with those written by SaveSnapshot.
+  void RestoreSnapshot(LoadFromBuffer* serializer);
+
  private:
-  std::unordered_map<Entity, std::string> entity_to_name_;
-  std::unordered_map<Entity, HashValue> entity_to_hash_;
-  // Only used when |allow_duplicate_names| is false.
-  std::unordered_map<HashValue, Entity> hash_to_entity_;
-  bool allow_duplicate_names_;
+  // Combines an ancestor and a name hash into a key for |index_|.
+  using IndexKey = uint64_t;
+  static IndexKey GetIndexKey(Entity ancestor, HashValue hash) {
+    return (static_cast<IndexKey>(ancestor) << 32) | hash;
+  }
+
+  // Adds |entity| with name |hash| to the index under itself, kNullEntity and
+  // all its current ancestors.
+  void AddToIndex(Entity entity, HashValue hash);
+  void RemoveFromIndex(Entity entity, HashValue hash);
+
+  // Adds or removes |entity| with name |hash| under |ancestor| and all of
+  // |ancestor|'s ancestors.
+  void IndexUnderAncestors(Entity ancestor, Entity entity, HashValue hash,
+                           bool add);
+  void AddIndexEntry(IndexKey key, Entity entity);
+  void RemoveIndexEntry(IndexKey key, Entity entity);
+
+  // Moves the index entries of all named entities in the subtree rooted at
+  // |event.target| from the old parent's ancestors to the new parent's.
+  void OnParentChanged(const ParentChangedImmediateEvent& event);
 
   Entity FindDescendantWithDuplicateNames(
       TransformSystem* transform_system, Entity root, HashValue hash) const;
+
+  std::unordered_map<Entity, std::string> entity_to_name_;
+  std::unordered_map<Entity, HashValue> entity_to_hash_;
+  // Named entities by (ancestor, name hash).  Every named entity is listed
+  // under itself and kNullEntity as well as under each of its ancestors.  Sets
+  // keep adding and removing duplicate names cheap.
+  std::unordered_map<IndexKey, std::set<Entity>> index_;
+  bool allow_duplicate_names_;
+  // True if |index_| is kept up to date when entities are reparented.
+  bool track_hierarchy_ = false;
 };
 
 struct SetNameEvent {
@@ -18,9 +18,12 @@ limitations under the License.
 
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/modules/render/vertex.h"
 #include "lullaby/systems/layout/layout_box_system.h"
+#include "lullaby/systems/render/mesh_factory.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/data_container.h"
 #include "lullaby/util/logging.h"
 #include "lullaby/generated/nine_patch_def_generated.h"
 #include "mathfu/glsl_mappings.h"
@@ -71,10 +74,14 @@ void NinePatchSystem::PostCreateInit(Entity entity, DefType type,
                  << entity;
     return;
   }
-  UpdateNinePatchMesh(entity, kNullEntity, &iter->second);
+  UpdateNinePatchMesh(entity, kNullEntity, &iter->second, kCreateSharedMesh);
 }
 
-void NinePatchSystem::Destroy(Entity entity) { nine_patches_.erase(entity); }
+void NinePatchSystem::Destroy(Entity entity) {
+  ReleaseSharedMesh(entity);
+  dynamic_mesh_users_.erase(entity);
+  nine_patches_.erase(entity);
+}
 
 void NinePatchSystem::SetSize(Entity entity, const mathfu::vec2& size) {
   auto iter = nine_patches_.find(entity);
@@ -84,7 +91,7 @@ void NinePatchSystem::SetSize(Entity entity, const mathfu::vec2& size) {
     return;
   }
   iter->second.size = size;
-  UpdateNinePatchMesh(entity, kNullEntity, &iter->second);
+  UpdateNinePatchMesh(entity, kNullEntity, &iter->second, kUpdateDynamicMesh);
 }
 
 Optional<mathfu::vec2> NinePatchSystem::GetSize(Entity entity) const {
@@ -103,7 +110,7 @@ void NinePatchSystem::SetOriginalSize(Entity entity, const mathfu::vec2& size) {
     return;
   }
   iter->second.original_size = size;
-  UpdateNinePatchMesh(entity, kNullEntity, &iter->second);
+  UpdateNinePatchMesh(entity, kNullEntity, &iter->second, kUpdateDynamicMesh);
 }
 
 Optional<mathfu::vec2> NinePatchSystem::GetOriginalSize(Entity entity) const {
@@ -115,17 +122,14 @@ Optional<mathfu::vec2> NinePatchSystem::GetOriginalSize(Entity entity) const {
 }
 
 void NinePatchSystem::UpdateNinePatchMesh(Entity entity, Entity source,
-                                          const NinePatch* nine_patch) {
-  auto* render_system = registry_->Get<RenderSystem>();
-
-  auto nine_patch_mesh_fn = [&nine_patch](lull::MeshData* mesh) {
-    GenerateNinePatchMesh(*nine_patch, mesh);
-  };
-
-  render_system->UpdateDynamicMesh(
-      entity, lull::MeshData::PrimitiveType::kTriangles,
-      lull::VertexPTT::kFormat, nine_patch->GetVertexCount(),
-      nine_patch->GetIndexCount(), nine_patch_mesh_fn);
+                                          const NinePatch* nine_patch,
+                                          MeshUpdateMode mode) {
+  auto shared = shared_mesh_users_.find(entity);
+  const bool up_to_date =
+      shared != shared_mesh_users_.end() && shared->second == *nine_patch;
+  if (!up_to_date && !SetSharedMesh(entity, *nine_patch, mode)) {
+    SetDynamicMesh(entity, *nine_patch);
+  }
 
   auto *layout_box_system = registry_->Get<LayoutBoxSystem>();
   if (layout_box_system) {
@@ -146,6 +150,113 @@ void NinePatchSystem::UpdateNinePatchMesh(Entity entity, Entity source,
   transform_system->SetAabb(entity, aabb);
 }
 
+bool NinePatchSystem::SetSharedMesh(Entity entity, const NinePatch& nine_patch,
+                                    MeshUpdateMode mode) {
+  auto* render_system = registry_->Get<RenderSystem>();
+  const std::vector<HashValue> passes = render_system->GetRenderPasses(entity);
+  if (passes.empty()) {
+    return false;
+  }
+
+  auto* mesh_factory = registry_->Get<MeshFactory>();
+  auto iter = shared_meshes_.find(nine_patch);
+  if (iter == shared_meshes_.end() &&
+      (mode != kCreateSharedMesh || !mesh_factory)) {
+    // Backends without a MeshFactory can only use per-entity meshes.
+    return false;
+  }
+
+  if (dynamic_mesh_users_.erase(entity) > 0) {
+    // Return the entity's dynamic mesh to the RenderSystem.
+    render_system->UpdateDynamicMesh(entity, MeshData::kTriangles,
+                                     VertexPTT::kFormat, 0, 0,
+                                     [](MeshData*) {});
+  }
+
+  if (iter == shared_meshes_.end()) {
+    const std::vector<uint16_t>& indices = GetIndices(nine_patch);
+    MeshData data(
+        MeshData::kTriangles, VertexPTT::kFormat,
+        DataContainer::CreateHeapDataContainer(nine_patch.GetVertexCount() *
+                                               sizeof(VertexPTT)),
+        MeshData::kIndexU16,
+        DataContainer::CreateHeapDataContainer(indices.size() *
+                                               sizeof(uint16_t)));
+    GenerateNinePatchVertices(nine_patch, &data);
+    data.AddIndices(indices.data(), indices.size());
+
+    iter = shared_meshes_.emplace(nine_patch, SharedMesh()).first;
+    iter->second.mesh = mesh_factory->CreateMesh(std::move(data));
+  }
+
+  ++iter->second.ref_count;
+  ReleaseSharedMesh(entity);
+  shared_mesh_users_.emplace(entity, nine_patch);
+
+  for (HashValue pass : passes) {
+    if (render_system->GetMesh(entity, pass) != iter->second.mesh) {
+      render_system->SetMesh(entity, pass, iter->second.mesh);
+    }
+  }
+  return true;
+}
+
+void NinePatchSystem::SetDynamicMesh(Entity entity,
+                                     const NinePatch& nine_patch) {
+  ReleaseSharedMesh(entity);
+  dynamic_mesh_users_.insert(entity);
+
+  const std::vector<uint16_t>& indices = GetIndices(nine_patch);
+  auto nine_patch_mesh_fn = [&nine_patch, &indices](MeshData* mesh) {
+    GenerateNinePatchVertices(nine_patch, mesh);
+    mesh->AddIndices(indices.data(), indices.size());
+  };
+
+  auto* render_system = registry_->Get<RenderSystem>();
+  render_system->UpdateDynamicMesh(
+      entity, MeshData::kTriangles, VertexPTT::kFormat,
+      nine_patch.GetVertexCount(), nine_patch.GetIndexCount(),
+      nine_patch_mesh_fn);
+}
+
+void NinePatchSystem::ReleaseSharedMesh(Entity entity) {
+  auto user = shared_mesh_users_.find(entity);
+  if (user == shared_mesh_users_.end()) {
+    return;
+  }
+  auto iter = shared_meshes_.find(user->second);
+  if (iter != shared_meshes_.end() && --iter->second.ref_count == 0) {
+    shared_meshes_.erase(iter);
+  }
+  shared_mesh_users_.erase(user);
+}
+
+const std::vector<uint16_t>& NinePatchSystem::GetIndices(
+    const NinePatch& nine_patch) {
+  const uint64_t key =
+      (static_cast<uint64_t>(static_cast<uint32_t>(nine_patch.subdivisions.x))
+       << 32) |
+      static_cast<uint32_t>(nine_patch.subdivisions.y);
+  auto iter = indices_.find(key);
+  if (iter == indices_.end()) {
+    // MeshData validates indices against its vertices, so generate the whole
+    // mesh once and keep the indices.
+    MeshData data(MeshData::kTriangles, VertexPTT::kFormat,
+                  DataContainer::CreateHeapDataContainer(
+                      nine_patch.GetVertexCount() * sizeof(VertexPTT)),
+                  MeshData::kIndexU16,
+                  DataContainer::CreateHeapDataContainer(
+                      nine_patch.GetIndexCount() * sizeof(uint16_t)));
+    GenerateNinePatchMesh(nine_patch, &data);
+    const uint16_t* begin = data.GetIndexData<uint16_t>();
+    iter = indices_
+               .emplace(key, std::vector<uint16_t>(
+                                 begin, begin + data.GetNumIndices()))
+               .first;
+  }
+  return iter->second;
+}
+
 void NinePatchSystem::OnDesiredSizeChanged(
     const DesiredSizeChangedEvent& event) {
   auto iter = nine_patches_.find(event.target);
@@ -162,7 +273,8 @@ void NinePatchSystem::OnDesiredSizeChanged(
     if (y) {
       nine_patch.size.y = *y;
     }
-    UpdateNinePatchMesh(event.target, event.source, &nine_patch);
+    UpdateNinePatchMesh(event.target, event.source, &nine_patch,
+                        kCreateSharedMesh);
   }
 }
 
@@ -17,9 +17,14 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_NINE_PATCH_NINE_PATCH_SYSTEM_H_
 #define LULLABY_SYSTEMS_NINE_PATCH_NINE_PATCH_SYSTEM_H_
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "lullaby/events/layout_events.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/modules/render/nine_patch.h"
+#include "lullaby/systems/render/mesh.h"
 #include "lullaby/util/optional.h"
 
 namespace lull {
@@ -28,6 +33,14 @@ namespace lull {
 // the dimensions of a quad to fill, the original (unaltered) size of the nine
 // patch, and the locations of the slices, a mesh is generated with appropriate
 // vertex locations and texture coordinates.
+//
+// Entities whose nine patches have identical parameters share a single mesh,
+// which is created with the MeshFactory (if one is registered), reference
+// counted, and released when no entity uses it anymore.
+// Explicit size changes (eg. from SetSize() during an animation) that do not
+// match an existing shared mesh instead update the entity's own dynamic mesh in
+// place.  In both cases, the indices are generated once per subdivision count
+// and reused since they do not depend on the size of the nine patch.
 class NinePatchSystem : public System {
  public:
   explicit NinePatchSystem(Registry* registry);
@@ -59,14 +72,49 @@ class NinePatchSystem : public System {
   Optional<mathfu::vec2> GetOriginalSize(Entity entity) const;
 
  private:
+  // Determines what to do when no shared mesh matches a nine patch.
+  enum MeshUpdateMode {
+    // Create a new mesh and share it with other entities.
+    kCreateSharedMesh,
+    // Update the entity's dynamic mesh, since the nine patch is likely to be
+    // resized again soon.
+    kUpdateDynamicMesh,
+  };
+
+  struct SharedMesh {
+    MeshPtr mesh;
+    int ref_count = 0;
+  };
+
   // Recomputes the mesh for |entity| given the component data in |nine_patch|.
   void UpdateNinePatchMesh(Entity entity, Entity source,
-                           const NinePatch* nine_patch);
+                           const NinePatch* nine_patch, MeshUpdateMode mode);
+
+  // Assigns the shared mesh for |nine_patch| to |entity|, creating it if
+  // |mode| allows it.  Returns false if no shared mesh was assigned.
+  bool SetSharedMesh(Entity entity, const NinePatch& nine_patch,
+                     MeshUpdateMode mode);
+
+  // Updates the dynamic mesh of |entity| with the data in |nine_patch|.
+  void SetDynamicMesh(Entity entity, const NinePatch& nine_patch);
+
+  // Releases |entity|'s reference to its shared mesh, if any.
+  void ReleaseSharedMesh(Entity entity);
+
+  // Returns the indices for nine patches with the same subdivisions as
+  // |nine_patch|.
+  const std::vector<uint16_t>& GetIndices(const NinePatch& nine_patch);
 
   // Recompute nine_patch based on new desired_size.
   void OnDesiredSizeChanged(const DesiredSizeChangedEvent& event);
 
   std::unordered_map<Entity, NinePatch> nine_patches_;
+  std::unordered_map<NinePatch, SharedMesh, NinePatchHash> shared_meshes_;
+  // The nine patch whose shared mesh is assigned to each entity.
+  std::unordered_map<Entity, NinePatch> shared_mesh_users_;
+  std::unordered_set<Entity> dynamic_mesh_users_;
+  // Indices keyed by the subdivisions they were generated for.
+  std::unordered_map<uint64_t, std::vector<uint16_t>> indices_;
 };
 
 }  // namespace lull
@@ -36,12 +36,15 @@ class DisplayList {
     RenderSortOrder sort_order;
   };
 
+  // Entries are kept small so that sorting the list moves as little memory as
+  // possible.  The world matrix points into the TransformSystem's storage and
+  // is only valid until the next time the TransformSystem is modified.
   struct Entry {
     explicit Entry(Entity e) : entity(e) {}
 
     Entity entity;
     const Component* component = nullptr;
-    mathfu::mat4 world_from_entity_matrix;
+    const mathfu::mat4* world_from_entity_matrix = nullptr;
     SortKey sort_key;
   };
 
@@ -56,15 +59,20 @@ class DisplayList {
                 size_t num_views);
 
  private:
-  void GetComponentsUnsorted(const RenderPool<Component>& pool);
-  void GetComponentsWithSortOrder(const RenderPool<Component>& pool);
-  void GetComponentsWithWorldSpaceZ(const RenderPool<Component>& pool);
-  void GetComponentsWithWorldSpaceVector(const RenderPool<Component>& pool,
-                                         const mathfu::vec3& vector);
-  void GetComponentsWithAverageSpaceZ(const RenderPool<Component>& pool,
-                                      const RenderView* views,
-                                      size_t num_views);
-  void GetComponentsWithWorldSpaceZMinusAbsX(const RenderPool<Component>& pool);
+  // The values needed to compute an entry's sort key, calculated once per call
+  // to Populate.
+  struct SortParams {
+    SortMode mode = SortMode_None;
+    mathfu::vec3 origin = mathfu::kZeros3f;
+    mathfu::vec3 direction = mathfu::kZeros3f;
+  };
+
+  bool InitSortParams(const RenderPool<Component>& pool,
+                      const RenderView* views, size_t num_views,
+                      SortParams* params) const;
+  static SortKey ComputeSortKey(const SortParams& params,
+                                const Component& component,
+                                const mathfu::mat4& world_from_entity_matrix);
 
   void SortDecreasingFloat();
   void SortIncreasingFloat();
@@ -78,99 +86,74 @@ class DisplayList {
 };
 
 template <typename Component>
-void DisplayList<Component>::GetComponentsUnsorted(
-    const RenderPool<Component>& pool) {
-  for (auto& info : list_) {
-    info.component = pool.GetComponent(info.entity);
-    if (!info.component) {
-      LOG(DFATAL) << "Failed to get component.";
-    }
-  }
-}
-
-template <typename Component>
-void DisplayList<Component>::GetComponentsWithSortOrder(
-    const RenderPool<Component>& pool) {
-  for (auto& info : list_) {
-    info.component = pool.GetComponent(info.entity);
-    if (!info.component) {
-      LOG(DFATAL) << "Failed to get component.";
-      return;
-    }
-    info.sort_key.sort_order = info.component->sort_order;
-  }
-}
-
-template <typename Component>
-void DisplayList<Component>::GetComponentsWithAverageSpaceZ(
-    const RenderPool<Component>& pool, const RenderView* views,
-    size_t num_views) {
-  if (num_views <= 0) {
-    LOG(DFATAL) << "Must have at least 1 view.";
-    return;
-  }
-  mathfu::vec3 avg_pos(0, 0, 0);
-  mathfu::vec3 avg_z(0, 0, 0);
-  for (size_t i = 0; i < num_views; ++i) {
-    avg_pos += views[i].world_from_eye_matrix.TranslationVector3D();
-    avg_z += GetMatrixColumn3D(views[i].world_from_eye_matrix, 2);
-  }
-  avg_pos /= static_cast<float>(num_views);
-  avg_z.Normalize();
-
-  for (auto& info : list_) {
-    info.component = pool.GetComponent(info.entity);
-    if (!info.component) {
-      LOG(DFATAL) << "Failed to get component.";
-      return;
-    }
-    const mathfu::vec3 world_pos =
-        info.world_from_entity_matrix.TranslationVector3D();
-    info.sort_key.f32 = mathfu::vec3::DotProduct(world_pos - avg_pos, avg_z);
-  }
-}
-
-template <typename Component>
-void DisplayList<Component>::GetComponentsWithWorldSpaceZ(
-    const RenderPool<Component>& pool) {
-  for (auto& info : list_) {
-    info.component = pool.GetComponent(info.entity);
-    if (!info.component) {
-      LOG(DFATAL) << "Failed to get component.";
-      return;
+bool DisplayList<Component>::InitSortParams(const RenderPool<Component>& pool,
+                                            const RenderView* views,
+                                            size_t num_views,
+                                            SortParams* params) const {
+  params->mode = pool.GetSortMode();
+  switch (params->mode) {
+    case SortMode_WorldSpaceZBackToFront:
+    case SortMode_WorldSpaceZFrontToBack:
+      params->direction = mathfu::kAxisZ3f;
+      break;
+    case SortMode_WorldSpaceVectorBackToFront:
+    case SortMode_WorldSpaceVectorFrontToBack:
+      params->direction = pool.GetSortVector().value();
+      break;
+    case SortMode_AverageSpaceOriginBackToFront:
+    case SortMode_AverageSpaceOriginFrontToBack: {
+      if (num_views <= 0) {
+        LOG(DFATAL) << "Must have at least 1 view.";
+        return false;
+      }
+      mathfu::vec3 avg_pos(0, 0, 0);
+      mathfu::vec3 avg_z(0, 0, 0);
+      for (size_t i = 0; i < num_views; ++i) {
+        avg_pos += views[i].world_from_eye_matrix.TranslationVector3D();
+        avg_z += GetMatrixColumn3D(views[i].world_from_eye_matrix, 2);
+      }
+      avg_pos /= static_cast<float>(num_views);
+      avg_z.Normalize();
+      params->origin = avg_pos;
+      params->direction = avg_z;
+      break;
     }
-    info.sort_key.f32 = info.world_from_entity_matrix.TranslationVector3D().z;
+    default:
+      break;
   }
+  return true;
 }
 
 template <typename Component>
-void DisplayList<Component>::GetComponentsWithWorldSpaceVector(
-    const RenderPool<Component>& pool, const mathfu::vec3& vector) {
-  for (auto& info : list_) {
-    info.component = pool.GetComponent(info.entity);
-    if (!info.component) {
-      LOG(DFATAL) << "Failed to get component.";
-      return;
+typename DisplayList<Component>::SortKey DisplayList<Component>::ComputeSortKey(
+    const SortParams& params, const Component& component,
+    const mathfu::mat4& world_from_entity_matrix) {
+  SortKey key;
+  switch (params.mode) {
+    case SortMode_SortOrderIncreasing:
+    case SortMode_SortOrderDecreasing:
+      key.sort_order = component.sort_order;
+      break;
+    case SortMode_WorldSpaceZBackToFront:
+    case SortMode_WorldSpaceZFrontToBack:
+    case SortMode_WorldSpaceVectorBackToFront:
+    case SortMode_WorldSpaceVectorFrontToBack:
+    case SortMode_AverageSpaceOriginBackToFront:
+    case SortMode_AverageSpaceOriginFrontToBack:
+      key.f32 = mathfu::vec3::DotProduct(
+          world_from_entity_matrix.TranslationVector3D() - params.origin,
+          params.direction);
+      break;
+    case SortMode_WorldSpaceZBackToFrontXOutToMiddle: {
+      const mathfu::vec3 world_pos =
+          world_from_entity_matrix.TranslationVector3D();
+      key.f32 = world_pos.z - std::abs(world_pos.x);
+      break;
     }
-    const mathfu::vec3 pos =
-        info.world_from_entity_matrix.TranslationVector3D();
-    info.sort_key.f32 = mathfu::vec3::DotProduct(pos, vector);
-  }
-}
-
-template <typename Component>
-void DisplayList<Component>::GetComponentsWithWorldSpaceZMinusAbsX(
-    const RenderPool<Component>& pool) {
-  for (auto& info : list_) {
-    info.component = pool.GetComponent(info.entity);
-    if (!info.component) {
-      LOG(DFATAL) << "Failed to get component.";
-      return;
-    }
-    const mathfu::vec3 world_pos =
-        info.world_from_entity_matrix.TranslationVector3D();
-    info.sort_key.f32 = world_pos.z - std::abs(world_pos.x);
+    default:
+      break;
   }
+  return key;
 }
 
 template <typename Component>
@@ -210,23 +193,15 @@ void DisplayList<Component>::Populate(const RenderPool<Component>& pool,
   list_.clear();
   list_.reserve(pool.Size());
 
-  const RenderCullMode cull_mode = pool.GetCullMode();
-
-  const auto* transform_system = registry_->Get<TransformSystem>();
+  SortParams sort_params;
+  if (!InitSortParams(pool, views, num_views, &sort_params)) {
+    return;
+  }
 
-  if (cull_mode == RenderCullMode::kNone) {
-    transform_system->ForEach(
-        pool.GetTransformFlag(),
-        [&](Entity e, const mathfu::mat4& world_from_entity_mat,
-            const Aabb& box) {
-          // TODO(b/28213394) Don't copy transforms.
-          Entry info(e);
-          info.world_from_entity_matrix = world_from_entity_mat;
-          list_.push_back(info);
-        });
-  } else {
-    // Compute the view frustum for all views.
-    mathfu::vec4 frustum_clipping_planes[kMaxViews][kNumFrustumPlanes];
+  // Compute the view frustum for all views.
+  const bool cull = pool.GetCullMode() != RenderCullMode::kNone;
+  mathfu::vec4 frustum_clipping_planes[kMaxViews][kNumFrustumPlanes];
+  if (cull) {
     if (num_views > kMaxViews) {
       LOG(DFATAL) << "Cannot have more views than eyes.";
       return;
@@ -235,15 +210,16 @@ void DisplayList<Component>::Populate(const RenderPool<Component>& pool,
       CalculateViewFrustum(views[i].clip_from_world_matrix,
                            frustum_clipping_planes[i]);
     }
+  }
 
-    transform_system->ForEach(
-        pool.GetTransformFlag(),
-        [&](Entity e, const mathfu::mat4& world_from_entity_mat,
-            const Aabb& box) {
-          // TODO(b/28213394) Don't copy transforms.
-          Entry info(e);
-          info.world_from_entity_matrix = world_from_entity_mat;
-
+  // Build the entries, including their sort keys, in a single pass over the
+  // transforms flagged as belonging to this pool.
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  transform_system->ForEach(
+      pool.GetTransformFlag(),
+      [&](Entity e, const mathfu::mat4& world_from_entity_mat,
+          const Aabb& box) {
+        if (cull) {
           // Compute the bounding sphere from bounding box and transform it
           // to world space because the view's frustum is in world space.
           // TODO(b/30646608): This should be cached since most entities are
@@ -253,53 +229,58 @@ void DisplayList<Component>::Populate(const RenderPool<Component>& pool,
               world_from_entity_mat *
               mathfu::vec3::Lerp(box.min, box.max, 0.5f);
 
-          // Add the entity to the display list, if it's bounding sphere
+          // Only add the entity to the display list if its bounding sphere
           // intersects at least one render view's frustum.
-          for (size_t i = 0; i < num_views; i++) {
-            if (CheckSphereInFrustum(center, radius,
-                                     frustum_clipping_planes[i])) {
-              list_.push_back(info);
-              break;
-            }
+          bool visible = false;
+          for (size_t i = 0; i < num_views && !visible; i++) {
+            visible = CheckSphereInFrustum(center, radius,
+                                           frustum_clipping_planes[i]);
           }
-        });
-  }
-
-  const SortMode sort_mode = pool.GetSortMode();
-
-  if (sort_mode == SortMode_SortOrderIncreasing) {
-    GetComponentsWithSortOrder(pool);
-    SortIncreasingUnsigned();
-  } else if (sort_mode == SortMode_SortOrderDecreasing) {
-    GetComponentsWithSortOrder(pool);
-    SortDecreasingUnsigned();
-  } else if (sort_mode == SortMode_WorldSpaceZBackToFront) {
-    // -z is forward, so z decreases as distance in front of camera increases.
-    GetComponentsWithWorldSpaceZ(pool);
-    SortIncreasingFloat();
-  } else if (sort_mode == SortMode_WorldSpaceZFrontToBack) {
-    GetComponentsWithWorldSpaceZ(pool);
-    SortDecreasingFloat();
-  } else if (sort_mode == SortMode_WorldSpaceVectorBackToFront) {
-    GetComponentsWithWorldSpaceVector(pool, pool.GetSortVector().value());
-    SortDecreasingFloat();
-  } else if (sort_mode == SortMode_WorldSpaceVectorFrontToBack) {
-    GetComponentsWithWorldSpaceVector(pool, pool.GetSortVector().value());
-    SortIncreasingFloat();
-  } else if (sort_mode == SortMode_AverageSpaceOriginBackToFront) {
+          if (!visible) {
+            return;
+          }
+        }
+
+        const Component* component = pool.GetComponent(e);
+        if (!component) {
+          LOG(DFATAL) << "Failed to get component.";
+          return;
+        }
+
+        list_.emplace_back(e);
+        Entry& entry = list_.back();
+        entry.component = component;
+        entry.world_from_entity_matrix = &world_from_entity_mat;
+        entry.sort_key =
+            ComputeSortKey(sort_params, *component, world_from_entity_mat);
+      });
+
+  switch (sort_params.mode) {
+    case SortMode_SortOrderIncreasing:
+      SortIncreasingUnsigned();
+      break;
+    case SortMode_SortOrderDecreasing:
+      SortDecreasingUnsigned();
+      break;
     // -z is forward, so z decreases as distance in front of camera increases.
-    GetComponentsWithAverageSpaceZ(pool, views, num_views);
-    SortIncreasingFloat();
-  } else if (sort_mode == SortMode_AverageSpaceOriginFrontToBack) {
-    GetComponentsWithAverageSpaceZ(pool, views, num_views);
-    SortDecreasingFloat();
-  } else if (sort_mode == SortMode_WorldSpaceZBackToFrontXOutToMiddle) {
-    GetComponentsWithWorldSpaceZMinusAbsX(pool);
-    SortIncreasingFloat();
-  } else {
-    DCHECK(sort_mode == SortMode_None)
-        << "Unsupported sort mode " << static_cast<int>(sort_mode);
-    GetComponentsUnsorted(pool);
+    case SortMode_WorldSpaceZBackToFront:
+    case SortMode_AverageSpaceOriginBackToFront:
+    case SortMode_WorldSpaceZBackToFrontXOutToMiddle:
+    case SortMode_WorldSpaceVectorFrontToBack:
+      SortIncreasingFloat();
+      break;
+    case SortMode_WorldSpaceZFrontToBack:
+    case SortMode_AverageSpaceOriginFrontToBack:
+    case SortMode_WorldSpaceVectorBackToFront:
+      SortDecreasingFloat();
+      break;
+    case SortMode_MinimizeStateChanges:
+      // The display list has no access to render state, so leave the order.
+      break;
+    default:
+      DCHECK(sort_params.mode == SortMode_None)
+          << "Unsupported sort mode " << static_cast<int>(sort_params.mode);
+      break;
   }
 }
 
@@ -56,6 +56,13 @@ constexpr RenderSortOrderOffset SortOrderManager::kUseDefaultOffset;
 void SortOrderManager::Destroy(EntityIdPair entity_id_pair) {
   requested_offset_map_.erase(entity_id_pair);
   root_offset_map_.erase(entity_id_pair);
+  dirty_set_.erase(entity_id_pair);
+}
+
+void SortOrderManager::MarkDirty(EntityIdPair entity_id_pair) {
+  if (dirty_set_.insert(entity_id_pair).second) {
+    dirty_list_.push_back(entity_id_pair);
+  }
 }
 
 RenderSortOrderOffset SortOrderManager::GetOffset(
@@ -130,21 +137,23 @@ std::pair<RenderSortOrder, int> SortOrderManager::CalculateSortOrderAndDepth(
     return std::make_pair(CalculateRootSortOrder(entity_id_pair), 0);
   }
 
-  auto iter = requested_offset_map_.find(entity_id_pair);
-  RenderSortOrderOffset offset;
-  if (iter == requested_offset_map_.end() ||
-      iter->second == kUseDefaultOffset) {
+  RenderSortOrderOffset offset = GetOffset(entity_id_pair);
+  if (offset == kUseDefaultOffset) {
     offset = CalculateSiblingOffset(entity_id_pair, parent);
-  } else {
-    offset = iter->second;
   }
 
-  offset = CheckOffsetBounds(entity_id_pair, offset);
-
   const auto parent_order_depth_pair =
       CalculateSortOrderAndDepth(EntityIdPair(parent, entity_id_pair.id));
-  RenderSortOrder parent_sort_order = parent_order_depth_pair.first;
-  const int parent_depth = parent_order_depth_pair.second;
+  return CalculateChildSortOrderAndDepth(entity_id_pair, offset,
+                                         parent_order_depth_pair.first,
+                                         parent_order_depth_pair.second);
+}
+
+std::pair<RenderSortOrder, int>
+SortOrderManager::CalculateChildSortOrderAndDepth(
+    EntityIdPair entity_id_pair, RenderSortOrderOffset offset,
+    RenderSortOrder parent_sort_order, int parent_depth) const {
+  offset = CheckOffsetBounds(entity_id_pair, offset);
 
   const int depth = parent_depth + 1;
   if (depth >= lull::RenderSortOrder::kMaxDepth) {
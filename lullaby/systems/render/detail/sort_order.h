@@ -17,7 +17,9 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_RENDER_DETAIL_SORT_ORDER_H_
 #define LULLABY_SYSTEMS_RENDER_DETAIL_SORT_ORDER_H_
 
+#include <algorithm>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -63,6 +65,10 @@ struct EntityIdPairHash {
 // Sort orders are calculated from offsets at every level of a hierarchy.  If an
 // entity doesn't have an offset or its offset is 0, then it uses a default
 // value based on its inheritance.
+//
+// Hierarchy changes can be handled lazily by calling MarkDirty and then
+// ProcessDirty once per frame.  This updates each dirty subtree exactly once in
+// a single top-down pass, no matter how many of its entities were changed.
 class SortOrderManager {
  public:
   static constexpr RenderSortOrderOffset kUseDefaultOffset = 0;
@@ -87,12 +93,40 @@ class SortOrderManager {
   RenderSortOrder CalculateSortOrder(EntityIdPair entity_id_pair);
 
   // Calculates |entity_id_pair|'s sort order, stores it in its render component
-  // (if it has one), and recurses through its children.
+  // (if it has one), and recurses through its children.  Only the sort order of
+  // |entity_id_pair| itself walks up the hierarchy; descendants are calculated
+  // from their parent's sort order.
   template <typename GetComponentFn>
   void UpdateSortOrder(EntityIdPair entity_id_pair,
                        const GetComponentFn& get_component);
 
+  // Flags |entity_id_pair| and its descendants as requiring a sort order update
+  // during the next call to ProcessDirty.
+  void MarkDirty(EntityIdPair entity_id_pair);
+
+  // Returns true if there are entities waiting for ProcessDirty.
+  bool HasDirty() const { return !dirty_set_.empty(); }
+
+  // Updates the sort orders of all entities flagged with MarkDirty.  Dirty
+  // entities that have a dirty ancestor are skipped since they are updated as
+  // part of the ancestor's subtree.
+  template <typename GetComponentFn>
+  void ProcessDirty(const GetComponentFn& get_component);
+
  private:
+  // Stores |sort_order| in |entity_id_pair|'s render component (if it has one)
+  // and recurses through its children, passing the sort order down.
+  template <typename GetComponentFn>
+  void UpdateSortOrderTopDown(EntityIdPair entity_id_pair,
+                              RenderSortOrder sort_order, int depth,
+                              const GetComponentFn& get_component);
+
+  // Returns the sort order and depth of a non-root |entity_id_pair| with the
+  // given |offset| from its parent's sort order and depth.
+  std::pair<RenderSortOrder, int> CalculateChildSortOrderAndDepth(
+      EntityIdPair entity_id_pair, RenderSortOrderOffset offset,
+      RenderSortOrder parent_sort_order, int parent_depth) const;
+
   // Returns the sibling offset of |entity_id_pair|.  Result is undefined if
   // |parent| is kNullEntity.
   RenderSortOrderOffset CalculateSiblingOffset(EntityIdPair entity_id_pair,
@@ -123,24 +157,84 @@ class SortOrderManager {
 
   // Offset to use for the next root-level entity to be registered.
   RenderSortOrderOffset next_root_offset_ = 1;
+
+  // Entities flagged with MarkDirty, in the order they were flagged so that
+  // root offsets are assigned deterministically.  The set is used to check
+  // membership.
+  std::vector<EntityIdPair> dirty_list_;
+  std::unordered_set<EntityIdPair, EntityIdPairHash> dirty_set_;
 };
 
 template <typename GetComponentFn>
 void SortOrderManager::UpdateSortOrder(EntityIdPair entity_id_pair,
                                        const GetComponentFn& get_component) {
+  const auto order_depth_pair = CalculateSortOrderAndDepth(entity_id_pair);
+  UpdateSortOrderTopDown(entity_id_pair, order_depth_pair.first,
+                         order_depth_pair.second, get_component);
+}
+
+template <typename GetComponentFn>
+void SortOrderManager::UpdateSortOrderTopDown(
+    EntityIdPair entity_id_pair, RenderSortOrder sort_order, int depth,
+    const GetComponentFn& get_component) {
   auto* component = get_component(entity_id_pair);
   if (component) {
-    component->sort_order = CalculateSortOrder(entity_id_pair);
+    component->sort_order = sort_order;
   }
 
   const auto* transform_system = registry_->Get<TransformSystem>();
   const std::vector<Entity>* children =
       transform_system->GetChildren(entity_id_pair.entity);
-  if (children) {
-    for (const auto& child : *children) {
-      UpdateSortOrder(EntityIdPair(child, entity_id_pair.id), get_component);
+  if (!children) {
+    return;
+  }
+
+  // The default offset of a child is its (1-based) index amongst its siblings.
+  RenderSortOrderOffset sibling_offset = 1;
+  for (const auto& child : *children) {
+    const EntityIdPair child_pair(child, entity_id_pair.id);
+    RenderSortOrderOffset offset = GetOffset(child_pair);
+    if (offset == kUseDefaultOffset) {
+      offset = std::min(lull::RenderSortOrder::kMaxOffset - 1, sibling_offset);
+    }
+    const auto order_depth_pair =
+        CalculateChildSortOrderAndDepth(child_pair, offset, sort_order, depth);
+    UpdateSortOrderTopDown(child_pair, order_depth_pair.first,
+                           order_depth_pair.second, get_component);
+    ++sibling_offset;
+  }
+}
+
+template <typename GetComponentFn>
+void SortOrderManager::ProcessDirty(const GetComponentFn& get_component) {
+  if (dirty_set_.empty()) {
+    dirty_list_.clear();
+    return;
+  }
+
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  for (const EntityIdPair& entity_id_pair : dirty_list_) {
+    // Entities destroyed after being flagged are no longer in the set.
+    if (dirty_set_.count(entity_id_pair) == 0) {
+      continue;
+    }
+
+    bool has_dirty_ancestor = false;
+    Entity parent = transform_system->GetParent(entity_id_pair.entity);
+    while (parent != kNullEntity) {
+      if (dirty_set_.count(EntityIdPair(parent, entity_id_pair.id)) != 0) {
+        has_dirty_ancestor = true;
+        break;
+      }
+      parent = transform_system->GetParent(parent);
+    }
+
+    if (!has_dirty_ancestor) {
+      UpdateSortOrder(entity_id_pair, get_component);
     }
   }
+  dirty_list_.clear();
+  dirty_set_.clear();
 }
 
 }  // namespace detail
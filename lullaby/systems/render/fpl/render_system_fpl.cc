@@ -113,6 +113,7 @@ RenderSystemFpl::RenderSystemFpl(Registry* registry,
                                  const RenderSystem::InitParams& init_params)
     : System(registry),
       render_component_pools_(registry),
+      display_list_(registry),
       sort_order_manager_(registry_),
       multiview_enabled_(init_params.enable_stereo_multiview),
       clip_from_model_matrix_func_(CalculateClipFromModelMatrix) {
@@ -127,10 +128,10 @@ RenderSystemFpl::RenderSystemFpl(Registry* registry,
 
   auto* dispatcher = registry->Get<Dispatcher>();
   dispatcher->Connect(this, [this](const ParentChangedEvent& event) {
-    UpdateSortOrder(event.target);
+    MarkSortOrderDirty(event.target);
   });
   dispatcher->Connect(this, [this](const ChildIndexChangedEvent& event) {
-    UpdateSortOrder(event.target);
+    MarkSortOrderDirty(event.target);
   });
 
   FunctionBinder* binder = registry->Get<FunctionBinder>();
@@ -395,6 +396,7 @@ void RenderSystemFpl::ProcessTasks() {
 
   CreateDeferredMeshes();
   factory_->UpdateAssetLoad();
+  UpdateDirtySortOrders();
 }
 
 void RenderSystemFpl::WaitForAssetsToLoad() {
@@ -1197,14 +1199,21 @@ void RenderSystemFpl::BeginFrame() {
 void RenderSystemFpl::EndFrame() {
   // Something in later passes seems to expect depth write to be on. Setting
   // this here until the culprit is identified (b/36200233).
+  if (ShouldResetState()) {
+    SetDepthWrite(true);
+  }
+}
+
+bool RenderSystemFpl::ShouldResetState() {
   const auto* config = registry_->Get<Config>();
-  bool reset_state = true;
-  if (config) {
-    reset_state = config->Get(kRenderResetStateHash, reset_state);
+  if (!config) {
+    return true;
   }
-  if (reset_state) {
-    SetDepthWrite(true);
+  if (config != reset_state_config_) {
+    reset_state_config_ = config;
+    reset_state_ = ConfigValue<bool>(config, kRenderResetStateHash, true);
   }
+  return reset_state_.Get();
 }
 
 void RenderSystemFpl::BeginRendering() {}
@@ -1368,7 +1377,7 @@ void RenderSystemFpl::RenderDisplayList(const View& view,
   std::for_each(
       list->begin(), list->end(), [&](const DisplayList::Entry& info) {
         if (info.component) {
-          RenderAt(info.component, info.world_from_entity_matrix, view);
+          RenderAt(info.component, *info.world_from_entity_matrix, view);
         }
       });
 }
@@ -1381,7 +1390,7 @@ void RenderSystemFpl::RenderDisplayListMultiview(
                 [&](const DisplayList::Entry& info) {
                   if (info.component) {
                     RenderAtMultiview(info.component,
-                                      info.world_from_entity_matrix, views);
+                                      *info.world_from_entity_matrix, views);
                   }
                 });
 }
@@ -1391,19 +1400,18 @@ void RenderSystemFpl::RenderComponentsInPass(const View* views,
   pass = FixRenderPass(pass);
   const RenderPool& pool =
       render_component_pools_.GetPool(static_cast<RenderPass>(pass));
-  DisplayList display_list(registry_);
-  display_list.Populate(pool, views, num_views);
+  display_list_.Populate(pool, views, num_views);
 
   if (multiview_enabled_) {
     SetViewport(views[0]);
     SetViewUniforms(views[0]);
-    RenderDisplayListMultiview(views, display_list);
+    RenderDisplayListMultiview(views, display_list_);
 
   } else {
     for (size_t j = 0; j < num_views; ++j) {
       SetViewport(views[j]);
       SetViewUniforms(views[j]);
-      RenderDisplayList(views[j], display_list);
+      RenderDisplayList(views[j], display_list_);
     }
   }
 
@@ -1414,6 +1422,7 @@ void RenderSystemFpl::RenderComponentsInPass(const View* views,
 
 
 void RenderSystemFpl::Render(const View* views, size_t num_views) {
+  UpdateDirtySortOrders();
   renderer_.BeginRendering();
 
   ResetState();
@@ -1443,11 +1452,7 @@ void RenderSystemFpl::Render(const View* views, size_t num_views,
     }
   }
 
-  bool reset_state = true;
-  auto* config = registry_->Get<Config>();
-  if (config) {
-    reset_state = config->Get(kRenderResetStateHash, reset_state);
-  }
+  const bool reset_state = ShouldResetState();
 
   switch (pass) {
     case RenderPass_Pano: {
@@ -1758,11 +1763,15 @@ void RenderSystemFpl::RenderDebugStats(const View* views, size_t num_views) {
   SetDepthWrite(true);
 }
 
-void RenderSystemFpl::UpdateSortOrder(Entity entity) {
-  sort_order_manager_.UpdateSortOrder(
-      entity, [this](detail::EntityIdPair entity_id_pair) {
-        return render_component_pools_.GetComponent(entity_id_pair.entity);
-      });
+void RenderSystemFpl::MarkSortOrderDirty(Entity entity) {
+  sort_order_manager_.MarkDirty(entity);
+}
+
+void RenderSystemFpl::UpdateDirtySortOrders() {
+  LULLABY_CPU_TRACE_CALL();
+  sort_order_manager_.ProcessDirty([this](detail::EntityIdPair entity_id_pair) {
+    return render_component_pools_.GetComponent(entity_id_pair.entity);
+  });
 }
 
 const fplbase::RenderState& RenderSystemFpl::GetCachedRenderState() const {
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "lullaby/events/entity_events.h"
+#include "lullaby/modules/config/config.h"
 #include "lullaby/modules/ecs/system.h"
 #include "lullaby/systems/render/detail/display_list.h"
 #include "lullaby/systems/render/detail/render_pool_map.h"
@@ -295,6 +296,9 @@ class RenderSystemFpl : public System {
   void RenderComponentsInPass(const View* views, size_t num_views,
                               HashValue pass);
   void RenderDisplayList(const View& view, const DisplayList& display_list);
+  // Returns the value of "lull.Render.ResetState" in the Config, or true if
+  // it isn't set.
+  bool ShouldResetState();
   void RenderDisplayListMultiview(const View* views,
                                   const DisplayList& display_list);
   void SetViewUniforms(const View& view);
@@ -311,7 +315,11 @@ class RenderSystemFpl : public System {
   void UpdateUniformLocations(RenderComponent* component);
 
   void RenderDebugStats(const View* views, size_t num_views);
-  void UpdateSortOrder(Entity entity);
+  // Flags the sort orders of |entity| and its descendants to be recalculated
+  // by the next call to UpdateDirtySortOrders.
+  void MarkSortOrderDirty(Entity entity);
+  // Recalculates all sort orders flagged by MarkSortOrderDirty.
+  void UpdateDirtySortOrders();
   void OnTextureLoaded(const RenderComponent& component, int unit,
                        const TexturePtr& texture);
   bool IsReadyToRenderImpl(const RenderComponent& component) const;
@@ -325,6 +333,8 @@ class RenderSystemFpl : public System {
 
   RenderFactory* factory_;
   RenderPoolMap render_component_pools_;
+  // Reused by every pass so the list's storage is only allocated once.
+  DisplayList display_list_;
   fplbase::BlendMode blend_mode_ = fplbase::kBlendModeOff;
   int max_texture_unit_ = 0;
 
@@ -345,6 +355,11 @@ class RenderSystemFpl : public System {
   // render pass.
   bool known_state_ = false;
 
+  // Cached handle to the ResetState config value, which is read every pass.
+  // Rebound if the Config instance in the registry changes.
+  const Config* reset_state_config_ = nullptr;
+  ConfigValue<bool> reset_state_;
+
   // This lets us know if the current render call is being done for the right
   // eye instead of the left eye.
   bool rendering_right_eye_ = false;
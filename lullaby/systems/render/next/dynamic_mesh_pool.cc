@@ -0,0 +1,186 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/dynamic_mesh_pool.h"
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace {
+
+// Rounds |count| up to the next power of two so that requests with similar
+// sizes share a bucket.  A count of zero remains zero.
+size_t GetCapacityClass(size_t count) {
+  if (count == 0) {
+    return 0;
+  }
+  size_t capacity = 1;
+  while (capacity < count) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+template <typename T>
+HashValue HashCombine(HashValue basis, const T& value) {
+  return Hash(basis, reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+DataContainer WrapScratchData(uint8_t* data, size_t capacity) {
+  if (capacity == 0) {
+    return DataContainer();
+  }
+  // The pool retains ownership of the data, so use a no-op deleter.
+  return DataContainer(DataContainer::DataPtr(data, [](const uint8_t*) {}),
+                       capacity, DataContainer::kAll);
+}
+
+class FactoryBackend : public DynamicMeshPool::Backend {
+ public:
+  explicit FactoryBackend(MeshFactoryImpl* mesh_factory)
+      : mesh_factory_(mesh_factory) {}
+
+  MeshPtr CreateMesh(const DynamicMeshPool::Params& params) override {
+    return mesh_factory_->CreateDynamicMesh(
+        params.primitive_type, params.vertex_format, params.max_vertices,
+        params.index_type, params.max_indices);
+  }
+
+  void UpdateMesh(Mesh* mesh, const MeshData& data) override {
+    mesh->Update(data);
+  }
+
+ private:
+  MeshFactoryImpl* mesh_factory_;
+};
+
+}  // namespace
+
+DynamicMeshPool::DynamicMeshPool(MeshFactoryImpl* mesh_factory)
+    : DynamicMeshPool(
+          std::unique_ptr<Backend>(new FactoryBackend(mesh_factory))) {}
+
+DynamicMeshPool::DynamicMeshPool(std::unique_ptr<Backend> backend)
+    : backend_(std::move(backend)) {}
+
+HashValue DynamicMeshPool::GetKey(const Params& params) {
+  HashValue key = kHashOffsetBasis;
+  key = HashCombine(key, params.primitive_type);
+  key = HashCombine(key, params.index_type);
+  for (size_t i = 0; i < params.vertex_format.GetNumAttributes(); ++i) {
+    const VertexAttribute* attrib = params.vertex_format.GetAttributeAt(i);
+    key = HashCombine(key, attrib->usage());
+    key = HashCombine(key, attrib->type());
+  }
+  key = HashCombine(key, GetCapacityClass(params.max_vertices));
+  key = HashCombine(key, GetCapacityClass(params.max_indices));
+  key = HashCombine(key, GetCapacityClass(params.max_ranges));
+  return key;
+}
+
+DynamicMeshPool::Entry DynamicMeshPool::Acquire(HashValue key,
+                                                const Params& params) {
+  auto bucket = free_.find(key);
+  if (bucket != free_.end()) {
+    std::vector<Entry>& entries = bucket->second;
+    for (auto iter = entries.begin(); iter != entries.end(); ++iter) {
+      // Skip meshes that are still referenced elsewhere (eg. by render data
+      // that has not yet been drawn) since their contents must not change.
+      if (iter->mesh.use_count() == 1) {
+        Entry entry = std::move(*iter);
+        entries.erase(iter);
+        return entry;
+      }
+    }
+  }
+
+  Entry entry;
+  entry.key = key;
+  entry.vertex_capacity = GetCapacityClass(params.max_vertices) *
+                          params.vertex_format.GetVertexSize();
+  entry.index_capacity = GetCapacityClass(params.max_indices) *
+                         MeshData::GetIndexSize(params.index_type);
+  entry.range_capacity =
+      GetCapacityClass(params.max_ranges) * sizeof(MeshData::IndexRange);
+  entry.vertex_data.reset(new uint8_t[entry.vertex_capacity]);
+  if (entry.index_capacity > 0) {
+    entry.index_data.reset(new uint8_t[entry.index_capacity]);
+  }
+  if (entry.range_capacity > 0) {
+    entry.range_data.reset(new uint8_t[entry.range_capacity]);
+  }
+  Params capacity = params;
+  capacity.max_vertices = GetCapacityClass(params.max_vertices);
+  capacity.max_indices = GetCapacityClass(params.max_indices);
+  capacity.max_ranges = GetCapacityClass(params.max_ranges);
+  entry.mesh = backend_->CreateMesh(capacity);
+  ++num_meshes_created_;
+  return entry;
+}
+
+MeshPtr DynamicMeshPool::Update(
+    Entity entity, const Params& params,
+    const std::function<void(MeshData*)>& update_mesh) {
+  const HashValue key = GetKey(params);
+
+  // Give up the entity's mesh if it no longer satisfies |params|, or if it is
+  // still referenced elsewhere (eg. by render data that has not yet been
+  // drawn) since its contents must not change.
+  auto iter = active_.find(entity);
+  if (iter != active_.end() &&
+      (iter->second.key != key || iter->second.mesh.use_count() > 1)) {
+    free_[iter->second.key].emplace_back(std::move(iter->second));
+    active_.erase(iter);
+    iter = active_.end();
+  }
+  if (iter == active_.end()) {
+    iter = active_.emplace(entity, Acquire(key, params)).first;
+  }
+
+  Entry& entry = iter->second;
+  MeshData data(params.primitive_type, params.vertex_format,
+                WrapScratchData(entry.vertex_data.get(), entry.vertex_capacity),
+                params.index_type,
+                WrapScratchData(entry.index_data.get(), entry.index_capacity),
+                WrapScratchData(entry.range_data.get(), entry.range_capacity));
+  update_mesh(&data);
+  backend_->UpdateMesh(entry.mesh.get(), data);
+  return entry.mesh;
+}
+
+const Mesh* DynamicMeshPool::GetMesh(Entity entity) const {
+  auto iter = active_.find(entity);
+  return iter != active_.end() ? iter->second.mesh.get() : nullptr;
+}
+
+void DynamicMeshPool::Release(Entity entity) {
+  auto iter = active_.find(entity);
+  if (iter == active_.end()) {
+    return;
+  }
+  free_[iter->second.key].emplace_back(std::move(iter->second));
+  active_.erase(iter);
+}
+
+size_t DynamicMeshPool::GetNumFreeMeshes() const {
+  size_t count = 0;
+  for (const auto& bucket : free_) {
+    count += bucket.second.size();
+  }
+  return count;
+}
+
+}  // namespace lull
@@ -0,0 +1,127 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_NEXT_DYNAMIC_MESH_POOL_H_
+#define LULLABY_SYSTEMS_RENDER_NEXT_DYNAMIC_MESH_POOL_H_
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/modules/render/vertex_format.h"
+#include "lullaby/systems/render/next/mesh.h"
+#include "lullaby/systems/render/next/mesh_factory.h"
+#include "lullaby/util/entity.h"
+#include "lullaby/util/hash.h"
+
+namespace lull {
+
+// Manages a pool of dynamic Mesh objects used by
+// RenderSystem::UpdateDynamicMesh.
+//
+// Each entity is assigned a dynamic mesh that is updated in place (ie. using
+// buffer sub-updates) every time the entity's geometry changes.  Meshes are
+// bucketed by primitive type, vertex format, index type and capacity class.
+// When an entity is destroyed or requires a mesh from a different bucket, its
+// mesh is returned to the pool so that it can be reused by any other entity
+// with compatible requirements.  The same happens when the entity's mesh is
+// still referenced outside of the pool (eg. by render data that has not yet
+// been drawn), so that in-flight frames never see their geometry change.  The
+// CPU-side storage used to build the MeshData is owned by the pool as well, so
+// steady-state updates do not allocate.  All GPU work goes through a Backend
+// so that the pooling can be verified without a GL context.
+class DynamicMeshPool {
+ public:
+  // The requirements for a dynamic mesh.
+  struct Params {
+    MeshData::PrimitiveType primitive_type = MeshData::kTriangles;
+    VertexFormat vertex_format;
+    size_t max_vertices = 0;
+    size_t max_indices = 0;
+    MeshData::IndexType index_type = MeshData::kIndexU16;
+    size_t max_ranges = 0;
+  };
+
+  // Interface to the creation and updating of the GPU meshes.
+  class Backend {
+   public:
+    virtual ~Backend() {}
+
+    // Creates a dynamic mesh with room for the (rounded up) |max_vertices| and
+    // |max_indices| in |params|.
+    virtual MeshPtr CreateMesh(const Params& params) = 0;
+
+    // Uploads |data| into |mesh|.
+    virtual void UpdateMesh(Mesh* mesh, const MeshData& data) = 0;
+  };
+
+  // Creates a pool that creates its meshes using |mesh_factory|.
+  explicit DynamicMeshPool(MeshFactoryImpl* mesh_factory);
+
+  // Creates a pool that creates and updates its meshes through |backend|.
+  explicit DynamicMeshPool(std::unique_ptr<Backend> backend);
+
+  DynamicMeshPool(const DynamicMeshPool&) = delete;
+  DynamicMeshPool& operator=(const DynamicMeshPool&) = delete;
+
+  // Returns the dynamic mesh assigned to |entity| after filling it using
+  // |update_mesh|.  A mesh is taken from the pool (or created) if |entity| does
+  // not already have a mesh that satisfies |params|, or if its mesh is still
+  // referenced outside of the pool.
+  MeshPtr Update(Entity entity, const Params& params,
+                 const std::function<void(MeshData*)>& update_mesh);
+
+  // Returns the mesh assigned to |entity|, or nullptr if it has none.
+  const Mesh* GetMesh(Entity entity) const;
+
+  // Returns the mesh assigned to |entity| (if any) to the pool.
+  void Release(Entity entity);
+
+  // Returns the number of meshes created by the pool.
+  size_t GetNumMeshesCreated() const { return num_meshes_created_; }
+
+  // Returns the number of meshes in the pool that are not assigned to an
+  // entity.
+  size_t GetNumFreeMeshes() const;
+
+ private:
+  struct Entry {
+    HashValue key = 0;
+    MeshPtr mesh;
+    size_t vertex_capacity = 0;
+    size_t index_capacity = 0;
+    size_t range_capacity = 0;
+    std::unique_ptr<uint8_t[]> vertex_data;
+    std::unique_ptr<uint8_t[]> index_data;
+    std::unique_ptr<uint8_t[]> range_data;
+  };
+
+  // Returns the bucket key for the given |params|.
+  static HashValue GetKey(const Params& params);
+
+  // Returns a free entry in the bucket for |key|, or creates a new one.
+  Entry Acquire(HashValue key, const Params& params);
+
+  std::unique_ptr<Backend> backend_;
+  std::unordered_map<Entity, Entry> active_;
+  std::unordered_map<HashValue, std::vector<Entry>> free_;
+  size_t num_meshes_created_ = 0;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_NEXT_DYNAMIC_MESH_POOL_H_
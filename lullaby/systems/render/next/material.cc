@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 
 #include "lullaby/systems/render/next/detail/glplatform.h"
+#include "lullaby/systems/render/next/render_state_manager.h"
 #include "lullaby/systems/render/next/shader.h"
 #include "lullaby/systems/render/next/texture.h"
 #include "lullaby/util/logging.h"
@@ -27,6 +28,7 @@ namespace lull {
 
 Material::Material() {
   textures_.resize(MaterialTextureUsage_MAX + 1);
+  UpdateRenderStateHash();
 }
 
 void Material::SetShader(const ShaderPtr& shader) {
@@ -251,6 +253,7 @@ void Material::SetBlendState(const BlendStateT* blend_state) {
   } else {
     blend_state_.reset();
   }
+  UpdateRenderStateHash();
 }
 
 void Material::SetCullState(const CullStateT* cull_state) {
@@ -259,6 +262,7 @@ void Material::SetCullState(const CullStateT* cull_state) {
   } else {
     cull_state_.reset();
   }
+  UpdateRenderStateHash();
 }
 
 void Material::SetDepthState(const DepthStateT* depth_state) {
@@ -267,6 +271,7 @@ void Material::SetDepthState(const DepthStateT* depth_state) {
   } else {
     depth_state_.reset();
   }
+  UpdateRenderStateHash();
 }
 
 void Material::SetPointState(const PointStateT* point_state) {
@@ -275,6 +280,7 @@ void Material::SetPointState(const PointStateT* point_state) {
   } else {
     point_state_.reset();
   }
+  UpdateRenderStateHash();
 }
 
 void Material::SetStencilState(const StencilStateT* stencil_state) {
@@ -283,6 +289,31 @@ void Material::SetStencilState(const StencilStateT* stencil_state) {
   } else {
     stencil_state_.reset();
   }
+  UpdateRenderStateHash();
+}
+
+static uint64_t CombineRenderStateHash(uint64_t seed, uint64_t value) {
+  return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+}
+
+template <typename T>
+static uint64_t CombineRenderStateKey(uint64_t seed,
+                                      const Optional<T>& state) {
+  // Unset states use a value that no valid key can have.
+  const uint64_t key = state ? RenderStateManager::GetKey(*state) : ~0ull;
+  return CombineRenderStateHash(seed, key);
+}
+
+void Material::UpdateRenderStateHash() {
+  uint64_t hash = 0;
+  hash = CombineRenderStateKey(hash, blend_state_);
+  hash = CombineRenderStateKey(hash, cull_state_);
+  hash = CombineRenderStateKey(hash, depth_state_);
+  hash = CombineRenderStateKey(hash, point_state_);
+  hash = CombineRenderStateHash(
+      hash, stencil_state_ ? RenderStateManager::GetHash(*stencil_state_)
+                           : ~0ull);
+  render_state_hash_ = hash;
 }
 
 const BlendStateT* Material::GetBlendState() const {
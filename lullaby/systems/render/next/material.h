@@ -106,6 +106,11 @@ class Material {
   /// state is set.
   const StencilStateT* GetStencilState() const;
 
+  /// Returns a hash of all the render states set on the material.  Materials
+  /// with the same hash can usually be drawn one after the other without any
+  /// render state changes.
+  uint64_t GetRenderStateHash() const { return render_state_hash_; }
+
  private:
   /// Stores the data and the location binding for a single uniform instance.
   struct Uniform {
@@ -126,6 +131,9 @@ class Material {
   Optional<DepthStateT> depth_state_;
   Optional<PointStateT> point_state_;
   Optional<StencilStateT> stencil_state_;
+  uint64_t render_state_hash_ = 0;
+
+  void UpdateRenderStateHash();
 };
 
 template <typename T>
@@ -99,6 +99,108 @@ void Mesh::Init(const MeshData& mesh, const SkeletonData& skeleton) {
     bone_names_[i] = skeleton.bone_names[i].data();
   }
 
+  InvokeOnLoadCallbacks();
+}
+
+void Mesh::InitDynamic(MeshData::PrimitiveType primitive_type,
+                       const VertexFormat& vertex_format, size_t max_vertices,
+                       MeshData::IndexType index_type, size_t max_indices) {
+  if (vbo_) {
+    DLOG(FATAL) << "Can only be initialized once.";
+    return;
+  }
+
+  dynamic_ = true;
+  vertex_format_ = vertex_format;
+  primitive_type_ = primitive_type;
+  index_type_ = index_type;
+  max_vertices_ = max_vertices;
+  max_indices_ = max_indices;
+
+  const size_t vbo_size = vertex_format_.GetVertexSize() * max_vertices_;
+  GLuint gl_vbo = 0;
+  GL_CALL(glGenBuffers(1, &gl_vbo));
+  GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, gl_vbo));
+  GL_CALL(
+      glBufferData(GL_ARRAY_BUFFER, vbo_size, nullptr, GL_DYNAMIC_DRAW));
+  vbo_ = gl_vbo;
+
+  if (GlSupportsVertexArrays()) {
+    GLuint gl_vao = 0;
+    GL_CALL(glGenVertexArrays(1, &gl_vao));
+    GL_CALL(glBindVertexArray(gl_vao));
+    SetVertexAttributes(vertex_format_);
+    GL_CALL(glBindVertexArray(0));
+    vao_ = gl_vao;
+  }
+
+  if (max_indices_ > 0) {
+    const size_t ibo_size = MeshData::GetIndexSize(index_type_) * max_indices_;
+    GLuint gl_ibo = 0;
+    GL_CALL(glGenBuffers(1, &gl_ibo));
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, gl_ibo));
+    GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, ibo_size, nullptr,
+                         GL_DYNAMIC_DRAW));
+    ibo_ = gl_ibo;
+  }
+
+  GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+  GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+}
+
+void Mesh::Update(const MeshData& mesh) {
+  if (!dynamic_) {
+    LOG(DFATAL) << "Only dynamic meshes can be updated.";
+    return;
+  }
+  if (mesh.GetPrimitiveType() != primitive_type_ ||
+      mesh.GetIndexType() != index_type_ ||
+      !(mesh.GetVertexFormat() == vertex_format_)) {
+    LOG(DFATAL) << "Mesh data does not match the dynamic mesh format.";
+    return;
+  }
+  if (mesh.GetNumVertices() > max_vertices_ ||
+      mesh.GetNumIndices() > max_indices_) {
+    LOG(DFATAL) << "Mesh data exceeds the dynamic mesh capacity.";
+    return;
+  }
+
+  num_vertices_ = mesh.GetNumVertices();
+  num_indices_ = mesh.GetNumIndices();
+  aabb_ = mesh.GetAabb();
+
+  if (num_vertices_ > 0) {
+    const size_t vbo_size = vertex_format_.GetVertexSize() * num_vertices_;
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, *vbo_));
+    GL_CALL(glBufferSubData(GL_ARRAY_BUFFER, 0, vbo_size,
+                            mesh.GetVertexBytes()));
+    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, 0));
+  }
+
+  // The submesh vector is cleared rather than reallocated so that its storage
+  // is reused across updates.
+  submeshes_.clear();
+  if (num_indices_ > 0 && mesh.GetIndexBytes()) {
+    const size_t ibo_size = mesh.GetIndexSize() * num_indices_;
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, *ibo_));
+    GL_CALL(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, ibo_size,
+                            mesh.GetIndexBytes()));
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+
+    for (size_t i = 0; i < mesh.GetNumSubMeshes(); ++i) {
+      submeshes_.push_back(mesh.GetSubMesh(i));
+    }
+  }
+
+  InvokeOnLoadCallbacks();
+}
+
+bool Mesh::IsDynamic() const { return dynamic_; }
+
+void Mesh::InvokeOnLoadCallbacks() {
+  if (!IsLoaded()) {
+    return;
+  }
   for (auto& cb : on_load_callbacks_) {
     cb();
   }
@@ -48,6 +48,22 @@ class Mesh {
   void Init(const MeshData& mesh,
             const SkeletonData& skeleton = SkeletonData());
 
+  // Creates GPU buffers large enough to hold |max_vertices| vertices and
+  // |max_indices| indices without providing any data.  The contents of the
+  // mesh are specified (and can be repeatedly respecified) using Update().
+  void InitDynamic(MeshData::PrimitiveType primitive_type,
+                   const VertexFormat& vertex_format, size_t max_vertices,
+                   MeshData::IndexType index_type, size_t max_indices);
+
+  // Replaces the contents of a mesh created with InitDynamic() with |mesh| by
+  // updating the existing GPU buffers in place.  |mesh| must have the same
+  // primitive type, vertex format and index type as the dynamic mesh, and must
+  // fit within the capacity specified in InitDynamic().
+  void Update(const MeshData& mesh);
+
+  // Returns true if this mesh was created with InitDynamic().
+  bool IsDynamic() const;
+
   // Returns if this mesh has been loaded into OpenGL.
   bool IsLoaded() const;
 
@@ -85,6 +101,7 @@ class Mesh {
   void DrawElements(size_t index);
   void BindAttributes();
   void UnbindAttributes();
+  void InvokeOnLoadCallbacks();
 
   BufferHnd vbo_;
   BufferHnd vao_;
@@ -92,6 +109,9 @@ class Mesh {
   Aabb aabb_;
   size_t num_vertices_ = 0;
   size_t num_indices_ = 0;
+  size_t max_vertices_ = 0;
+  size_t max_indices_ = 0;
+  bool dynamic_ = false;
   std::vector<MeshData::IndexRange> submeshes_;
   VertexFormat vertex_format_;
   MeshData::PrimitiveType primitive_type_ = MeshData::kTriangles;
@@ -19,6 +19,7 @@ limitations under the License.
 #include "fplbase/mesh_generated.h"
 #include "lullaby/modules/file/asset.h"
 #include "lullaby/modules/file/asset_loader.h"
+#include "lullaby/systems/render/next/upload_queue.h"
 
 namespace lull {
 namespace {
@@ -333,6 +334,41 @@ class MeshAsset : public Asset {
   std::function<void(MeshAsset*)> finalizer_;
 };
 
+// The contents of a MeshAsset that are needed to initialize a Mesh.  The asset
+// is destroyed once it is finalized, so its contents are moved here when the
+// upload is deferred.
+struct LoadedMesh {
+  explicit LoadedMesh(MeshAsset* asset)
+      : mesh_data(std::move(asset->mesh_data_)),
+        bone_names(std::move(asset->bone_names_)),
+        bone_name_views(std::move(asset->bone_name_views_)),
+        parent_indices(std::move(asset->parent_indices_)),
+        inverse_bind_pose(std::move(asset->inverse_bind_pose_)),
+        shader_indices(std::move(asset->shader_indices_)) {}
+
+  // Moving |bone_names| keeps its elements in place, so |bone_name_views|
+  // still refer to them.
+  std::unique_ptr<MeshData> mesh_data;
+  std::vector<std::string> bone_names;
+  std::vector<string_view> bone_name_views;
+  std::vector<uint8_t> parent_indices;
+  std::vector<mathfu::AffineTransform> inverse_bind_pose;
+  std::vector<uint8_t> shader_indices;
+};
+
+void InitMesh(Mesh* mesh, const LoadedMesh& loaded) {
+  if (loaded.bone_names.empty()) {
+    mesh->Init(*loaded.mesh_data);
+  } else {
+    Mesh::SkeletonData skeleton;
+    skeleton.parent_indices = loaded.parent_indices;
+    skeleton.inverse_bind_pose = loaded.inverse_bind_pose;
+    skeleton.shader_indices = loaded.shader_indices;
+    skeleton.bone_names = loaded.bone_name_views;
+    mesh->Init(*loaded.mesh_data, skeleton);
+  }
+}
+
 }  // namespace
 
 MeshFactoryImpl::MeshFactoryImpl(Registry* registry)
@@ -343,19 +379,30 @@ MeshPtr MeshFactoryImpl::LoadMesh(const std::string& filename) {
 
   MeshPtr mesh = meshes_.Create(key, [&]() {
     auto mesh = std::make_shared<Mesh>();
-    auto finalizer = [mesh](MeshAsset* asset) {
-      if (asset->mesh_data_) {
-        if (asset->bone_names_.empty()) {
-          mesh->Init(*asset->mesh_data_);
-        } else {
-          Mesh::SkeletonData skeleton;
-          skeleton.parent_indices = asset->parent_indices_;
-          skeleton.inverse_bind_pose = asset->inverse_bind_pose_;
-          skeleton.shader_indices = asset->shader_indices_;
-          skeleton.bone_names = asset->bone_name_views_;
-          mesh->Init(*asset->mesh_data_, skeleton);
-        }
+    auto finalizer = [this, mesh](MeshAsset* asset) {
+      if (!asset->mesh_data_) {
+        return;
       }
+      auto loaded = std::make_shared<LoadedMesh>(asset);
+      auto* upload_queue = registry_->Get<UploadQueue>();
+      if (!upload_queue) {
+        InitMesh(mesh.get(), *loaded);
+        return;
+      }
+
+      const MeshData& mesh_data = *loaded->mesh_data;
+      const size_t num_bytes =
+          mesh_data.GetNumVertices() *
+              mesh_data.GetVertexFormat().GetVertexSize() +
+          mesh_data.GetNumIndices() * mesh_data.GetIndexSize();
+      // Only hold a weak reference so that a mesh released before its upload
+      // runs isn't uploaded at all.
+      std::weak_ptr<Mesh> weak_mesh = mesh;
+      upload_queue->Enqueue(mesh.get(), num_bytes, [weak_mesh, loaded]() {
+        if (auto mesh = weak_mesh.lock()) {
+          InitMesh(mesh.get(), *loaded);
+        }
+      });
     };
 
     auto* asset_loader = registry_->Get<AssetLoader>();
@@ -394,6 +441,15 @@ MeshPtr MeshFactoryImpl::CreateMesh(const MeshData* mesh_data) {
   return mesh;
 }
 
+MeshPtr MeshFactoryImpl::CreateDynamicMesh(
+    MeshData::PrimitiveType primitive_type, const VertexFormat& vertex_format,
+    size_t max_vertices, MeshData::IndexType index_type, size_t max_indices) {
+  MeshPtr mesh = std::make_shared<Mesh>();
+  mesh->InitDynamic(primitive_type, vertex_format, max_vertices, index_type,
+                    max_indices);
+  return mesh;
+}
+
 MeshPtr MeshFactoryImpl::CreateMesh(HashValue name, const MeshData* mesh_data) {
   return meshes_.Create(name, [&]() { return CreateMesh(mesh_data); });
 }
@@ -52,6 +52,13 @@ class MeshFactoryImpl : public MeshFactory {
   // Returns an empty mesh.
   MeshPtr EmptyMesh() override;
 
+  // Creates a dynamic mesh with room for |max_vertices| and |max_indices|.  The
+  // contents of the mesh are provided with Mesh::Update.
+  MeshPtr CreateDynamicMesh(MeshData::PrimitiveType primitive_type,
+                            const VertexFormat& vertex_format,
+                            size_t max_vertices, MeshData::IndexType index_type,
+                            size_t max_indices);
+
   // DEPRECATED. Loads the fplmesh with the given |filename|.
   MeshPtr LoadMesh(const std::string& filename);
 
@@ -0,0 +1,194 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/program_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <iterator>
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+namespace {
+
+// Magic number at the start of every entry ('LPBC' in little-endian).
+constexpr uint32_t kEntryMagic = 0x4342504c;
+// Bump whenever the layout of EntryHeader changes.
+constexpr uint32_t kEntryVersion = 1;
+
+struct EntryHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t key;
+  uint64_t driver_hash;
+  uint64_t checksum;
+  uint32_t format;
+  uint32_t size;
+};
+
+constexpr uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+constexpr uint64_t kFnvPrime = 0x100000001b3ull;
+
+// 64-bit FNV-1a.  The cache keys programs by content, so it needs more bits
+// than the 32-bit HashValue to make collisions between programs implausible.
+uint64_t Fnv1a(uint64_t hash, const void* data, size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= kFnvPrime;
+  }
+  return hash;
+}
+
+}  // namespace
+
+ProgramCache::ProgramCache(std::string directory,
+                           std::unique_ptr<Backend> backend)
+    : directory_(std::move(directory)), backend_(std::move(backend)) {}
+
+ProgramCache::Key ProgramCache::ComputeKey(Span<string_view> sources) {
+  uint64_t hash = kFnvOffsetBasis;
+  for (const string_view& source : sources) {
+    // Include the size so that moving text from one source to the next
+    // changes the key.
+    const uint64_t size = source.size();
+    hash = Fnv1a(hash, &size, sizeof(size));
+    hash = Fnv1a(hash, source.data(), source.size());
+  }
+  return hash;
+}
+
+std::string ProgramCache::GetEntryPath(Key key) const {
+  char name[32];
+  snprintf(name, sizeof(name), "%016llx.bin",
+           static_cast<unsigned long long>(key));
+  if (directory_.empty() || directory_.back() == '/') {
+    return directory_ + name;
+  }
+  return directory_ + "/" + name;
+}
+
+uint64_t ProgramCache::GetDriverHash() {
+  if (!driver_hash_valid_) {
+    const std::string driver_id = backend_->GetDriverId();
+    driver_hash_ = Fnv1a(kFnvOffsetBasis, driver_id.data(), driver_id.size());
+    driver_hash_valid_ = true;
+  }
+  return driver_hash_;
+}
+
+ProgramHnd ProgramCache::Load(Key key) {
+  const std::string path = GetEntryPath(key);
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    ++stats_.misses;
+    return ProgramHnd();
+  }
+
+  const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+  file.close();
+
+  EntryHeader header;
+  if (data.size() < sizeof(header)) {
+    LOG(WARNING) << "Truncated program cache entry: " << path;
+    Invalidate(key);
+    return ProgramHnd();
+  }
+  memcpy(&header, data.data(), sizeof(header));
+  const uint8_t* binary = data.data() + sizeof(header);
+
+  if (header.magic != kEntryMagic || header.version != kEntryVersion ||
+      header.key != key || header.size != data.size() - sizeof(header)) {
+    LOG(WARNING) << "Invalid program cache entry: " << path;
+    Invalidate(key);
+    return ProgramHnd();
+  }
+  if (header.driver_hash != GetDriverHash()) {
+    // The driver was updated since the entry was written, which is expected so
+    // isn't worth a warning.
+    Invalidate(key);
+    return ProgramHnd();
+  }
+  if (header.checksum != Fnv1a(kFnvOffsetBasis, binary, header.size)) {
+    LOG(WARNING) << "Corrupt program cache entry: " << path;
+    Invalidate(key);
+    return ProgramHnd();
+  }
+
+  const ProgramHnd program = backend_->LoadProgramBinary(
+      header.format, Span<uint8_t>(binary, header.size));
+  if (!program) {
+    LOG(WARNING) << "Driver rejected program cache entry: " << path;
+    Invalidate(key);
+    return ProgramHnd();
+  }
+
+  ++stats_.hits;
+  return program;
+}
+
+bool ProgramCache::Store(Key key, ProgramHnd program) {
+  EntryHeader header;
+  std::vector<uint8_t> binary;
+  if (!program || !backend_->GetProgramBinary(program, &header.format,
+                                              &binary) ||
+      binary.empty()) {
+    return false;
+  }
+
+  header.magic = kEntryMagic;
+  header.version = kEntryVersion;
+  header.key = key;
+  header.driver_hash = GetDriverHash();
+  header.checksum = Fnv1a(kFnvOffsetBasis, binary.data(), binary.size());
+  header.size = static_cast<uint32_t>(binary.size());
+
+  // Write to a temporary file and rename it so that a crash or a concurrent
+  // writer never leaves a partially written entry behind.
+  const std::string path = GetEntryPath(key);
+  const std::string temp_path = path + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+    if (!file) {
+      LOG(WARNING) << "Failed to write program cache entry: " << temp_path;
+      file.close();
+      remove(temp_path.c_str());
+      return false;
+    }
+  }
+  remove(path.c_str());
+  if (rename(temp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Failed to write program cache entry: " << path;
+    remove(temp_path.c_str());
+    return false;
+  }
+
+  ++stats_.stores;
+  return true;
+}
+
+void ProgramCache::Invalidate(Key key) {
+  remove(GetEntryPath(key).c_str());
+  ++stats_.invalidated;
+  ++stats_.misses;
+}
+
+}  // namespace lull
@@ -0,0 +1,120 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_NEXT_PROGRAM_CACHE_H_
+#define LULLABY_SYSTEMS_RENDER_NEXT_PROGRAM_CACHE_H_
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "lullaby/systems/render/next/render_handle.h"
+#include "lullaby/util/span.h"
+#include "lullaby/util/string_view.h"
+
+namespace lull {
+
+/// Persistent, content-addressed cache of linked shader program binaries.
+///
+/// Programs are keyed by the final (preprocessed and sanitized) source of all
+/// their stages, so any change to the shader code, its defines or its features
+/// produces a new key.  Each entry is stored in its own file in the cache
+/// directory along with the identity of the driver that produced it and a
+/// checksum of the binary.  Entries that are truncated, corrupt, created by a
+/// different driver or rejected by the driver are deleted and reported as a
+/// miss, in which case the caller is expected to compile the program from
+/// source and Store() it again.
+///
+/// All graphics API calls go through the Backend so that the cache can be used
+/// (and tested) without a GL context.
+class ProgramCache {
+ public:
+  using Key = uint64_t;
+
+  /// Interface to the graphics API used to save and restore program binaries.
+  class Backend {
+   public:
+    virtual ~Backend() {}
+
+    /// Returns a string identifying the driver, eg. its vendor, renderer and
+    /// version.  Binaries are only reused with the driver that created them.
+    virtual std::string GetDriverId() = 0;
+
+    /// Retrieves the binary and its driver-specific |format| for the linked
+    /// |program|.  Returns false if the binary is not available.
+    virtual bool GetProgramBinary(ProgramHnd program, uint32_t* format,
+                                  std::vector<uint8_t>* binary) = 0;
+
+    /// Creates a program from a binary previously returned by
+    /// GetProgramBinary().  Returns an invalid handle if the driver rejects the
+    /// binary.
+    virtual ProgramHnd LoadProgramBinary(uint32_t format,
+                                         Span<uint8_t> binary) = 0;
+  };
+
+  /// Usage information since the cache was created.
+  struct Stats {
+    /// Number of programs loaded from the cache.
+    size_t hits = 0;
+    /// Number of lookups for which no usable entry existed.
+    size_t misses = 0;
+    /// Number of entries that existed but were deleted because they were
+    /// corrupt, stale or rejected by the driver.  These are also misses.
+    size_t invalidated = 0;
+    /// Number of programs written to the cache.
+    size_t stores = 0;
+  };
+
+  /// Creates a cache that stores its entries in the existing, writable
+  /// |directory|.
+  ProgramCache(std::string directory, std::unique_ptr<Backend> backend);
+
+  ProgramCache(const ProgramCache&) = delete;
+  ProgramCache& operator=(const ProgramCache&) = delete;
+
+  /// Returns the key for a program built from the given stage |sources|.  Any
+  /// other state that affects linking, such as attribute bindings, should be
+  /// passed as an additional source.
+  static Key ComputeKey(Span<string_view> sources);
+
+  /// Returns the program created from the entry for |key|, or an invalid
+  /// handle if there is no valid entry.
+  ProgramHnd Load(Key key);
+
+  /// Writes the binary of the linked |program| to the entry for |key|.
+  /// Returns false if the binary could not be retrieved or written.
+  bool Store(Key key, ProgramHnd program);
+
+  /// Returns the path of the file that holds the entry for |key|.
+  std::string GetEntryPath(Key key) const;
+
+  const Stats& GetStats() const { return stats_; }
+
+ private:
+  uint64_t GetDriverHash();
+  void Invalidate(Key key);
+
+  const std::string directory_;
+  std::unique_ptr<Backend> backend_;
+  uint64_t driver_hash_ = 0;
+  bool driver_hash_valid_ = false;
+  Stats stats_;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_RENDER_NEXT_PROGRAM_CACHE_H_
@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/systems/render/next/render_state_manager.h"
 
+#include <string.h>
+
 #include "lullaby/systems/render/next/detail/glplatform.h"
 
 namespace lull {
@@ -179,7 +181,161 @@ static GLenum GetGlStencilAction(StencilAction action) {
   }
 }
 
-void RenderStateManager::Reset() { state_ = RenderStateT(); }
+namespace {
+
+// The value of keys for sub-states whose GL state is unknown.
+constexpr uint64_t kUnknownKey = ~0ull;
+
+static GLenum GetGlCapability(RenderStateManager::Capability capability) {
+  switch (capability) {
+#ifndef FPLBASE_GLES  // Alpha test not supported in ES 2.
+    case RenderStateManager::kAlphaTest:
+      return GL_ALPHA_TEST;
+#endif
+    case RenderStateManager::kBlend:
+      return GL_BLEND;
+    case RenderStateManager::kCullFace:
+      return GL_CULL_FACE;
+    case RenderStateManager::kDepthTest:
+      return GL_DEPTH_TEST;
+#if !defined(FPLBASE_GLES) && defined(GL_POINT_SPRITE)
+    case RenderStateManager::kPointSprite:
+      return GL_POINT_SPRITE;
+#endif
+#if !defined(FPLBASE_GLES) && defined(GL_PROGRAM_POINT_SIZE)
+    case RenderStateManager::kProgramPointSize:
+      return GL_PROGRAM_POINT_SIZE;
+#elif !defined(FPLBASE_GLES) && defined(GL_VERTEX_PROGRAM_POINT_SIZE)
+    case RenderStateManager::kProgramPointSize:
+      return GL_VERTEX_PROGRAM_POINT_SIZE;
+#endif
+    case RenderStateManager::kScissorTest:
+      return GL_SCISSOR_TEST;
+    case RenderStateManager::kStencilTest:
+      return GL_STENCIL_TEST;
+    default:
+      // Not supported by this GL version.
+      return 0;
+  }
+}
+
+static GLenum GetGlFace(RenderStateManager::Face face) {
+  return face == RenderStateManager::kFront ? GL_FRONT : GL_BACK;
+}
+
+static void CheckDepthBuffer() {
+#if !defined(NDEBUG) && !defined(__ANDROID__)
+  static bool check_once = false;
+  if (!check_once) {
+    // GL_DEPTH_BITS was deprecated in desktop GL 3.3, so make sure this get
+    // succeeds before checking depth_bits.
+    GLint depth_bits = 0;
+    glGetIntegerv(GL_DEPTH_BITS, &depth_bits);
+    if (glGetError() == 0 && depth_bits == 0) {
+      LOG(WARNING) << "Enabling depth test without a depth buffer; this has "
+                      "known issues on some platforms.";
+    }
+    check_once = true;
+  }
+#endif  // !NDEBUG
+}
+
+// Makes the GL calls for state changes.
+class GlBackend : public RenderStateManager::Backend {
+ public:
+  void SetEnabled(RenderStateManager::Capability capability,
+                  bool enabled) override {
+    const GLenum gl_capability = GetGlCapability(capability);
+    if (gl_capability == 0) {
+      return;
+    }
+    if (capability == RenderStateManager::kDepthTest) {
+      CheckDepthBuffer();
+    }
+    if (enabled) {
+      GL_CALL(glEnable(gl_capability));
+    } else {
+      GL_CALL(glDisable(gl_capability));
+    }
+  }
+
+  void SetAlphaFunc(RenderFunction function, float ref) override {
+#ifndef FPLBASE_GLES  // Alpha test not supported in ES 2.
+    GL_CALL(glAlphaFunc(GetGlRenderFunction(function), ref));
+#endif
+  }
+
+  void SetBlendFunc(BlendFactor src_color, BlendFactor dst_color,
+                    BlendFactor src_alpha, BlendFactor dst_alpha) override {
+    GL_CALL(glBlendFuncSeparate(
+        GetGlBlendFactor(src_color), GetGlBlendFactor(dst_color),
+        GetGlBlendFactor(src_alpha), GetGlBlendFactor(dst_alpha)));
+  }
+
+  void SetColorMask(bool red, bool green, bool blue, bool alpha) override {
+    GL_CALL(glColorMask(red ? GL_TRUE : GL_FALSE, green ? GL_TRUE : GL_FALSE,
+                        blue ? GL_TRUE : GL_FALSE,
+                        alpha ? GL_TRUE : GL_FALSE));
+  }
+
+  void SetCullFace(CullFace face) override {
+    GL_CALL(glCullFace(GetGlCullFace(face)));
+  }
+
+  void SetFrontFace(FrontFace face) override {
+    GL_CALL(glFrontFace(GetGlFrontFace(face)));
+  }
+
+  void SetDepthMask(bool enabled) override {
+    GL_CALL(glDepthMask(enabled ? GL_TRUE : GL_FALSE));
+  }
+
+  void SetDepthFunc(RenderFunction function) override {
+    GL_CALL(glDepthFunc(GetGlRenderFunction(function)));
+  }
+
+  void SetPointSize(float size) override {
+#if !defined(FPLBASE_GLES)
+    GL_CALL(glPointSize(size));
+#endif
+  }
+
+  void SetStencilFunc(RenderStateManager::Face face,
+                      const StencilFunctionT& function) override {
+    GL_CALL(glStencilFuncSeparate(GetGlFace(face),
+                                  GetGlRenderFunction(function.function),
+                                  function.ref, function.mask));
+  }
+
+  void SetStencilOp(RenderStateManager::Face face,
+                    const StencilOperationT& op) override {
+    GL_CALL(glStencilOpSeparate(GetGlFace(face),
+                                GetGlStencilAction(op.stencil_fail),
+                                GetGlStencilAction(op.depth_fail),
+                                GetGlStencilAction(op.pass)));
+  }
+
+  void SetViewport(const mathfu::recti& rect) override {
+    GL_CALL(glViewport(rect.pos.x, rect.pos.y, rect.size.x, rect.size.y));
+  }
+};
+
+}  // namespace
+
+RenderStateManager::RenderStateManager()
+    : RenderStateManager(std::unique_ptr<Backend>(new GlBackend())) {}
+
+RenderStateManager::RenderStateManager(std::unique_ptr<Backend> backend)
+    : backend_(std::move(backend)) {
+  Reset();
+}
+
+void RenderStateManager::Reset() {
+  state_ = RenderStateT();
+  for (uint64_t& key : keys_) {
+    key = kUnknownKey;
+  }
+}
 
 static bool ValidateAlphaTestState(const AlphaTestStateT& state) {
   bool ok = true;
@@ -361,365 +517,262 @@ void RenderStateManager::SetRenderState(const RenderStateT& state) {
   }
 }
 
-static void SetGlAlphaTestEnabled(const AlphaTestStateT& state) {
-#ifndef FPLBASE_GLES  // Alpha test not supported in ES 2.
-  if (state.enabled) {
-    GL_CALL(glEnable(GL_ALPHA_TEST));
-  } else {
-    GL_CALL(glDisable(GL_ALPHA_TEST));
+bool RenderStateManager::UpdateKey(KeyIndex index, uint64_t key) {
+  if (keys_[index] == key) {
+    ++stats_.num_redundant_states;
+    return true;
   }
-#endif
+  keys_[index] = key;
+  return false;
 }
 
-static void SetGlAlphaFunc(const AlphaTestStateT& state) {
-#ifndef FPLBASE_GLES  // Alpha test not supported in ES 2.
-  const GLenum func = GetGlRenderFunction(state.function);
-  GL_CALL(glAlphaFunc(func, state.ref));
-#endif
+RenderStateManager::Backend* RenderStateManager::Change() {
+  ++stats_.num_state_changes;
+  return backend_.get();
 }
 
 void RenderStateManager::SetAlphaTestState(const AlphaTestStateT& state) {
-  bool update = false;
-
-  if (!state_.alpha_test_state ||
-      state.enabled != state_.alpha_test_state->enabled) {
-    SetGlAlphaTestEnabled(state);
-    update = true;
+  if (UpdateKey(kAlphaTestKey, GetKey(state))) {
+    return;
   }
 
-  if (!state_.alpha_test_state || state.ref != state_.alpha_test_state->ref ||
-      state.function != state_.alpha_test_state->function) {
-    SetGlAlphaFunc(state);
-    update = true;
+  const AlphaTestStateT* current = state_.alpha_test_state.get();
+  if (!current || state.enabled != current->enabled) {
+    Change()->SetEnabled(kAlphaTest, state.enabled);
   }
-
-  if (update) {
-    state_.alpha_test_state = state;
-  }
-}
-
-static void SetGlBlendEnabled(const BlendStateT& state) {
-  if (state.enabled) {
-    GL_CALL(glEnable(GL_BLEND));
-  } else {
-    GL_CALL(glDisable(GL_BLEND));
+  if (!current || state.ref != current->ref ||
+      state.function != current->function) {
+    Change()->SetAlphaFunc(state.function, state.ref);
   }
-}
-
-static void SetGlBlendFunc(const BlendStateT& state) {
-  const GLenum src_factor = GetGlBlendFactor(state.src_alpha);
-  const GLenum dst_factor = GetGlBlendFactor(state.dst_alpha);
-  GL_CALL(glBlendFunc(src_factor, dst_factor));
+  state_.alpha_test_state = state;
 }
 
 void RenderStateManager::SetBlendState(const BlendStateT& state) {
-  bool update = false;
-
-  if (!state_.blend_state || state.enabled != state_.blend_state->enabled) {
-    SetGlBlendEnabled(state);
-    update = true;
+  if (UpdateKey(kBlendKey, GetKey(state))) {
+    return;
   }
 
-  if (!state_.blend_state || state.src_alpha != state_.blend_state->src_alpha ||
-      state.src_color != state_.blend_state->src_color ||
-      state.dst_alpha != state_.blend_state->dst_alpha ||
-      state.dst_color != state_.blend_state->dst_color) {
-    SetGlBlendFunc(state);
-    update = true;
+  const BlendStateT* current = state_.blend_state.get();
+  if (!current || state.enabled != current->enabled) {
+    Change()->SetEnabled(kBlend, state.enabled);
   }
-
-  if (update) {
-    state_.blend_state = state;
+  if (!current || state.src_alpha != current->src_alpha ||
+      state.src_color != current->src_color ||
+      state.dst_alpha != current->dst_alpha ||
+      state.dst_color != current->dst_color) {
+    Change()->SetBlendFunc(state.src_color, state.dst_color, state.src_alpha,
+                           state.dst_alpha);
   }
-}
-
-static void SetGlColorMask(const ColorStateT& state) {
-  const GLboolean r = state.write_red ? GL_TRUE : GL_FALSE;
-  const GLboolean g = state.write_green ? GL_TRUE : GL_FALSE;
-  const GLboolean b = state.write_blue ? GL_TRUE : GL_FALSE;
-  const GLboolean a = state.write_alpha ? GL_TRUE : GL_FALSE;
-  GL_CALL(glColorMask(r, g, b, a));
+  state_.blend_state = state;
 }
 
 void RenderStateManager::SetColorState(const ColorStateT& state) {
-  bool update = false;
-
-  if (!state_.color_state || state.write_red != state_.color_state->write_red ||
-      state.write_green != state_.color_state->write_green ||
-      state.write_blue != state_.color_state->write_blue ||
-      state.write_alpha != state_.color_state->write_alpha) {
-    SetGlColorMask(state);
-    update = true;
-  }
-
-  if (update) {
-    state_.color_state = state;
-  }
-}
-
-static void SetGlCullEnabled(const CullStateT& state) {
-  if (state.enabled) {
-    GL_CALL(glEnable(GL_CULL_FACE));
-  } else {
-    GL_CALL(glDisable(GL_CULL_FACE));
+  if (UpdateKey(kColorKey, GetKey(state))) {
+    return;
   }
-}
-
-static void SetGlCullFace(const CullStateT& state) {
-  const GLenum cull_face = GetGlCullFace(state.face);
-  GL_CALL(glCullFace(cull_face));
-}
 
-static void SetGlFrontFace(const CullStateT& state) {
-  GL_CALL(glFrontFace(GetGlFrontFace(state.front)));
+  Change()->SetColorMask(state.write_red, state.write_green, state.write_blue,
+                         state.write_alpha);
+  state_.color_state = state;
 }
 
 void RenderStateManager::SetCullState(const CullStateT& state) {
-  bool update = false;
-
-  if (!state_.cull_state || state.enabled != state_.cull_state->enabled) {
-    SetGlCullEnabled(state);
-    update = true;
+  if (UpdateKey(kCullKey, GetKey(state))) {
+    return;
   }
 
-  if (!state_.cull_state || state.face != state_.cull_state->face) {
-    SetGlCullFace(state);
-    update = true;
+  const CullStateT* current = state_.cull_state.get();
+  if (!current || state.enabled != current->enabled) {
+    Change()->SetEnabled(kCullFace, state.enabled);
   }
-
-  if (!state_.cull_state || state.front != state_.cull_state->front) {
-    SetGlFrontFace(state);
-    update = true;
+  if (!current || state.face != current->face) {
+    Change()->SetCullFace(state.face);
   }
-
-  if (update) {
-    state_.cull_state = state;
+  if (!current || state.front != current->front) {
+    Change()->SetFrontFace(state.front);
   }
+  state_.cull_state = state;
 }
 
-static void SetGlDepthTestEnabled(const DepthStateT& state) {
-#if !defined(NDEBUG) && !defined(__ANDROID__)
-  static bool check_once = false;
-  if (!check_once) {
-    // GL_DEPTH_BITS was deprecated in desktop GL 3.3, so make sure this get
-    // succeeds before checking depth_bits.
-    GLint depth_bits = 0;
-    glGetIntegerv(GL_DEPTH_BITS, &depth_bits);
-    if (glGetError() == 0 && depth_bits == 0) {
-      LOG(WARNING) << "Enabling depth test without a depth buffer; this has "
-                      "known issues on some platforms.";
-    }
-    check_once = true;
+void RenderStateManager::SetDepthState(const DepthStateT& state) {
+  if (UpdateKey(kDepthKey, GetKey(state))) {
+    return;
   }
-#endif  // !NDEBUG
 
-  if (state.test_enabled) {
-    GL_CALL(glEnable(GL_DEPTH_TEST));
-  } else {
-    GL_CALL(glDisable(GL_DEPTH_TEST));
+  const DepthStateT* current = state_.depth_state.get();
+  if (!current || state.test_enabled != current->test_enabled) {
+    Change()->SetEnabled(kDepthTest, state.test_enabled);
   }
+  if (!current || state.write_enabled != current->write_enabled) {
+    Change()->SetDepthMask(state.write_enabled);
+  }
+  if (!current || state.function != current->function) {
+    Change()->SetDepthFunc(state.function);
+  }
+  state_.depth_state = state;
 }
 
-static void SetGlDepthWriteEnabled(const DepthStateT& state) {
-  GL_CALL(glDepthMask(state.write_enabled ? GL_TRUE : GL_FALSE));
-}
-
-static void SetGlDepthFunction(const DepthStateT& state) {
-  const GLenum func = GetGlRenderFunction(state.function);
-  GL_CALL(glDepthFunc(func));
-}
-
-void RenderStateManager::SetDepthState(const DepthStateT& state) {
-  bool update = false;
-
-  if (!state_.depth_state ||
-      state.test_enabled != state_.depth_state->test_enabled) {
-    SetGlDepthTestEnabled(state);
-    update = true;
+void RenderStateManager::SetPointState(const PointStateT& state) {
+  if (UpdateKey(kPointKey, GetKey(state))) {
+    return;
   }
 
-  if (!state_.depth_state ||
-      state.write_enabled != state_.depth_state->write_enabled) {
-    SetGlDepthWriteEnabled(state);
-    update = true;
+  const PointStateT* current = state_.point_state.get();
+  if (!current ||
+      state.point_sprite_enabled != current->point_sprite_enabled) {
+    Change()->SetEnabled(kPointSprite, state.point_sprite_enabled);
   }
-
-  if (!state_.depth_state || state.function != state_.depth_state->function) {
-    SetGlDepthFunction(state);
-    update = true;
+  if (!current || state.program_point_size_enabled !=
+                      current->program_point_size_enabled) {
+    Change()->SetEnabled(kProgramPointSize, state.program_point_size_enabled);
   }
-
-  if (update) {
-    state_.depth_state = state;
+  if (state.point_size > 0 &&
+      (!current || state.point_size != current->point_size)) {
+    Change()->SetPointSize(state.point_size);
   }
+  state_.point_state = state;
 }
 
-static void SetGlPointSpriteEnabled(const PointStateT& state) {
-#if !defined(FPLBASE_GLES) && defined(GL_POINT_SPRITE)
-  if (state.point_sprite_enabled) {
-    GL_CALL(glEnable(GL_POINT_SPRITE));
-  } else {
-    GL_CALL(glDisable(GL_POINT_SPRITE));
+void RenderStateManager::SetScissorState(const ScissorStateT& state) {
+  if (UpdateKey(kScissorKey, GetKey(state))) {
+    return;
   }
-#endif
+
+  Change()->SetEnabled(kScissorTest, state.enabled);
+  state_.scissor_state = state;
 }
 
-static void SetGlPointSizeEnabled(const PointStateT& state) {
-#if !defined(FPLBASE_GLES) && defined(GL_PROGRAM_POINT_SIZE)
-  if (state.program_point_size_enabled) {
-    GL_CALL(glEnable(GL_PROGRAM_POINT_SIZE));
-  } else {
-    GL_CALL(glDisable(GL_PROGRAM_POINT_SIZE));
-  }
-#elif !defined(FPLBASE_GLES) && defined(GL_VERTEX_PROGRAM_POINT_SIZE)
-  if (state.program_point_size_enabled) {
-    GL_CALL(glEnable(GL_VERTEX_PROGRAM_POINT_SIZE));
-  } else {
-    GL_CALL(glDisable(GL_VERTEX_PROGRAM_POINT_SIZE));
-  }
-#endif
+static bool operator!=(const StencilFunctionT& lhs,
+                       const StencilFunctionT& rhs) {
+  return lhs.function != rhs.function || lhs.mask != rhs.mask ||
+         lhs.ref != rhs.ref;
 }
 
-void SetGlPointSize(const PointStateT& state) {
-#if !defined(FPLBASE_GLES)
-  if (state.point_size > 0) {
-    GL_CALL(glPointSize(state.point_size));
-  }
-#endif
+static bool operator!=(const StencilOperationT& lhs,
+                       const StencilOperationT& rhs) {
+  return lhs.depth_fail != rhs.depth_fail ||
+         lhs.stencil_fail != rhs.stencil_fail || lhs.pass != rhs.pass;
 }
 
-void RenderStateManager::SetPointState(const PointStateT& state) {
+void RenderStateManager::SetStencilState(const StencilStateT& state) {
+  const StencilStateT* current = state_.stencil_state.get();
   bool update = false;
 
-  if (!state_.point_state ||
-      state.point_sprite_enabled != state_.point_state->point_sprite_enabled) {
-    SetGlPointSpriteEnabled(state);
+  if (!current || state.enabled != current->enabled) {
+    Change()->SetEnabled(kStencilTest, state.enabled);
     update = true;
   }
-
-  if (!state_.point_state ||
-      state.program_point_size_enabled !=
-          state_.point_state->program_point_size_enabled) {
-    SetGlPointSizeEnabled(state);
+  if (!current || state.back_function != current->back_function) {
+    Change()->SetStencilFunc(kBack, state.back_function);
     update = true;
   }
-
-  if (!state_.point_state ||
-      state.point_size != state_.point_state->point_size) {
-    SetGlPointSize(state);
+  if (!current || state.front_function != current->front_function) {
+    Change()->SetStencilFunc(kFront, state.front_function);
     update = true;
   }
-
-  if (update) {
-    state_.point_state = state;
-  }
-}
-
-static void SetGlScissorEnabled(const ScissorStateT& state) {
-  if (state.enabled) {
-    GL_CALL(glEnable(GL_SCISSOR_TEST));
-  } else {
-    GL_CALL(glDisable(GL_SCISSOR_TEST));
+  if (!current || state.front_op != current->front_op) {
+    Change()->SetStencilOp(kFront, state.front_op);
+    update = true;
   }
-}
-
-void RenderStateManager::SetScissorState(const ScissorStateT& state) {
-  bool update = false;
-
-  if (!state_.scissor_state || state.enabled != state_.scissor_state->enabled) {
-    SetGlScissorEnabled(state);
+  if (!current || state.back_op != current->back_op) {
+    Change()->SetStencilOp(kBack, state.back_op);
     update = true;
   }
 
   if (update) {
-    state_.scissor_state = state;
+    state_.stencil_state = state;
+  } else {
+    ++stats_.num_redundant_states;
   }
 }
 
-static void SetGlStencilTestEnabled(const StencilStateT& state) {
-  if (state.enabled) {
-    GL_CALL(glEnable(GL_STENCIL_TEST));
-  } else {
-    GL_CALL(glDisable(GL_STENCIL_TEST));
+void RenderStateManager::SetViewport(const mathfu::recti& rect) {
+  if (state_.viewport && rect == state_.viewport.value()) {
+    ++stats_.num_redundant_states;
+    return;
+  }
+  if (rect.size.x <= 0 || rect.size.y <= 0) {
+    return;
   }
+  Change()->SetViewport(rect);
+  state_.viewport = rect;
 }
 
-bool operator!=(const StencilFunctionT& lhs, const StencilFunctionT& rhs) {
-  return lhs.function != rhs.function || lhs.mask != rhs.mask ||
-         lhs.ref != rhs.ref;
+static uint64_t FloatBits(float value) {
+  uint32_t bits = 0;
+  memcpy(&bits, &value, sizeof(bits));
+  return bits;
 }
 
-bool operator!=(const StencilOperationT& lhs, const StencilOperationT& rhs) {
-  return lhs.depth_fail != rhs.depth_fail ||
-         lhs.stencil_fail != rhs.stencil_fail || lhs.pass != rhs.pass;
+// Each key packs the enabled flag into the lowest bit, followed by the other
+// fields.  Enums have fewer than 256 values, so each is given 8 bits.  No key
+// uses the highest bit, so kUnknownKey never matches a valid state.
+uint64_t RenderStateManager::GetKey(const AlphaTestStateT& state) {
+  return static_cast<uint64_t>(state.enabled) |
+         (static_cast<uint64_t>(state.function) << 1) |
+         (FloatBits(state.ref) << 9);
 }
 
-static void SetGlStencilFunction(GLenum face, const StencilFunctionT& func) {
-  const GLenum gl_func = GetGlRenderFunction(func.function);
-  GL_CALL(glStencilFuncSeparate(face, gl_func, func.ref, func.mask));
+uint64_t RenderStateManager::GetKey(const BlendStateT& state) {
+  return static_cast<uint64_t>(state.enabled) |
+         (static_cast<uint64_t>(state.src_alpha) << 1) |
+         (static_cast<uint64_t>(state.src_color) << 9) |
+         (static_cast<uint64_t>(state.dst_alpha) << 17) |
+         (static_cast<uint64_t>(state.dst_color) << 25);
 }
 
-static void SetGlStencilOperation(GLenum face, const StencilOperationT& op) {
-  const GLenum stencil_fail = GetGlStencilAction(op.stencil_fail);
-  const GLenum depth_fail = GetGlStencilAction(op.depth_fail);
-  const GLenum pass = GetGlStencilAction(op.pass);
-  GL_CALL(glStencilOpSeparate(face, stencil_fail, depth_fail, pass));
+uint64_t RenderStateManager::GetKey(const ColorStateT& state) {
+  return static_cast<uint64_t>(state.write_red) |
+         (static_cast<uint64_t>(state.write_green) << 1) |
+         (static_cast<uint64_t>(state.write_blue) << 2) |
+         (static_cast<uint64_t>(state.write_alpha) << 3);
 }
 
-void RenderStateManager::SetStencilState(const StencilStateT& state) {
-  bool update = false;
-
-  if (!state_.stencil_state || state.enabled != state_.stencil_state->enabled) {
-    SetGlStencilTestEnabled(state);
-    update = true;
-  }
-
-  if (!state_.stencil_state ||
-      state.back_function != state_.stencil_state->back_function) {
-    SetGlStencilFunction(GL_BACK, state.back_function);
-    update = true;
-  }
-
-  if (!state_.stencil_state ||
-      state.front_function != state_.stencil_state->front_function) {
-    SetGlStencilFunction(GL_FRONT, state.front_function);
-    update = true;
-  }
+uint64_t RenderStateManager::GetKey(const CullStateT& state) {
+  return static_cast<uint64_t>(state.enabled) |
+         (static_cast<uint64_t>(state.face) << 1) |
+         (static_cast<uint64_t>(state.front) << 9);
+}
 
-  if (!state_.stencil_state ||
-      state.front_op != state_.stencil_state->front_op) {
-    SetGlStencilOperation(GL_FRONT, state.front_op);
-    update = true;
-  }
+uint64_t RenderStateManager::GetKey(const DepthStateT& state) {
+  return static_cast<uint64_t>(state.test_enabled) |
+         (static_cast<uint64_t>(state.write_enabled) << 1) |
+         (static_cast<uint64_t>(state.function) << 2);
+}
 
-  if (!state_.stencil_state || state.back_op != state_.stencil_state->back_op) {
-    SetGlStencilOperation(GL_FRONT, state.back_op);
-    update = true;
-  }
+uint64_t RenderStateManager::GetKey(const PointStateT& state) {
+  return static_cast<uint64_t>(state.point_sprite_enabled) |
+         (static_cast<uint64_t>(state.program_point_size_enabled) << 1) |
+         (FloatBits(state.point_size) << 2);
+}
 
-  if (update) {
-    state_.stencil_state = state;
-  }
+uint64_t RenderStateManager::GetKey(const ScissorStateT& state) {
+  return static_cast<uint64_t>(state.enabled);
 }
 
-static void SetGlViewport(const mathfu::recti& rect) {
-  GL_CALL(glViewport(rect.pos.x, rect.pos.y, rect.size.x, rect.size.y));
+static uint64_t HashCombine(uint64_t seed, uint64_t value) {
+  // Same mixing step as boost::hash_combine, widened to 64 bits.
+  return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
 }
 
-void RenderStateManager::SetViewport(const mathfu::recti& rect) {
-  bool update = false;
+static uint64_t GetHash(uint64_t seed, const StencilFunctionT& function) {
+  seed = HashCombine(seed, static_cast<uint64_t>(function.function));
+  seed = HashCombine(seed, static_cast<uint32_t>(function.ref));
+  return HashCombine(seed, function.mask);
+}
 
-  if (!state_.viewport || rect != state_.viewport.value()) {
-    if (rect.size.x <= 0 || rect.size.y <= 0) {
-      return;
-    }
-    SetGlViewport(rect);
-    update = true;
-  }
+static uint64_t GetHash(uint64_t seed, const StencilOperationT& op) {
+  seed = HashCombine(seed, static_cast<uint64_t>(op.stencil_fail));
+  seed = HashCombine(seed, static_cast<uint64_t>(op.depth_fail));
+  return HashCombine(seed, static_cast<uint64_t>(op.pass));
+}
 
-  if (update) {
-    state_.viewport = rect;
-  }
+uint64_t RenderStateManager::GetHash(const StencilStateT& state) {
+  uint64_t hash = static_cast<uint64_t>(state.enabled);
+  hash = lull::GetHash(hash, state.back_function);
+  hash = lull::GetHash(hash, state.back_op);
+  hash = lull::GetHash(hash, state.front_function);
+  return lull::GetHash(hash, state.front_op);
 }
 
 }  // namespace lull
@@ -17,6 +17,10 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_RENDER_NEXT_RENDER_STATE_MANAGER_H_
 #define LULLABY_SYSTEMS_RENDER_NEXT_RENDER_STATE_MANAGER_H_
 
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+
 #include "lullaby/generated/render_state_def_generated.h"
 
 namespace lull {
@@ -26,9 +30,66 @@ namespace lull {
 /// This class uses a RenderStateT instance to reflect any changes made to the
 /// underlying GL hardware state.  The internally cached RenderState may have
 /// NullOpt values which indicates that the actual hardware state is unknown.
+///
+/// Each sub-state is also tracked as a packed 64-bit key (see GetKey()) so that
+/// setting a state identical to the current one costs a single comparison.
+/// Otherwise, only the GL calls for the parts of the sub-state that actually
+/// differ are made.  All GL calls go through a Backend so that the exact calls
+/// can be verified without a GL context.
 class RenderStateManager {
  public:
-  RenderStateManager() {}
+  /// GL capabilities that are toggled with glEnable/glDisable.
+  enum Capability {
+    kAlphaTest,
+    kBlend,
+    kCullFace,
+    kDepthTest,
+    kPointSprite,
+    kProgramPointSize,
+    kScissorTest,
+    kStencilTest,
+  };
+
+  /// Polygon faces that have separate stencil state.
+  enum Face {
+    kFront,
+    kBack,
+  };
+
+  /// Interface to the GL calls that change the render state.
+  class Backend {
+   public:
+    virtual ~Backend() {}
+
+    virtual void SetEnabled(Capability capability, bool enabled) = 0;
+    virtual void SetAlphaFunc(RenderFunction function, float ref) = 0;
+    virtual void SetBlendFunc(BlendFactor src_color, BlendFactor dst_color,
+                              BlendFactor src_alpha, BlendFactor dst_alpha) = 0;
+    virtual void SetColorMask(bool red, bool green, bool blue, bool alpha) = 0;
+    virtual void SetCullFace(CullFace face) = 0;
+    virtual void SetFrontFace(FrontFace face) = 0;
+    virtual void SetDepthMask(bool enabled) = 0;
+    virtual void SetDepthFunc(RenderFunction function) = 0;
+    virtual void SetPointSize(float size) = 0;
+    virtual void SetStencilFunc(Face face, const StencilFunctionT& function) = 0;
+    virtual void SetStencilOp(Face face, const StencilOperationT& op) = 0;
+    virtual void SetViewport(const mathfu::recti& rect) = 0;
+  };
+
+  /// Counts of the work done since the last call to ResetStats().
+  struct Stats {
+    /// Number of GL calls made to change the render state.
+    size_t num_state_changes = 0;
+    /// Number of sub-states that were set but matched the current state, so
+    /// required no GL calls.
+    size_t num_redundant_states = 0;
+  };
+
+  /// Creates a manager that makes GL calls directly.
+  RenderStateManager();
+
+  /// Creates a manager that makes all state changes through |backend|.
+  explicit RenderStateManager(std::unique_ptr<Backend> backend);
 
   RenderStateManager(const RenderStateManager&) = delete;
   RenderStateManager& operator=(const RenderStateManager&) = delete;
@@ -76,8 +137,49 @@ class RenderStateManager {
   /// Sets the viewport state.
   void SetViewport(const mathfu::recti& rect);
 
+  /// Returns the counts of state changes since the last call to ResetStats().
+  const Stats& GetStats() const { return stats_; }
+
+  /// Resets the state change counts, eg. at the start of a frame.
+  void ResetStats() { stats_ = Stats(); }
+
+  /// Returns a key that packs all the fields of |state|.  Two states have the
+  /// same key if and only if they result in the same GL state.
+  static uint64_t GetKey(const AlphaTestStateT& state);
+  static uint64_t GetKey(const BlendStateT& state);
+  static uint64_t GetKey(const ColorStateT& state);
+  static uint64_t GetKey(const CullStateT& state);
+  static uint64_t GetKey(const DepthStateT& state);
+  static uint64_t GetKey(const PointStateT& state);
+  static uint64_t GetKey(const ScissorStateT& state);
+
+  /// Returns a hash of the stencil |state|, which has too many fields to pack
+  /// into a key.  Unlike keys, different states may have the same hash.
+  static uint64_t GetHash(const StencilStateT& state);
+
  private:
+  enum KeyIndex {
+    kAlphaTestKey,
+    kBlendKey,
+    kColorKey,
+    kCullKey,
+    kDepthKey,
+    kPointKey,
+    kScissorKey,
+    kNumKeys,
+  };
+
+  // Returns true (and counts a redundant state) if |key| matches the current
+  // key at |index|.  Otherwise, stores the new |key| and returns false.
+  bool UpdateKey(KeyIndex index, uint64_t key);
+
+  // Counts a state change and returns the backend to make it with.
+  Backend* Change();
+
+  std::unique_ptr<Backend> backend_;
   RenderStateT state_;
+  uint64_t keys_[kNumKeys];
+  Stats stats_;
 };
 
 }  // namespace lull
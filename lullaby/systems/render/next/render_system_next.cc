@@ -20,6 +20,7 @@ limitations under the License.
 #include <stdio.h>
 #include <algorithm>
 #include <cctype>
+#include <functional>
 #include <memory>
 
 #include "fplbase/gpu_debug.h"
@@ -249,6 +250,7 @@ RenderSystemNext::RenderPassObject::RenderPassObject()
 RenderSystemNext::RenderSystemNext(Registry* registry,
                                    const RenderSystem::InitParams& init_params)
     : System(registry),
+      render_data_pipeline_(init_params.render_data_depth),
       sort_order_manager_(registry_),
       shading_model_path_(kDefaultMaterialShaderDirectory),
       clip_from_model_matrix_func_(CalculateClipFromModelMatrix) {
@@ -264,8 +266,12 @@ RenderSystemNext::RenderSystemNext(Registry* registry,
     renderer_.EnableMultiview();
   }
 
+  // Created before the factories, which queue their uploads on it.
+  upload_queue_ = registry->Create<UploadQueue>();
+
   mesh_factory_ = new MeshFactoryImpl(registry);
   registry->Register(std::unique_ptr<MeshFactory>(mesh_factory_));
+  dynamic_mesh_pool_ = MakeUnique<DynamicMeshPool>(mesh_factory_);
 
   texture_factory_ = new TextureFactoryImpl(registry);
   registry->Register(std::unique_ptr<TextureFactory>(texture_factory_));
@@ -275,10 +281,10 @@ RenderSystemNext::RenderSystemNext(Registry* registry,
 
   auto* dispatcher = registry->Get<Dispatcher>();
   dispatcher->Connect(this, [this](const ParentChangedEvent& event) {
-    UpdateSortOrder(event.target);
+    MarkSortOrderDirty(event.target);
   });
   dispatcher->Connect(this, [this](const ChildIndexChangedEvent& event) {
-    UpdateSortOrder(event.target);
+    MarkSortOrderDirty(event.target);
   });
 
   FunctionBinder* binder = registry->Get<FunctionBinder>();
@@ -500,6 +506,7 @@ void RenderSystemNext::PostCreateInit(Entity e, HashValue type,
 
 void RenderSystemNext::Destroy(Entity e) {
   deformations_.erase(e);
+  dynamic_mesh_pool_->Release(e);
   for (auto& pass : render_passes_) {
     const detail::EntityIdPair entity_id_pair(e, pass.first);
     pass.second.components.Destroy(e);
@@ -533,12 +540,15 @@ void RenderSystemNext::ProcessTasks() {
   LULLABY_CPU_TRACE_CALL();
 
   CreateDeferredMeshes();
+  UpdateDirtySortOrders();
+  upload_queue_->ProcessUploads();
 }
 
 void RenderSystemNext::WaitForAssetsToLoad() {
   CreateDeferredMeshes();
   while (registry_->Get<AssetLoader>()->Finalize()) {
   }
+  upload_queue_->Flush();
 }
 
 const mathfu::vec4& RenderSystemNext::GetDefaultColor(Entity entity) const {
@@ -1141,6 +1151,24 @@ bool RenderSystemNext::IsReadyToRenderImpl(
   return true;
 }
 
+void RenderSystemNext::PrioritizeUploads(const RenderComponent& component) {
+  if (component.mesh && !component.mesh->IsLoaded()) {
+    upload_queue_->Prioritize(component.mesh.get());
+  }
+  for (const auto& material : component.materials) {
+    if (!material) {
+      continue;
+    }
+    for (int i = MaterialTextureUsage_MIN; i <= MaterialTextureUsage_MAX; ++i) {
+      const MaterialTextureUsage usage = static_cast<MaterialTextureUsage>(i);
+      TexturePtr texture = material->GetTexture(usage);
+      if (texture && !texture->IsLoaded()) {
+        upload_queue_->Prioritize(texture.get());
+      }
+    }
+  }
+}
+
 bool RenderSystemNext::IsHidden(Entity e) const {
   const auto* render_component = FindRenderComponentForEntity(e);
   const bool render_component_hidden =
@@ -1628,11 +1656,35 @@ void RenderSystemNext::SetClearColor(float r, float g, float b, float a) {
 }
 
 void RenderSystemNext::SubmitRenderData() {
-  RenderData* data = render_data_buffer_.LockWriteBuffer();
+  RenderData* data = render_data_pipeline_.BeginWrite();
   if (!data) {
     return;
   }
-  data->clear();
+
+  // Reset the pass containers instead of clearing the map so that the render
+  // object vectors keep their capacity from one frame to the next.  The render
+  // data outlives the frame in which it is submitted (it may be read by the
+  // render thread afterwards), so it cannot come from the FrameAllocator.
+  for (auto iter = data->begin(); iter != data->end();) {
+    if (render_passes_.count(iter->first) == 0) {
+      iter = data->erase(iter);
+      continue;
+    }
+    RenderPassDrawContainer& pass_container = iter->second;
+    pass_container.clear_params = RenderClearParams();
+    pass_container.render_target = nullptr;
+    for (RenderLayer& layer : pass_container.layers) {
+      RenderObjectVector render_objects = std::move(layer.render_objects);
+      render_objects.clear();
+      layer = RenderLayer();
+      layer.render_objects = std::move(render_objects);
+    }
+    ++iter;
+  }
+
+  // Sort orders are recalculated once per frame in case the hierarchy changed
+  // since the last call to ProcessTasks.
+  UpdateDirtySortOrders();
 
   const auto* transform_system = registry_->Get<TransformSystem>();
 
@@ -1701,6 +1753,7 @@ void RenderSystemNext::SubmitRenderData() {
           if (render_component.hidden) {
             return;
           }
+          PrioritizeUploads(render_component);
           if (!render_component.mesh ||
               render_component.mesh->GetNumSubmeshes() == 0) {
             return;
@@ -1748,16 +1801,30 @@ void RenderSystemNext::SubmitRenderData() {
     }
   }
 
-  render_data_buffer_.UnlockWriteBuffer();
+  render_data_pipeline_.EndWrite();
 }
 
 void RenderSystemNext::BeginRendering() {
-  active_render_data_ = render_data_buffer_.LockReadBuffer();
+  RenderStateManager& render_state_manager = renderer_.GetRenderStateManager();
+  render_state_stats_ = render_state_manager.GetStats();
+  render_state_manager.ResetStats();
+
+  active_render_data_ = render_data_pipeline_.BeginRead();
 }
 
 void RenderSystemNext::EndRendering() {
-  render_data_buffer_.UnlockReadBuffer();
-  active_render_data_ = nullptr;
+  if (active_render_data_) {
+    render_data_pipeline_.EndRead();
+    active_render_data_ = nullptr;
+  }
+}
+
+FramePipelineStats RenderSystemNext::GetRenderDataStats() const {
+  return render_data_pipeline_.GetStats();
+}
+
+RenderStateManager::Stats RenderSystemNext::GetRenderStateStats() const {
+  return render_state_stats_;
 }
 
 void RenderSystemNext::RenderAt(const RenderObject* render_object,
@@ -1943,7 +2010,11 @@ void RenderSystemNext::BindTexture(int unit, const TexturePtr& texture) {
     gpu_cache_.bound_textures.resize(unit + 1);
   }
 
-  if (texture) {
+  if (texture && !texture->IsLoaded()) {
+    // Stand in for textures whose upload hasn't run yet.
+    upload_queue_->Prioritize(texture.get());
+    texture_factory_->GetWhiteTexture()->Bind(unit);
+  } else if (texture) {
     texture->Bind(unit);
   } else if (gpu_cache_.bound_textures[unit]) {
     GL_CALL(glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(unit)));
@@ -1974,23 +2045,49 @@ void RenderSystemNext::UpdateDynamicMesh(
     const size_t max_ranges,
     const std::function<void(MeshData*)>& update_mesh) {
   if (max_vertices > 0) {
-    DataContainer vertex_data = DataContainer::CreateHeapDataContainer(
-        max_vertices * vertex_format.GetVertexSize());
-    DataContainer index_data = DataContainer::CreateHeapDataContainer(
-        max_indices * MeshData::GetIndexSize(index_type));
-    DataContainer range_data = DataContainer::CreateHeapDataContainer(
-        max_ranges * sizeof(MeshData::IndexRange));
-    MeshData data(primitive_type, vertex_format, std::move(vertex_data),
-                  index_type, std::move(index_data), std::move(range_data));
-    update_mesh(&data);
-    MeshPtr mesh = mesh_factory_->CreateMesh(std::move(data));
+    DynamicMeshPool::Params params;
+    params.primitive_type = primitive_type;
+    params.vertex_format = vertex_format;
+    params.max_vertices = max_vertices;
+    params.max_indices = max_indices;
+    params.index_type = index_type;
+    params.max_ranges = max_ranges;
+    // Drop the components' references to the entity's pooled mesh so that the
+    // pool only sees those held by render data that has not yet been drawn.
+    const Mesh* pooled_mesh = dynamic_mesh_pool_->GetMesh(entity);
+    std::vector<HashValue> pooled_passes;
+    if (pooled_mesh) {
+      ForEachComponentOfEntity(
+          entity, [pooled_mesh, &pooled_passes](RenderComponent* component,
+                                                HashValue pass) {
+            if (component->mesh.get() == pooled_mesh) {
+              component->mesh.reset();
+              pooled_passes.push_back(pass);
+            }
+          });
+    }
+
+    MeshPtr mesh = dynamic_mesh_pool_->Update(entity, params, update_mesh);
+    // The pooled mesh is usually the one already assigned to the entity, in
+    // which case its contents were updated in place and there is no need to
+    // notify listeners.
     ForEachComponentOfEntity(
-        entity,
-        [this, entity, mesh](RenderComponent* component, HashValue pass) {
+        entity, [this, entity, mesh, pooled_mesh, &pooled_passes](
+                    RenderComponent* component, HashValue pass) {
+          if (component->mesh == mesh) {
+            return;
+          }
           component->mesh = mesh;
-          SendEvent(registry_, entity, MeshChangedEvent(entity, pass));
+          const bool unchanged =
+              mesh.get() == pooled_mesh &&
+              std::find(pooled_passes.begin(), pooled_passes.end(), pass) !=
+                  pooled_passes.end();
+          if (!unchanged) {
+            SendEvent(registry_, entity, MeshChangedEvent(entity, pass));
+          }
         });
   } else {
+    dynamic_mesh_pool_->Release(entity);
     ForEachComponentOfEntity(
         entity, [this, entity](RenderComponent* component, HashValue pass) {
           component->mesh.reset();
@@ -2110,17 +2207,20 @@ void RenderSystemNext::RenderDebugStats(const RenderView* views,
   SetDepthWrite(true);
 }
 
-void RenderSystemNext::UpdateSortOrder(Entity entity) {
+void RenderSystemNext::MarkSortOrderDirty(Entity entity) {
   ForEachComponentOfEntity(
       entity, [&](RenderComponent* render_component, HashValue pass) {
-        const detail::EntityIdPair entity_id_pair(entity, pass);
-        sort_order_manager_.UpdateSortOrder(
-            entity_id_pair, [this](detail::EntityIdPair entity_id_pair) {
-              return GetComponent(entity_id_pair.entity, entity_id_pair.id);
-            });
+        sort_order_manager_.MarkDirty(detail::EntityIdPair(entity, pass));
       });
 }
 
+void RenderSystemNext::UpdateDirtySortOrders() {
+  LULLABY_CPU_TRACE_CALL();
+  sort_order_manager_.ProcessDirty([this](detail::EntityIdPair entity_id_pair) {
+    return GetComponent(entity_id_pair.entity, entity_id_pair.id);
+  });
+}
+
 const fplbase::RenderState& RenderSystemNext::GetCachedRenderState() const {
   return render_state_;
 }
@@ -2442,6 +2542,16 @@ namespace {
 inline float GetZBackToFrontXOutToMiddleDistance(const mathfu::vec3& pos) {
   return pos.z - std::abs(pos.x);
 }
+
+inline uint64_t GetMaterialStateHash(
+    const std::shared_ptr<Material>& material) {
+  return material ? material->GetRenderStateHash() : 0;
+}
+
+inline const Shader* GetMaterialShader(
+    const std::shared_ptr<Material>& material) {
+  return material ? material->GetShader().get() : nullptr;
+}
 }  // namespace
 
 void RenderSystemNext::SortObjects(std::vector<RenderObject>* objects,
@@ -2492,6 +2602,25 @@ void RenderSystemNext::SortObjects(std::vector<RenderObject>* objects,
                 });
       break;
 
+    case SortMode_MinimizeStateChanges:
+      // Group objects with identical render state, then identical shaders, so
+      // that consecutive draws need as few GL state changes as possible.
+      std::sort(objects->begin(), objects->end(),
+                [](const RenderObject& a, const RenderObject& b) {
+                  const uint64_t a_hash = GetMaterialStateHash(a.material);
+                  const uint64_t b_hash = GetMaterialStateHash(b.material);
+                  if (a_hash != b_hash) {
+                    return a_hash < b_hash;
+                  }
+                  const Shader* a_shader = GetMaterialShader(a.material);
+                  const Shader* b_shader = GetMaterialShader(b.material);
+                  if (a_shader != b_shader) {
+                    return std::less<const Shader*>()(a_shader, b_shader);
+                  }
+                  return a.sort_order < b.sort_order;
+                });
+      break;
+
     default:
       LOG(DFATAL) << "SortObjects called with unsupported sort mode!";
       break;
@@ -18,6 +18,7 @@ limitations under the License.
 #define LULLABY_SYSTEMS_RENDER_NEXT_RENDER_SYSTEM_NEXT_H_
 
 #include <array>
+#include <memory>
 #include <queue>
 #include <set>
 #include <string>
@@ -29,6 +30,7 @@ limitations under the License.
 #include "lullaby/modules/render/mesh_data.h"
 #include "lullaby/modules/render/vertex.h"
 #include "lullaby/systems/render/detail/sort_order.h"
+#include "lullaby/systems/render/next/dynamic_mesh_pool.h"
 #include "lullaby/systems/render/next/material.h"
 #include "lullaby/systems/render/next/mesh.h"
 #include "lullaby/systems/render/next/mesh_factory.h"
@@ -38,10 +40,11 @@ limitations under the License.
 #include "lullaby/systems/render/next/shader_factory.h"
 #include "lullaby/systems/render/next/texture_atlas_factory.h"
 #include "lullaby/systems/render/next/texture_factory.h"
+#include "lullaby/systems/render/next/upload_queue.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/async_processor.h"
-#include "lullaby/util/buffered_data.h"
+#include "lullaby/util/frame_pipeline.h"
 #include "lullaby/util/string_view.h"
 #include "lullaby/generated/render_def_generated.h"
 #include "lullaby/generated/render_pass_def_generated.h"
@@ -86,6 +89,14 @@ class RenderSystemNext : public System {
   void EndRendering();
   void SubmitRenderData();
 
+  /// Returns statistics about the handoff of render data from
+  /// SubmitRenderData() to BeginRendering().
+  FramePipelineStats GetRenderDataStats() const;
+
+  /// Returns the render state changes made while rendering the last complete
+  /// frame, ie. between the previous pair of BeginRendering() calls.
+  RenderStateManager::Stats GetRenderStateStats() const;
+
   const mathfu::vec4& GetDefaultColor(Entity entity) const;
   void SetDefaultColor(Entity entity, const mathfu::vec4& color);
 
@@ -378,12 +389,20 @@ class RenderSystemNext : public System {
   void CreateDeferredMeshes();
 
   void RenderDebugStats(const RenderView* views, size_t num_views);
-  void UpdateSortOrder(Entity entity);
+  // Flags the sort orders of |entity| and its descendants to be recalculated
+  // by the next call to UpdateDirtySortOrders.
+  void MarkSortOrderDirty(Entity entity);
+  // Recalculates all sort orders flagged by MarkSortOrderDirty.
+  void UpdateDirtySortOrders();
   void OnTextureLoaded(const RenderComponent& component, HashValue pass,
                        int unit, const TexturePtr& texture);
   void OnMeshLoaded(RenderComponent* render_component, HashValue pass);
   bool IsReadyToRenderImpl(const RenderComponent& component) const;
 
+  // Moves the pending uploads of the component's mesh and textures to the
+  // front of the upload queue.
+  void PrioritizeUploads(const RenderComponent& component);
+
   void SetUniformImpl(RenderComponent* component, int material_index,
                       string_view name, ShaderDataType type, Span<uint8_t> data,
                       int count);
@@ -475,9 +494,12 @@ class RenderSystemNext : public System {
   /// BeginFrame and released at EndFrame.
   RenderData* active_render_data_ = nullptr;
 
-  /// Buffer of RenderData objects so one thread can write data while another
+  /// Pipeline of RenderData objects so one thread can write data while another
   /// can use data for rendering.
-  BufferedData<RenderData> render_data_buffer_;
+  FramePipeline<RenderData> render_data_pipeline_;
+
+  /// Render state changes made while rendering the last frame.
+  RenderStateManager::Stats render_state_stats_;
 
   /// Definitions of Render Passes.
   HashValue default_pass_ = ConstHash("Main");
@@ -489,6 +511,12 @@ class RenderSystemNext : public System {
   TextureFactoryImpl* texture_factory_;
   TextureAtlasFactory* texture_atlas_factory_;
 
+  /// GPU uploads of loaded assets, spread over multiple frames.
+  UploadQueue* upload_queue_;
+
+  /// Pool of meshes reused across calls to UpdateDynamicMesh.
+  std::unique_ptr<DynamicMeshPool> dynamic_mesh_pool_;
+
   std::unordered_map<Entity, RenderSystem::DeformationFn> deformations_;
   /// Since deformations require transforms and meshes can be set before the
   /// transform system has initialized, we need to delay deformations until we
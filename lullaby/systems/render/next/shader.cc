@@ -22,7 +22,8 @@ limitations under the License.
 namespace lull {
 
 void Shader::Init(ProgramHnd program, ShaderHnd vs, ShaderHnd fs) {
-  if (!program || !vs || !fs) {
+  // Programs loaded from a binary are created without any shader objects.
+  if (!program || (!vs && fs) || (vs && !fs)) {
     LOG(DFATAL) << "Initializing shader with invalid objects.";
     return;
   }
@@ -23,6 +23,7 @@ limitations under the License.
 #include "lullaby/systems/render/next/mesh.h"
 #include "lullaby/util/flatbuffer_reader.h"
 #include "lullaby/util/logging.h"
+#include "lullaby/util/make_unique.h"
 
 namespace lull {
 namespace {
@@ -57,6 +58,77 @@ ShaderUniformDefT CreateUniformDef(const char* name, ShaderDataType type,
   return uniform_def;
 }
 
+// Saves and restores program binaries using the GL program binary API.
+class GlProgramCacheBackend : public ProgramCache::Backend {
+ public:
+  // Returns true if the driver supports at least one program binary format.
+  static bool IsSupported() {
+#ifdef GL_NUM_PROGRAM_BINARY_FORMATS
+    GLint num_formats = 0;
+    GL_CALL(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats));
+    return num_formats > 0;
+#else
+    return false;
+#endif
+  }
+
+  std::string GetDriverId() override {
+    std::string id;
+    for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+      const GLubyte* str = glGetString(name);
+      if (str) {
+        id += reinterpret_cast<const char*>(str);
+      }
+      id += '\n';
+    }
+    return id;
+  }
+
+  bool GetProgramBinary(ProgramHnd program, uint32_t* format,
+                        std::vector<uint8_t>* binary) override {
+#ifdef GL_PROGRAM_BINARY_LENGTH
+    GLint length = 0;
+    GL_CALL(glGetProgramiv(*program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0) {
+      return false;
+    }
+    GLenum gl_format = 0;
+    binary->resize(length);
+    GL_CALL(glGetProgramBinary(*program, length, &length, &gl_format,
+                               binary->data()));
+    binary->resize(length);
+    *format = gl_format;
+    return length > 0;
+#else
+    return false;
+#endif
+  }
+
+  ProgramHnd LoadProgramBinary(uint32_t format,
+                               Span<uint8_t> binary) override {
+#ifdef GL_PROGRAM_BINARY_LENGTH
+    const ProgramHnd program = glCreateProgram();
+    if (!program) {
+      return ProgramHnd();
+    }
+    // The driver is allowed to reject any binary (eg. after an update), so
+    // don't treat errors as fatal.
+    glProgramBinary(*program, format, binary.data(),
+                    static_cast<GLsizei>(binary.size()));
+    glGetError();
+    GLint status = GL_FALSE;
+    GL_CALL(glGetProgramiv(*program, GL_LINK_STATUS, &status));
+    if (status == GL_FALSE) {
+      GL_CALL(glDeleteProgram(*program));
+      return ProgramHnd();
+    }
+    return program;
+#else
+    return ProgramHnd();
+#endif
+  }
+};
+
 HashValue HashLoadParams(const ShaderCreateParams& params) {
   HashValue hash = Hash(params.shading_model);
   for (const HashValue it : params.environment) {
@@ -98,6 +170,29 @@ ShaderPtr ShaderFactory::LoadShaderFromDef(const ShaderDefT& shader_def,
     return nullptr;
   }
 
+  // Sanitize the code of each stage.  The result is also what the program cache
+  // is keyed on.
+  std::array<std::string, ShaderData::kNumStages> sources;
+  for (int i = static_cast<int>(ShaderStageType_MIN);
+       i <= static_cast<int>(ShaderStageType_MAX); ++i) {
+    const ShaderStageType shader_stage = static_cast<ShaderStageType>(i);
+    if (shader_data.HasStage(shader_stage)) {
+      sources[shader_stage] = SanitizeShaderSource(
+          shader_data.GetStageCode(shader_stage), GetShaderProfile());
+    }
+  }
+
+  ProgramCache::Key cache_key = 0;
+  if (program_cache_) {
+    cache_key = GetProgramCacheKey(sources[ShaderStageType_Vertex],
+                                   sources[ShaderStageType_Fragment]);
+    ShaderPtr shader =
+        LoadCachedShader(cache_key, shader_data.GetDescription());
+    if (shader) {
+      return shader;
+    }
+  }
+
   // Construct the shader handles.
   std::array<ShaderHnd, ShaderData::kNumStages> shader_handles;
   for (int i = static_cast<int>(ShaderStageType_MIN);
@@ -108,8 +203,8 @@ ShaderPtr ShaderFactory::LoadShaderFromDef(const ShaderDefT& shader_def,
     }
 
     // Compile the shader stage.
-    shader_handles[shader_stage] = CompileShader(
-        shader_data.GetStageCode(shader_stage).c_str(), shader_stage);
+    shader_handles[shader_stage] =
+        CompileShader(sources[shader_stage], shader_stage);
     if (!shader_handles[shader_stage]) {
       LOG(DFATAL) << "Failed to compile shader stage " << shader_stage;
       ReleaseShadersArray(shader_handles);
@@ -136,6 +231,9 @@ ShaderPtr ShaderFactory::LoadShaderFromDef(const ShaderDefT& shader_def,
     ReleaseShadersArray(shader_handles);
     return nullptr;
   }
+  if (program_cache_) {
+    program_cache_->Store(cache_key, program);
+  }
 
   // Initialize and return the shader.
   ShaderPtr shader = std::make_shared<Shader>(shader_data.GetDescription());
@@ -156,6 +254,46 @@ void ShaderFactory::ReleaseShaderFromCache(HashValue key) {
   shaders_.Release(key);
 }
 
+void ShaderFactory::EnableProgramCache(const std::string& directory) {
+  if (!GlProgramCacheBackend::IsSupported()) {
+    LOG(INFO) << "Program binaries are not supported, not caching programs.";
+    return;
+  }
+  program_cache_ =
+      MakeUnique<ProgramCache>(directory, MakeUnique<GlProgramCacheBackend>());
+}
+
+const ProgramCache* ShaderFactory::GetProgramCache() const {
+  return program_cache_.get();
+}
+
+ProgramCache::Key ShaderFactory::GetProgramCacheKey(
+    const std::string& vs_source, const std::string& fs_source) const {
+  // The attribute locations are bound before linking, so they are part of the
+  // program.
+  std::string attributes;
+  for (const auto& attribute : GetDefaultVertexAttributes()) {
+    attributes += attribute.first;
+    attributes += '=';
+    attributes += std::to_string(attribute.second);
+    attributes += ';';
+  }
+  const string_view sources[] = {vs_source, fs_source, attributes};
+  return ProgramCache::ComputeKey(sources);
+}
+
+ShaderPtr ShaderFactory::LoadCachedShader(
+    ProgramCache::Key key, const Shader::Description& description) {
+  const ProgramHnd program = program_cache_->Load(key);
+  if (!program) {
+    return nullptr;
+  }
+  // Programs loaded from a binary have no shader objects.
+  ShaderPtr shader = std::make_shared<Shader>(description);
+  shader->Init(program, ShaderHnd(), ShaderHnd());
+  return shader;
+}
+
 ShaderPtr ShaderFactory::LoadLullShaderImpl(const std::string& filename,
                                             const ShaderCreateParams& params) {
   auto* asset_loader = registry_->Get<AssetLoader>();
@@ -213,7 +351,7 @@ ShaderPtr ShaderFactory::LoadFplShaderImpl(const std::string& filename) {
   return shader;
 }
 
-ShaderHnd ShaderFactory::CompileShader(const char* source,
+ShaderHnd ShaderFactory::CompileShader(const std::string& safe_source,
                                        ShaderStageType stage) {
   const GLenum gl_stage =
       stage == ShaderStageType_Vertex ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER;
@@ -223,9 +361,6 @@ ShaderHnd ShaderFactory::CompileShader(const char* source,
     return shader;
   }
 
-  const std::string safe_source =
-      SanitizeShaderSource(source, GetShaderProfile());
-
   const char* safe_source_cstr = safe_source.c_str();
   GL_CALL(glShaderSource(*shader, 1, &safe_source_cstr, nullptr));
   GL_CALL(glCompileShader(*shader));
@@ -262,6 +397,12 @@ ProgramHnd ShaderFactory::LinkProgram(ShaderHnd vs, ShaderHnd fs,
 
   GL_CALL(glAttachShader(*program, *vs));
   GL_CALL(glAttachShader(*program, *fs));
+#ifdef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+  if (program_cache_) {
+    GL_CALL(glProgramParameteri(*program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                GL_TRUE));
+  }
+#endif
   if (attributes.empty()) {
     const auto mesh_default_attributes = GetDefaultVertexAttributes();
     for (size_t i = 0; i < mesh_default_attributes.size(); ++i) {
@@ -294,8 +435,21 @@ ProgramHnd ShaderFactory::LinkProgram(ShaderHnd vs, ShaderHnd fs,
 
 ShaderPtr ShaderFactory::CompileAndLink(const char* vs_source,
                                         const char* fs_source) {
-  const ShaderHnd vs = CompileShader(vs_source, ShaderStageType_Vertex);
-  const ShaderHnd fs = CompileShader(fs_source, ShaderStageType_Fragment);
+  const ShaderProfile profile = GetShaderProfile();
+  const std::string safe_vs_source = SanitizeShaderSource(vs_source, profile);
+  const std::string safe_fs_source = SanitizeShaderSource(fs_source, profile);
+
+  ProgramCache::Key cache_key = 0;
+  if (program_cache_) {
+    cache_key = GetProgramCacheKey(safe_vs_source, safe_fs_source);
+    ShaderPtr shader = LoadCachedShader(cache_key, Shader::Description());
+    if (shader) {
+      return shader;
+    }
+  }
+
+  const ShaderHnd vs = CompileShader(safe_vs_source, ShaderStageType_Vertex);
+  const ShaderHnd fs = CompileShader(safe_fs_source, ShaderStageType_Fragment);
 
   ProgramHnd program;
   if (vs && fs) {
@@ -303,6 +457,9 @@ ShaderPtr ShaderFactory::CompileAndLink(const char* vs_source,
   }
 
   if (program && fs && vs) {
+    if (program_cache_) {
+      program_cache_->Store(cache_key, program);
+    }
     ShaderPtr shader = std::make_shared<Shader>();
     shader->Init(program, fs, vs);
     return shader;
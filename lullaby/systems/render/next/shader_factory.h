@@ -17,7 +17,11 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_RENDER_NEXT_SHADER_FACTORY_H_
 #define LULLABY_SYSTEMS_RENDER_NEXT_SHADER_FACTORY_H_
 
+#include <memory>
+#include <string>
+
 #include "lullaby/modules/render/vertex_format.h"
+#include "lullaby/systems/render/next/program_cache.h"
 #include "lullaby/systems/render/next/shader.h"
 #include "lullaby/systems/render/next/shader_data.h"
 #include "lullaby/util/registry.h"
@@ -49,6 +53,15 @@ class ShaderFactory {
   /// Releases the cached shader associated with |key|.
   void ReleaseShaderFromCache(HashValue key);
 
+  /// Enables the persistent program binary cache, which stores the linked
+  /// programs in the existing, writable |directory| so that they only need to
+  /// be compiled from source the first time they are loaded with a given
+  /// driver.  Has no effect if the driver can't retrieve program binaries.
+  void EnableProgramCache(const std::string& directory);
+
+  /// Returns the program binary cache, or nullptr if it isn't enabled.
+  const ProgramCache* GetProgramCache() const;
+
  private:
   ShaderPtr LoadImpl(const ShaderCreateParams& params);
   ShaderPtr LoadShaderFromDef(const ShaderDefT& shader_def,
@@ -57,12 +70,23 @@ class ShaderFactory {
   ShaderPtr LoadLullShaderImpl(const std::string& filename,
                                const ShaderCreateParams& params);
   ShaderPtr CompileAndLink(const char* vs_source, const char* fs_source);
-  ShaderHnd CompileShader(const char* source, ShaderStageType stage);
+  ShaderHnd CompileShader(const std::string& safe_source,
+                          ShaderStageType stage);
   ProgramHnd LinkProgram(ShaderHnd vs, ShaderHnd fs,
                          Span<ShaderAttributeDefT> attributes = {});
 
+  // Returns the program cache key for the sanitized vertex and fragment shader
+  // sources, which are linked using the default vertex attributes.
+  ProgramCache::Key GetProgramCacheKey(const std::string& vs_source,
+                                       const std::string& fs_source) const;
+  // Returns a shader using the program stored in the program cache for |key|,
+  // or nullptr if the program cache doesn't contain it.
+  ShaderPtr LoadCachedShader(ProgramCache::Key key,
+                             const Shader::Description& description);
+
   Registry* registry_;
   ResourceManager<Shader> shaders_;
+  std::unique_ptr<ProgramCache> program_cache_;
 };
 
 }  // namespace lull
@@ -20,6 +20,7 @@ limitations under the License.
 #include "lullaby/modules/file/asset_loader.h"
 #include "lullaby/modules/render/image_decode.h"
 #include "lullaby/systems/render/next/gl_helpers.h"
+#include "lullaby/systems/render/next/upload_queue.h"
 #include "lullaby/util/filename.h"
 
 namespace lull {
@@ -50,6 +51,19 @@ bool IsCompressed(ImageData::Format format) {
   }
 }
 
+// Returns true if DecodeImage() returns images of |format| that reference the
+// encoded file data rather than owning a decoded copy.
+bool IsContainerFormat(ImageData::Format format) {
+  switch (format) {
+    case ImageData::kAstc:
+    case ImageData::kPkm:
+    case ImageData::kKtx:
+      return true;
+    default:
+      return false;
+  }
+}
+
 bool IsKtxSupported() {
   // KTX can contain any image format.
   return g_is_ktx_supported;
@@ -635,7 +649,29 @@ TexturePtr TextureFactoryImpl::LoadTexture(string_view filename,
     auto* asset_loader = registry_->Get<AssetLoader>();
     asset_loader->LoadAsync<TextureAsset>(
         resolved, params, [this, texture](TextureAsset* asset) {
-          InitTextureImpl(texture, &asset->image_data_, asset->params_);
+          auto* upload_queue = registry_->Get<UploadQueue>();
+          if (!upload_queue) {
+            InitTextureImpl(texture, &asset->image_data_, asset->params_);
+            return;
+          }
+
+          // The file data is released once the asset is finalized, so images
+          // that still reference it need their own copy.
+          ImageData& image = asset->image_data_;
+          auto pending = std::make_shared<ImageData>(
+              IsContainerFormat(image.GetFormat()) ? image.CreateHeapCopy()
+                                                   : std::move(image));
+          const TextureParams params = asset->params_;
+          // Only hold a weak reference so that a texture released before its
+          // upload runs isn't uploaded at all.
+          std::weak_ptr<Texture> weak_texture = texture;
+          upload_queue->Enqueue(
+              texture.get(), pending->GetDataSize(),
+              [this, weak_texture, pending, params]() {
+                if (auto texture = weak_texture.lock()) {
+                  InitTextureImpl(texture, pending.get(), params);
+                }
+              });
         });
     return texture;
   });
@@ -0,0 +1,137 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/upload_queue.h"
+
+#include <algorithm>
+
+namespace lull {
+
+const int UploadQueue::kDefaultPriority;
+const int UploadQueue::kVisiblePriority;
+
+UploadQueue::UploadQueue() : UploadQueue(Budget()) {}
+
+UploadQueue::UploadQueue(const Budget& budget, NowFn now)
+    : now_(std::move(now)), budget_(budget) {}
+
+void UploadQueue::SetBudget(const Budget& budget) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  budget_ = budget;
+}
+
+UploadQueue::Budget UploadQueue::GetBudget() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return budget_;
+}
+
+void UploadQueue::Enqueue(const void* resource, size_t num_bytes, Task task,
+                          int priority) {
+  if (!task) {
+    return;
+  }
+
+  Upload upload;
+  upload.resource = resource;
+  upload.num_bytes = num_bytes;
+  upload.priority = priority;
+  upload.task = std::move(task);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  upload.sequence = next_sequence_++;
+  num_pending_bytes_ += num_bytes;
+  uploads_.emplace_back(std::move(upload));
+}
+
+bool UploadQueue::Prioritize(const void* resource, int priority) {
+  bool found = false;
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (Upload& upload : uploads_) {
+    if (upload.resource == resource) {
+      upload.priority = std::max(upload.priority, priority);
+      found = true;
+    }
+  }
+  return found;
+}
+
+std::vector<UploadQueue::Upload>::iterator UploadQueue::FindNext() {
+  // The queue is expected to be short, and priorities change while uploads are
+  // queued, so a linear search is simpler than maintaining a heap.
+  auto next = uploads_.begin();
+  for (auto iter = uploads_.begin(); iter != uploads_.end(); ++iter) {
+    if (iter->priority > next->priority ||
+        (iter->priority == next->priority && iter->sequence < next->sequence)) {
+      next = iter;
+    }
+  }
+  return next;
+}
+
+size_t UploadQueue::ProcessUploads() { return Process(true); }
+
+size_t UploadQueue::Flush() { return Process(false); }
+
+size_t UploadQueue::Process(bool use_budget) {
+  const Budget budget = GetBudget();
+  const Clock::time_point start = now_();
+
+  size_t num_uploads = 0;
+  size_t num_bytes = 0;
+  Upload upload;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto next = FindNext();
+      if (next == uploads_.end()) {
+        break;
+      }
+      // Stop before an upload that would exceed the byte budget, unless it is
+      // the first one this frame.
+      if (use_budget && num_uploads > 0 && budget.max_bytes_per_frame > 0 &&
+          num_bytes + next->num_bytes > budget.max_bytes_per_frame) {
+        break;
+      }
+      upload = std::move(*next);
+      uploads_.erase(next);
+      num_pending_bytes_ -= upload.num_bytes;
+    }
+
+    // Tasks may queue more uploads, so they are run without holding the lock.
+    upload.task();
+    upload.task = nullptr;
+    ++num_uploads;
+    num_bytes += upload.num_bytes;
+
+    if (use_budget && budget.max_time_per_frame > Clock::duration::zero() &&
+        now_() - start >= budget.max_time_per_frame) {
+      break;
+    }
+  }
+  return num_uploads;
+}
+
+size_t UploadQueue::GetNumPendingUploads() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return uploads_.size();
+}
+
+size_t UploadQueue::GetNumPendingBytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return num_pending_bytes_;
+}
+
+}  // namespace lull
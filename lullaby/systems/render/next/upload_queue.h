@@ -0,0 +1,127 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_RENDER_NEXT_UPLOAD_QUEUE_H_
+#define LULLABY_SYSTEMS_RENDER_NEXT_UPLOAD_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "lullaby/util/clock.h"
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+/// Spreads GPU uploads (eg. of textures and meshes that finished loading) over
+/// multiple frames.
+///
+/// Uploads are queued along with their size in bytes and the resource they
+/// initialize.  Each call to ProcessUploads() then runs queued uploads until
+/// the per-frame byte or time budget is used up.  At least one upload is run
+/// per call so that uploads larger than the budget still make progress.
+///
+/// Uploads run in order of priority, and in the order they were queued within
+/// the same priority.  A resource that is needed for rendering before its
+/// upload has run (ie. the renderer is using a placeholder in its stead) can be
+/// moved to the front of the queue with Prioritize().
+///
+/// Enqueue() and Prioritize() may be called from any thread.
+class UploadQueue {
+ public:
+  using Task = std::function<void()>;
+  using NowFn = std::function<Clock::time_point()>;
+
+  /// Priority of uploads for resources that aren't known to be needed yet.
+  static const int kDefaultPriority = 0;
+  /// Priority of uploads for resources that are needed for rendering.
+  static const int kVisiblePriority = 1;
+
+  /// Limits on the work done by a single call to ProcessUploads().  A value of
+  /// zero means unlimited.
+  struct Budget {
+    size_t max_bytes_per_frame = 4 * 1024 * 1024;
+    Clock::duration max_time_per_frame = std::chrono::milliseconds(2);
+  };
+
+  /// Creates the queue with the default budget.
+  UploadQueue();
+
+  /// Creates the queue.  |now| is used to measure the time spent uploading and
+  /// can be overridden for testing.
+  explicit UploadQueue(const Budget& budget, NowFn now = Clock::now);
+
+  UploadQueue(const UploadQueue&) = delete;
+  UploadQueue& operator=(const UploadQueue&) = delete;
+
+  /// Sets the per-frame budget.
+  void SetBudget(const Budget& budget);
+
+  /// Returns the per-frame budget.
+  Budget GetBudget() const;
+
+  /// Queues the |task| that uploads |num_bytes| to initialize |resource|.
+  /// |resource| is only used to identify the upload in Prioritize().
+  void Enqueue(const void* resource, size_t num_bytes, Task task,
+               int priority = kDefaultPriority);
+
+  /// Raises the priority of all queued uploads for |resource| to |priority|.
+  /// Returns false if there are no queued uploads for |resource|.
+  bool Prioritize(const void* resource, int priority = kVisiblePriority);
+
+  /// Runs queued uploads until the budget is used up.  Returns the number of
+  /// uploads that were run.
+  size_t ProcessUploads();
+
+  /// Runs all queued uploads regardless of the budget, eg. while a loading
+  /// screen is displayed.  Returns the number of uploads that were run.
+  size_t Flush();
+
+  /// Returns the number of queued uploads.
+  size_t GetNumPendingUploads() const;
+
+  /// Returns the total size of the queued uploads.
+  size_t GetNumPendingBytes() const;
+
+ private:
+  struct Upload {
+    const void* resource = nullptr;
+    size_t num_bytes = 0;
+    int priority = kDefaultPriority;
+    uint64_t sequence = 0;
+    Task task;
+  };
+
+  // Returns the upload that should run next, or uploads_.end() if the queue is
+  // empty.  Must be called with |mutex_| locked.
+  std::vector<Upload>::iterator FindNext();
+  size_t Process(bool use_budget);
+
+  NowFn now_;
+  mutable std::mutex mutex_;
+  Budget budget_;
+  std::vector<Upload> uploads_;
+  size_t num_pending_bytes_ = 0;
+  uint64_t next_sequence_ = 0;
+};
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::UploadQueue);
+
+#endif  // LULLABY_SYSTEMS_RENDER_NEXT_UPLOAD_QUEUE_H_
@@ -62,9 +62,17 @@ using FontPtr = std::shared_ptr<Font>;
 class RenderSystem : public System {
  public:
   struct InitParams {
-    InitParams() : native_window(nullptr), enable_stereo_multiview(false) {}
+    InitParams()
+        : native_window(nullptr),
+          enable_stereo_multiview(false),
+          render_data_depth(3) {}
     void* native_window;
     bool enable_stereo_multiview;
+    /// Number of frames of render data that can be in flight between
+    /// SubmitRenderData() and BeginRendering().  3 lets the simulation submit
+    /// a frame while the previous one is still pending and another is being
+    /// rendered.  Only used by the "next" backend.
+    size_t render_data_depth;
   };
 
   /// Params describing the properties of a Group.
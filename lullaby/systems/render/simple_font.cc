@@ -47,6 +47,11 @@ MeshData SimpleFontMesh::CreateHeapCopyMesh() const {
                   WrapVectorAsReadOnly(indices_).CreateHeapCopy());
 }
 
+void SimpleFontMesh::Clear() {
+  vertices_.clear();
+  indices_.clear();
+}
+
 mathfu::vec3 SimpleFontMesh::AddGlyph(char c, const mathfu::vec3& pos,
                                       float size) {
   if (c >= 'a' && c <= 'z') {
@@ -36,6 +36,12 @@ class SimpleFontMesh {
   // Creates an independent read-write mesh using the currently buffered glyphs.
   MeshData CreateHeapCopyMesh() const;
 
+  // Returns the number of vertices in the buffered glyph quads.
+  size_t GetNumVertices() const { return vertices_.size(); }
+
+  // Removes all buffered glyphs, keeping the allocated memory.
+  void Clear();
+
   // Adds a glyph quad for |c|, returning the position of the next character.
   mathfu::vec3 AddGlyph(char c, const mathfu::vec3& pos, float size);
 
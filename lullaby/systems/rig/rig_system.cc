@@ -16,11 +16,25 @@ limitations under the License.
 
 #include "lullaby/systems/rig/rig_system.h"
 
+#include <algorithm>
+
 #include "lullaby/systems/animation/animation_system.h"
 #include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/make_unique.h"
+#include "lullaby/util/math.h"
 
 namespace lull {
+namespace {
+
+bool operator==(const RigSystem::Lod& lhs, const RigSystem::Lod& rhs) {
+  return lhs.update_interval == rhs.update_interval &&
+         lhs.max_bone_depth == rhs.max_bone_depth;
+}
+
+}  // namespace
+
+const int RigSystem::Lod::kAllBones;
 
 class RigChannel : public AnimationChannel {
  public:
@@ -40,6 +54,12 @@ class RigChannel : public AnimationChannel {
     rig_system_->SetPose(entity, {values, len});
   }
 
+  void SetSharedRig(Entity entity, Entity source,
+                    const mathfu::AffineTransform* values,
+                    size_t len) override {
+    rig_system_->SetSharedPose(entity, source, {values, len});
+  }
+
   RigSystem* rig_system_;
 };
 
@@ -91,6 +111,26 @@ void RigSystem::SetRig(Entity entity, BoneIndices parent_indices,
   rig.shader_indices.assign(shader_indices.begin(), shader_indices.end());
   rig.bone_names = std::move(bone_names);
 
+  rig.bone_depths.resize(num_bones);
+  for (size_t i = 0; i < num_bones; ++i) {
+    int depth = 0;
+    size_t parent = rig.parent_indices[i];
+    while (parent < num_bones && depth < Lod::kAllBones) {
+      ++depth;
+      parent = rig.parent_indices[parent];
+    }
+    rig.bone_depths[i] = static_cast<uint8_t>(depth);
+  }
+  UpdateLodShaderIndices(&rig);
+
+  rig.rig_hash = HashBytes(kHashOffsetBasis, rig.parent_indices.data(),
+                           rig.parent_indices.size());
+  rig.rig_hash = HashBytes(rig.rig_hash, rig.shader_indices.data(),
+                           rig.shader_indices.size());
+  rig.rig_hash = HashBytes(
+      rig.rig_hash, rig.inverse_bind_pose.data(),
+      rig.inverse_bind_pose.size() * sizeof(mathfu::AffineTransform));
+
   // Clear out any previous pose.
   rig.pose.resize(num_bones);
   for (size_t i = 0; i < rig.pose.size(); ++i) {
@@ -162,34 +202,229 @@ void RigSystem::SetPose(Entity entity, Pose pose) {
     return;
   }
 
+  // Always keep the pose, even if the palette isn't updated, so GetPose()
+  // returns the latest pose.
   rig.pose.assign(pose.begin(), pose.end());
+
+  auto* render_system = registry_->Get<RenderSystem>();
+  if (render_system->IsHidden(entity)) {
+    // Nothing will be drawn with the palette, so don't bother evaluating it.
+    rig.stale = true;
+    return;
+  }
+
+  const int interval = std::max(rig.lod.update_interval, 1);
+  if (!rig.stale && rig.frames_since_update + 1 < interval) {
+    ++rig.frames_since_update;
+    InterpolatePalette(&rig, static_cast<float>(rig.frames_since_update + 1) /
+                                 static_cast<float>(interval));
+    UploadPalette(entity, rig);
+    return;
+  }
+
   UpdateShaderTransforms(entity, &rig);
 }
 
-void RigSystem::UpdateShaderTransforms(Entity entity, RigComponent* rig) {
-  if (rig->pose.empty() || rig->parent_indices.empty()) {
+void RigSystem::SetSharedPose(Entity entity, Entity source, Pose pose) {
+  auto iter = rigs_.find(entity);
+  auto source_iter = rigs_.find(source);
+  if (iter == rigs_.end() || source_iter == rigs_.end()) {
+    SetPose(entity, pose);
     return;
   }
 
+  RigComponent& rig = iter->second;
+  const RigComponent& source_rig = source_iter->second;
+  if (rig.rig_hash != source_rig.rig_hash || !(rig.lod == source_rig.lod) ||
+      source_rig.stale) {
+    SetPose(entity, pose);
+    return;
+  }
+
+  rig.pose.assign(pose.begin(), pose.end());
+
+  auto* render_system = registry_->Get<RenderSystem>();
+  if (render_system->IsHidden(entity)) {
+    rig.stale = true;
+    return;
+  }
+
+  rig.shader_pose = source_rig.shader_pose;
+  if (rig.lod.update_interval > 1) {
+    rig.prev_palette = source_rig.prev_palette;
+    rig.next_palette = source_rig.next_palette;
+  }
+  rig.frames_since_update = source_rig.frames_since_update;
+  rig.stale = false;
+  UploadPalette(entity, rig);
+}
+
+void RigSystem::SetLod(Entity entity, const Lod& lod) {
+  auto iter = rigs_.find(entity);
+  if (iter == rigs_.end()) {
+    return;
+  }
+
+  RigComponent& rig = iter->second;
+  if (rig.lod == lod) {
+    return;
+  }
+  if (rig.lod.update_interval != lod.update_interval) {
+    rig.stale = true;
+  }
+  rig.lod = lod;
+  UpdateLodShaderIndices(&rig);
+}
+
+RigSystem::Lod RigSystem::GetLod(Entity entity) const {
+  auto iter = rigs_.find(entity);
+  if (iter != rigs_.end()) {
+    return iter->second.lod;
+  }
+  return Lod();
+}
+
+void RigSystem::SetLodLevels(std::vector<LodLevel> levels) {
+  lod_levels_ = std::move(levels);
+  std::sort(lod_levels_.begin(), lod_levels_.end(),
+            [](const LodLevel& lhs, const LodLevel& rhs) {
+              return lhs.min_distance < rhs.min_distance;
+            });
+}
+
+void RigSystem::UpdateLods(const mathfu::vec3& camera_position) {
+  const auto* transform_system = registry_->Get<TransformSystem>();
+  if (!transform_system) {
+    LOG(DFATAL) << "UpdateLods requires the TransformSystem.";
+    return;
+  }
+
+  for (const auto& iter : rigs_) {
+    const Entity entity = iter.first;
+    const mathfu::mat4* world_from_entity =
+        transform_system->GetWorldFromEntityMatrix(entity);
+    if (!world_from_entity) {
+      continue;
+    }
+
+    const float distance_sq =
+        (world_from_entity->TranslationVector3D() - camera_position)
+            .LengthSquared();
+    Lod lod;
+    for (const LodLevel& level : lod_levels_) {
+      if (distance_sq < level.min_distance * level.min_distance) {
+        break;
+      }
+      lod = level.lod;
+    }
+    SetLod(entity, lod);
+  }
+}
+
+void RigSystem::UpdateLodShaderIndices(RigComponent* rig) {
   const size_t num_bones = rig->shader_indices.size();
-  rig->shader_pose.resize(num_bones);
+  rig->lod_bone_indices.resize(num_bones);
+  rig->lod_shader_indices.resize(num_bones);
+  const int max_bone_depth = std::max(rig->lod.max_bone_depth, 0);
   for (size_t i = 0; i < num_bones; ++i) {
-    const uint8_t bone_index = rig->shader_indices[i];
+    uint8_t bone_index = rig->shader_indices[i];
     CHECK(bone_index < rig->parent_indices.size());
+    while (rig->bone_depths[bone_index] > max_bone_depth) {
+      bone_index = rig->parent_indices[bone_index];
+    }
+    rig->lod_bone_indices[i] = bone_index;
+
+    // Bones sharing an evaluated ancestor share its transform, so only the
+    // first of them needs to be evaluated.
+    const auto begin = rig->lod_bone_indices.begin();
+    const auto first = std::find(begin, begin + i, bone_index);
+    rig->lod_shader_indices[i] = static_cast<uint8_t>(first - begin);
+  }
+}
+
+void RigSystem::UpdateShaderTransforms(Entity entity, RigComponent* rig) {
+  if (rig->pose.empty() || rig->parent_indices.empty()) {
+    return;
+  }
 
-    const mathfu::AffineTransform& transform = rig->pose[bone_index];
-    const mathfu::AffineTransform& inverse = rig->inverse_bind_pose[bone_index];
+  if (rig->lod.update_interval <= 1) {
+    EvaluatePalette(*rig, &rig->shader_pose);
+  } else if (rig->stale) {
+    EvaluatePalette(*rig, &rig->shader_pose);
+    DecomposePalette(rig->shader_pose, &rig->next_palette);
+    rig->prev_palette = rig->next_palette;
+  } else {
+    // Start moving from the palette currently shown towards the new pose.
+    DecomposePalette(rig->shader_pose, &rig->prev_palette);
+    EvaluatePalette(*rig, &rig->shader_pose);
+    DecomposePalette(rig->shader_pose, &rig->next_palette);
+    InterpolatePalette(rig,
+                       1.f / static_cast<float>(rig->lod.update_interval));
+  }
+  rig->frames_since_update = 0;
+  rig->stale = false;
+  UploadPalette(entity, *rig);
+}
 
-    rig->shader_pose[i] = mathfu::mat4::ToAffineTransform(
+void RigSystem::EvaluatePalette(
+    const RigComponent& rig,
+    std::vector<mathfu::AffineTransform, AffineMatrixAllocator>* palette)
+    const {
+  const size_t num_bones = rig.shader_indices.size();
+  palette->resize(num_bones);
+  for (size_t i = 0; i < num_bones; ++i) {
+    const uint8_t source = rig.lod_shader_indices[i];
+    if (source != i) {
+      (*palette)[i] = (*palette)[source];
+      continue;
+    }
+
+    const uint8_t bone_index = rig.lod_bone_indices[i];
+    const mathfu::AffineTransform& transform = rig.pose[bone_index];
+    const mathfu::AffineTransform& inverse = rig.inverse_bind_pose[bone_index];
+
+    (*palette)[i] = mathfu::mat4::ToAffineTransform(
         mathfu::mat4::FromAffineTransform(transform) *
         mathfu::mat4::FromAffineTransform(inverse));
   }
+}
+
+void RigSystem::DecomposePalette(
+    const std::vector<mathfu::AffineTransform, AffineMatrixAllocator>& palette,
+    std::vector<Sqt, SqtAllocator>* sqts) {
+  sqts->resize(palette.size());
+  for (size_t i = 0; i < palette.size(); ++i) {
+    (*sqts)[i] = CalculateSqtFromAffineTransform(palette[i]);
+  }
+}
+
+void RigSystem::InterpolatePalette(RigComponent* rig, float t) {
+  // Blending the matrices directly would shrink and shear bones that rotate,
+  // so interpolate their scale, rotation and translation instead.
+  const size_t num_bones = rig->next_palette.size();
+  rig->shader_pose.resize(num_bones);
+  for (size_t i = 0; i < num_bones; ++i) {
+    const Sqt& prev = rig->prev_palette[i];
+    const Sqt& next = rig->next_palette[i];
+    const Sqt sqt(mathfu::vec3::Lerp(prev.translation, next.translation, t),
+                  mathfu::quat::Slerp(prev.rotation, next.rotation, t),
+                  mathfu::vec3::Lerp(prev.scale, next.scale, t));
+    rig->shader_pose[i] =
+        mathfu::mat4::ToAffineTransform(CalculateTransformMatrix(sqt));
+  }
+}
+
+void RigSystem::UploadPalette(Entity entity, const RigComponent& rig) {
+  if (rig.shader_pose.empty()) {
+    return;
+  }
 
   constexpr int kDimension = 4;
   constexpr int kNumVec4sInAffineTransform = 3;
   constexpr const char* kUniform = "bone_transforms";
-  const float* data = &rig->shader_pose[0][0];
-  const int count = kNumVec4sInAffineTransform * static_cast<int>(num_bones);
+  const float* data = &rig.shader_pose[0][0];
+  const int count =
+      kNumVec4sInAffineTransform * static_cast<int>(rig.shader_pose.size());
 
   auto* render_system = registry_->Get<RenderSystem>();
   render_system->SetUniform(entity, kUniform, data, kDimension, count);
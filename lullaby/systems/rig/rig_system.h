@@ -23,6 +23,8 @@ limitations under the License.
 
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/math.h"
 #include "lullaby/util/span.h"
 #include "mathfu/glsl_mappings.h"
 
@@ -34,6 +36,11 @@ namespace lull {
 // both the Animation and RenderSystems. It allows for performing additional
 // manipulations on the skeleton before sending the information to the
 // RenderSystem for drawing.
+//
+// The cost of turning poses into the bone palette can be reduced per Entity by
+// setting a Lod, either directly or by distance from the camera using
+// SetLodLevels and UpdateLods.  Entities hidden in the RenderSystem do not
+// have their palettes updated at all.
 class RigSystem : public System {
  public:
   // A list of bone indices.
@@ -42,6 +49,31 @@ class RigSystem : public System {
   // A pose is defined by a transform for each bone in the rig.
   using Pose = Span<mathfu::AffineTransform>;
 
+  // Controls how much work is spent turning an Entity's poses into the bone
+  // palette used for skinning.
+  struct Lod {
+    static const int kAllBones = 255;
+
+    // Only one of every |update_interval| poses is evaluated.  The palette is
+    // interpolated towards the last evaluated pose in between, so throttled
+    // Entities lag by up to one interval instead of visibly popping.  Each
+    // bone's scale, rotation and translation are interpolated separately, so
+    // bones with shearing (eg. non-uniform scale under a rotation) may not
+    // exactly match their evaluated palette entries.
+    int update_interval = 1;
+
+    // Bones deeper than |max_bone_depth| in the hierarchy (where root bones
+    // have a depth of 0) are not evaluated and instead rigidly follow their
+    // ancestor at that depth.
+    int max_bone_depth = kAllBones;
+  };
+
+  // A Lod used for Entities at least |min_distance| away from the camera.
+  struct LodLevel {
+    float min_distance = 0.f;
+    Lod lod;
+  };
+
   explicit RigSystem(Registry* registry);
 
   // Initializes the "rig" animation channel to pass pose information from
@@ -59,9 +91,29 @@ class RigSystem : public System {
               BoneIndices shader_indices,
               std::vector<std::string> bone_names = {});
 
-  // Sets the current pose for the Entity.
+  // Sets the current pose for the Entity.  Depending on the Entity's Lod, the
+  // pose may be skipped or only partially evaluated.
   void SetPose(Entity entity, Pose pose);
 
+  // Sets the current pose for the Entity, where |pose| was just set on the
+  // |source| Entity.  If both Entities have the same rig and Lod, the
+  // |source|'s bone palette is reused instead of being evaluated again.
+  void SetSharedPose(Entity entity, Entity source, Pose pose);
+
+  // Sets the level of detail used to evaluate poses for the Entity.
+  void SetLod(Entity entity, const Lod& lod);
+
+  // Returns the level of detail used to evaluate poses for the Entity.
+  Lod GetLod(Entity entity) const;
+
+  // Sets the levels of detail used by UpdateLods.  Entities closer than the
+  // smallest |min_distance| use the default Lod.
+  void SetLodLevels(std::vector<LodLevel> levels);
+
+  // Sets the Lod of every rigged Entity based on its distance from
+  // |camera_position| using the levels specified by SetLodLevels.
+  void UpdateLods(const mathfu::vec3& camera_position);
+
   // Returns the number of bones associated with |entity|.
   size_t GetNumBones(Entity entity) const;
 
@@ -75,12 +127,13 @@ class RigSystem : public System {
   // matrices) associated with |entity|.
   Pose GetDefaultBoneTransformInverses(Entity entity) const;
 
-  // Returns the array of bone transforms representing the current pose
-  // associated with |entity|.
+  // Returns the array of bone transforms representing the last pose set on
+  // |entity|, even if its Lod skipped evaluating it.
   Pose GetPose(Entity entity) const;
 
  private:
   using AffineMatrixAllocator = mathfu::simd_allocator<mathfu::AffineTransform>;
+  using SqtAllocator = mathfu::simd_allocator<Sqt>;
 
   struct RigComponent {
     // The number of elements represents the number of bones in the rig, and
@@ -104,9 +157,49 @@ class RigSystem : public System {
 
     // The flattened pose data passed to the shader.
     std::vector<mathfu::AffineTransform, AffineMatrixAllocator> shader_pose;
+
+    // The depth of each bone in the hierarchy.
+    std::vector<uint8_t> bone_depths;
+
+    // A hash of the rig's hierarchy, bind pose and shader bones, used to find
+    // rigs that can share palettes.
+    HashValue rig_hash = 0;
+
+    Lod lod;
+
+    // For each shader bone, the bone whose transform it uses under the current
+    // Lod, and the first shader bone using that same transform.
+    std::vector<uint8_t> lod_bone_indices;
+    std::vector<uint8_t> lod_shader_indices;
+
+    // The palettes being interpolated between when the Lod skips poses,
+    // decomposed so each bone can be interpolated rigidly.
+    std::vector<Sqt, SqtAllocator> prev_palette;
+    std::vector<Sqt, SqtAllocator> next_palette;
+
+    // The number of poses received since the last evaluated one.
+    int frames_since_update = 0;
+
+    // Set when the palettes can't be interpolated between, eg. after being
+    // hidden, so the next pose is applied without interpolation.
+    bool stale = true;
   };
 
+  void UpdateLodShaderIndices(RigComponent* rig);
   void UpdateShaderTransforms(Entity entity, RigComponent* rig);
+  void EvaluatePalette(const RigComponent& rig,
+                       std::vector<mathfu::AffineTransform,
+                                   AffineMatrixAllocator>* palette) const;
+  static void DecomposePalette(
+      const std::vector<mathfu::AffineTransform, AffineMatrixAllocator>&
+          palette,
+      std::vector<Sqt, SqtAllocator>* sqts);
+  // Sets the shader pose to |t| of the way from the previous to the next
+  // palette.
+  static void InterpolatePalette(RigComponent* rig, float t);
+  void UploadPalette(Entity entity, const RigComponent& rig);
+
+  std::vector<LodLevel> lod_levels_;
 
   std::unordered_map<Entity, RigComponent> rigs_;
 };
@@ -16,13 +16,41 @@ limitations under the License.
 
 #include "lullaby/systems/shape/shape_system.h"
 
+#include <vector>
+
 #include "lullaby/modules/render/mesh_util.h"
+#include "lullaby/systems/render/mesh_factory.h"
 #include "lullaby/systems/render/render_system.h"
+#include "lullaby/util/hash.h"
 #include "lullaby/generated/shape_def_generated.h"
 
 namespace lull {
+namespace {
+
+HashValue GetKey(const SphereDefT& sphere) {
+  HashValue key = ConstHash("SphereDef");
+  key = HashBytes(key, sphere.radius);
+  key = HashBytes(key, sphere.num_parallels);
+  key = HashBytes(key, sphere.num_meridians);
+  return key;
+}
+
+HashValue GetKey(const RectMeshDefT& quad) {
+  HashValue key = ConstHash("RectMeshDef");
+  key = HashBytes(key, quad.size_x);
+  key = HashBytes(key, quad.size_y);
+  key = HashBytes(key, quad.verts_x);
+  key = HashBytes(key, quad.verts_y);
+  key = HashBytes(key, quad.corner_radius);
+  key = HashBytes(key, quad.corner_verts);
+  return key;
+}
+
+}  // namespace
 
-ShapeSystem::ShapeSystem(Registry* registry) : System(registry) {
+ShapeSystem::ShapeSystem(Registry* registry)
+    : System(registry),
+      meshes_(ResourceManager<Mesh>::kWeakCachingOnly) {
   RegisterDef(this, ConstHash("SphereDef"));
   RegisterDef(this, ConstHash("RectMeshDef"));
   RegisterDependency<RenderSystem>(this);
@@ -33,23 +61,45 @@ void ShapeSystem::PostCreateComponent(Entity entity,
   if (blueprint.Is<SphereDefT>()) {
     SphereDefT sphere;
     blueprint.Read(&sphere);
-    MeshData mesh = CreateLatLonSphere(sphere.radius, sphere.num_parallels,
-                                       sphere.num_meridians);
-
-    auto* render_system = registry_->Get<RenderSystem>();
-    render_system->SetMesh(entity, mesh);
+    SetMesh(entity, GetKey(sphere), [&sphere]() {
+      return CreateLatLonSphere(sphere.radius, sphere.num_parallels,
+                                sphere.num_meridians);
+    });
   } else if (blueprint.Is<RectMeshDefT>()) {
     RectMeshDefT quad;
     blueprint.Read(&quad);
-    MeshData mesh = CreateQuadMesh<VertexPT>(
-        quad.size_x, quad.size_y, quad.verts_x, quad.verts_y,
-        quad.corner_radius, quad.corner_verts);
-
-    auto* render_system = registry_->Get<RenderSystem>();
-    render_system->SetMesh(entity, mesh);
+    SetMesh(entity, GetKey(quad), [&quad]() {
+      return CreateQuadMesh<VertexPT>(quad.size_x, quad.size_y, quad.verts_x,
+                                      quad.verts_y, quad.corner_radius,
+                                      quad.corner_verts);
+    });
   } else {
     LOG(DFATAL) << "Unsupported shape.";
   }
 }
 
+void ShapeSystem::SetMesh(Entity entity, HashValue key,
+                          const GenerateFn& generate) {
+  auto* render_system = registry_->Get<RenderSystem>();
+  auto* mesh_factory = registry_->Get<MeshFactory>();
+  if (!mesh_factory) {
+    // Backends without a MeshFactory can only take the mesh data directly.
+    render_system->SetMesh(entity, generate());
+    return;
+  }
+
+  // Like SetMesh(Entity, const MeshData&), apply the mesh to every pass the
+  // entity is rendered in.
+  const std::vector<HashValue> passes = render_system->GetRenderPasses(entity);
+  if (passes.empty()) {
+    return;
+  }
+
+  const MeshPtr mesh = meshes_.Create(
+      key, [&]() { return mesh_factory->CreateMesh(generate()); });
+  for (HashValue pass : passes) {
+    render_system->SetMesh(entity, pass, mesh);
+  }
+}
+
 }  // namespace lull
@@ -17,11 +17,20 @@ limitations under the License.
 #ifndef LULLABY_SYSTEMS_SHAPE_SHAPE_SYSTEM_H_
 #define LULLABY_SYSTEMS_SHAPE_SHAPE_SYSTEM_H_
 
+#include <functional>
+
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/systems/render/mesh.h"
+#include "lullaby/util/resource_manager.h"
 
 namespace lull {
 
 // The ShapeSystem generates specifically defined mesh shapes for entities.
+//
+// When a MeshFactory is available, shapes are keyed by their parameters and
+// entities with identical shapes share a single Mesh, which is released along
+// with the last entity referencing it.
 class ShapeSystem : public System {
  public:
   explicit ShapeSystem(Registry* registry);
@@ -31,6 +40,15 @@ class ShapeSystem : public System {
 
   void PostCreateComponent(Entity entity,
                            const Blueprint& blueprint) override;
+
+ private:
+  using GenerateFn = std::function<MeshData()>;
+
+  // Sets the mesh identified by |key| on |entity|, calling |generate| to
+  // create it if it isn't already in use.
+  void SetMesh(Entity entity, HashValue key, const GenerateFn& generate);
+
+  ResourceManager<Mesh> meshes_;
 };
 
 }  // namespace lull
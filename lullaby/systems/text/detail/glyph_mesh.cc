@@ -0,0 +1,62 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/text/detail/glyph_mesh.h"
+
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+MeshData BuildBatchedGlyphMesh(Span<VertexPT> vertices,
+                               const std::vector<GlyphSlice>& slices) {
+  size_t num_indices = 0;
+  for (const GlyphSlice& slice : slices) {
+    num_indices += slice.indices.size();
+  }
+
+  DataContainer vertex_data = DataContainer::CreateHeapDataContainer(
+      vertices.size() * sizeof(VertexPTT));
+  DataContainer index_data =
+      DataContainer::CreateHeapDataContainer(num_indices * sizeof(uint16_t));
+  MeshData mesh(MeshData::kTriangles, VertexPTT::kFormat,
+                std::move(vertex_data), MeshData::kIndexU16,
+                std::move(index_data));
+
+  for (const VertexPT& v : vertices) {
+    mesh.AddVertex<VertexPTT>(v.x, v.y, v.z, v.u0, v.v0, 0.f, 0.f);
+  }
+
+  // Each glyph belongs to exactly one slice, so tag its vertices with that
+  // slice's texture unit and link state.  Vertices that aren't referenced by
+  // any of the slices are never drawn and are left at unit 0.
+  VertexPTT* batched = mesh.GetMutableVertexData<VertexPTT>();
+  for (const GlyphSlice& slice : slices) {
+    const float unit = static_cast<float>(slice.texture_unit);
+    const float link = slice.link ? 1.f : 0.f;
+    for (const uint16_t index : slice.indices) {
+      if (index >= vertices.size()) {
+        LOG(DFATAL) << "Glyph index out of range: " << index;
+        continue;
+      }
+      batched[index].u1 = unit;
+      batched[index].v1 = link;
+    }
+    mesh.AddIndices(slice.indices.data(), slice.indices.size());
+  }
+  return mesh;
+}
+
+}  // namespace lull
@@ -0,0 +1,55 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_SYSTEMS_TEXT_DETAIL_GLYPH_MESH_H_
+#define LULLABY_SYSTEMS_TEXT_DETAIL_GLYPH_MESH_H_
+
+#include <vector>
+
+#include "lullaby/modules/render/mesh_data.h"
+#include "lullaby/modules/render/vertex.h"
+#include "lullaby/util/span.h"
+
+namespace lull {
+
+// The number of glyph cache textures the batched text shader can sample from
+// (see data/shaders/text.glslf built with GLYPH_SLICES).
+constexpr int kMaxBatchedGlyphTextures = 4;
+
+// The triangles of one glyph cache slice to add to a batched glyph mesh.
+struct GlyphSlice {
+  GlyphSlice(Span<uint16_t> indices, int texture_unit, bool link)
+      : indices(indices), texture_unit(texture_unit), link(link) {}
+
+  // The triangle indices of the slice's glyphs.
+  Span<uint16_t> indices;
+  // The texture unit the slice's glyph cache texture is bound to.
+  int texture_unit;
+  // Whether the slice's glyphs are part of a link.
+  bool link;
+};
+
+// Builds a single mesh that draws the glyphs from several glyph cache slices.
+// All slices share |vertices|.  The resulting mesh uses VertexPTT, where the
+// first texture coordinate is the glyph's uv, the x component of the second
+// texture coordinate is the texture unit of the vertex's slice, and the y
+// component is 1 for link glyphs and 0 otherwise.
+MeshData BuildBatchedGlyphMesh(Span<VertexPT> vertices,
+                               const std::vector<GlyphSlice>& slices);
+
+}  // namespace lull
+
+#endif  // LULLABY_SYSTEMS_TEXT_DETAIL_GLYPH_MESH_H_
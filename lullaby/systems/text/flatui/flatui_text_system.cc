@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "lullaby/systems/text/flatui/flatui_text_system.h"
 
+#include <algorithm>
+
 #include "fplbase/glplatform.h"
 #include "fplbase/internal/type_conversions_gl.h"
 #include "lullaby/events/entity_events.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "lullaby/systems/dispatcher/dispatcher_system.h"
 #include "lullaby/systems/layout/layout_box_system.h"
 #include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/text/detail/glyph_mesh.h"
 #include "lullaby/systems/text/detail/util.h"
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/util/android_context.h"
@@ -56,6 +59,7 @@ constexpr char kTexCoordAaPaddingUniform[] = "tex_coord_aa_padding";
 constexpr char kSdfParamsUniform[] = "sdf_params";
 constexpr char kTextureSizeUniform[] = "texture_size";
 constexpr char kColorUniform[] = "color";
+constexpr char kLinkColorUniform[] = "link_color";
 
 constexpr float kMetersFromMillimeters = .001f;
 
@@ -108,6 +112,19 @@ Entity CreateDefaultEntity(Registry* registry, Entity parent) {
   return entity;
 }
 
+// Sets the glyph cache |texture| on |unit| and, since all slices of the glyph
+// cache have the same size, the uniforms derived from it.
+void SetGlyphTexture(RenderSystem* render_system, Entity entity, int unit,
+                     const fplbase::Texture* texture,
+                     const mathfu::vec4& sdf_params) {
+  render_system->SetTextureId(entity, unit, GL_TEXTURE_2D,
+                              fplbase::GlTextureHandle(texture->id()));
+  const mathfu::vec2 texture_size = mathfu::vec2(texture->size());
+  render_system->SetUniform(entity, kTextureSizeUniform, &texture_size[0], 2,
+                            1);
+  render_system->SetUniform(entity, kSdfParamsUniform, &sdf_params[0], 4, 1);
+}
+
 void CopyAlpha(Registry* registry, Entity entity, Entity parent) {
   auto* render_system = registry->Get<RenderSystem>();
   mathfu::vec4 parent_color = kDefaultLinkColor;
@@ -241,6 +258,7 @@ void FlatuiTextSystem::Create(Entity entity, DefType type, const Def* def) {
       text_def.line_height_scale();
   component->text_buffer_params.kerning_scale = text_def.kerning_scale();
   component->edge_softness = text_def.edge_softness();
+  component->batch_slices = text_def.batch_slices();
   MathfuVec2FromFbVec2(text_def.bounds(),
                        &component->text_buffer_params.bounds);
   component->text_buffer_params.horizontal_align =
@@ -329,6 +347,7 @@ void FlatuiTextSystem::CreateEmpty(Entity entity) {
       default_def.line_height_scale;
   component->text_buffer_params.kerning_scale = default_def.kerning_scale;
   component->edge_softness = default_def.edge_softness;
+  component->batch_slices = default_def.batch_slices;
   component->text_buffer_params.bounds = default_def.bounds;
   component->text_buffer_params.horizontal_align =
       default_def.horizontal_alignment;
@@ -722,8 +741,6 @@ Entity FlatuiTextSystem::CreateEntity(TextComponent* component,
 }
 
 void FlatuiTextSystem::CreateTextEntities(TextComponent* component) {
-  const size_t num_slices = component->buffer->GetNumSlices();
-
   const int32_t text_size_mm = static_cast<int>(
       component->text_buffer_params.font_size / kMetersFromMillimeters);
   const float softness_scale =
@@ -731,31 +748,86 @@ void FlatuiTextSystem::CreateTextEntities(TextComponent* component) {
       kMetersFromMillimeters / component->text_buffer_params.font_size;
   const mathfu::vec4 sdf_params = CalcSdfParams(
       component->edge_softness * softness_scale, kSdfDistOffset, kSdfDistScale);
+
+  if (component->batch_slices &&
+      CreateBatchedTextEntity(component, sdf_params)) {
+    return;
+  }
+
   auto* render_system = registry_->Get<RenderSystem>();
+  const size_t num_slices = component->buffer->GetNumSlices();
   for (size_t i = 0; i < num_slices; ++i) {
-    Entity entity;
-    if (component->buffer->IsLinkSlice(i)) {
-      entity = CreateEntity(component, component->link_text_blueprint);
-      if (entity == kNullEntity) {
-        continue;
-      }
-      component->link_entities.emplace_back(entity);
-      CopyAlpha(registry_, entity, component->GetEntity());
-    } else {
-      entity = CreateDefaultEntity(registry_, component->GetEntity());
-      component->plain_entities.emplace_back(entity);
+    const Entity entity =
+        CreateGlyphEntity(component, component->buffer->IsLinkSlice(i));
+    if (entity == kNullEntity) {
+      continue;
     }
 
-    const fplbase::Texture* texture = component->buffer->GetSliceTexture(i);
     render_system->SetAndDeformMesh(entity,
                                     component->buffer->BuildSliceMesh(i));
-    render_system->SetTextureId(entity, 0, GL_TEXTURE_2D,
-                                fplbase::GlTextureHandle(texture->id()));
-    const mathfu::vec2 texture_size = mathfu::vec2(texture->size());
-    render_system->SetUniform(entity, kTextureSizeUniform, &texture_size[0], 2,
-                              1);
-    render_system->SetUniform(entity, kSdfParamsUniform, &sdf_params[0], 4, 1);
+    SetGlyphTexture(render_system, entity, 0,
+                    component->buffer->GetSliceTexture(i), sdf_params);
+  }
+}
+
+bool FlatuiTextSystem::CreateBatchedTextEntity(TextComponent* component,
+                                               const mathfu::vec4& sdf_params) {
+  // Links are drawn with the link color by the batched shader, which can't
+  // apply a custom link blueprint.
+  if (component->link_text_blueprint != kDefaultLinkTextBlueprint &&
+      component->buffer->HasLinks()) {
+    return false;
+  }
+
+  std::vector<fplbase::Texture*> textures;
+  const MeshData mesh = component->buffer->BuildBatchedMesh(&textures);
+  if (textures.empty()) {
+    return true;
   }
+  if (static_cast<int>(textures.size()) > GetMaxBatchedGlyphTextures()) {
+    // The glyphs span more glyph cache textures than can be bound at once.
+    return false;
+  }
+
+  const Entity entity = CreateDefaultEntity(registry_, component->GetEntity());
+  component->plain_entities.emplace_back(entity);
+
+  auto* render_system = registry_->Get<RenderSystem>();
+  render_system->SetAndDeformMesh(entity, mesh);
+  for (size_t unit = 0; unit < textures.size(); ++unit) {
+    SetGlyphTexture(render_system, entity, static_cast<int>(unit),
+                    textures[unit], sdf_params);
+  }
+  render_system->SetUniform(entity, kLinkColorUniform, &kDefaultLinkColor[0],
+                            4, 1);
+  return true;
+}
+
+int FlatuiTextSystem::GetMaxBatchedGlyphTextures() {
+  if (max_batched_glyph_textures_ == 0) {
+    GLint max_units = 0;
+    GL_CALL(glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_units));
+    max_batched_glyph_textures_ = std::max(
+        1, std::min(kMaxBatchedGlyphTextures, static_cast<int>(max_units)));
+  }
+  return max_batched_glyph_textures_;
+}
+
+Entity FlatuiTextSystem::CreateGlyphEntity(TextComponent* component,
+                                           bool link) {
+  Entity entity;
+  if (link) {
+    entity = CreateEntity(component, component->link_text_blueprint);
+    if (entity == kNullEntity) {
+      return kNullEntity;
+    }
+    component->link_entities.emplace_back(entity);
+    CopyAlpha(registry_, entity, component->GetEntity());
+  } else {
+    entity = CreateDefaultEntity(registry_, component->GetEntity());
+    component->plain_entities.emplace_back(entity);
+  }
+  return entity;
 }
 
 void FlatuiTextSystem::CreateLinkUnderlineEntity(TextComponent* component) {
@@ -108,6 +108,17 @@ class FlatuiTextSystem : public TextSystemImpl {
 
   Entity CreateEntity(TextComponent* component, const std::string& blueprint);
   void CreateTextEntities(TextComponent* component);
+  // Creates a single entity rendering all the slices of the component's text
+  // buffer, including links.  Returns false without creating anything if the
+  // slices can't be batched, in which case one entity per slice is needed.
+  bool CreateBatchedTextEntity(TextComponent* component,
+                               const mathfu::vec4& sdf_params);
+  // Returns the number of glyph cache textures that a batched text entity can
+  // use, limited by both the shader and GL_MAX_TEXTURE_IMAGE_UNITS.
+  int GetMaxBatchedGlyphTextures();
+  // Creates an entity to render glyphs, using the link text blueprint if
+  // |link| is true, and adds it to the component's plain or link entities.
+  Entity CreateGlyphEntity(TextComponent* component, bool link);
   void CreateLinkUnderlineEntity(TextComponent* component);
   void DestroyRenderEntities(TextComponent* component);
   void UpdateComponentUniform(Entity entity, HashValue pass, int submesh_index,
@@ -162,6 +173,9 @@ class FlatuiTextSystem : public TextSystemImpl {
   // Set of entities which need to have their rendering data refreshed. The
   // value of the map is the entity's desired_size_source.
   std::unordered_map<Entity, Entity> update_map_;
+
+  // Cached result of GetMaxBatchedGlyphTextures(), or 0 if not yet queried.
+  int max_batched_glyph_textures_ = 0;
 };
 
 }  // namespace lull
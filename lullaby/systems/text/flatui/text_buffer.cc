@@ -16,9 +16,11 @@ limitations under the License.
 
 #include "lullaby/systems/text/flatui/text_buffer.h"
 
+#include <algorithm>
 #include <array>
 
 #include "flatui/font_util.h"
+#include "lullaby/systems/text/detail/glyph_mesh.h"
 
 namespace lull {
 namespace {
@@ -171,6 +173,16 @@ bool TextBuffer::IsLinkSlice(size_t i) const {
   return attributes.get_underline();
 }
 
+bool TextBuffer::HasLinks() const {
+  const size_t num_slices = GetNumSlices();
+  for (size_t i = 0; i < num_slices; ++i) {
+    if (IsLinkSlice(i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void TextBuffer::Finalize() {
   // Font metrics definition from FlatUi:
   // ascender + descender = font size. Text is always aligned along baseline.
@@ -336,6 +348,36 @@ MeshData TextBuffer::BuildSliceMesh(size_t slice) const {
   return mesh;
 }
 
+MeshData TextBuffer::BuildBatchedMesh(
+    std::vector<fplbase::Texture*>* textures) const {
+  const auto* font_buffer = static_cast<const flatui::FontBuffer*>(font_buffer_);
+
+  std::vector<GlyphSlice> slices;
+  const size_t num_slices = GetNumSlices();
+  for (size_t i = 0; i < num_slices; ++i) {
+    const std::vector<uint16_t>& indices =
+        font_buffer->get_indices(static_cast<int>(i));
+    if (indices.empty()) {
+      continue;
+    }
+
+    // Link and plain slices can share a glyph cache texture, so only bind each
+    // texture once.
+    fplbase::Texture* texture = GetSliceTexture(i);
+    auto iter = std::find(textures->begin(), textures->end(), texture);
+    if (iter == textures->end()) {
+      iter = textures->insert(textures->end(), texture);
+    }
+    const int unit = static_cast<int>(iter - textures->begin());
+    slices.emplace_back(indices, unit, IsLinkSlice(i));
+  }
+
+  if (slices.empty()) {
+    return MeshData();
+  }
+  return BuildBatchedGlyphMesh(vertices_, slices);
+}
+
 MeshData TextBuffer::BuildUnderlineMesh() const {
   if (underline_vertices_.size() < 3) {
     return MeshData();
@@ -79,8 +79,17 @@ class TextBuffer {
   fplbase::Texture* GetSliceTexture(size_t i) const;
   bool IsLinkSlice(size_t i) const;
 
+  // Returns true if any of the slices are links.
+  bool HasLinks() const;
+
   MeshData BuildSliceMesh(size_t slice) const;
 
+  // Builds a single mesh for all the slices, including links.  The distinct
+  // slice textures are added to |textures|, and the vertices store the index of
+  // their slice's texture in |textures| (see BuildBatchedGlyphMesh).  Returns
+  // an empty mesh if there are no slices.
+  MeshData BuildBatchedMesh(std::vector<fplbase::Texture*>* textures) const;
+
   MeshData BuildUnderlineMesh() const;
 
   const Aabb& GetAabb() { return aabb_; }
@@ -41,6 +41,7 @@ struct TextComponent : Component {
   TextBufferPtr buffer = nullptr;
   bool loading_buffer = false;
   float edge_softness = 0.3f;
+  bool batch_slices = false;
   TextBufferParams text_buffer_params;
   std::string link_text_blueprint;
   std::string link_underline_blueprint;
@@ -154,9 +154,12 @@ bool EditText::Backspace() {
 }
 
 bool EditText::Insert(const char* utf8_cstr) {
-  std::string old = text_.str();
+  // Only the selection is replaced, so the text changes unless the selection
+  // is replaced by identical text.
+  std::string replaced;
   if (HasSelectionRegion()) {
     const size_t delete_len = selection_end_index_ - selection_start_index_;
+    replaced = text_.Substr(selection_start_index_, delete_len);
     text_.DeleteChars(selection_start_index_, delete_len);
 
     FixComposingRegionForDeletion(selection_start_index_, delete_len);
@@ -173,7 +176,7 @@ bool EditText::Insert(const char* utf8_cstr) {
 
   SetCaretPosition(selection_start_index_ + added);
 
-  return old != text_.str();
+  return replaced != utf8_cstr;
 }
 
 bool EditText::Insert(const std::string& utf8_str) {
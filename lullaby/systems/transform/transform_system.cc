@@ -51,6 +51,38 @@ size_t RoundAndClampIndex(int index, size_t list_size) {
 }  // namespace
 
 namespace lull {
+namespace {
+
+// The state of a single transform component as written by
+// TransformSystem::SaveSnapshot.
+struct TransformSnapshot {
+  template <typename Archive>
+  void Serialize(Archive archive) {
+    archive(&entity, ConstHash("entity"));
+    archive(&parent, ConstHash("parent"));
+    archive(&children, ConstHash("children"));
+    archive(&local_sqt, ConstHash("local_sqt"));
+    archive(&aabb_padding, ConstHash("aabb_padding"));
+    archive(&box, ConstHash("box"));
+    archive(&world_from_entity_mat, ConstHash("world_from_entity_mat"));
+    archive(&flags, ConstHash("flags"));
+    archive(&enable_self, ConstHash("enable_self"));
+    archive(&enabled, ConstHash("enabled"));
+  }
+
+  Entity entity = kNullEntity;
+  Entity parent = kNullEntity;
+  std::vector<Entity> children;
+  Sqt local_sqt;
+  Aabb aabb_padding;
+  Aabb box;
+  mathfu::mat4 world_from_entity_mat = mathfu::mat4::Identity();
+  Bits flags = 0;
+  bool enable_self = true;
+  bool enabled = true;
+};
+
+}  // namespace
 
 const TransformSystem::TransformFlags TransformSystem::kInvalidFlag = 0;
 const TransformSystem::TransformFlags TransformSystem::kAllFlags = ~0;
@@ -509,6 +541,11 @@ const mathfu::mat4* TransformSystem::GetWorldFromEntityMatrix(Entity e) const {
   return transform ? &transform->world_from_entity_mat : nullptr;
 }
 
+uint64_t TransformSystem::GetWorldRevision(Entity e) const {
+  auto transform = GetWorldTransform(e);
+  return transform ? transform->revision : 0;
+}
+
 void TransformSystem::SetWorldFromEntityMatrixFunction(
     Entity e, const CalculateWorldFromEntityMatrixFunc& func,
     const CalculateLocalSqtFunc* inverse_func) {
@@ -837,6 +874,7 @@ void TransformSystem::RecalculateWorldFromEntityMatrix(Entity child) {
   world_transform->world_from_entity_mat =
       node->world_from_entity_matrix_function(
           node->local_sqt, GetWorldFromEntityMatrix(node->parent));
+  world_transform->revision = ++world_revision_;
   for (const auto& grand_child : node->children) {
     RecalculateWorldFromEntityMatrix(grand_child);
   }
@@ -924,6 +962,68 @@ void TransformSystem::ReleaseFlag(TransformFlags flag) {
   reserved_flags_ = ClearBit(reserved_flags_, flag);
 }
 
+void TransformSystem::SaveSnapshot(SaveToBuffer* serializer) const {
+  size_t count = nodes_.Size();
+  Serialize(serializer, &count, ConstHash("count"));
+
+  TransformSnapshot snapshot;
+  nodes_.ForEach([&](const GraphNode& node) {
+    const Entity entity = node.GetEntity();
+    const WorldTransform* transform = world_transforms_.Get(entity);
+    snapshot.enabled = transform != nullptr;
+    if (!transform) {
+      transform = disabled_transforms_.Get(entity);
+    }
+    if (transform) {
+      snapshot.box = transform->box;
+      snapshot.world_from_entity_mat = transform->world_from_entity_mat;
+      snapshot.flags = transform->flags;
+    } else {
+      LOG(DFATAL) << "Encountered node without world transform!";
+    }
+
+    snapshot.entity = entity;
+    snapshot.parent = node.parent;
+    snapshot.children = node.children;
+    snapshot.local_sqt = node.local_sqt;
+    snapshot.aabb_padding = node.aabb_padding;
+    snapshot.enable_self = node.enable_self;
+    Serialize(serializer, &snapshot, ConstHash("transform"));
+  });
+}
+
+void TransformSystem::RestoreSnapshot(LoadFromBuffer* serializer) {
+  nodes_.Clear();
+  world_transforms_.Clear();
+  disabled_transforms_.Clear();
+  pending_children_.clear();
+
+  size_t count = 0;
+  Serialize(serializer, &count, ConstHash("count"));
+
+  TransformSnapshot snapshot;
+  for (size_t i = 0; i < count; ++i) {
+    Serialize(serializer, &snapshot, ConstHash("transform"));
+
+    GraphNode* node = nodes_.Emplace(snapshot.entity);
+    node->parent = snapshot.parent;
+    node->children = std::move(snapshot.children);
+    node->local_sqt = snapshot.local_sqt;
+    node->aabb_padding = snapshot.aabb_padding;
+    node->enable_self = snapshot.enable_self;
+    node->world_from_entity_matrix_function = CalculateWorldFromEntityMatrix;
+    node->local_sqt_function = CalculateLocalSqt;
+
+    WorldTransform* transform =
+        snapshot.enabled ? world_transforms_.Emplace(snapshot.entity)
+                         : disabled_transforms_.Emplace(snapshot.entity);
+    transform->box = snapshot.box;
+    transform->world_from_entity_mat = snapshot.world_from_entity_mat;
+    transform->revision = ++world_revision_;
+    transform->flags = snapshot.flags;
+  }
+}
+
 std::string TransformSystem::GetEntityTreeDebugString(bool enabled_only) const {
   const auto& blueprints =
       registry_->Get<EntityFactory>()->GetEntityToBlueprintMap();
@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "lullaby/modules/ecs/component.h"
 #include "lullaby/modules/ecs/system.h"
+#include "lullaby/modules/serialize/buffer_serializer.h"
 #include "lullaby/util/bits.h"
 #include "lullaby/util/math.h"
 #include "mathfu/constants.h"
@@ -160,6 +161,15 @@ class TransformSystem : public System {
   /// have a transform).
   const mathfu::mat4* GetWorldFromEntityMatrix(Entity e) const;
 
+  /// Returns a revision number that increases whenever the world matrix of any
+  /// entity changes.  It is 0 until the first world matrix is calculated.
+  uint64_t GetWorldRevision() const { return world_revision_; }
+
+  /// Returns the value of GetWorldRevision() when the world matrix of |e| last
+  /// changed, or 0 if |e| does not have a transform.  Systems can compare this
+  /// to a previously seen revision to skip entities that have not moved.
+  uint64_t GetWorldRevision(Entity e) const;
+
   /// Overrides the default math for calculating local->world and world->local
   /// transforms.
   void SetWorldFromEntityMatrixFunction(
@@ -295,6 +305,16 @@ class TransformSystem : public System {
   static mathfu::mat4 CalculateWorldFromEntityMatrix(
       const Sqt& local_sqt, const mathfu::mat4* world_from_parent_mat);
 
+  /// Writes the state of all transform components (including the hierarchy,
+  /// enabled state and flags) for use with the WorldSnapshot.  Custom
+  /// functions set with SetWorldFromEntityMatrixFunction are not saved; the
+  /// resulting world matrices are saved instead.
+  void SaveSnapshot(SaveToBuffer* serializer) const;
+
+  /// Replaces all transform components with the state written by
+  /// SaveSnapshot.  No events are sent.
+  void RestoreSnapshot(LoadFromBuffer* serializer);
+
  private:
   struct GraphNode : Component {
     explicit GraphNode(Entity e)
@@ -319,6 +339,7 @@ class TransformSystem : public System {
     Bits flags;
     mathfu::mat4 world_from_entity_mat;
     Aabb box;
+    uint64_t revision = 0;
   };
 
   static Sqt CalculateLocalSqt(const mathfu::mat4& world_from_entity_mat,
@@ -339,6 +360,7 @@ class TransformSystem : public System {
   ComponentPool<WorldTransform> world_transforms_;
   ComponentPool<WorldTransform> disabled_transforms_;
   uint32_t reserved_flags_;
+  uint64_t world_revision_ = 0;
 
   // A map of parent/child relationships requested by CreateChild, which need to
   // be handled during Create().
@@ -15,6 +15,12 @@ limitations under the License.
 */
 
 #include "lullaby/systems/animation/animation_system.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "flatbuffers/flatbuffers.h"
 #include "gtest/gtest.h"
 #include "lullaby/modules/animation_channels/transform_channels.h"
 #include "lullaby/modules/ecs/entity_factory.h"
@@ -22,10 +28,108 @@ limitations under the License.
 #include "lullaby/systems/transform/transform_system.h"
 #include "lullaby/tests/portable_test_macros.h"
 #include "lullaby/generated/transform_def_generated.h"
+#include "motive/anim_generated.h"
+#include "motive/engine.h"
+#include "motive/spline_anim_generated.h"
 
 namespace lull {
 namespace {
 
+// Creates an animation with a spline for each of the |end_values|, each of
+// which goes from 0 to its end value over one second.
+AnimationAssetPtr CreateSplineAnimation(const std::vector<float>& end_values) {
+  flatbuffers::FlatBufferBuilder fbb;
+  std::vector<flatbuffers::Offset<motive::CompactSplineFloatFb>> splines;
+  for (float end_value : end_values) {
+    const motive::CompactSplineFloatNodeFb nodes[] = {
+        motive::CompactSplineFloatNodeFb(0.f, 0.f, 0.f),
+        motive::CompactSplineFloatNodeFb(end_value, 1.f, 0.f),
+    };
+    splines.push_back(motive::CreateCompactSplineFloatFb(
+        fbb, 0.f, end_value, fbb.CreateVectorOfStructs(nodes, 2)));
+  }
+  fbb.Finish(motive::CreateCompactSplineAnimFloatFbDirect(fbb, &splines));
+
+  std::string data(reinterpret_cast<const char*>(fbb.GetBufferPointer()),
+                   fbb.GetSize());
+  auto asset = std::make_shared<AnimationAsset>();
+  asset->OnFinalize("test.splineanim", &data);
+  return asset;
+}
+
+// Creates a rig animation with a single bone whose x scale goes from 1 to
+// |end_scale| over one second.
+AnimationAssetPtr CreateRigAnimation(float end_scale) {
+  flatbuffers::FlatBufferBuilder fbb;
+  const motive::CompactSplineNodeFb nodes[] = {
+      motive::CompactSplineNodeFb(0, 0, 0),
+      motive::CompactSplineNodeFb(1000, 65535, 0),
+  };
+  const auto spline = motive::CreateCompactSplineFb(
+      fbb, 1.f, end_scale, 1.f, fbb.CreateVectorOfStructs(nodes, 2));
+  const std::vector<flatbuffers::Offset<motive::MatrixOpFb>> ops = {
+      motive::CreateMatrixOpFb(fbb, 0, motive::MatrixOperationTypeFb_kScaleX,
+                               motive::MatrixOpValueFb_CompactSplineFb,
+                               spline.Union()),
+  };
+  const std::vector<flatbuffers::Offset<motive::MatrixAnimFb>> matrix_anims =
+      {motive::CreateMatrixAnimFbDirect(fbb, &ops)};
+  const std::vector<uint8_t> bone_parents = {motive::kInvalidBoneIdx};
+  const std::vector<flatbuffers::Offset<flatbuffers::String>> bone_names = {
+      fbb.CreateString("root")};
+  motive::FinishRigAnimFbBuffer(
+      fbb, motive::CreateRigAnimFbDirect(fbb, &matrix_anims, &bone_parents,
+                                         &bone_names, false, "test"));
+
+  std::string data(reinterpret_cast<const char*>(fbb.GetBufferPointer()),
+                   fbb.GetSize());
+  auto asset = std::make_shared<AnimationAsset>();
+  asset->OnFinalize("test.motiveanim", &data);
+  return asset;
+}
+
+// Rig channel that records the x scale of each Entity's root bone, and how
+// often the pose was calculated rather than copied from a shared rig.
+class TestRigChannel : public AnimationChannel {
+ public:
+  static const HashValue kChannelName;
+
+  explicit TestRigChannel(Registry* registry)
+      : AnimationChannel(registry, 0, 32) {}
+
+  bool IsRigChannel() const override { return true; }
+
+  size_t GetNumSharedRigs() const { return shared_rigs_.size(); }
+
+  float GetScale(Entity entity) const {
+    auto iter = scales_.find(entity);
+    return iter != scales_.end() ? iter->second : 0.f;
+  }
+
+  int num_set_rigs = 0;
+  int num_set_shared_rigs = 0;
+
+ private:
+  void Set(Entity entity, const float* values, size_t len) override {}
+
+  void SetRig(Entity entity, const mathfu::AffineTransform* values,
+              size_t len) override {
+    ++num_set_rigs;
+    scales_[entity] = values[0][0];
+  }
+
+  void SetSharedRig(Entity entity, Entity source,
+                    const mathfu::AffineTransform* values,
+                    size_t len) override {
+    ++num_set_shared_rigs;
+    scales_[entity] = scales_[source];
+  }
+
+  std::unordered_map<Entity, float> scales_;
+};
+
+const HashValue TestRigChannel::kChannelName = ConstHash("test-rig");
+
 class AnimationSystemTest : public testing::Test {
  public:
   void SetUp() override {
@@ -131,6 +235,251 @@ TEST_F(AnimationSystemTest, CreateWithDelay) {
   EXPECT_NEAR(sqt->scale.z, 30.f, kEpsilon);
 }
 
+TEST_F(AnimationSystemTest, PlaySplineAnimation) {
+  Blueprint blueprint(512);
+  {
+    TransformDefT transform;
+    blueprint.Write(&transform);
+  }
+
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  const Entity entity = entity_factory->Create(&blueprint);
+
+  auto animation_system = registry_->Get<AnimationSystem>();
+  const AnimationId id = animation_system->PlayAnimation(
+      entity, PositionChannel::kChannelName,
+      CreateSplineAnimation({1.f, 2.f, 3.f}), PlaybackParameters());
+  EXPECT_NE(id, kNullAnimation);
+  EXPECT_TRUE(animation_system->IsAnimationPlaying(id));
+  animation_system->AdvanceFrame(std::chrono::seconds(1));
+
+  auto transform_system = registry_->Get<TransformSystem>();
+  const Sqt* sqt = transform_system->GetSqt(entity);
+
+  static const float kEpsilon = 0.001f;
+
+  EXPECT_NE(sqt, nullptr);
+  EXPECT_NEAR(sqt->translation.x, 1.f, kEpsilon);
+  EXPECT_NEAR(sqt->translation.y, 2.f, kEpsilon);
+  EXPECT_NEAR(sqt->translation.z, 3.f, kEpsilon);
+}
+
+TEST_F(AnimationSystemTest, PlaySplineAnimationBlends) {
+  Blueprint blueprint(512);
+  {
+    TransformDefT transform;
+    blueprint.Write(&transform);
+  }
+
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  const Entity entity = entity_factory->Create(&blueprint);
+
+  auto animation_system = registry_->Get<AnimationSystem>();
+  auto transform_system = registry_->Get<TransformSystem>();
+  const AnimationAssetPtr anim = CreateSplineAnimation({4.f, 4.f, 4.f});
+  PlaybackParameters params;
+  animation_system->PlayAnimation(entity, PositionChannel::kChannelName, anim,
+                                  params);
+  animation_system->AdvanceFrame(std::chrono::milliseconds(500));
+  const float x = transform_system->GetSqt(entity)->translation.x;
+  EXPECT_GT(x, 1.f);
+
+  // Restarting the animation with a blend starts from the current position
+  // rather than jumping back to the start of the splines.
+  params.blend_time_s = 0.5f;
+  animation_system->PlayAnimation(entity, PositionChannel::kChannelName, anim,
+                                  params);
+  animation_system->AdvanceFrame(std::chrono::milliseconds(10));
+  EXPECT_GT(transform_system->GetSqt(entity)->translation.x, x / 2.f);
+
+  // Without a blend, it does jump back.
+  params.blend_time_s = 0.f;
+  animation_system->PlayAnimation(entity, PositionChannel::kChannelName, anim,
+                                  params);
+  animation_system->AdvanceFrame(std::chrono::milliseconds(10));
+  EXPECT_LT(transform_system->GetSqt(entity)->translation.x, x / 2.f);
+}
+
+TEST_F(AnimationSystemTest, PlaySplineAnimationWithFewerSplines) {
+  Blueprint blueprint(512);
+  {
+    TransformDefT transform;
+    blueprint.Write(&transform);
+  }
+
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  const Entity entity = entity_factory->Create(&blueprint);
+
+  // The dimensions without a spline are driven to their operations' default
+  // values.
+  auto animation_system = registry_->Get<AnimationSystem>();
+  animation_system->PlayAnimation(entity, ScaleChannel::kChannelName,
+                                  CreateSplineAnimation({4.f}),
+                                  PlaybackParameters());
+  animation_system->AdvanceFrame(std::chrono::seconds(1));
+
+  auto transform_system = registry_->Get<TransformSystem>();
+  const Sqt* sqt = transform_system->GetSqt(entity);
+
+  static const float kEpsilon = 0.001f;
+
+  EXPECT_NE(sqt, nullptr);
+  EXPECT_NEAR(sqt->scale.x, 4.f, kEpsilon);
+  EXPECT_NEAR(sqt->scale.y, 1.f, kEpsilon);
+  EXPECT_NEAR(sqt->scale.z, 1.f, kEpsilon);
+}
+
+TEST_F(AnimationSystemTest, SharesRigPlayback) {
+  auto* rig_channel = new TestRigChannel(registry_.get());
+  auto animation_system = registry_->Get<AnimationSystem>();
+  animation_system->AddChannel(TestRigChannel::kChannelName,
+                               AnimationChannelPtr(rig_channel));
+
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  const Entity a = entity_factory->Create();
+  const Entity b = entity_factory->Create();
+  const Entity c = entity_factory->Create();
+  const AnimationAssetPtr anim = CreateRigAnimation(5.f);
+
+  animation_system->PlayAnimation(a, TestRigChannel::kChannelName, anim,
+                                  PlaybackParameters());
+  animation_system->PlayAnimation(b, TestRigChannel::kChannelName, anim,
+                                  PlaybackParameters());
+  EXPECT_TRUE(rig_channel->IsShared(a));
+  EXPECT_TRUE(rig_channel->IsShared(b));
+  EXPECT_EQ(rig_channel->GetNumSharedRigs(), 1u);
+
+  // Only one of the Entities' poses is calculated.
+  animation_system->AdvanceFrame(std::chrono::milliseconds(500));
+  EXPECT_EQ(rig_channel->num_set_rigs, 1);
+  EXPECT_EQ(rig_channel->num_set_shared_rigs, 1);
+  EXPECT_GT(rig_channel->GetScale(a), 1.f);
+  EXPECT_EQ(rig_channel->GetScale(a), rig_channel->GetScale(b));
+
+  // Playback started on a later frame is out of phase, so it isn't shared with
+  // the earlier Entities.
+  animation_system->PlayAnimation(c, TestRigChannel::kChannelName, anim,
+                                  PlaybackParameters());
+  EXPECT_TRUE(rig_channel->IsShared(c));
+  EXPECT_EQ(rig_channel->GetNumSharedRigs(), 2u);
+}
+
+TEST_F(AnimationSystemTest, ReleasesSharedRigOnCancel) {
+  auto* rig_channel = new TestRigChannel(registry_.get());
+  auto animation_system = registry_->Get<AnimationSystem>();
+  animation_system->AddChannel(TestRigChannel::kChannelName,
+                               AnimationChannelPtr(rig_channel));
+
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  const Entity a = entity_factory->Create();
+  const Entity b = entity_factory->Create();
+  const AnimationAssetPtr anim = CreateRigAnimation(5.f);
+
+  animation_system->PlayAnimation(a, TestRigChannel::kChannelName, anim,
+                                  PlaybackParameters());
+  animation_system->PlayAnimation(b, TestRigChannel::kChannelName, anim,
+                                  PlaybackParameters());
+
+  // The shared rig outlives the first Entity to stop using it.
+  animation_system->CancelAnimation(a, TestRigChannel::kChannelName);
+  EXPECT_FALSE(rig_channel->IsShared(a));
+  EXPECT_TRUE(rig_channel->IsShared(b));
+  EXPECT_EQ(rig_channel->GetNumSharedRigs(), 1u);
+
+  animation_system->AdvanceFrame(std::chrono::milliseconds(500));
+  EXPECT_EQ(rig_channel->num_set_rigs, 1);
+  EXPECT_GT(rig_channel->GetScale(b), 1.f);
+  EXPECT_EQ(rig_channel->GetScale(a), 0.f);
+
+  animation_system->CancelAnimation(b, TestRigChannel::kChannelName);
+  EXPECT_FALSE(rig_channel->IsShared(b));
+  EXPECT_EQ(rig_channel->GetNumSharedRigs(), 0u);
+}
+
+TEST_F(AnimationSystemTest, UnshareContinuesFromSharedPose) {
+  auto* rig_channel = new TestRigChannel(registry_.get());
+  auto animation_system = registry_->Get<AnimationSystem>();
+  animation_system->AddChannel(TestRigChannel::kChannelName,
+                               AnimationChannelPtr(rig_channel));
+
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  const Entity a = entity_factory->Create();
+  const Entity b = entity_factory->Create();
+  const AnimationAssetPtr anim = CreateRigAnimation(5.f);
+
+  animation_system->PlayAnimation(a, TestRigChannel::kChannelName, anim,
+                                  PlaybackParameters());
+  animation_system->PlayAnimation(b, TestRigChannel::kChannelName, anim,
+                                  PlaybackParameters());
+  animation_system->AdvanceFrame(std::chrono::milliseconds(400));
+  const float scale = rig_channel->GetScale(b);
+
+  // Unsharing (here by setting the unchanged rate) doesn't restart the
+  // animation or put it out of phase.
+  animation_system->SetPlaybackRate(a, TestRigChannel::kChannelName, 1.f);
+  EXPECT_FALSE(rig_channel->IsShared(a));
+  EXPECT_TRUE(rig_channel->IsShared(b));
+
+  animation_system->AdvanceFrame(std::chrono::milliseconds(100));
+  EXPECT_EQ(rig_channel->num_set_rigs, 3);
+  EXPECT_GT(rig_channel->GetScale(b), scale);
+  EXPECT_NEAR(rig_channel->GetScale(a), rig_channel->GetScale(b), 0.01f);
+}
+
+TEST_F(AnimationSystemTest, SetPlaybackRateUnsharesRig) {
+  auto* rig_channel = new TestRigChannel(registry_.get());
+  auto animation_system = registry_->Get<AnimationSystem>();
+  animation_system->AddChannel(TestRigChannel::kChannelName,
+                               AnimationChannelPtr(rig_channel));
+
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  const Entity a = entity_factory->Create();
+  const Entity b = entity_factory->Create();
+  const AnimationAssetPtr anim = CreateRigAnimation(5.f);
+
+  animation_system->PlayAnimation(a, TestRigChannel::kChannelName, anim,
+                                  PlaybackParameters());
+  animation_system->PlayAnimation(b, TestRigChannel::kChannelName, anim,
+                                  PlaybackParameters());
+  animation_system->AdvanceFrame(std::chrono::milliseconds(100));
+
+  // Changing the rate only affects the Entity it was set on.
+  animation_system->SetPlaybackRate(a, TestRigChannel::kChannelName, 2.f);
+  EXPECT_FALSE(rig_channel->IsShared(a));
+  EXPECT_TRUE(rig_channel->IsShared(b));
+  EXPECT_EQ(rig_channel->GetNumSharedRigs(), 1u);
+
+  animation_system->AdvanceFrame(std::chrono::milliseconds(200));
+  EXPECT_GT(rig_channel->GetScale(a), rig_channel->GetScale(b));
+}
+
+TEST_F(AnimationSystemTest, PlaySharedFallsBackOnKeyCollision) {
+  motive::MotiveEngine engine;
+  TestRigChannel rig_channel(registry_.get());
+
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  const Entity a = entity_factory->Create();
+  const Entity b = entity_factory->Create();
+  const AnimationAssetPtr anim_a = CreateRigAnimation(5.f);
+  const AnimationAssetPtr anim_b = CreateRigAnimation(2.f);
+  const motive::RigAnim* rig_a = anim_a->GetRigAnim(0);
+  const motive::RigAnim* rig_b = anim_b->GetRigAnim(0);
+  const HashValue key = Hash("collision");
+
+  rig_channel.PlayShared(a, &engine, 1, key, rig_a, rig_a,
+                         PlaybackParameters(), 0);
+  EXPECT_TRUE(rig_channel.IsShared(a));
+
+  // A different animation with the same key plays on its own motivator.
+  rig_channel.PlayShared(b, &engine, 2, key, rig_b, rig_b,
+                         PlaybackParameters(), 0);
+  EXPECT_TRUE(rig_channel.IsShared(a));
+  EXPECT_FALSE(rig_channel.IsShared(b));
+  EXPECT_EQ(rig_channel.GetNumSharedRigs(), 1u);
+  EXPECT_EQ(rig_channel.CurrentRigAnim(a), rig_a);
+  EXPECT_EQ(rig_channel.CurrentRigAnim(b), rig_b);
+}
+
 TEST(AnimationSystemDeathTest, SplitListFilenameAndIndex) {
   std::string filename;
   int index = 0;
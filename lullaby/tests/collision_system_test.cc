@@ -172,6 +172,60 @@ TEST_F(CollisionSystemTest, CheckForCollision) {
   }
 }
 
+TEST_F(CollisionSystemTest, CheckForCollisions) {
+  auto* entity_factory = registry_->Get<EntityFactory>();
+  auto* transform_system = registry_->Get<TransformSystem>();
+  auto* collision_system = registry_->Get<CollisionSystem>();
+
+  Blueprint blueprint1;
+  {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(0.f, 0.f, -4.f);
+    CollisionDefT collision;
+    blueprint1.Write(&transform);
+    blueprint1.Write(&collision);
+  }
+  const Entity entity1 = entity_factory->Create(&blueprint1);
+  transform_system->SetAabb(entity1, Aabb(-mathfu::kOnes3f, mathfu::kOnes3f));
+
+  Blueprint blueprint2;
+  {
+    TransformDefT transform;
+    transform.position = mathfu::vec3(0.f, 0.f, -2.f);
+    transform.rotation = mathfu::vec3(0.f, 30.f, 0.f);
+    CollisionDefT collision;
+    collision.collision_on_exit = true;
+    blueprint2.Write(&transform);
+    blueprint2.Write(&collision);
+  }
+  const Entity entity2 = entity_factory->Create(&blueprint2);
+  transform_system->SetAabb(entity2, Aabb(-mathfu::kOnes3f / 2.f,
+                                          mathfu::kOnes3f / 2.f));
+
+  const Ray rays[] = {
+      Ray(mathfu::kZeros3f, -mathfu::kAxisZ3f),
+      Ray(mathfu::vec3(0.75f, 0.f, 0.f), -mathfu::kAxisZ3f),
+      Ray(mathfu::vec3(2.f, 0.f, 0.f), -mathfu::kAxisZ3f),
+      Ray(mathfu::vec3(0.f, 0.f, -2.f), mathfu::kAxisX3f),
+      Ray(mathfu::vec3(0.1f, 0.2f, 1.f),
+          mathfu::vec3(0.f, -0.1f, -1.f).Normalized()),
+  };
+  const size_t kNumRays = sizeof(rays) / sizeof(rays[0]);
+
+  CollisionSystem::CollisionResult results[kNumRays];
+  collision_system->CheckForCollisions(rays, results);
+
+  // The batched results must match the single ray results exactly.
+  for (size_t i = 0; i < kNumRays; ++i) {
+    const auto expected = collision_system->CheckForCollision(rays[i]);
+    EXPECT_EQ(results[i].entity, expected.entity);
+    EXPECT_EQ(results[i].distance, expected.distance);
+  }
+  EXPECT_EQ(results[0].entity, entity2);
+  EXPECT_EQ(results[1].entity, entity1);
+  EXPECT_EQ(results[2].entity, kNullEntity);
+}
+
 TEST_F(CollisionSystemTest, CheckForCollisionReverseOrder) {
   Blueprint blueprint1;
   {
@@ -0,0 +1,148 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <mutex>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/config/config.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+
+// Number of values in the config, roughly that of a typical app config.
+constexpr int kNumValues = 64;
+const HashValue kKey = ConstHash("lull.Render.ResetState");
+
+void PopulateConfig(Config* config) {
+  VariantMap values;
+  for (int i = 0; i < kNumValues; ++i) {
+    values[Hash(("key_" + std::to_string(i)).c_str())] = i;
+  }
+  values[kKey] = true;
+  config->SetAll(values);
+}
+
+// The mutex-protected map that Config used before it published snapshots.
+class LockedConfig {
+ public:
+  void Set(HashValue key, Variant value) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    values_[key] = std::move(value);
+  }
+
+  template <typename T>
+  T Get(HashValue key, const T& default_value) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto iter = values_.find(key);
+    if (iter == values_.end()) {
+      return default_value;
+    }
+    const T* ptr = iter->second.Get<T>();
+    return ptr ? *ptr : default_value;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  VariantMap values_;
+};
+
+// The configs are shared by all benchmark threads, so are created once and
+// never destroyed.
+LockedConfig* GetLockedConfig() {
+  static LockedConfig* config = []() {
+    auto* config = new LockedConfig();
+    for (int i = 0; i < kNumValues; ++i) {
+      config->Set(Hash(("key_" + std::to_string(i)).c_str()), i);
+    }
+    config->Set(kKey, true);
+    return config;
+  }();
+  return config;
+}
+
+Config* GetConfig() {
+  static Config* config = []() {
+    auto* config = new Config();
+    PopulateConfig(config);
+    return config;
+  }();
+  return config;
+}
+
+static void BM_LockedMapGet(benchmark::State& state) {
+  const LockedConfig* config = GetLockedConfig();
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(config->Get(kKey, false));
+  }
+}
+BENCHMARK(BM_LockedMapGet)->ThreadRange(1, 4);
+
+static void BM_ConfigGet(benchmark::State& state) {
+  const Config* config = GetConfig();
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(config->Get(kKey, false));
+  }
+}
+BENCHMARK(BM_ConfigGet)->ThreadRange(1, 4);
+
+static void BM_ConfigValueGet(benchmark::State& state) {
+  // Each thread has its own ConfigValue.
+  ConfigValue<bool> value(GetConfig(), kKey, false);
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(value.Get());
+  }
+}
+BENCHMARK(BM_ConfigValueGet)->ThreadRange(1, 4);
+
+// Like BM_ConfigValueGet, but every thread also modifies the config every 1000
+// iterations, which forces all threads to re-read the value.
+static void BM_ConfigValueGetWithWrites(benchmark::State& state) {
+  Config* config = GetConfig();
+  ConfigValue<bool> value(config, kKey, false);
+  int count = 0;
+  while (state.KeepRunning()) {
+    if (++count == 1000) {
+      count = 0;
+      config->Set(kKey, true);
+    }
+    benchmark::DoNotOptimize(value.Get());
+  }
+}
+BENCHMARK(BM_ConfigValueGetWithWrites)->ThreadRange(1, 4);
+
+// This test verifies that all benchmarked paths read the same value.
+TEST(ConfigBenchmarkTest, BenchmarkTestVerification) {
+  Config config;
+  PopulateConfig(&config);
+  ConfigValue<bool> value(&config, kKey, false);
+  EXPECT_TRUE(config.Get(kKey, false));
+  EXPECT_TRUE(value.Get());
+
+  config.Set(kKey, false);
+  EXPECT_FALSE(config.Get(kKey, true));
+  EXPECT_FALSE(value.Get());
+
+  ConfigValue<int> int_value(&config, Hash("key_7"), -1);
+  EXPECT_THAT(int_value.Get(), Eq(7));
+}
+
+}  // namespace
+}  // namespace lull
@@ -16,6 +16,11 @@ limitations under the License.
 
 #include "lullaby/modules/config/config.h"
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "lullaby/generated/config_def_generated.h"
@@ -28,6 +33,8 @@ namespace lull {
 namespace {
 
 using ::testing::Eq;
+using ::testing::Ge;
+using ::testing::Le;
 
 TEST(ConfigTest, Empty) {
   const HashValue key = Hash("key");
@@ -59,6 +66,114 @@ TEST(ConfigTest, Remove) {
   EXPECT_THAT(cfg.Get(key, 12), Eq(12));
 }
 
+TEST(ConfigTest, SnapshotIsImmutable) {
+  const HashValue key = Hash("key");
+
+  Config cfg;
+  cfg.Set(key, 34);
+  const Config::SnapshotPtr snapshot = cfg.GetSnapshot();
+  const uint64_t version = cfg.GetVersion();
+  EXPECT_THAT(snapshot->GetVersion(), Eq(version));
+
+  cfg.Set(key, 56);
+  cfg.Remove(Hash("other_key"));
+  EXPECT_THAT(snapshot->Get(key, 12), Eq(34));
+  EXPECT_THAT(cfg.Get(key, 12), Eq(56));
+  EXPECT_THAT(cfg.GetVersion(), Eq(version + 2));
+  EXPECT_THAT(cfg.GetSnapshot()->GetVersion(), Eq(version + 2));
+}
+
+TEST(ConfigTest, SetAll) {
+  VariantMap values;
+  values[Hash("int_key")] = 123;
+  values[Hash("float_key")] = 456.f;
+
+  Config cfg;
+  cfg.Set(Hash("int_key"), 1);
+  cfg.Set(Hash("bool_key"), true);
+  const uint64_t version = cfg.GetVersion();
+  cfg.SetAll(values);
+  EXPECT_THAT(cfg.GetVersion(), Eq(version + 1));
+  EXPECT_THAT(cfg.Get(Hash("int_key"), 0), Eq(123));
+  EXPECT_THAT(cfg.Get(Hash("float_key"), 0.f), Eq(456.f));
+  EXPECT_TRUE(cfg.Get(Hash("bool_key"), false));
+}
+
+TEST(ConfigTest, ConfigValue) {
+  const HashValue key = Hash("key");
+
+  Config cfg;
+  ConfigValue<int> value(&cfg, key, 12);
+  EXPECT_THAT(value.Get(), Eq(12));
+
+  cfg.Set(key, 34);
+  EXPECT_THAT(value.Get(), Eq(34));
+  EXPECT_THAT(value.Get(), Eq(34));
+
+  // Values of the wrong type are ignored.
+  cfg.Set(key, 5.f);
+  EXPECT_THAT(value.Get(), Eq(12));
+
+  cfg.Remove(key);
+  EXPECT_THAT(value.Get(), Eq(12));
+}
+
+TEST(ConfigTest, ConfigValueWithoutConfig) {
+  ConfigValue<int> value(nullptr, Hash("key"), 12);
+  EXPECT_THAT(value.Get(), Eq(12));
+
+  ConfigValue<std::string> empty;
+  EXPECT_THAT(empty.Get(), Eq(""));
+}
+
+// Reads values on several threads while another thread keeps writing them, and
+// checks that every read sees a consistent, monotonically increasing value.
+TEST(ConfigTest, ConcurrentReadsAndWrites) {
+  const int kNumReaders = 4;
+  const int kNumWrites = 2000;
+  const HashValue int_key = Hash("int_key");
+  const HashValue string_key = Hash("string_key");
+
+  Config cfg;
+  std::atomic<bool> done(false);
+  std::vector<std::thread> readers;
+  for (int i = 0; i < kNumReaders; ++i) {
+    readers.emplace_back([&]() {
+      ConfigValue<int> int_value(&cfg, int_key, 0);
+      ConfigValue<std::string> string_value(&cfg, string_key, "0");
+      int last_value = 0;
+      while (!done) {
+        const int value = int_value.Get();
+        EXPECT_THAT(value, Ge(last_value));
+        last_value = value;
+
+        // Both values are written together, so a snapshot always holds the
+        // same number in both.
+        const Config::SnapshotPtr snapshot = cfg.GetSnapshot();
+        EXPECT_THAT(snapshot->Get(string_key, std::string("0")),
+                    Eq(std::to_string(snapshot->Get(int_key, 0))));
+
+        // A ConfigValue may be a write behind the snapshot taken after it,
+        // but never ahead of it.
+        const int cached = std::stoi(string_value.Get());
+        EXPECT_THAT(cached, Le(cfg.Get(int_key, 0)));
+      }
+      EXPECT_THAT(int_value.Get(), Eq(kNumWrites));
+    });
+  }
+
+  for (int i = 1; i <= kNumWrites; ++i) {
+    VariantMap values;
+    values[int_key] = i;
+    values[string_key] = std::to_string(i);
+    cfg.SetAll(values);
+  }
+  done = true;
+  for (std::thread& reader : readers) {
+    reader.join();
+  }
+}
+
 template <typename T>
 void AddVariant(ConfigDefT* def, const std::string& key,
                 const decltype(T::value) & value) {
@@ -0,0 +1,187 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/debug/debug_render_impl.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Invoke;
+using ::testing::IsEmpty;
+using ::testing::Return;
+using ::testing::_;
+
+const Color4ub kRed(255, 0, 0, 255);
+const Color4ub kGreen(0, 255, 0, 255);
+
+// Summary of a single DrawMesh() call.
+struct Draw {
+  MeshData::PrimitiveType type;
+  uint32_t num_vertices;
+  size_t num_indices;
+};
+
+bool operator==(const Draw& lhs, const Draw& rhs) {
+  return lhs.type == rhs.type && lhs.num_vertices == rhs.num_vertices &&
+         lhs.num_indices == rhs.num_indices;
+}
+
+class DebugRenderImplTest : public ::testing::Test {
+ protected:
+  DebugRenderImplTest() {
+    auto* entity_factory = registry_.Create<EntityFactory>(&registry_);
+    render_system_ = entity_factory->CreateSystem<RenderSystem>();
+
+    RenderSystemImpl* mock = render_system_->GetImpl();
+    EXPECT_CALL(*mock, LoadShader(_)).WillRepeatedly(Return(ShaderPtr()));
+    EXPECT_CALL(*mock, LoadTexture(_, _)).WillRepeatedly(Return(TexturePtr()));
+    ON_CALL(*mock, DrawMesh(_))
+        .WillByDefault(Invoke([this](const MeshData& mesh) {
+          const Draw draw = {mesh.GetPrimitiveType(), mesh.GetNumVertices(),
+                             mesh.GetNumIndices()};
+          draws_.push_back(draw);
+        }));
+
+    for (RenderSystem::View& view : views_) {
+      view.dimensions = mathfu::vec2i(100, 100);
+      view.world_from_eye_matrix = mathfu::mat4::Identity();
+      view.clip_from_eye_matrix = mathfu::mat4::Identity();
+      view.clip_from_world_matrix = mathfu::mat4::Identity();
+    }
+
+    debug_render_.reset(new DebugRenderImpl(&registry_));
+  }
+
+  static constexpr size_t kNumViews = 2;
+
+  Registry registry_;
+  RenderSystem* render_system_;
+  RenderSystem::View views_[kNumViews];
+  std::unique_ptr<DebugRenderImpl> debug_render_;
+  std::vector<Draw> draws_;
+};
+
+TEST_F(DebugRenderImplTest, NothingDrawn) {
+  debug_render_->Begin(views_, kNumViews);
+  debug_render_->End();
+  EXPECT_THAT(draws_, IsEmpty());
+}
+
+TEST_F(DebugRenderImplTest, BatchesShapes) {
+  const Aabb box(mathfu::vec3(-1, -1, -1), mathfu::vec3(1, 1, 1));
+
+  debug_render_->Begin(views_, kNumViews);
+  for (int i = 0; i < 100; ++i) {
+    debug_render_->DrawLine(mathfu::kZeros3f, mathfu::kOnes3f, kRed);
+    debug_render_->DrawBox3D(mathfu::mat4::Identity(), box, kGreen);
+  }
+  EXPECT_THAT(draws_, IsEmpty());
+  debug_render_->End();
+
+  const Draw lines = {MeshData::kLines, 200, 0};
+  const Draw boxes = {MeshData::kTriangles, 800, 3600};
+  EXPECT_THAT(draws_, ElementsAre(lines, boxes, lines, boxes));
+}
+
+TEST_F(DebugRenderImplTest, BatchesTextByColor) {
+  debug_render_->Begin(views_, kNumViews);
+  for (int i = 0; i < 10; ++i) {
+    debug_render_->DrawText3D(mathfu::kZeros3f, kRed, "AB");
+    debug_render_->DrawText2D(kGreen, "C");
+  }
+  debug_render_->End();
+
+  // One draw for each color in each view.
+  const Draw red = {MeshData::kTriangles, 80, 120};
+  const Draw green = {MeshData::kTriangles, 40, 60};
+  EXPECT_THAT(draws_, ElementsAre(red, green, red, green));
+}
+
+TEST_F(DebugRenderImplTest, BatchesQuadsByColor) {
+  debug_render_->Begin(views_, kNumViews);
+  for (int i = 0; i < 10; ++i) {
+    debug_render_->DrawQuad2D(kRed, 0.f, 0.f, 1.f, 1.f, TexturePtr());
+    debug_render_->DrawQuad2DAbsolute(
+        Color4ub::ToVec4(kRed), mathfu::vec2(0, 0), mathfu::kZeros2f,
+        mathfu::vec2(10, 10), mathfu::kOnes2f, TexturePtr());
+  }
+  debug_render_->DrawQuad2D(kGreen, 0.f, 0.f, 1.f, 1.f, TexturePtr());
+  debug_render_->End();
+
+  const Draw red = {MeshData::kTriangles, 80, 120};
+  const Draw green = {MeshData::kTriangles, 4, 6};
+  EXPECT_THAT(draws_, ElementsAre(red, green, red, green));
+}
+
+TEST_F(DebugRenderImplTest, PreservesOrderBetweenKinds) {
+  debug_render_->Begin(views_, 1);
+  debug_render_->DrawLine(mathfu::kZeros3f, mathfu::kOnes3f, kRed);
+  debug_render_->DrawLine(mathfu::kZeros3f, mathfu::kOnes3f, kGreen);
+  debug_render_->DrawQuad2D(kRed, 0.f, 0.f, 1.f, 1.f, TexturePtr());
+  debug_render_->DrawText3D(mathfu::kZeros3f, kRed, "A");
+  debug_render_->DrawLine(mathfu::kZeros3f, mathfu::kOnes3f, kRed);
+  debug_render_->DrawText3D(mathfu::kZeros3f, kRed, "B");
+  debug_render_->End();
+
+  // Each run of primitives of the same kind is drawn before the next one, so
+  // later primitives draw on top of earlier ones.
+  const Draw lines = {MeshData::kLines, 4, 0};
+  const Draw quad = {MeshData::kTriangles, 4, 6};
+  const Draw text = {MeshData::kTriangles, 4, 6};
+  const Draw line = {MeshData::kLines, 2, 0};
+  EXPECT_THAT(draws_, ElementsAre(lines, quad, text, line, text));
+}
+
+TEST_F(DebugRenderImplTest, DrawsFullBatchesEarly) {
+  const Aabb box(mathfu::vec3(-1, -1, -1), mathfu::vec3(1, 1, 1));
+  const int kBoxesPerBatch = 65536 / 8;
+
+  debug_render_->Begin(views_, 1);
+  for (int i = 0; i < kBoxesPerBatch + 1; ++i) {
+    debug_render_->DrawBox3D(mathfu::mat4::Identity(), box, kGreen);
+  }
+  EXPECT_THAT(draws_.size(), Eq(1u));
+  debug_render_->End();
+
+  const Draw full = {MeshData::kTriangles, 65536, 36 * kBoxesPerBatch};
+  const Draw rest = {MeshData::kTriangles, 8, 36};
+  EXPECT_THAT(draws_, ElementsAre(full, rest));
+}
+
+TEST_F(DebugRenderImplTest, StartsEmptyEachFrame) {
+  debug_render_->Begin(views_, 1);
+  debug_render_->DrawLine(mathfu::kZeros3f, mathfu::kOnes3f, kRed);
+  debug_render_->End();
+  draws_.clear();
+
+  debug_render_->Begin(views_, 1);
+  debug_render_->End();
+  EXPECT_THAT(draws_, IsEmpty());
+}
+
+}  // namespace
+}  // namespace lull
@@ -275,6 +275,37 @@ TEST_F(DispatcherSystemTest, MultipleEntitiesQueued) {
   EXPECT_THAT(order, ElementsAre(entity1, entity2, entity2, entity1));
 }
 
+TEST_F(DispatcherSystemTest, QueuedEventsGroupedByEntity) {
+  const Entity entity1 = Hash("test");
+  const Entity entity2 = Hash("test2");
+  DispatcherSystem::EnableQueuedDispatch();
+
+  std::vector<std::pair<Entity, int>> order;
+  dispatcher_->Connect(entity1, [&](const EventClass& e) {
+    order.emplace_back(entity1, e.value);
+  });
+  dispatcher_->Connect(entity2, [&](const EventClass& e) {
+    order.emplace_back(entity2, e.value);
+    // Events sent while dispatching are dispatched in the same call.
+    if (e.value == 2) {
+      dispatcher_->Send(entity1, EventClass(4));
+    }
+  });
+
+  dispatcher_->Send(entity2, EventClass(1));
+  dispatcher_->Send(entity1, EventClass(2));
+  dispatcher_->Send(entity2, EventClass(2));
+  dispatcher_->Send(entity1, EventClass(3));
+  EXPECT_TRUE(order.empty());
+
+  dispatcher_->Dispatch();
+  EXPECT_THAT(order, ElementsAre(std::make_pair(entity2, 1),
+                                 std::make_pair(entity2, 2),
+                                 std::make_pair(entity1, 2),
+                                 std::make_pair(entity1, 3),
+                                 std::make_pair(entity1, 4)));
+}
+
 TEST_F(DispatcherSystemTest, SendImmediately) {
   const Entity entity = Hash("test");
   DispatcherSystem::EnableQueuedDispatch();
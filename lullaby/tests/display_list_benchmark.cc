@@ -0,0 +1,136 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/component.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/render/detail/display_list.h"
+#include "lullaby/systems/transform/transform_system.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Le;
+
+// The number of renderable entities, which is roughly what the FPL backend
+// draws in a dense scene.
+constexpr int kNumEntities = 50000;
+
+// Mirrors the parts of the FPL RenderComponent used by the DisplayList.
+struct TestRenderComponent : Component {
+  explicit TestRenderComponent(Entity e) : Component(e) {}
+
+  RenderSortOrder sort_order = 0;
+};
+
+using DisplayList = detail::DisplayList<TestRenderComponent>;
+using RenderPool = detail::RenderPool<TestRenderComponent>;
+
+// A pool of entities spread through a 200m cube in front of the camera, along
+// with some entities that are not rendered so that the display list has to
+// filter them out.
+struct Scene {
+  Scene() {
+    registry.Create<Dispatcher>();
+    auto* entity_factory = registry.Create<EntityFactory>(&registry);
+    auto* transform_system = entity_factory->CreateSystem<TransformSystem>();
+    pool.reset(new RenderPool(&registry, kNumEntities));
+
+    for (int i = 0; i < kNumEntities * 2; ++i) {
+      const float x = static_cast<float>((i * 7919) % 200) - 100.f;
+      const float y = static_cast<float>((i * 104729) % 200) - 100.f;
+      const float z = -static_cast<float>((i * 15485863) % 200);
+      const Entity entity = entity_factory->Create();
+      transform_system->Create(
+          entity, Sqt(mathfu::vec3(x, y, z), mathfu::quat::identity,
+                      mathfu::kOnes3f));
+      transform_system->SetAabb(entity,
+                                Aabb(-mathfu::kOnes3f, mathfu::kOnes3f));
+      if (i % 2 == 0) {
+        TestRenderComponent& component = pool->EmplaceComponent(entity);
+        component.sort_order = static_cast<RenderSortOrder>(i * 2654435761u);
+      }
+    }
+
+    view.world_from_eye_matrix = mathfu::mat4::Identity();
+    view.clip_from_eye_matrix = mathfu::mat4::Perspective(
+        kPi / 2.f, 1.f, 0.1f, 1000.f);
+    view.clip_from_world_matrix =
+        view.clip_from_eye_matrix * view.world_from_eye_matrix.Inverse();
+  }
+
+  Registry registry;
+  std::unique_ptr<RenderPool> pool;
+  RenderView view;
+};
+
+static void BM_PopulateDisplayList(benchmark::State& state) {
+  Scene scene;
+  scene.pool->SetSortMode(static_cast<SortMode>(state.range(0)));
+  DisplayList list(&scene.registry);
+  while (state.KeepRunning()) {
+    list.Populate(*scene.pool, &scene.view, 1);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumEntities);
+}
+BENCHMARK(BM_PopulateDisplayList)
+    ->Arg(SortMode_None)
+    ->Arg(SortMode_SortOrderIncreasing)
+    ->Arg(SortMode_WorldSpaceZBackToFront)
+    ->Arg(SortMode_AverageSpaceOriginFrontToBack);
+
+static void BM_PopulateDisplayListCulled(benchmark::State& state) {
+  Scene scene;
+  scene.pool->SetSortMode(SortMode_AverageSpaceOriginFrontToBack);
+  scene.pool->SetCullMode(RenderCullMode::kVisibleInAnyView);
+  DisplayList list(&scene.registry);
+  while (state.KeepRunning()) {
+    list.Populate(*scene.pool, &scene.view, 1);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumEntities);
+}
+BENCHMARK(BM_PopulateDisplayListCulled);
+
+// This test verifies that the benchmarked display list contains every
+// renderable entity in sorted order.
+TEST(DisplayListBenchmarkTest, BenchmarkTestVerification) {
+  Scene scene;
+  scene.pool->SetSortMode(SortMode_SortOrderIncreasing);
+  DisplayList list(&scene.registry);
+  list.Populate(*scene.pool, &scene.view, 1);
+
+  const std::vector<DisplayList::Entry>& contents = *list.GetContents();
+  EXPECT_THAT(contents.size(), Eq(static_cast<size_t>(kNumEntities)));
+  for (size_t i = 1; i < contents.size(); ++i) {
+    EXPECT_THAT(contents[i - 1].component->sort_order,
+                Le(contents[i].component->sort_order));
+  }
+
+  const auto* transform_system = scene.registry.Get<TransformSystem>();
+  for (const DisplayList::Entry& entry : contents) {
+    EXPECT_THAT(entry.world_from_entity_matrix,
+                Eq(transform_system->GetWorldFromEntityMatrix(entry.entity)));
+  }
+}
+
+}  // namespace
+}  // namespace lull
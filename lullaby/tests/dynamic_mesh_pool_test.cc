@@ -0,0 +1,160 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/dynamic_mesh_pool.h"
+
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/render/vertex.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Ne;
+
+// A fake backend that creates meshes without GPU buffers and records the
+// capacities requested and the data uploaded.
+class FakeBackend : public DynamicMeshPool::Backend {
+ public:
+  MeshPtr CreateMesh(const DynamicMeshPool::Params& params) override {
+    max_vertices.push_back(params.max_vertices);
+    max_indices.push_back(params.max_indices);
+    return std::make_shared<Mesh>();
+  }
+
+  void UpdateMesh(Mesh* mesh, const MeshData& data) override {
+    last_vertex_bytes = data.GetVertexBytes();
+    last_num_vertices = data.GetNumVertices();
+    ++num_updates;
+  }
+
+  std::vector<size_t> max_vertices;
+  std::vector<size_t> max_indices;
+  const uint8_t* last_vertex_bytes = nullptr;
+  size_t last_num_vertices = 0;
+  int num_updates = 0;
+};
+
+class DynamicMeshPoolTest : public ::testing::Test {
+ protected:
+  DynamicMeshPoolTest() {
+    backend_ = new FakeBackend();
+    pool_.reset(new DynamicMeshPool(std::unique_ptr<FakeBackend>(backend_)));
+  }
+
+  // Fills the mesh for |entity| with |num_vertices| points.
+  MeshPtr Update(Entity entity, size_t num_vertices) {
+    DynamicMeshPool::Params params;
+    params.primitive_type = MeshData::kPoints;
+    params.vertex_format = VertexP::kFormat;
+    params.max_vertices = num_vertices;
+    return pool_->Update(entity, params, [num_vertices](MeshData* mesh) {
+      for (size_t i = 0; i < num_vertices; ++i) {
+        mesh->AddVertex<VertexP>(static_cast<float>(i), 0.f, 0.f);
+      }
+    });
+  }
+
+  FakeBackend* backend_;
+  std::unique_ptr<DynamicMeshPool> pool_;
+};
+
+TEST_F(DynamicMeshPoolTest, RoundsCapacityUp) {
+  Update(Entity(1), 5);
+  EXPECT_THAT(pool_->GetNumMeshesCreated(), Eq(1u));
+  EXPECT_THAT(backend_->max_vertices[0], Eq(8u));
+  EXPECT_THAT(backend_->max_indices[0], Eq(0u));
+  EXPECT_THAT(backend_->last_num_vertices, Eq(5u));
+}
+
+TEST_F(DynamicMeshPoolTest, KeepsMeshForEntity) {
+  const Mesh* mesh = Update(Entity(1), 5).get();
+  const uint8_t* bytes = backend_->last_vertex_bytes;
+  EXPECT_THAT(pool_->GetMesh(Entity(1)), Eq(mesh));
+
+  // Updates within the same capacity class reuse both the mesh and the CPU
+  // storage, so nothing is allocated.
+  EXPECT_THAT(Update(Entity(1), 7).get(), Eq(mesh));
+  EXPECT_THAT(Update(Entity(1), 6).get(), Eq(mesh));
+  EXPECT_THAT(backend_->last_vertex_bytes, Eq(bytes));
+  EXPECT_THAT(backend_->last_num_vertices, Eq(6u));
+  EXPECT_THAT(backend_->num_updates, Eq(3));
+  EXPECT_THAT(pool_->GetNumMeshesCreated(), Eq(1u));
+  EXPECT_THAT(pool_->GetNumFreeMeshes(), Eq(0u));
+}
+
+TEST_F(DynamicMeshPoolTest, DoesNotRewriteMeshStillInUse) {
+  // Hold a reference to the mesh as pending render data would.
+  MeshPtr in_use = Update(Entity(1), 5);
+  MeshPtr next = Update(Entity(1), 5);
+  EXPECT_THAT(next, Ne(in_use));
+  EXPECT_THAT(pool_->GetMesh(Entity(1)), Eq(next.get()));
+  EXPECT_THAT(pool_->GetNumMeshesCreated(), Eq(2u));
+  EXPECT_THAT(pool_->GetNumFreeMeshes(), Eq(1u));
+
+  // Once the references are gone, the entity's mesh is updated in place again.
+  const Mesh* next_mesh = next.get();
+  in_use.reset();
+  next.reset();
+  EXPECT_THAT(Update(Entity(1), 5).get(), Eq(next_mesh));
+  EXPECT_THAT(pool_->GetNumMeshesCreated(), Eq(2u));
+  EXPECT_THAT(pool_->GetNumFreeMeshes(), Eq(1u));
+}
+
+TEST_F(DynamicMeshPoolTest, GrowsIntoLargerBucket) {
+  const Mesh* small = Update(Entity(1), 4).get();
+  const Mesh* large = Update(Entity(1), 9).get();
+  EXPECT_THAT(large, Ne(small));
+  EXPECT_THAT(backend_->max_vertices[1], Eq(16u));
+  EXPECT_THAT(pool_->GetNumMeshesCreated(), Eq(2u));
+
+  // The smaller mesh was returned to the pool and is reused by another entity.
+  EXPECT_THAT(pool_->GetNumFreeMeshes(), Eq(1u));
+  EXPECT_THAT(Update(Entity(2), 3).get(), Eq(small));
+  EXPECT_THAT(pool_->GetNumMeshesCreated(), Eq(2u));
+  EXPECT_THAT(pool_->GetNumFreeMeshes(), Eq(0u));
+}
+
+TEST_F(DynamicMeshPoolTest, ReusesReleasedMeshes) {
+  Update(Entity(1), 4);
+  pool_->Release(Entity(1));
+  EXPECT_THAT(pool_->GetNumFreeMeshes(), Eq(1u));
+
+  // Releasing an entity without a mesh does nothing.
+  pool_->Release(Entity(3));
+  EXPECT_THAT(pool_->GetNumFreeMeshes(), Eq(1u));
+
+  Update(Entity(2), 4);
+  EXPECT_THAT(pool_->GetNumMeshesCreated(), Eq(1u));
+  EXPECT_THAT(pool_->GetNumFreeMeshes(), Eq(0u));
+}
+
+TEST_F(DynamicMeshPoolTest, SkipsMeshesStillInUse) {
+  // Hold a reference to the mesh as pending render data would.
+  const MeshPtr in_use = Update(Entity(1), 4);
+  pool_->Release(Entity(1));
+
+  EXPECT_THAT(Update(Entity(2), 4), Ne(in_use));
+  EXPECT_THAT(pool_->GetNumMeshesCreated(), Eq(2u));
+  EXPECT_THAT(pool_->GetNumFreeMeshes(), Eq(1u));
+}
+
+}  // namespace
+}  // namespace lull
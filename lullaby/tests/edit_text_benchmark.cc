@@ -0,0 +1,147 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "lullaby/systems/text_input/edit_text.h"
+#include "lullaby/util/utf8_string.h"
+
+namespace lull {
+namespace {
+
+// Builds a string with |num_chars| characters, mixing one, two and three byte
+// UTF8 characters.
+std::string CreateText(size_t num_chars) {
+  static const char* kChars[] = {"a", "\xC3\xA9", "b", "\xE1\x82\xA0", "c"};
+  std::string text;
+  for (size_t i = 0; i < num_chars; ++i) {
+    text += kChars[i % 5];
+  }
+  return text;
+}
+
+// Inserts a character in the middle of the string and then deletes it again,
+// which is what typing and correcting a character in a long document does.
+static void BM_UTF8StringInsertMiddle(benchmark::State& state) {
+  const size_t num_chars = static_cast<size_t>(state.range(0));
+  UTF8String text(CreateText(num_chars));
+  const size_t index = num_chars / 2;
+  while (state.KeepRunning()) {
+    text.Insert(index, "x");
+    text.DeleteChars(index, 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_UTF8StringInsertMiddle)->Arg(1024)->Arg(4096)->Arg(16384);
+
+// Types characters one at a time at the caret, which starts in the middle of
+// the text.
+static void BM_EditTextTypeMiddle(benchmark::State& state) {
+  const size_t num_chars = static_cast<size_t>(state.range(0));
+  EditText text;
+  text.SetText(CreateText(num_chars));
+  text.SetCaretPosition(num_chars / 2);
+  size_t num_typed = 0;
+  while (state.KeepRunning()) {
+    text.Insert("x");
+    if (++num_typed == 256) {
+      state.PauseTiming();
+      text.SetText(CreateText(num_chars));
+      text.SetCaretPosition(num_chars / 2);
+      num_typed = 0;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EditTextTypeMiddle)->Arg(1024)->Arg(4096)->Arg(16384);
+
+// Types characters as above, but also reads the whole string after every edit
+// like TextInputSystem does to update the text and send the TextChangedEvent.
+// Unlike the edit itself, this is linear in the length of the text.
+static void BM_EditTextTypeMiddleAndRead(benchmark::State& state) {
+  const size_t num_chars = static_cast<size_t>(state.range(0));
+  EditText text;
+  text.SetText(CreateText(num_chars));
+  text.SetCaretPosition(num_chars / 2);
+  size_t num_typed = 0;
+  while (state.KeepRunning()) {
+    text.Insert("x");
+    benchmark::DoNotOptimize(text.str().data());
+    if (++num_typed == 256) {
+      state.PauseTiming();
+      text.SetText(CreateText(num_chars));
+      text.SetCaretPosition(num_chars / 2);
+      num_typed = 0;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EditTextTypeMiddleAndRead)->Arg(1024)->Arg(4096)->Arg(16384);
+
+// Updates the IME composing text in the middle of the text, as happens on
+// every key press while composing a word.
+static void BM_EditTextComposeMiddle(benchmark::State& state) {
+  const size_t num_chars = static_cast<size_t>(state.range(0));
+  EditText text;
+  text.SetText(CreateText(num_chars));
+  text.SetCaretPosition(num_chars / 2);
+  const std::string composing[] = {"k", "ka", "kan", "kanj", "kanji"};
+  size_t i = 0;
+  while (state.KeepRunning()) {
+    text.SetComposingText(composing[i % 5]);
+    if (++i % 5 == 0) {
+      text.Commit("\xE6\xBC\xA2");
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EditTextComposeMiddle)->Arg(1024)->Arg(4096)->Arg(16384);
+
+// This test verifies that the edits made by the benchmarks produce the
+// expected text.
+TEST(EditTextBenchmarkTest, BenchmarkTestVerification) {
+  const std::string original = CreateText(4096);
+  std::string expected = original;
+
+  UTF8String utf8_string(original);
+  utf8_string.Insert(2048, "x");
+  EXPECT_EQ("x", utf8_string.CharAt(2048));
+  utf8_string.DeleteChars(2048, 1);
+  EXPECT_EQ(original, utf8_string.str());
+
+  EditText text;
+  text.SetText(original);
+  text.SetCaretPosition(2048);
+  text.Insert("x");
+  text.Insert("y");
+  EXPECT_EQ(static_cast<size_t>(2050), text.GetCaretPosition());
+  EXPECT_EQ("x", text.CharAt(2048));
+  EXPECT_EQ("y", text.CharAt(2049));
+  EXPECT_EQ(static_cast<size_t>(4098), text.CharSize());
+
+  text.SetComposingText("ka");
+  text.Commit("\xE6\xBC\xA2");
+  EXPECT_EQ("\xE6\xBC\xA2", text.CharAt(2050));
+  EXPECT_EQ(static_cast<size_t>(4099), text.CharSize());
+  EXPECT_FALSE(text.HasComposingRegion());
+}
+
+}  // namespace
+}  // namespace lull
@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include <vector>
+
 #include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "lullaby/util/flatbuffer_reader.h"
@@ -32,7 +34,8 @@ flatbuffers::Offset<T> Finish(Builder* builder) {
   return offset;
 }
 
-void Flatbuffer_Write_Benchmark(::benchmark::State& state) {
+// Creates the native object used by the benchmarks.
+ComplexT CreateComplexObject() {
   ComplexT obj;
   obj.name = "hello";
   obj.basic.b = true;
@@ -118,17 +121,11 @@ void Flatbuffer_Write_Benchmark(::benchmark::State& state) {
   obj.quats = {
       {10.f, 11.f, 12.f, 13.f}, {10.01f, 11.11f, 12.21f, 13.31f},
   };
-
-  for (auto _ : state) {
-    InwardBuffer buffer(1024);
-    const void* flatbuffer = FlatbufferWriter::SerializeObject(&obj, &buffer);
-    (void)flatbuffer;
-  }
+  return obj;
 }
 
-void Flatbuffer_Read_Benchmark(::benchmark::State& state) {
-  flatbuffers::FlatBufferBuilder fbb;
-
+// Builds the flatbuffer equivalent of CreateComplexObject() into |fbb|.
+const uint8_t* BuildComplexFlatbuffer(flatbuffers::FlatBufferBuilder* fbb) {
   // Structs.
   const InnerFixed inner(1, 2, 3);
   const MiddleFixed middle(4, inner, 5, 6);
@@ -156,12 +153,12 @@ void Flatbuffer_Read_Benchmark(::benchmark::State& state) {
   // Strings.
   const std::vector<std::string> str_vec = {"hello", "world"};
 
-  const auto str1 = fbb.CreateString("hello");
-  const auto str2 = fbb.CreateString("world");
-  const auto arr = fbb.CreateVectorOfStrings(str_vec);
+  const auto str1 = fbb->CreateString("hello");
+  const auto str2 = fbb->CreateString("world");
+  const auto arr = fbb->CreateVectorOfStrings(str_vec);
 
   // Basics.
-  BasicsBuilder basic(fbb);
+  BasicsBuilder basic(*fbb);
   basic.add_u8(1);
   basic.add_i8(2);
   basic.add_u16(3);
@@ -175,7 +172,7 @@ void Flatbuffer_Read_Benchmark(::benchmark::State& state) {
   basic.add_str(str1);
   const auto basic_offset = Finish<Basics>(&basic);
 
-  BasicsBuilder basic1(fbb);
+  BasicsBuilder basic1(*fbb);
   basic1.add_u8(1);
   basic1.add_i8(2);
   basic1.add_u16(3);
@@ -189,7 +186,7 @@ void Flatbuffer_Read_Benchmark(::benchmark::State& state) {
   basic1.add_str(str1);
   const auto basic1_offset = Finish<Basics>(&basic1);
 
-  BasicsBuilder basic2(fbb);
+  BasicsBuilder basic2(*fbb);
   basic2.add_u8(10);
   basic2.add_i8(20);
   basic2.add_u16(30);
@@ -206,15 +203,15 @@ void Flatbuffer_Read_Benchmark(::benchmark::State& state) {
   flatbuffers::Offset<Basics> basics_arr[2] = {basic1_offset, basic2_offset};
 
   // Vectors
-  const auto basics_offset = fbb.CreateVector(basics_arr, 2);
-  const auto outers_offset = fbb.CreateVectorOfStructs(outers_arr, 2);
-  const auto vec2s_offset = fbb.CreateVectorOfStructs(vec2s_arr, 2);
-  const auto vec3s_offset = fbb.CreateVectorOfStructs(vec3s_arr, 2);
-  const auto vec4s_offset = fbb.CreateVectorOfStructs(vec4s_arr, 2);
-  const auto quats_offset = fbb.CreateVectorOfStructs(quats_arr, 2);
+  const auto basics_offset = fbb->CreateVector(basics_arr, 2);
+  const auto outers_offset = fbb->CreateVectorOfStructs(outers_arr, 2);
+  const auto vec2s_offset = fbb->CreateVectorOfStructs(vec2s_arr, 2);
+  const auto vec3s_offset = fbb->CreateVectorOfStructs(vec3s_arr, 2);
+  const auto vec4s_offset = fbb->CreateVectorOfStructs(vec4s_arr, 2);
+  const auto quats_offset = fbb->CreateVectorOfStructs(quats_arr, 2);
 
   // Build the root table.
-  ComplexBuilder complex(fbb);
+  ComplexBuilder complex(*fbb);
 
   complex.add_basic(basic_offset);
   complex.add_basics(basics_offset);
@@ -232,18 +229,96 @@ void Flatbuffer_Read_Benchmark(::benchmark::State& state) {
   complex.add_quats(quats_offset);
 
   Finish<Complex>(&complex);
-  auto* flatbuffer = fbb.GetBufferPointer();
+  return fbb->GetBufferPointer();
+}
+
+// Returns the flatbuffer written for |obj| by the SerializeFlatbuffer()
+// visitor.  Every field is written, so two objects are equal if and only if
+// their buffers are.
+std::vector<uint8_t> WriteWithVisitor(ComplexT* obj) {
+  InwardBuffer buffer(1024);
+  FlatbufferWriter::SerializeObjectWithVisitor(obj, &buffer);
+  const uint8_t* data =
+      static_cast<const uint8_t*>(buffer.BackAt(buffer.BackSize()));
+  return std::vector<uint8_t>(data, data + buffer.BackSize());
+}
+
+void Flatbuffer_Write_Benchmark(::benchmark::State& state) {
+  ComplexT obj = CreateComplexObject();
+
+  for (auto _ : state) {
+    InwardBuffer buffer(1024);
+    const void* flatbuffer =
+        FlatbufferWriter::SerializeObjectWithVisitor(&obj, &buffer);
+    (void)flatbuffer;
+  }
+}
+
+void Flatbuffer_Read_Benchmark(::benchmark::State& state) {
+  flatbuffers::FlatBufferBuilder fbb;
+  const uint8_t* flatbuffer = BuildComplexFlatbuffer(&fbb);
 
   std::string name;
   for (auto _ : state) {
     auto table = flatbuffers::GetRoot<flatbuffers::Table>(flatbuffer);
 
     ComplexT t;
-    FlatbufferReader::SerializeObject(&t, table);
+    FlatbufferReader::SerializeObjectWithVisitor(&t, table);
+
+    name = t.name;
+  }
+  EXPECT_THAT(name, Eq("hello"));
+}
+
+// Packs the native object using the generated Pack() function which calls the
+// flatc builders directly instead of going through the FlatbufferWriter.
+void Flatbuffer_DirectPack_Benchmark(::benchmark::State& state) {
+  ComplexT obj = CreateComplexObject();
+
+  for (auto _ : state) {
+    flatbuffers::FlatBufferBuilder fbb(1024);
+    fbb.Finish(obj.Pack(&fbb));
+  }
+
+  // Reading the packed data back with the visitor must give the whole object.
+  flatbuffers::FlatBufferBuilder fbb;
+  fbb.Finish(obj.Pack(&fbb));
+  ComplexT t;
+  FlatbufferReader::SerializeObjectWithVisitor(
+      &t, flatbuffers::GetRoot<flatbuffers::Table>(fbb.GetBufferPointer()));
+  EXPECT_THAT(WriteWithVisitor(&t), Eq(WriteWithVisitor(&obj)));
+}
+
+// Unpacks the flatbuffer using the generated Unpack() function which reads the
+// flatc accessors directly instead of going through the FlatbufferReader.
+void Flatbuffer_DirectUnpack_Benchmark(::benchmark::State& state) {
+  flatbuffers::FlatBufferBuilder fbb;
+  const uint8_t* flatbuffer = BuildComplexFlatbuffer(&fbb);
+
+  std::string name;
+  for (auto _ : state) {
+    const Complex* c = flatbuffers::GetRoot<Complex>(flatbuffer);
+
+    ComplexT t;
+    t.Unpack(c);
 
     name = t.name;
   }
   EXPECT_THAT(name, Eq("hello"));
+
+  // The whole object must match what the visitor reads.
+  ComplexT direct;
+  direct.Unpack(flatbuffers::GetRoot<Complex>(flatbuffer));
+  ComplexT expected;
+  FlatbufferReader::SerializeObjectWithVisitor(
+      &expected, flatbuffers::GetRoot<flatbuffers::Table>(flatbuffer));
+  EXPECT_THAT(WriteWithVisitor(&direct), Eq(WriteWithVisitor(&expected)));
+
+  // Unpacking over an object with stale data gives the same result.
+  ComplexT reused = CreateComplexObject();
+  reused.basics.resize(5);
+  reused.Unpack(flatbuffers::GetRoot<Complex>(flatbuffer));
+  EXPECT_THAT(WriteWithVisitor(&reused), Eq(WriteWithVisitor(&expected)));
 }
 
 }  // namespace
@@ -251,3 +326,5 @@ void Flatbuffer_Read_Benchmark(::benchmark::State& state) {
 
 BENCHMARK(lull::Flatbuffer_Write_Benchmark);
 BENCHMARK(lull::Flatbuffer_Read_Benchmark);
+BENCHMARK(lull::Flatbuffer_DirectPack_Benchmark);
+BENCHMARK(lull::Flatbuffer_DirectUnpack_Benchmark);
@@ -31,7 +31,8 @@ flatbuffers::Offset<T> Finish(Builder* builder) {
   return offset;
 }
 
-void Flatbuffer_Pack_Benchmark(::benchmark::State& state) {
+// Creates the native object used by the benchmarks.
+ComplexT CreateComplexObject() {
   ComplexT obj;
   obj.name = "hello";
   obj.basic.reset(new BasicsT());
@@ -121,17 +122,11 @@ void Flatbuffer_Pack_Benchmark(::benchmark::State& state) {
   obj.quats = {
       {10.f, 11.f, 12.f, 13.f}, {10.01f, 11.11f, 12.21f, 13.31f},
   };
-
-  for (auto _ : state) {
-    flatbuffers::FlatBufferBuilder fbb;
-    auto c = Complex::Pack(fbb, &obj);
-    (void)c;
-  }
+  return obj;
 }
 
-void Flatbuffer_UnPack_Benchmark(::benchmark::State& state) {
-  flatbuffers::FlatBufferBuilder fbb;
-
+// Builds the flatbuffer equivalent of CreateComplexObject() into |fbb|.
+const uint8_t* BuildComplexFlatbuffer(flatbuffers::FlatBufferBuilder* fbb) {
   // Structs.
   const InnerFixed inner(1, 2, 3);
   const MiddleFixed middle(4, inner, 5, 6);
@@ -159,12 +154,12 @@ void Flatbuffer_UnPack_Benchmark(::benchmark::State& state) {
   // Strings.
   const std::vector<std::string> str_vec = {"hello", "world"};
 
-  const auto str1 = fbb.CreateString("hello");
-  const auto str2 = fbb.CreateString("world");
-  const auto arr = fbb.CreateVectorOfStrings(str_vec);
+  const auto str1 = fbb->CreateString("hello");
+  const auto str2 = fbb->CreateString("world");
+  const auto arr = fbb->CreateVectorOfStrings(str_vec);
 
   // Basics.
-  BasicsBuilder basic(fbb);
+  BasicsBuilder basic(*fbb);
   basic.add_u8(1);
   basic.add_i8(2);
   basic.add_u16(3);
@@ -178,7 +173,7 @@ void Flatbuffer_UnPack_Benchmark(::benchmark::State& state) {
   basic.add_str(str1);
   const auto basic_offset = Finish<Basics>(&basic);
 
-  BasicsBuilder basic1(fbb);
+  BasicsBuilder basic1(*fbb);
   basic1.add_u8(1);
   basic1.add_i8(2);
   basic1.add_u16(3);
@@ -192,7 +187,7 @@ void Flatbuffer_UnPack_Benchmark(::benchmark::State& state) {
   basic1.add_str(str1);
   const auto basic1_offset = Finish<Basics>(&basic1);
 
-  BasicsBuilder basic2(fbb);
+  BasicsBuilder basic2(*fbb);
   basic2.add_u8(10);
   basic2.add_i8(20);
   basic2.add_u16(30);
@@ -209,15 +204,15 @@ void Flatbuffer_UnPack_Benchmark(::benchmark::State& state) {
   flatbuffers::Offset<Basics> basics_arr[2] = {basic1_offset, basic2_offset};
 
   // Vectors
-  const auto basics_offset = fbb.CreateVector(basics_arr, 2);
-  const auto outers_offset = fbb.CreateVectorOfStructs(outers_arr, 2);
-  const auto vec2s_offset = fbb.CreateVectorOfStructs(vec2s_arr, 2);
-  const auto vec3s_offset = fbb.CreateVectorOfStructs(vec3s_arr, 2);
-  const auto vec4s_offset = fbb.CreateVectorOfStructs(vec4s_arr, 2);
-  const auto quats_offset = fbb.CreateVectorOfStructs(quats_arr, 2);
+  const auto basics_offset = fbb->CreateVector(basics_arr, 2);
+  const auto outers_offset = fbb->CreateVectorOfStructs(outers_arr, 2);
+  const auto vec2s_offset = fbb->CreateVectorOfStructs(vec2s_arr, 2);
+  const auto vec3s_offset = fbb->CreateVectorOfStructs(vec3s_arr, 2);
+  const auto vec4s_offset = fbb->CreateVectorOfStructs(vec4s_arr, 2);
+  const auto quats_offset = fbb->CreateVectorOfStructs(quats_arr, 2);
 
   // Build the root table.
-  ComplexBuilder complex(fbb);
+  ComplexBuilder complex(*fbb);
 
   complex.add_basic(basic_offset);
   complex.add_basics(basics_offset);
@@ -235,7 +230,22 @@ void Flatbuffer_UnPack_Benchmark(::benchmark::State& state) {
   complex.add_quats(quats_offset);
 
   Finish<Complex>(&complex);
-  auto* flatbuffer = fbb.GetBufferPointer();
+  return fbb->GetBufferPointer();
+}
+
+void Flatbuffer_Pack_Benchmark(::benchmark::State& state) {
+  ComplexT obj = CreateComplexObject();
+
+  for (auto _ : state) {
+    flatbuffers::FlatBufferBuilder fbb;
+    auto c = Complex::Pack(fbb, &obj);
+    (void)c;
+  }
+}
+
+void Flatbuffer_UnPack_Benchmark(::benchmark::State& state) {
+  flatbuffers::FlatBufferBuilder fbb;
+  const uint8_t* flatbuffer = BuildComplexFlatbuffer(&fbb);
 
   std::string name;
   for (auto _ : state) {
@@ -246,8 +256,38 @@ void Flatbuffer_UnPack_Benchmark(::benchmark::State& state) {
   EXPECT_THAT(name, Eq("hello"));
 }
 
+// Builds the flatbuffer with hand-written flatc builder calls.  This is the
+// lower bound for both the object API Pack() and the straight-line Pack()
+// generated for Lullaby's native types (see flatbuffer_benchmark_lull.cc).
+void Flatbuffer_Build_Benchmark(::benchmark::State& state) {
+  for (auto _ : state) {
+    flatbuffers::FlatBufferBuilder fbb;
+    const uint8_t* flatbuffer = BuildComplexFlatbuffer(&fbb);
+    (void)flatbuffer;
+  }
+}
+
+// Same as Flatbuffer_UnPack_Benchmark, but unpacks into a stack object so that
+// the comparison with Flatbuffer_DirectUnpack_Benchmark in
+// flatbuffer_benchmark_lull.cc is not skewed by the leaked root object.
+void Flatbuffer_UnPackTo_Benchmark(::benchmark::State& state) {
+  flatbuffers::FlatBufferBuilder fbb;
+  const uint8_t* flatbuffer = BuildComplexFlatbuffer(&fbb);
+
+  std::string name;
+  for (auto _ : state) {
+    const Complex* c = flatbuffers::GetRoot<Complex>(flatbuffer);
+    ComplexT t;
+    c->UnPackTo(&t);
+    name = t.name;
+  }
+  EXPECT_THAT(name, Eq("hello"));
+}
+
 }  // namespace
 }  // namespace lull
 
 BENCHMARK(lull::Flatbuffer_Pack_Benchmark);
 BENCHMARK(lull::Flatbuffer_UnPack_Benchmark);
+BENCHMARK(lull::Flatbuffer_Build_Benchmark);
+BENCHMARK(lull::Flatbuffer_UnPackTo_Benchmark);
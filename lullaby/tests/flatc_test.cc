@@ -26,6 +26,7 @@ limitations under the License.
 namespace lull {
 namespace {
 
+using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::IsNull;
 using ::testing::Not;
@@ -140,5 +141,57 @@ TEST(FlatcTest, VerifyUnion) {
   EXPECT_THAT(invalid, IsNull());
 }
 
+TEST(FlatcTest, VerifyPackUnpack) {
+  ComplexT src;
+  src.name = "hello";
+  src.basic.u32 = 5;
+  src.basic.str = "world";
+  src.basics.resize(2);
+  src.basics[1].i8 = 20;
+  src.out.mid.in.c = 3;
+  src.out.x = 7.7f;
+  src.numbers = {1, 2, 3};
+  src.names = {"a", "bc"};
+  src.vec3 = mathfu::vec3(3.f, 4.f, 5.f);
+  src.vec2s = {mathfu::vec2(1.f, 2.f), mathfu::vec2(10.f, 20.f)};
+
+  flatbuffers::FlatBufferBuilder fbb;
+  fbb.Finish(src.Pack(&fbb));
+
+  ComplexT dst;
+  dst.Unpack(flatbuffers::GetRoot<Complex>(fbb.GetBufferPointer()));
+  EXPECT_THAT(dst.name, Eq("hello"));
+  EXPECT_THAT(dst.basic.u32, Eq(5u));
+  EXPECT_THAT(dst.basic.str, Eq("world"));
+  EXPECT_THAT(dst.basics.size(), Eq(2u));
+  EXPECT_THAT(dst.basics[1].i8, Eq(20));
+  EXPECT_THAT(dst.out.mid.in.c, Eq(3));
+  EXPECT_THAT(dst.out.x, Eq(7.7f));
+  EXPECT_THAT(dst.numbers, ElementsAre(1, 2, 3));
+  EXPECT_THAT(dst.names, ElementsAre("a", "bc"));
+  EXPECT_THAT(dst.vec3.z, Eq(5.f));
+  EXPECT_THAT(dst.vec2s.size(), Eq(2u));
+  EXPECT_THAT(dst.vec2s[1].y, Eq(20.f));
+}
+
+TEST(FlatcTest, VerifyUnpackResetsAbsentFields) {
+  flatbuffers::FlatBufferBuilder fbb;
+  const auto name = fbb.CreateString("hello");
+  ComplexBuilder builder(fbb);
+  builder.add_name(name);
+  fbb.Finish(builder.Finish());
+
+  // Fields missing from the flatbuffer must not keep their previous values.
+  ComplexT dst;
+  dst.basic.u32 = 5;
+  dst.basic.str = "stale";
+  dst.names = {"a"};
+  dst.Unpack(flatbuffers::GetRoot<Complex>(fbb.GetBufferPointer()));
+  EXPECT_THAT(dst.name, Eq("hello"));
+  EXPECT_THAT(dst.basic.u32, Eq(BasicsT().u32));
+  EXPECT_THAT(dst.basic.str, Eq(""));
+  EXPECT_THAT(dst.names.size(), Eq(0u));
+}
+
 }  // namespace
 }  // namespace lull
@@ -0,0 +1,157 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/frame_allocator.h"
+
+#include <string.h>
+#include <thread>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Ge;
+using ::testing::Gt;
+using ::testing::Ne;
+
+TEST(FrameAllocatorTest, AllocateIsAligned) {
+  FrameAllocator allocator(1024);
+  allocator.Allocate(1, 1);
+  void* ptr = allocator.Allocate(16, 16);
+  EXPECT_THAT(reinterpret_cast<uintptr_t>(ptr) % 16, Eq(0u));
+  allocator.Allocate(3, 1);
+  ptr = allocator.Allocate(8, 8);
+  EXPECT_THAT(reinterpret_cast<uintptr_t>(ptr) % 8, Eq(0u));
+}
+
+TEST(FrameAllocatorTest, ResetReusesMemory) {
+  FrameAllocator allocator(1024);
+  void* first = allocator.Allocate(64);
+  void* second = allocator.Allocate(64);
+  EXPECT_THAT(first, Ne(second));
+  EXPECT_THAT(allocator.GetCurrentUsage(), Ge(128u));
+
+  allocator.Reset();
+  EXPECT_THAT(allocator.GetCurrentUsage(), Eq(0u));
+  EXPECT_THAT(allocator.Allocate(64), Eq(first));
+}
+
+TEST(FrameAllocatorTest, DeallocateRollsBackLastAllocation) {
+  FrameAllocator allocator(1024);
+  void* first = allocator.Allocate(64);
+  void* second = allocator.Allocate(64);
+
+  // Only the most recent allocation is reclaimed.
+  allocator.Deallocate(first, 64);
+  EXPECT_THAT(allocator.Allocate(64), Ne(first));
+  allocator.Reset();
+
+  first = allocator.Allocate(64);
+  second = allocator.Allocate(64);
+  allocator.Deallocate(second, 64);
+  EXPECT_THAT(allocator.Allocate(64), Eq(second));
+}
+
+TEST(FrameAllocatorTest, PeakUsage) {
+  FrameAllocator allocator(1024);
+  allocator.Allocate(256);
+  allocator.Reset();
+  EXPECT_THAT(allocator.GetPeakUsage(), Eq(256u));
+
+  allocator.Allocate(128);
+  allocator.Reset();
+  EXPECT_THAT(allocator.GetPeakUsage(), Eq(256u));
+
+  allocator.Allocate(512);
+  allocator.Reset();
+  EXPECT_THAT(allocator.GetPeakUsage(), Eq(512u));
+}
+
+TEST(FrameAllocatorTest, OverflowFallsBackToHeapAndGrows) {
+  FrameAllocator allocator(128);
+  allocator.Allocate(100);
+  void* overflow = allocator.Allocate(100);
+  EXPECT_THAT(overflow, Ne(nullptr));
+  memset(overflow, 0xff, 100);
+
+  allocator.Reset();
+  FrameAllocator::Stats stats = allocator.GetStats();
+  EXPECT_THAT(stats.num_overflows, Eq(1u));
+  EXPECT_THAT(stats.overflow_bytes, Eq(100u));
+  EXPECT_THAT(stats.peak_usage, Eq(200u));
+  EXPECT_THAT(stats.capacity, Ge(200u));
+
+  // The arena was grown so the same workload no longer overflows.
+  allocator.Allocate(100);
+  allocator.Allocate(100);
+  allocator.Reset();
+  EXPECT_THAT(allocator.GetStats().num_overflows, Eq(1u));
+}
+
+TEST(FrameAllocatorTest, ArenaPerThread) {
+  FrameAllocator allocator(1024);
+  allocator.Allocate(64);
+
+  size_t thread_usage = 0;
+  std::thread thread([&]() {
+    allocator.Allocate(32);
+    thread_usage = allocator.GetCurrentUsage();
+  });
+  thread.join();
+
+  EXPECT_THAT(thread_usage, Eq(32u));
+  EXPECT_THAT(allocator.GetCurrentUsage(), Eq(64u));
+  allocator.Reset();
+  EXPECT_THAT(allocator.GetPeakUsage(), Eq(96u));
+  EXPECT_THAT(allocator.GetStats().capacity, Eq(2048u));
+}
+
+TEST(FrameAllocatorTest, FrameVector) {
+  FrameAllocator allocator(1024);
+  FrameVector<int> values(&allocator);
+  for (int i = 0; i < 4; ++i) {
+    values.push_back(i);
+  }
+  EXPECT_THAT(values, ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(allocator.GetCurrentUsage(), Gt(0u));
+}
+
+TEST(FrameAllocatorTest, FrameVectorWithoutAllocator) {
+  FrameVector<int> values(static_cast<FrameAllocator*>(nullptr));
+  for (int i = 0; i < 4; ++i) {
+    values.push_back(i);
+  }
+  EXPECT_THAT(values, ElementsAre(0, 1, 2, 3));
+}
+
+TEST(FrameAllocatorTest, AdapterEquality) {
+  FrameAllocator allocator1;
+  FrameAllocator allocator2;
+  const FrameAllocatorAdapter<int> adapter1(&allocator1);
+  const FrameAllocatorAdapter<float> adapter2(&allocator1);
+  const FrameAllocatorAdapter<int> adapter3(&allocator2);
+  EXPECT_TRUE(adapter1 == adapter2);
+  EXPECT_TRUE(adapter1 != adapter3);
+  EXPECT_THAT(FrameAllocatorAdapter<char>(adapter1).GetFrameAllocator(),
+              Eq(&allocator1));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,215 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/frame_pipeline.h"
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Ge;
+using ::testing::IsNull;
+using ::testing::Le;
+using ::testing::NotNull;
+
+using Pipeline = FramePipeline<int>;
+
+// Writes |value| as the next frame and returns its frame number.
+Pipeline::FrameId Write(Pipeline* pipeline, int value) {
+  int* data = pipeline->BeginWrite();
+  EXPECT_THAT(data, NotNull());
+  *data = value;
+  return pipeline->EndWrite();
+}
+
+// Reads the newest frame and returns its value, or -1 if there is none.
+int Read(Pipeline* pipeline) {
+  const int* data = pipeline->BeginRead();
+  const int value = data ? *data : -1;
+  if (data) {
+    pipeline->EndRead();
+  }
+  return value;
+}
+
+TEST(FramePipelineTest, NothingToRead) {
+  Pipeline pipeline(3);
+  EXPECT_THAT(pipeline.BeginRead(), IsNull());
+  EXPECT_THAT(pipeline.GetLastReadFrame(), Eq(Pipeline::kInvalidFrame));
+}
+
+TEST(FramePipelineTest, ReadsEachFrameInLockStep) {
+  Pipeline pipeline(3);
+  for (int i = 1; i <= 10; ++i) {
+    EXPECT_THAT(Write(&pipeline, i), Eq(Pipeline::FrameId(i)));
+    EXPECT_THAT(Read(&pipeline), Eq(i));
+  }
+
+  const Pipeline::Stats stats = pipeline.GetStats();
+  EXPECT_THAT(stats.frames_written, Eq(10u));
+  EXPECT_THAT(stats.frames_read, Eq(10u));
+  EXPECT_THAT(stats.frames_dropped, Eq(0u));
+  EXPECT_THAT(stats.frames_repeated, Eq(0u));
+}
+
+TEST(FramePipelineTest, ReadsNewestFrame) {
+  Pipeline pipeline(3);
+  Write(&pipeline, 1);
+  Write(&pipeline, 2);
+  EXPECT_THAT(Read(&pipeline), Eq(2));
+  EXPECT_THAT(pipeline.GetLastReadFrame(), Eq(Pipeline::FrameId(2)));
+  EXPECT_THAT(pipeline.GetStats().frames_dropped, Eq(1u));
+}
+
+TEST(FramePipelineTest, RepeatsLastFrame) {
+  Pipeline pipeline(3);
+  Write(&pipeline, 1);
+  EXPECT_THAT(Read(&pipeline), Eq(1));
+  EXPECT_THAT(Read(&pipeline), Eq(1));
+  EXPECT_THAT(pipeline.GetStats().frames_repeated, Eq(1u));
+
+  // The repeated frame is still available while the next one is written.
+  int* data = pipeline.BeginWrite();
+  *data = 2;
+  EXPECT_THAT(Read(&pipeline), Eq(1));
+  pipeline.EndWrite();
+  EXPECT_THAT(Read(&pipeline), Eq(2));
+}
+
+TEST(FramePipelineTest, WritesWhileReading) {
+  Pipeline pipeline(3);
+  Write(&pipeline, 1);
+
+  const int* read = pipeline.BeginRead();
+  EXPECT_THAT(pipeline.GetReadFrame(), Eq(Pipeline::FrameId(1)));
+  // The producer can run ahead of the consumer without disturbing the frame
+  // being read.
+  Write(&pipeline, 2);
+  Write(&pipeline, 3);
+  Write(&pipeline, 4);
+  EXPECT_THAT(*read, Eq(1));
+  pipeline.EndRead();
+
+  EXPECT_THAT(Read(&pipeline), Eq(4));
+  const Pipeline::Stats stats = pipeline.GetStats();
+  EXPECT_THAT(stats.frames_read, Eq(2u));
+  EXPECT_THAT(stats.frames_dropped, Eq(2u));
+}
+
+TEST(FramePipelineTest, DoubleBuffered) {
+  Pipeline pipeline(2);
+  Write(&pipeline, 1);
+  const int* read = pipeline.BeginRead();
+  Write(&pipeline, 2);
+  Write(&pipeline, 3);
+  EXPECT_THAT(*read, Eq(1));
+  pipeline.EndRead();
+  EXPECT_THAT(Read(&pipeline), Eq(3));
+}
+
+TEST(FramePipelineTest, SingleBuffered) {
+  Pipeline pipeline(1);
+  Write(&pipeline, 1);
+  EXPECT_THAT(Read(&pipeline), Eq(1));
+  Write(&pipeline, 2);
+  EXPECT_THAT(Read(&pipeline), Eq(2));
+
+  pipeline.BeginRead();
+  EXPECT_THAT(pipeline.BeginWrite(), IsNull());
+  pipeline.EndRead();
+}
+
+TEST(FramePipelineTest, ReusesSlots) {
+  FramePipeline<std::vector<int>> pipeline(3);
+  std::vector<const std::vector<int>*> slots;
+  for (int i = 0; i < 10; ++i) {
+    std::vector<int>* data = pipeline.BeginWrite();
+    data->clear();
+    data->push_back(i);
+    pipeline.EndWrite();
+    const std::vector<int>* read = pipeline.BeginRead();
+    EXPECT_THAT(read->front(), Eq(i));
+    if (std::find(slots.begin(), slots.end(), read) == slots.end()) {
+      slots.push_back(read);
+    }
+    pipeline.EndRead();
+  }
+  EXPECT_THAT(slots.size(), Le(pipeline.GetDepth()));
+}
+
+TEST(FramePipelineTest, WaitTimesOut) {
+  Pipeline pipeline(3);
+  EXPECT_FALSE(pipeline.WaitForWrite(1, std::chrono::milliseconds(1)));
+  Write(&pipeline, 1);
+  EXPECT_TRUE(pipeline.WaitForWrite(1, std::chrono::milliseconds(1)));
+  EXPECT_FALSE(pipeline.WaitForRead(1, std::chrono::milliseconds(1)));
+  Read(&pipeline);
+  EXPECT_TRUE(pipeline.WaitForRead(1, std::chrono::milliseconds(1)));
+}
+
+// Runs a producer and a consumer on separate threads, with the producer
+// fenced to stay at most one frame ahead, and checks that frames are handed
+// off in order, that every frame is either read or dropped, and that latency
+// is measured.
+TEST(FramePipelineTest, PipelinedThreads) {
+  const int kNumFrames = 200;
+  const auto kTimeout = std::chrono::seconds(10);
+  Pipeline pipeline(3);
+
+  std::thread producer([&]() {
+    for (int i = 1; i <= kNumFrames; ++i) {
+      // Don't start frame N + 1 until frame N - 1 has been picked up.
+      if (i > 2) {
+        EXPECT_TRUE(pipeline.WaitForRead(i - 2, kTimeout));
+      }
+      Write(&pipeline, i);
+    }
+  });
+
+  std::vector<int> read;
+  for (int i = 1; i <= kNumFrames; ++i) {
+    EXPECT_TRUE(pipeline.WaitForWrite(i, kTimeout));
+    const int* data = pipeline.BeginRead();
+    ASSERT_THAT(data, NotNull());
+    read.push_back(*data);
+    EXPECT_THAT(pipeline.GetReadFrame(), Ge(Pipeline::FrameId(i)));
+    pipeline.EndRead();
+    i = static_cast<int>(pipeline.GetLastReadFrame());
+  }
+  producer.join();
+
+  for (size_t i = 1; i < read.size(); ++i) {
+    EXPECT_THAT(read[i], Ge(read[i - 1] + 1));
+  }
+  EXPECT_THAT(read.back(), Eq(kNumFrames));
+
+  const Pipeline::Stats stats = pipeline.GetStats();
+  EXPECT_THAT(stats.frames_written, Eq(static_cast<uint64_t>(kNumFrames)));
+  EXPECT_THAT(stats.frames_read + stats.frames_dropped,
+              Eq(static_cast<uint64_t>(kNumFrames)));
+  EXPECT_THAT(stats.frames_repeated, Eq(0u));
+  EXPECT_THAT(stats.max_latency, Ge(stats.last_latency));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,97 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/gap_buffer.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+
+std::string ToString(const GapBuffer<char>& buffer) {
+  std::string str;
+  buffer.AppendTo(&str);
+  return str;
+}
+
+TEST(GapBufferTest, Empty) {
+  GapBuffer<char> buffer;
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_THAT(buffer.size(), Eq(0u));
+  EXPECT_THAT(buffer.GetGapPosition(), Eq(0u));
+  EXPECT_THAT(ToString(buffer), Eq(""));
+}
+
+TEST(GapBufferTest, Insert) {
+  GapBuffer<char> buffer;
+  buffer.Insert("hello", 5);
+  EXPECT_THAT(buffer.size(), Eq(5u));
+  EXPECT_THAT(buffer.GetGapPosition(), Eq(5u));
+
+  buffer.MoveGap(0);
+  buffer.Insert('>');
+  EXPECT_THAT(buffer.GetGapPosition(), Eq(1u));
+
+  buffer.MoveGap(3);
+  buffer.Insert("--", 2);
+  EXPECT_THAT(ToString(buffer), Eq(">he--llo"));
+  EXPECT_THAT(buffer[0], Eq('>'));
+  EXPECT_THAT(buffer[4], Eq('-'));
+  EXPECT_THAT(buffer[7], Eq('o'));
+}
+
+TEST(GapBufferTest, Erase) {
+  GapBuffer<char> buffer;
+  buffer.Insert("abcdefgh", 8);
+
+  buffer.MoveGap(2);
+  buffer.EraseAfterGap(2);
+  EXPECT_THAT(ToString(buffer), Eq("abefgh"));
+
+  buffer.MoveGap(5);
+  buffer.EraseBeforeGap(3);
+  EXPECT_THAT(ToString(buffer), Eq("abh"));
+  EXPECT_THAT(buffer.GetGapPosition(), Eq(2u));
+
+  buffer.Clear();
+  EXPECT_TRUE(buffer.empty());
+  buffer.Insert("xyz", 3);
+  EXPECT_THAT(ToString(buffer), Eq("xyz"));
+}
+
+TEST(GapBufferTest, Grow) {
+  GapBuffer<char> buffer;
+  std::string expected;
+  for (int i = 0; i < 1000; ++i) {
+    // Insert each character in the middle so that the gap has to move and grow
+    // while there are elements on both sides of it.
+    const char c = static_cast<char>('a' + i % 26);
+    const size_t index = expected.size() / 2;
+    expected.insert(expected.begin() + index, c);
+    buffer.MoveGap(index);
+    buffer.Insert(c);
+  }
+  EXPECT_THAT(buffer.size(), Eq(expected.size()));
+  EXPECT_THAT(ToString(buffer), Eq(expected));
+}
+
+}  // namespace
+}  // namespace lull
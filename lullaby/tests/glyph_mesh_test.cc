@@ -0,0 +1,111 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/text/detail/glyph_mesh.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+
+std::vector<VertexPT> CreateVertices(size_t count) {
+  std::vector<VertexPT> vertices;
+  for (size_t i = 0; i < count; ++i) {
+    const float f = static_cast<float>(i);
+    vertices.emplace_back(f, f + 1.f, f + 2.f, f / 10.f, f / 20.f);
+  }
+  return vertices;
+}
+
+TEST(GlyphMeshTest, SingleSlice) {
+  const std::vector<VertexPT> vertices = CreateVertices(4);
+  const std::vector<uint16_t> indices = {0, 1, 2, 2, 3, 0};
+
+  const MeshData mesh =
+      BuildBatchedGlyphMesh(vertices, {GlyphSlice(indices, 0, false)});
+  EXPECT_THAT(mesh.GetVertexFormat(), Eq(VertexPTT::kFormat));
+  EXPECT_THAT(mesh.GetNumVertices(), Eq(4));
+  EXPECT_THAT(mesh.GetNumIndices(), Eq(6));
+
+  const VertexPTT* batched = mesh.GetVertexData<VertexPTT>();
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    EXPECT_THAT(batched[i].x, Eq(vertices[i].x));
+    EXPECT_THAT(batched[i].y, Eq(vertices[i].y));
+    EXPECT_THAT(batched[i].z, Eq(vertices[i].z));
+    EXPECT_THAT(batched[i].u0, Eq(vertices[i].u0));
+    EXPECT_THAT(batched[i].v0, Eq(vertices[i].v0));
+    EXPECT_THAT(batched[i].u1, Eq(0.f));
+    EXPECT_THAT(batched[i].v1, Eq(0.f));
+  }
+}
+
+TEST(GlyphMeshTest, MultipleSlices) {
+  const std::vector<VertexPT> vertices = CreateVertices(12);
+  const std::vector<uint16_t> slice0 = {0, 1, 2, 2, 3, 0};
+  const std::vector<uint16_t> slice1 = {4, 5, 6, 6, 7, 4};
+  const std::vector<uint16_t> slice2 = {8, 9, 10, 10, 11, 8};
+
+  const MeshData mesh = BuildBatchedGlyphMesh(
+      vertices, {GlyphSlice(slice0, 0, false), GlyphSlice(slice1, 1, false),
+                 GlyphSlice(slice2, 2, false)});
+  EXPECT_THAT(mesh.GetNumVertices(), Eq(12));
+  EXPECT_THAT(mesh.GetNumIndices(), Eq(18));
+
+  // Each vertex is tagged with the texture unit of the slice that references
+  // it.
+  const VertexPTT* batched = mesh.GetVertexData<VertexPTT>();
+  for (size_t i = 0; i < vertices.size(); ++i) {
+    EXPECT_THAT(batched[i].u1, Eq(static_cast<float>(i / 4)));
+  }
+
+  // The indices are concatenated in slice order.
+  const uint16_t* indices = mesh.GetIndexData<uint16_t>();
+  for (size_t i = 0; i < 6; ++i) {
+    EXPECT_THAT(indices[i], Eq(slice0[i]));
+    EXPECT_THAT(indices[i + 6], Eq(slice1[i]));
+    EXPECT_THAT(indices[i + 12], Eq(slice2[i]));
+  }
+}
+
+TEST(GlyphMeshTest, LinksShareTextureUnits) {
+  const std::vector<VertexPT> vertices = CreateVertices(12);
+  const std::vector<uint16_t> text0 = {0, 1, 2, 2, 3, 0};
+  const std::vector<uint16_t> text1 = {4, 5, 6, 6, 7, 4};
+  const std::vector<uint16_t> link0 = {8, 9, 10, 10, 11, 8};
+
+  // The link glyphs come from the same cache slice as the first text glyphs.
+  const MeshData mesh = BuildBatchedGlyphMesh(
+      vertices, {GlyphSlice(text0, 0, false), GlyphSlice(text1, 1, false),
+                 GlyphSlice(link0, 0, true)});
+  EXPECT_THAT(mesh.GetNumVertices(), Eq(12));
+  EXPECT_THAT(mesh.GetNumIndices(), Eq(18));
+
+  const VertexPTT* batched = mesh.GetVertexData<VertexPTT>();
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_THAT(batched[i].u1, Eq(0.f));
+    EXPECT_THAT(batched[i].v1, Eq(0.f));
+    EXPECT_THAT(batched[i + 4].u1, Eq(1.f));
+    EXPECT_THAT(batched[i + 4].v1, Eq(0.f));
+    EXPECT_THAT(batched[i + 8].u1, Eq(0.f));
+    EXPECT_THAT(batched[i + 8].v1, Eq(1.f));
+  }
+}
+
+}  // namespace
+}  // namespace lull
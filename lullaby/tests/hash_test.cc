@@ -70,5 +70,20 @@ TEST(Hash, Basis) {
   EXPECT_THAT(Hash("Other"), Eq(Hash(Hash(""), "Other")));
 }
 
+TEST(Hash, HashBytes) {
+  EXPECT_THAT(HashBytes(kHashOffsetBasis, "Hello", 5), Eq(Hash("Hello")));
+  EXPECT_THAT(HashBytes(Hash("prefix"), "Suffix", 6),
+              Eq(Hash("prefixSuffix")));
+
+  // Zero bytes are hashed too.
+  const uint32_t zero = 0;
+  const uint32_t one = 1;
+  EXPECT_THAT(HashBytes(kHashOffsetBasis, zero),
+              Not(Eq(HashBytes(kHashOffsetBasis, one))));
+  EXPECT_THAT(HashBytes(kHashOffsetBasis, zero), Not(Eq(kHashOffsetBasis)));
+  EXPECT_THAT(HashBytes(kHashOffsetBasis, one),
+              Eq(HashBytes(kHashOffsetBasis, &one, sizeof(one))));
+}
+
 }  // namespace
 }  // namespace lull
@@ -0,0 +1,150 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/input_processor/input_processor.h"
+#include "lullaby/systems/dispatcher/dispatcher_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+
+const Clock::duration kDeltaTime = std::chrono::milliseconds(17);
+constexpr int kNumButtons = 32;
+constexpr int kNumPrefixedButtons = 4;
+
+// Every device type connected with many buttons, where every device and its
+// first few buttons have their own prefixes.
+struct InputScene {
+  InputScene() {
+    dispatcher = registry.Create<Dispatcher>();
+    input_manager = registry.Create<InputManager>();
+    input_processor = registry.Create<InputProcessor>(&registry);
+    auto* entity_factory = registry.Create<EntityFactory>(&registry);
+    entity_factory->CreateSystem<TransformSystem>();
+    entity_factory->CreateSystem<DispatcherSystem>();
+    entity_factory->Initialize();
+
+    any_press_connection = dispatcher->Connect(
+        Hash("AnyPressEvent"), [this](const EventWrapper&) { ++num_presses; });
+    prefixed_press_connection =
+        dispatcher->Connect(Hash("Button0PressEvent"),
+                            [this](const EventWrapper&) { ++num_prefixed; });
+
+    DeviceProfile profile;
+    profile.buttons.resize(kNumButtons);
+    for (int i = 0; i < InputManager::kMaxNumDeviceTypes; ++i) {
+      const auto device = static_cast<InputManager::DeviceType>(i);
+      input_manager->ConnectDevice(device, profile);
+      input_processor->SetPrefix(device, "Device" + std::to_string(i));
+      for (int j = 0; j < kNumPrefixedButtons; ++j) {
+        const auto button = static_cast<InputManager::ButtonId>(j);
+        input_processor->SetPrefix(device, button,
+                                   "Button" + std::to_string(j));
+      }
+    }
+  }
+
+  // Presses or releases the first button of every device.
+  void SetFirstButtons(bool pressed) {
+    for (int i = 0; i < InputManager::kMaxNumDeviceTypes; ++i) {
+      const auto device = static_cast<InputManager::DeviceType>(i);
+      input_manager->UpdateButton(device, 0, pressed, false);
+    }
+  }
+
+  // Updates every device, as the standard input pipeline does once per frame.
+  void AdvanceFrame() {
+    input_manager->AdvanceFrame(kDeltaTime);
+    for (int i = 0; i < InputManager::kMaxNumDeviceTypes; ++i) {
+      InputFocus focus;
+      focus.device = static_cast<InputManager::DeviceType>(i);
+      input_processor->UpdateDevice(kDeltaTime, focus);
+    }
+  }
+
+  Registry registry;
+  Dispatcher* dispatcher = nullptr;
+  InputManager* input_manager = nullptr;
+  InputProcessor* input_processor = nullptr;
+  Dispatcher::ScopedConnection any_press_connection;
+  Dispatcher::ScopedConnection prefixed_press_connection;
+  int num_presses = 0;
+  int num_prefixed = 0;
+};
+
+// No buttons change, so no events are sent.
+static void BM_UpdateDevicesIdle(benchmark::State& state) {
+  InputScene scene;
+  scene.AdvanceFrame();
+
+  while (state.KeepRunning()) {
+    scene.AdvanceFrame();
+  }
+}
+BENCHMARK(BM_UpdateDevicesIdle);
+
+// A prefixed button on every device is pressed or released each frame.
+static void BM_UpdateDevicesPressing(benchmark::State& state) {
+  InputScene scene;
+  bool pressed = false;
+
+  while (state.KeepRunning()) {
+    pressed = !pressed;
+    scene.SetFirstButtons(pressed);
+    scene.AdvanceFrame();
+  }
+}
+BENCHMARK(BM_UpdateDevicesPressing);
+
+// This test verifies that only changed buttons send events, and that they are
+// sent with both the "Any" and the button's prefix.
+TEST(InputProcessorBenchmarkTest, BenchmarkTestVerification) {
+  InputScene scene;
+  scene.AdvanceFrame();
+  EXPECT_THAT(scene.num_presses, Eq(0));
+
+  scene.SetFirstButtons(true);
+  scene.AdvanceFrame();
+  EXPECT_THAT(scene.num_presses, Eq(InputManager::kMaxNumDeviceTypes));
+  EXPECT_THAT(scene.num_prefixed, Eq(InputManager::kMaxNumDeviceTypes));
+
+  // Holding the buttons doesn't press them again.
+  scene.AdvanceFrame();
+  EXPECT_THAT(scene.num_presses, Eq(InputManager::kMaxNumDeviceTypes));
+
+  // Cleared prefixes only send the "Any" events.
+  scene.input_processor->ClearPrefix(InputManager::kController, 0);
+  scene.SetFirstButtons(false);
+  scene.AdvanceFrame();
+  scene.SetFirstButtons(true);
+  scene.AdvanceFrame();
+  EXPECT_THAT(scene.num_presses, Eq(2 * InputManager::kMaxNumDeviceTypes));
+  EXPECT_THAT(scene.num_prefixed, Eq(2 * InputManager::kMaxNumDeviceTypes - 1));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,179 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/systems/name/name_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Ne;
+
+// A scene of prefab instances, each a binary tree of named entities with the
+// same names in every instance: 64 instances of depth 7 (255 nodes each).
+constexpr int kNumInstances = 64;
+constexpr int kDepth = 7;
+
+struct PrefabScene {
+  // If |indexed| is false no Dispatcher is created, so the NameSystem can't
+  // track reparenting and searches the hierarchy instead.
+  PrefabScene(Registry* registry, bool indexed) {
+    if (indexed) {
+      registry->Create<Dispatcher>();
+    }
+    transform_system = registry->Create<TransformSystem>(registry);
+    const bool kAllowDuplicateNames = true;
+    name_system = registry->Create<NameSystem>(registry, kAllowDuplicateNames);
+
+    roots[0] = CreateEntity();
+    roots[1] = CreateEntity();
+    for (int i = 0; i < kNumInstances; ++i) {
+      const Entity instance = CreateInstance(0);
+      transform_system->AddChild(roots[0], instance);
+      instances.push_back(instance);
+    }
+  }
+
+  Entity CreateEntity() {
+    const Entity entity = ++last_entity;
+    transform_system->Create(entity, Sqt());
+    return entity;
+  }
+
+  // Creates the subtree of an instance whose root is the node with index
+  // |node| in breadth-first order.
+  Entity CreateInstance(int node) {
+    const Entity entity = CreateEntity();
+    name_system->SetName(entity, GetNodeName(node));
+    if (node < (1 << (kDepth - 1)) - 1) {
+      transform_system->AddChild(entity, CreateInstance(2 * node + 1));
+      transform_system->AddChild(entity, CreateInstance(2 * node + 2));
+    }
+    return entity;
+  }
+
+  static std::string GetNodeName(int node) {
+    return "node_" + std::to_string(node);
+  }
+
+  // Moves every instance to the other root.
+  void Reparent() {
+    current_root = 1 - current_root;
+    for (Entity instance : instances) {
+      transform_system->AddChild(roots[current_root], instance);
+    }
+  }
+
+  TransformSystem* transform_system = nullptr;
+  NameSystem* name_system = nullptr;
+  Entity roots[2];
+  int current_root = 0;
+  std::vector<Entity> instances;
+  Entity last_entity = kNullEntity;
+};
+
+// Names of the last leaf, which a depth-first search finds last, and of an
+// inner node halfway down the tree.
+const char* const kLookupNames[] = {"node_254", "node_12"};
+
+static void FindDescendants(benchmark::State& state, bool indexed) {
+  Registry registry;
+  PrefabScene scene(&registry, indexed);
+
+  while (state.KeepRunning()) {
+    for (Entity instance : scene.instances) {
+      for (const char* name : kLookupNames) {
+        benchmark::DoNotOptimize(
+            scene.name_system->FindDescendant(instance, name));
+      }
+    }
+  }
+}
+
+static void BM_FindDescendantSearch(benchmark::State& state) {
+  FindDescendants(state, false);
+}
+BENCHMARK(BM_FindDescendantSearch);
+
+static void BM_FindDescendantIndexed(benchmark::State& state) {
+  FindDescendants(state, true);
+}
+BENCHMARK(BM_FindDescendantIndexed);
+
+// Measures the cost of keeping the index up to date when whole prefab
+// instances are reparented.
+static void Reparent(benchmark::State& state, bool indexed) {
+  Registry registry;
+  PrefabScene scene(&registry, indexed);
+
+  while (state.KeepRunning()) {
+    scene.Reparent();
+  }
+}
+
+static void BM_ReparentSearch(benchmark::State& state) {
+  Reparent(state, false);
+}
+BENCHMARK(BM_ReparentSearch);
+
+static void BM_ReparentIndexed(benchmark::State& state) {
+  Reparent(state, true);
+}
+BENCHMARK(BM_ReparentIndexed);
+
+// This test verifies that the indexed and searching lookups find the same
+// entities, before and after reparenting.
+TEST(NameSystemBenchmarkTest, BenchmarkTestVerification) {
+  Registry search_registry;
+  PrefabScene search_scene(&search_registry, false);
+  Registry indexed_registry;
+  PrefabScene indexed_scene(&indexed_registry, true);
+
+  for (int pass = 0; pass < 2; ++pass) {
+    for (int root = 0; root < 2; ++root) {
+      for (const char* name : kLookupNames) {
+        EXPECT_THAT(
+            indexed_scene.name_system->FindDescendant(
+                indexed_scene.roots[root], name),
+            Eq(search_scene.name_system->FindDescendant(
+                search_scene.roots[root], name)));
+      }
+    }
+    for (size_t i = 0; i < search_scene.instances.size(); ++i) {
+      for (const char* name : kLookupNames) {
+        const Entity expected = search_scene.name_system->FindDescendant(
+            search_scene.instances[i], name);
+        EXPECT_THAT(expected, Ne(kNullEntity));
+        EXPECT_THAT(indexed_scene.name_system->FindDescendant(
+                        indexed_scene.instances[i], name),
+                    Eq(expected));
+      }
+    }
+    search_scene.Reparent();
+    indexed_scene.Reparent();
+  }
+}
+
+}  // namespace
+}  // namespace lull
@@ -193,5 +193,157 @@ TEST_F(NameSystemTest, FindDescendantWithDuplicateNames) {
               Eq(kChildEntity2));
 }
 
+TEST_F(NameSystemTest, FindEntityWithDuplicateNames) {
+  const bool kAllowDuplicateNames = true;
+  const Entity kTestEntity1 = 1;
+  const Entity kTestEntity2 = 2;
+  auto* name_system =
+      registry_.Create<NameSystem>(&registry_, kAllowDuplicateNames);
+  name_system->SetName(kTestEntity1, "left_button");
+  name_system->SetName(kTestEntity2, "left_button");
+
+  EXPECT_THAT(name_system->FindEntity("left_button"), Eq(kTestEntity1));
+
+  name_system->Destroy(kTestEntity1);
+  EXPECT_THAT(name_system->FindEntity("left_button"), Eq(kTestEntity2));
+
+  name_system->SetName(kTestEntity2, "right_button");
+  EXPECT_THAT(name_system->FindEntity("left_button"), Eq(kNullEntity));
+  EXPECT_THAT(name_system->FindEntity("right_button"), Eq(kTestEntity2));
+}
+
+TEST_F(NameSystemTest, FindDescendantAfterReparenting) {
+  const Entity kRootEntity1 = 1;
+  const Entity kRootEntity2 = 2;
+  const Entity kParentEntity = 3;
+  const Entity kChildEntity = 4;
+  Sqt sqt;
+  registry_.Create<Dispatcher>();
+  auto* transform_system = registry_.Create<TransformSystem>(&registry_);
+  auto* name_system = registry_.Create<NameSystem>(&registry_);
+  transform_system->Create(kRootEntity1, sqt);
+  transform_system->Create(kRootEntity2, sqt);
+  transform_system->Create(kParentEntity, sqt);
+  transform_system->Create(kChildEntity, sqt);
+  name_system->SetName(kParentEntity, "parent");
+  name_system->SetName(kChildEntity, "child");
+  transform_system->AddChild(kParentEntity, kChildEntity);
+  transform_system->AddChild(kRootEntity1, kParentEntity);
+
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity1, "parent"),
+              Eq(kParentEntity));
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity1, "child"),
+              Eq(kChildEntity));
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity2, "child"),
+              Eq(kNullEntity));
+
+  // Moving the parent moves its named descendants along with it.
+  transform_system->AddChild(kRootEntity2, kParentEntity);
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity1, "parent"),
+              Eq(kNullEntity));
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity1, "child"),
+              Eq(kNullEntity));
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity2, "parent"),
+              Eq(kParentEntity));
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity2, "child"),
+              Eq(kChildEntity));
+  EXPECT_THAT(name_system->FindDescendant(kParentEntity, "child"),
+              Eq(kChildEntity));
+
+  transform_system->RemoveParent(kChildEntity);
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity2, "child"),
+              Eq(kNullEntity));
+  EXPECT_THAT(name_system->FindDescendant(kParentEntity, "child"),
+              Eq(kNullEntity));
+  EXPECT_THAT(name_system->FindDescendant(kChildEntity, "child"),
+              Eq(kChildEntity));
+
+  // Renaming an attached entity updates its ancestors.
+  name_system->SetName(kParentEntity, "renamed");
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity2, "parent"),
+              Eq(kNullEntity));
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity2, "renamed"),
+              Eq(kParentEntity));
+}
+
+TEST_F(NameSystemTest, FindDescendantWithDuplicateNamesAndDispatcher) {
+  const bool kAllowDuplicateNames = true;
+  const Entity kRootEntity = 1;
+  const Entity kChildEntity1 = 2;
+  const Entity kChildEntity2 = 3;
+  const Entity kParentEntity = 4;
+  const Entity kGrandchildEntity = 5;
+  Sqt sqt;
+  registry_.Create<Dispatcher>();
+  auto* transform_system = registry_.Create<TransformSystem>(&registry_);
+  auto* name_system =
+      registry_.Create<NameSystem>(&registry_, kAllowDuplicateNames);
+  transform_system->Create(kRootEntity, sqt);
+  transform_system->Create(kChildEntity1, sqt);
+  transform_system->Create(kChildEntity2, sqt);
+  transform_system->Create(kParentEntity, sqt);
+  transform_system->Create(kGrandchildEntity, sqt);
+  transform_system->AddChild(kRootEntity, kParentEntity);
+  transform_system->AddChild(kRootEntity, kChildEntity2);
+  transform_system->AddChild(kRootEntity, kChildEntity1);
+  transform_system->AddChild(kParentEntity, kGrandchildEntity);
+  name_system->SetName(kChildEntity1, "button");
+  name_system->SetName(kChildEntity2, "button");
+  name_system->SetName(kGrandchildEntity, "button");
+
+  // The first match in pre-order is returned, regardless of the order in
+  // which the entities were created or named.
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity, "button"),
+              Eq(kGrandchildEntity));
+  EXPECT_THAT(name_system->FindDescendant(kParentEntity, "button"),
+              Eq(kGrandchildEntity));
+
+  transform_system->RemoveParent(kParentEntity);
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity, "button"),
+              Eq(kChildEntity2));
+
+  // The root itself takes precedence over its descendants.
+  name_system->SetName(kRootEntity, "button");
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity, "button"),
+              Eq(kRootEntity));
+
+  name_system->Destroy(kRootEntity);
+  name_system->Destroy(kChildEntity2);
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity, "button"),
+              Eq(kChildEntity1));
+}
+
+TEST_F(NameSystemTest, FindDescendantAfterDestroy) {
+  const bool kAllowDuplicateNames = true;
+  const Entity kRootEntity = 1;
+  const Entity kChildEntity1 = 2;
+  const Entity kChildEntity2 = 3;
+  Sqt sqt;
+  registry_.Create<Dispatcher>();
+  auto* transform_system = registry_.Create<TransformSystem>(&registry_);
+  auto* name_system =
+      registry_.Create<NameSystem>(&registry_, kAllowDuplicateNames);
+  transform_system->Create(kRootEntity, sqt);
+  transform_system->Create(kChildEntity1, sqt);
+  transform_system->Create(kChildEntity2, sqt);
+  transform_system->AddChild(kRootEntity, kChildEntity1);
+  transform_system->AddChild(kRootEntity, kChildEntity2);
+  name_system->SetName(kChildEntity1, "button");
+  name_system->SetName(kChildEntity2, "button");
+
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity, "button"),
+              Eq(kChildEntity1));
+
+  name_system->Destroy(kChildEntity1);
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity, "button"),
+              Eq(kChildEntity2));
+
+  transform_system->RemoveParent(kChildEntity2);
+  name_system->Destroy(kChildEntity2);
+  EXPECT_THAT(name_system->FindDescendant(kRootEntity, "button"),
+              Eq(kNullEntity));
+  EXPECT_THAT(name_system->FindEntity("button"), Eq(kNullEntity));
+}
+
 }  // namespace
 }  // namespace lull
@@ -16,9 +16,14 @@ limitations under the License.
 
 #include "lullaby/systems/nine_patch/nine_patch_system.h"
 
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "lullaby/modules/dispatcher/dispatcher.h"
 #include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/render/mesh_factory.h"
 #include "lullaby/systems/render/render_system.h"
 #include "lullaby/systems/render/testing/mock_render_system_impl.h"
 #include "lullaby/systems/transform/transform_system.h"
@@ -30,9 +35,34 @@ limitations under the License.
 namespace lull {
 namespace {
 
+using ::testing::Eq;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::_;
 using testing::NearMathfuVec3;
 static const float kEpsilon = 0.001f;
 
+// A MeshFactory that counts the number of meshes it has created.
+class CountingMeshFactory : public MeshFactory {
+ public:
+  explicit CountingMeshFactory(int* num_created) : num_created_(num_created) {}
+
+  void CacheMesh(HashValue name, const MeshPtr& mesh) override {}
+  MeshPtr GetMesh(HashValue name) const override { return nullptr; }
+  void ReleaseMesh(HashValue name) override {}
+  MeshPtr CreateMesh(MeshData mesh_data) override {
+    ++*num_created_;
+    return std::make_shared<Mesh>();
+  }
+  MeshPtr CreateMesh(HashValue name, MeshData mesh_data) override {
+    return CreateMesh(std::move(mesh_data));
+  }
+  MeshPtr EmptyMesh() override { return std::make_shared<Mesh>(); }
+
+ private:
+  int* num_created_;
+};
+
 class NinePatchSystemTest : public ::testing::Test {
  public:
   void SetUp() override {
@@ -48,13 +78,44 @@ class NinePatchSystemTest : public ::testing::Test {
   }
 
  protected:
+  // Registers a MeshFactory and gives every entity two render passes.  The
+  // meshes set on the entities are recorded in |meshes_|.
+  void UseMeshFactory() {
+    registry_->Register(std::unique_ptr<MeshFactory>(
+        new CountingMeshFactory(&num_meshes_created_)));
+    ON_CALL(*render_system_, GetRenderPasses(_))
+        .WillByDefault(Return(std::vector<HashValue>{kPassA, kPassB}));
+    ON_CALL(*render_system_, SetMesh(_, _, _))
+        .WillByDefault(Invoke([this](Entity, HashValue, MeshPtr mesh) {
+          meshes_.push_back(mesh);
+        }));
+  }
+
+  Entity CreateNinePatch(const mathfu::vec2& size) {
+    Blueprint blueprint;
+    TransformDefT transform;
+    blueprint.Write(&transform);
+    NinePatchDefT nine_patch;
+    nine_patch.size = size;
+    blueprint.Write(&nine_patch);
+    return entity_factory_->Create(&blueprint);
+  }
+
+  static const HashValue kPassA;
+  static const HashValue kPassB;
+
   std::unique_ptr<Registry> registry_;
   EntityFactory* entity_factory_ = nullptr;
   TransformSystem* transform_system_ = nullptr;
   MockRenderSystemImpl* render_system_ = nullptr;
   NinePatchSystem* nine_patch_system_ = nullptr;
+  int num_meshes_created_ = 0;
+  std::vector<MeshPtr> meshes_;
 };
 
+const HashValue NinePatchSystemTest::kPassA = ConstHash("PassA");
+const HashValue NinePatchSystemTest::kPassB = ConstHash("PassB");
+
 TEST_F(NinePatchSystemTest, Create) {
   TransformDefT transform;
   NinePatchDefT nine_patch;
@@ -89,5 +150,47 @@ TEST_F(NinePatchSystemTest, Aabb) {
   EXPECT_THAT(aabb->max, NearMathfuVec3(half_dims, kEpsilon));
 }
 
+TEST_F(NinePatchSystemTest, SharesIdenticalNinePatches) {
+  UseMeshFactory();
+  EXPECT_CALL(*render_system_, SetMesh(_, _, _)).Times(6);
+
+  CreateNinePatch(mathfu::vec2(2.f, 1.f));
+  CreateNinePatch(mathfu::vec2(2.f, 1.f));
+  EXPECT_THAT(num_meshes_created_, Eq(1));
+
+  // A different size needs its own mesh.
+  CreateNinePatch(mathfu::vec2(3.f, 1.f));
+  EXPECT_THAT(num_meshes_created_, Eq(2));
+
+  // Every pass of the identical nine patches uses the same mesh.
+  ASSERT_THAT(meshes_.size(), Eq(6u));
+  EXPECT_THAT(meshes_[1], Eq(meshes_[0]));
+  EXPECT_THAT(meshes_[2], Eq(meshes_[0]));
+  EXPECT_THAT(meshes_[3], Eq(meshes_[0]));
+  EXPECT_NE(meshes_[4], meshes_[0]);
+  EXPECT_THAT(meshes_[5], Eq(meshes_[4]));
+}
+
+TEST_F(NinePatchSystemTest, ReleasesSharedMeshOnDestroy) {
+  UseMeshFactory();
+
+  const Entity a = CreateNinePatch(mathfu::vec2(2.f, 1.f));
+  const Entity b = CreateNinePatch(mathfu::vec2(2.f, 1.f));
+  std::weak_ptr<Mesh> mesh = meshes_[0];
+  meshes_.clear();
+  EXPECT_FALSE(mesh.expired());
+
+  // The mesh stays cached while any entity uses it.
+  entity_factory_->Destroy(a);
+  EXPECT_FALSE(mesh.expired());
+
+  entity_factory_->Destroy(b);
+  EXPECT_TRUE(mesh.expired());
+
+  // A new nine patch with the same parameters creates the mesh again.
+  CreateNinePatch(mathfu::vec2(2.f, 1.f));
+  EXPECT_THAT(num_meshes_created_, Eq(2));
+}
+
 }  // namespace
 }  // namespace lull
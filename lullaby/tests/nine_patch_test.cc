@@ -625,5 +625,55 @@ TEST(NinePatch, CheckThinUnsymmetricalSliceVertices) {
                             expected_uvs, expected_uv1s);
 }
 
+TEST(NinePatch, HashAndEquality) {
+  NinePatch a;
+  a.size = mathfu::vec2(2.f, 1.f);
+  a.original_size = mathfu::vec2(4.f, 4.f);
+  a.left_slice = .25f;
+  a.subdivisions = mathfu::vec2i(2, 3);
+
+  NinePatch b = a;
+  EXPECT_TRUE(a == b);
+  EXPECT_THAT(Hash(a), Eq(Hash(b)));
+
+  b.size.x = 3.f;
+  EXPECT_TRUE(a != b);
+  EXPECT_NE(Hash(a), Hash(b));
+
+  b = a;
+  b.texture_alt_max.y = .5f;
+  EXPECT_TRUE(a != b);
+  EXPECT_NE(Hash(a), Hash(b));
+}
+
+TEST(NinePatch, IndicesIndependentOfSize) {
+  NinePatch small;
+  small.size = mathfu::vec2(1.f, 1.f);
+  small.original_size = mathfu::vec2(2.f, 2.f);
+  small.left_slice = small.right_slice = .2f;
+  small.bottom_slice = small.top_slice = .2f;
+  small.subdivisions = mathfu::vec2i(3, 2);
+
+  NinePatch large = small;
+  large.size = mathfu::vec2(5.f, 3.f);
+
+  std::vector<lull::VertexPTT> small_vertices(small.GetVertexCount());
+  std::vector<uint16_t> small_indices(small.GetIndexCount());
+  MeshData small_mesh =
+      BuildMeshFromNinePatchVerticesAndIndices(&small_vertices, &small_indices);
+  GenerateNinePatchMesh(small, &small_mesh);
+
+  // Generating the vertices and indices separately matches the full mesh.
+  std::vector<lull::VertexPTT> large_vertices(large.GetVertexCount());
+  std::vector<uint16_t> large_indices(large.GetIndexCount());
+  MeshData large_mesh =
+      BuildMeshFromNinePatchVerticesAndIndices(&large_vertices, &large_indices);
+  GenerateNinePatchVertices(large, &large_mesh);
+  GenerateNinePatchIndices(large, 0, &large_mesh);
+
+  EXPECT_THAT(large_mesh.GetNumVertices(), Eq(small_mesh.GetNumVertices()));
+  EXPECT_THAT(large_indices, Eq(small_indices));
+}
+
 }  // namespace
 }  // namespace lull
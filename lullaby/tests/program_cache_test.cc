@@ -0,0 +1,218 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/program_cache.h"
+
+#include <stdio.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/util/make_unique.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Ne;
+
+constexpr uint32_t kBinaryFormat = 0x1234;
+
+// A fake driver where the binary of a program is simply its handle followed by
+// some padding.
+class FakeBackend : public ProgramCache::Backend {
+ public:
+  std::string GetDriverId() override { return driver_id; }
+
+  bool GetProgramBinary(ProgramHnd program, uint32_t* format,
+                        std::vector<uint8_t>* binary) override {
+    if (!binaries_retrievable) {
+      return false;
+    }
+    *format = kBinaryFormat;
+    binary->assign(64, static_cast<uint8_t>(*program));
+    return true;
+  }
+
+  ProgramHnd LoadProgramBinary(uint32_t format,
+                               Span<uint8_t> binary) override {
+    ++num_loads;
+    if (reject_binaries || format != kBinaryFormat || binary.empty()) {
+      return ProgramHnd();
+    }
+    return ProgramHnd(binary[0]);
+  }
+
+  std::string driver_id = "FakeGL 1.0";
+  bool binaries_retrievable = true;
+  bool reject_binaries = false;
+  int num_loads = 0;
+};
+
+class ProgramCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto backend = MakeUnique<FakeBackend>();
+    backend_ = backend.get();
+    cache_ = MakeUnique<ProgramCache>(::testing::TempDir(), std::move(backend));
+    key_ = ProgramCache::ComputeKey(
+        std::vector<string_view>{"vs", ::testing::UnitTest::GetInstance()
+                                           ->current_test_info()
+                                           ->name()});
+  }
+
+  void TearDown() override { remove(cache_->GetEntryPath(key_).c_str()); }
+
+  std::string ReadEntry() {
+    std::ifstream file(cache_->GetEntryPath(key_), std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+  }
+
+  void WriteEntry(const std::string& data) {
+    std::ofstream file(cache_->GetEntryPath(key_),
+                       std::ios::binary | std::ios::trunc);
+    file << data;
+  }
+
+  bool EntryExists() {
+    return std::ifstream(cache_->GetEntryPath(key_)).good();
+  }
+
+  FakeBackend* backend_ = nullptr;
+  std::unique_ptr<ProgramCache> cache_;
+  ProgramCache::Key key_ = 0;
+};
+
+TEST_F(ProgramCacheTest, ComputeKey) {
+  const ProgramCache::Key key =
+      ProgramCache::ComputeKey(std::vector<string_view>{"ab", "c"});
+  EXPECT_THAT(ProgramCache::ComputeKey(std::vector<string_view>{"ab", "c"}),
+              Eq(key));
+  EXPECT_THAT(ProgramCache::ComputeKey(std::vector<string_view>{"a", "bc"}),
+              Ne(key));
+  EXPECT_THAT(ProgramCache::ComputeKey(std::vector<string_view>{"c", "ab"}),
+              Ne(key));
+  EXPECT_THAT(ProgramCache::ComputeKey(std::vector<string_view>{"ab", "d"}),
+              Ne(key));
+  EXPECT_THAT(
+      ProgramCache::ComputeKey(std::vector<string_view>{"ab", "c", ""}),
+      Ne(key));
+}
+
+TEST_F(ProgramCacheTest, StoreAndLoad) {
+  EXPECT_FALSE(cache_->Load(key_));
+  EXPECT_THAT(cache_->GetStats().misses, Eq(1u));
+
+  EXPECT_TRUE(cache_->Store(key_, ProgramHnd(7)));
+  EXPECT_TRUE(EntryExists());
+  EXPECT_THAT(cache_->GetStats().stores, Eq(1u));
+
+  EXPECT_THAT(*cache_->Load(key_), Eq(7u));
+  EXPECT_THAT(cache_->GetStats().hits, Eq(1u));
+  EXPECT_THAT(cache_->GetStats().invalidated, Eq(0u));
+
+  // Storing again replaces the entry.
+  EXPECT_TRUE(cache_->Store(key_, ProgramHnd(9)));
+  EXPECT_THAT(*cache_->Load(key_), Eq(9u));
+}
+
+TEST_F(ProgramCacheTest, BinaryNotRetrievable) {
+  backend_->binaries_retrievable = false;
+  EXPECT_FALSE(cache_->Store(key_, ProgramHnd(7)));
+  EXPECT_FALSE(cache_->Store(key_, ProgramHnd()));
+  EXPECT_FALSE(EntryExists());
+  EXPECT_THAT(cache_->GetStats().stores, Eq(0u));
+}
+
+TEST_F(ProgramCacheTest, DriverChanged) {
+  EXPECT_TRUE(cache_->Store(key_, ProgramHnd(7)));
+
+  auto backend = MakeUnique<FakeBackend>();
+  backend->driver_id = "FakeGL 2.0";
+  FakeBackend* new_backend = backend.get();
+  ProgramCache cache(::testing::TempDir(), std::move(backend));
+  EXPECT_FALSE(cache.Load(key_));
+  EXPECT_THAT(new_backend->num_loads, Eq(0));
+  EXPECT_THAT(cache.GetStats().invalidated, Eq(1u));
+  EXPECT_FALSE(EntryExists());
+}
+
+TEST_F(ProgramCacheTest, DriverRejectsBinary) {
+  EXPECT_TRUE(cache_->Store(key_, ProgramHnd(7)));
+  backend_->reject_binaries = true;
+  EXPECT_FALSE(cache_->Load(key_));
+  EXPECT_THAT(backend_->num_loads, Eq(1));
+  EXPECT_THAT(cache_->GetStats().invalidated, Eq(1u));
+  EXPECT_FALSE(EntryExists());
+}
+
+TEST_F(ProgramCacheTest, TruncatedEntry) {
+  EXPECT_TRUE(cache_->Store(key_, ProgramHnd(7)));
+  const std::string entry = ReadEntry();
+
+  // Truncated in the header.
+  WriteEntry(entry.substr(0, 10));
+  EXPECT_FALSE(cache_->Load(key_));
+  EXPECT_FALSE(EntryExists());
+
+  // Truncated in the binary.
+  WriteEntry(entry.substr(0, entry.size() - 1));
+  EXPECT_FALSE(cache_->Load(key_));
+  EXPECT_FALSE(EntryExists());
+
+  EXPECT_THAT(backend_->num_loads, Eq(0));
+  EXPECT_THAT(cache_->GetStats().invalidated, Eq(2u));
+}
+
+TEST_F(ProgramCacheTest, CorruptEntry) {
+  EXPECT_TRUE(cache_->Store(key_, ProgramHnd(7)));
+  std::string entry = ReadEntry();
+
+  entry[entry.size() - 1] ^= 0xff;
+  WriteEntry(entry);
+  EXPECT_FALSE(cache_->Load(key_));
+  EXPECT_FALSE(EntryExists());
+
+  // Not an entry at all.
+  WriteEntry(std::string(entry.size(), 'x'));
+  EXPECT_FALSE(cache_->Load(key_));
+  EXPECT_FALSE(EntryExists());
+
+  EXPECT_THAT(backend_->num_loads, Eq(0));
+  EXPECT_THAT(cache_->GetStats().invalidated, Eq(2u));
+
+  // The entry can be rebuilt afterwards.
+  EXPECT_TRUE(cache_->Store(key_, ProgramHnd(7)));
+  EXPECT_THAT(*cache_->Load(key_), Eq(7u));
+}
+
+TEST_F(ProgramCacheTest, EntryForDifferentKey) {
+  // An entry copied to the file of another key must not be used.
+  EXPECT_TRUE(cache_->Store(key_ + 1, ProgramHnd(7)));
+  std::ifstream file(cache_->GetEntryPath(key_ + 1), std::ios::binary);
+  WriteEntry(std::string((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>()));
+  remove(cache_->GetEntryPath(key_ + 1).c_str());
+
+  EXPECT_FALSE(cache_->Load(key_));
+  EXPECT_FALSE(EntryExists());
+}
+
+}  // namespace
+}  // namespace lull
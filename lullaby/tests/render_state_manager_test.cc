@@ -0,0 +1,238 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/render/next/render_state_manager.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/util/make_unique.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+using ::testing::Ne;
+
+// A fake backend that records a description of each GL call made.
+class RecordingBackend : public RenderStateManager::Backend {
+ public:
+  explicit RecordingBackend(std::vector<std::string>* calls) : calls_(calls) {}
+
+  void SetEnabled(RenderStateManager::Capability capability,
+                  bool enabled) override {
+    Record("Enabled", capability, enabled);
+  }
+  void SetAlphaFunc(RenderFunction function, float ref) override {
+    Record("AlphaFunc", function, static_cast<int>(ref));
+  }
+  void SetBlendFunc(BlendFactor src_color, BlendFactor dst_color,
+                    BlendFactor src_alpha, BlendFactor dst_alpha) override {
+    Record("BlendFunc", src_color, dst_color, src_alpha, dst_alpha);
+  }
+  void SetColorMask(bool red, bool green, bool blue, bool alpha) override {
+    Record("ColorMask", red, green, blue, alpha);
+  }
+  void SetCullFace(CullFace face) override { Record("CullFace", face); }
+  void SetFrontFace(FrontFace face) override { Record("FrontFace", face); }
+  void SetDepthMask(bool enabled) override { Record("DepthMask", enabled); }
+  void SetDepthFunc(RenderFunction function) override {
+    Record("DepthFunc", function);
+  }
+  void SetPointSize(float size) override {
+    Record("PointSize", static_cast<int>(size));
+  }
+  void SetStencilFunc(RenderStateManager::Face face,
+                      const StencilFunctionT& function) override {
+    Record("StencilFunc", face, function.function, function.ref,
+           function.mask);
+  }
+  void SetStencilOp(RenderStateManager::Face face,
+                    const StencilOperationT& op) override {
+    Record("StencilOp", face, op.stencil_fail, op.depth_fail, op.pass);
+  }
+  void SetViewport(const mathfu::recti& rect) override {
+    Record("Viewport", rect.pos.x, rect.pos.y, rect.size.x, rect.size.y);
+  }
+
+ private:
+  template <typename... Args>
+  void Record(const char* name, Args... args) {
+    std::string call = name;
+    const int values[] = {static_cast<int>(args)...};
+    for (int value : values) {
+      call += " " + std::to_string(value);
+    }
+    calls_->push_back(call);
+  }
+
+  std::vector<std::string>* calls_;
+};
+
+class RenderStateManagerTest : public ::testing::Test {
+ protected:
+  RenderStateManagerTest()
+      : manager_(MakeUnique<RecordingBackend>(&calls_)) {}
+
+  std::vector<std::string> calls_;
+  RenderStateManager manager_;
+};
+
+TEST_F(RenderStateManagerTest, SetsAllFieldsOfUnknownState) {
+  DepthStateT depth;
+  depth.test_enabled = true;
+  depth.write_enabled = false;
+  depth.function = RenderFunction_LessEqual;
+  manager_.SetDepthState(depth);
+
+  EXPECT_THAT(calls_, ElementsAre("Enabled 3 1", "DepthMask 0",
+                                  "DepthFunc 5"));
+  EXPECT_THAT(manager_.GetStats().num_state_changes, Eq(3u));
+  EXPECT_THAT(manager_.GetStats().num_redundant_states, Eq(0u));
+}
+
+TEST_F(RenderStateManagerTest, OnlyChangesDifferentFields) {
+  DepthStateT depth;
+  depth.test_enabled = true;
+  manager_.SetDepthState(depth);
+  calls_.clear();
+  manager_.ResetStats();
+
+  depth.function = RenderFunction_Less;
+  manager_.SetDepthState(depth);
+
+  EXPECT_THAT(calls_, ElementsAre("DepthFunc 4"));
+  EXPECT_THAT(manager_.GetStats().num_state_changes, Eq(1u));
+  EXPECT_THAT(manager_.GetRenderState().depth_state->function,
+              Eq(RenderFunction_Less));
+}
+
+TEST_F(RenderStateManagerTest, CountsRedundantStates) {
+  BlendStateT blend;
+  blend.enabled = true;
+  CullStateT cull;
+  StencilStateT stencil;
+  const mathfu::recti viewport(0, 0, 640, 480);
+
+  manager_.SetBlendState(blend);
+  manager_.SetCullState(cull);
+  manager_.SetStencilState(stencil);
+  manager_.SetViewport(viewport);
+  calls_.clear();
+  manager_.ResetStats();
+
+  for (int i = 0; i < 3; ++i) {
+    manager_.SetBlendState(blend);
+    manager_.SetCullState(cull);
+    manager_.SetStencilState(stencil);
+    manager_.SetViewport(viewport);
+  }
+
+  EXPECT_THAT(calls_, IsEmpty());
+  EXPECT_THAT(manager_.GetStats().num_state_changes, Eq(0u));
+  EXPECT_THAT(manager_.GetStats().num_redundant_states, Eq(12u));
+}
+
+TEST_F(RenderStateManagerTest, SetsSeparateBlendFunctions) {
+  BlendStateT blend;
+  blend.enabled = true;
+  blend.src_color = BlendFactor_SrcAlpha;
+  blend.dst_color = BlendFactor_OneMinusSrcAlpha;
+  blend.src_alpha = BlendFactor_One;
+  blend.dst_alpha = BlendFactor_Zero;
+  manager_.SetBlendState(blend);
+
+  EXPECT_THAT(calls_, ElementsAre("Enabled 1 1", "BlendFunc 6 7 1 0"));
+}
+
+TEST_F(RenderStateManagerTest, SetsBackStencilOperationOnBackFace) {
+  StencilStateT stencil;
+  manager_.SetStencilState(stencil);
+  calls_.clear();
+
+  stencil.back_op.pass = StencilAction_Replace;
+  manager_.SetStencilState(stencil);
+
+  EXPECT_THAT(calls_, ElementsAre("StencilOp 1 0 0 2"));
+}
+
+TEST_F(RenderStateManagerTest, ResetReappliesState) {
+  ScissorStateT scissor;
+  scissor.enabled = true;
+  manager_.SetScissorState(scissor);
+  manager_.SetScissorState(scissor);
+  EXPECT_THAT(calls_, ElementsAre("Enabled 6 1"));
+
+  manager_.Reset();
+  EXPECT_FALSE(manager_.GetRenderState().scissor_state);
+  manager_.SetScissorState(scissor);
+  EXPECT_THAT(calls_, ElementsAre("Enabled 6 1", "Enabled 6 1"));
+}
+
+TEST_F(RenderStateManagerTest, IgnoresEmptyViewport) {
+  manager_.SetViewport(mathfu::recti(0, 0, 0, 0));
+  EXPECT_THAT(calls_, IsEmpty());
+  EXPECT_FALSE(manager_.GetRenderState().viewport);
+}
+
+TEST(RenderStateManagerKeyTest, KeysDifferForEachField) {
+  const BlendStateT blend;
+  const uint64_t key = RenderStateManager::GetKey(blend);
+  EXPECT_THAT(RenderStateManager::GetKey(BlendStateT()), Eq(key));
+
+  BlendStateT other = blend;
+  other.enabled = true;
+  EXPECT_THAT(RenderStateManager::GetKey(other), Ne(key));
+  other = blend;
+  other.src_alpha = BlendFactor_SrcAlpha;
+  EXPECT_THAT(RenderStateManager::GetKey(other), Ne(key));
+  other = blend;
+  other.src_color = BlendFactor_SrcAlpha;
+  EXPECT_THAT(RenderStateManager::GetKey(other), Ne(key));
+  other = blend;
+  other.dst_alpha = BlendFactor_SrcAlpha;
+  EXPECT_THAT(RenderStateManager::GetKey(other), Ne(key));
+  other = blend;
+  other.dst_color = BlendFactor_SrcAlpha;
+  EXPECT_THAT(RenderStateManager::GetKey(other), Ne(key));
+
+  AlphaTestStateT alpha;
+  const uint64_t alpha_key = RenderStateManager::GetKey(alpha);
+  alpha.ref = 0.5f;
+  EXPECT_THAT(RenderStateManager::GetKey(alpha), Ne(alpha_key));
+}
+
+TEST(RenderStateManagerKeyTest, StencilHashDependsOnFaces) {
+  StencilStateT stencil;
+  const uint64_t hash = RenderStateManager::GetHash(stencil);
+
+  StencilStateT front = stencil;
+  front.front_function.ref = 1;
+  StencilStateT back = stencil;
+  back.back_function.ref = 1;
+
+  EXPECT_THAT(RenderStateManager::GetHash(front), Ne(hash));
+  EXPECT_THAT(RenderStateManager::GetHash(back), Ne(hash));
+  EXPECT_THAT(RenderStateManager::GetHash(front),
+              Ne(RenderStateManager::GetHash(back)));
+}
+
+}  // namespace
+}  // namespace lull
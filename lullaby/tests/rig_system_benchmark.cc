@@ -0,0 +1,239 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/systems/rig/rig_system.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::FloatEq;
+using ::testing::Invoke;
+using ::testing::_;
+
+// A crowd of rigged entities, each with a binary tree of 63 bones (6 levels)
+// all of which are used by the shader.
+constexpr int kNumEntities = 500;
+constexpr int kNumBones = 63;
+constexpr uint8_t kNoParent = 255;
+constexpr int kFloatsPerBone = 12;
+
+using PoseVector = std::vector<mathfu::AffineTransform,
+                               mathfu::simd_allocator<mathfu::AffineTransform>>;
+
+struct CrowdScene {
+  CrowdScene() {
+    auto* entity_factory = registry.Create<EntityFactory>(&registry);
+    render_system = entity_factory->CreateSystem<RenderSystem>()->GetImpl();
+    rig_system = registry.Create<RigSystem>(&registry);
+
+    ON_CALL(*render_system, IsHidden(_))
+        .WillByDefault(Invoke([this](Entity) { return hidden; }));
+    ON_CALL(*render_system, SetUniform(_, _, _, _, _))
+        .WillByDefault(Invoke([this](Entity, const char*, const float* data,
+                                     int dimension, int count) {
+          ++num_uploads;
+          palette.assign(data, data + dimension * count);
+        }));
+
+    std::vector<uint8_t> parents(kNumBones);
+    std::vector<uint8_t> shader_indices(kNumBones);
+    const PoseVector inverse_bind_pose = CreatePose(0.f);
+    for (int i = 0; i < kNumBones; ++i) {
+      parents[i] = i == 0 ? kNoParent : static_cast<uint8_t>((i - 1) / 2);
+      shader_indices[i] = static_cast<uint8_t>(i);
+    }
+
+    for (int i = 0; i < kNumEntities; ++i) {
+      const Entity entity = static_cast<Entity>(i + 1);
+      rig_system->SetRig(entity, parents, inverse_bind_pose, shader_indices);
+      entities.push_back(entity);
+    }
+
+    for (int i = 0; i < kNumPoses; ++i) {
+      poses[i] = CreatePose(static_cast<float>(i));
+    }
+  }
+
+  // Creates a pose where every bone is translated by |x| along the x-axis.
+  static PoseVector CreatePose(float x) {
+    const mathfu::AffineTransform transform = mathfu::mat4::ToAffineTransform(
+        mathfu::mat4::FromTranslationVector(mathfu::vec3(x, 0.f, 0.f)));
+    return PoseVector(kNumBones, transform);
+  }
+
+  void SetLod(const RigSystem::Lod& lod) {
+    for (Entity entity : entities) {
+      rig_system->SetLod(entity, lod);
+    }
+  }
+
+  // Sends every entity the next pose, as the rig animation channel does once
+  // per frame.
+  void AdvanceFrame() {
+    const PoseVector& pose = poses[frame % kNumPoses];
+    for (Entity entity : entities) {
+      rig_system->SetPose(entity, pose);
+    }
+    ++frame;
+  }
+
+  // Like AdvanceFrame, but as if every entity were playing the same shared
+  // animation.
+  void AdvanceFrameShared() {
+    const PoseVector& pose = poses[frame % kNumPoses];
+    rig_system->SetPose(entities[0], pose);
+    for (size_t i = 1; i < entities.size(); ++i) {
+      rig_system->SetSharedPose(entities[i], entities[0], pose);
+    }
+    ++frame;
+  }
+
+  // Returns the x translation of |bone| in the last uploaded palette.  Affine
+  // transforms are stored by row, so it is the last element of the first row.
+  float GetUploadedX(int bone) const {
+    return palette[bone * kFloatsPerBone + 3];
+  }
+
+  static constexpr int kNumPoses = 8;
+
+  Registry registry;
+  MockRenderSystemImpl* render_system = nullptr;
+  RigSystem* rig_system = nullptr;
+  std::vector<Entity> entities;
+  PoseVector poses[kNumPoses];
+  int frame = 0;
+  bool hidden = false;
+  int num_uploads = 0;
+  std::vector<float> palette;
+};
+
+static void BM_SetPoseFullLod(benchmark::State& state) {
+  CrowdScene scene;
+  while (state.KeepRunning()) {
+    scene.AdvanceFrame();
+  }
+}
+BENCHMARK(BM_SetPoseFullLod);
+
+static void BM_SetPoseThrottled(benchmark::State& state) {
+  CrowdScene scene;
+  RigSystem::Lod lod;
+  lod.update_interval = static_cast<int>(state.range(0));
+  scene.SetLod(lod);
+
+  while (state.KeepRunning()) {
+    scene.AdvanceFrame();
+  }
+}
+BENCHMARK(BM_SetPoseThrottled)->Arg(2)->Arg(4);
+
+static void BM_SetPoseFewerBones(benchmark::State& state) {
+  CrowdScene scene;
+  RigSystem::Lod lod;
+  lod.max_bone_depth = static_cast<int>(state.range(0));
+  scene.SetLod(lod);
+
+  while (state.KeepRunning()) {
+    scene.AdvanceFrame();
+  }
+}
+BENCHMARK(BM_SetPoseFewerBones)->Arg(1)->Arg(3);
+
+static void BM_SetSharedPose(benchmark::State& state) {
+  CrowdScene scene;
+  while (state.KeepRunning()) {
+    scene.AdvanceFrameShared();
+  }
+}
+BENCHMARK(BM_SetSharedPose);
+
+static void BM_SetPoseHidden(benchmark::State& state) {
+  CrowdScene scene;
+  scene.hidden = true;
+
+  while (state.KeepRunning()) {
+    scene.AdvanceFrame();
+  }
+}
+BENCHMARK(BM_SetPoseHidden);
+
+// This test verifies the palettes uploaded under each Lod.
+TEST(RigSystemBenchmarkTest, BenchmarkTestVerification) {
+  CrowdScene scene;
+  const Entity entity = scene.entities[0];
+  const PoseVector pose0 = CrowdScene::CreatePose(0.f);
+  const PoseVector pose4 = CrowdScene::CreatePose(4.f);
+
+  // Every pose is evaluated by default.
+  scene.rig_system->SetPose(entity, pose4);
+  EXPECT_THAT(scene.GetUploadedX(kNumBones - 1), FloatEq(4.f));
+
+  // Throttled rigs interpolate towards the last evaluated pose.
+  RigSystem::Lod lod;
+  lod.update_interval = 4;
+  scene.rig_system->SetLod(entity, lod);
+  scene.rig_system->SetPose(entity, pose0);
+  EXPECT_THAT(scene.GetUploadedX(0), FloatEq(0.f));
+  const float expected[] = {0.f, 0.f, 0.f, 1.f, 2.f, 3.f, 4.f};
+  for (float x : expected) {
+    scene.rig_system->SetPose(entity, pose4);
+    EXPECT_THAT(scene.GetUploadedX(0), FloatEq(x));
+  }
+
+  // Bones below the maximum depth follow their ancestors.
+  lod = RigSystem::Lod();
+  lod.max_bone_depth = 0;
+  scene.rig_system->SetLod(entity, lod);
+  PoseVector pose = pose0;
+  pose[0] = pose4[0];
+  scene.rig_system->SetPose(entity, pose);
+  for (int i = 0; i < kNumBones; ++i) {
+    EXPECT_THAT(scene.GetUploadedX(i), FloatEq(4.f));
+  }
+
+  // Shared poses reuse the source's palette rather than evaluating the pose,
+  // but only if the rigs have the same Lod.
+  const Entity other = scene.entities[1];
+  scene.rig_system->SetPose(entity, pose4);
+  scene.rig_system->SetSharedPose(other, entity, pose0);
+  EXPECT_THAT(scene.GetUploadedX(kNumBones - 1), FloatEq(0.f));
+  scene.rig_system->SetLod(other, lod);
+  scene.rig_system->SetSharedPose(other, entity, pose0);
+  EXPECT_THAT(scene.GetUploadedX(kNumBones - 1), FloatEq(4.f));
+
+  // Hidden rigs don't upload anything, and snap to the pose when shown.
+  scene.num_uploads = 0;
+  scene.hidden = true;
+  scene.rig_system->SetPose(entity, pose0);
+  EXPECT_THAT(scene.num_uploads, Eq(0));
+  scene.hidden = false;
+  scene.rig_system->SetPose(entity, pose0);
+  EXPECT_THAT(scene.num_uploads, Eq(1));
+  EXPECT_THAT(scene.GetUploadedX(0), FloatEq(0.f));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,176 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/rig/rig_system.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using ::testing::FloatNear;
+using ::testing::Invoke;
+using ::testing::_;
+
+using PoseVector = std::vector<mathfu::AffineTransform,
+                               mathfu::simd_allocator<mathfu::AffineTransform>>;
+
+// A chain of three bones, all of which are used by the shader.
+constexpr int kNumBones = 3;
+constexpr uint8_t kNoParent = 255;
+constexpr int kFloatsPerBone = 12;
+constexpr float kEpsilon = 1e-4f;
+constexpr Entity kEntity = 1;
+
+// Returns a transform rotating |degrees| around the z-axis and then
+// translating |x| along the x-axis.
+mathfu::AffineTransform CreateTransform(float degrees, float x) {
+  const mathfu::quat rotation = mathfu::quat::FromAngleAxis(
+      degrees * kDegreesToRadians, mathfu::kAxisZ3f);
+  return mathfu::mat4::ToAffineTransform(
+      mathfu::mat4::FromTranslationVector(mathfu::vec3(x, 0.f, 0.f)) *
+      rotation.ToMatrix4());
+}
+
+class RigSystemTest : public ::testing::Test {
+ protected:
+  RigSystemTest() {
+    auto* entity_factory = registry_.Create<EntityFactory>(&registry_);
+    render_system_ = entity_factory->CreateSystem<RenderSystem>()->GetImpl();
+    rig_system_ = registry_.Create<RigSystem>(&registry_);
+
+    ON_CALL(*render_system_, IsHidden(_))
+        .WillByDefault(Invoke([this](Entity) { return hidden_; }));
+    ON_CALL(*render_system_, SetUniform(_, _, _, _, _))
+        .WillByDefault(Invoke([this](Entity, const char*, const float* data,
+                                     int dimension, int count) {
+          ++num_uploads_;
+          palette_.assign(data, data + dimension * count);
+        }));
+
+    const std::vector<uint8_t> parents = {kNoParent, 0, 1};
+    const std::vector<uint8_t> shader_indices = {0, 1, 2};
+    const PoseVector inverse_bind_pose(kNumBones, CreateTransform(0.f, 0.f));
+    rig_system_->SetRig(kEntity, parents, inverse_bind_pose, shader_indices);
+  }
+
+  // Returns the element at |row| and |col| of |bone|'s uploaded transform.
+  // Affine transforms are stored by row.
+  float GetUploaded(int bone, int row, int col) const {
+    return palette_[bone * kFloatsPerBone + row * 4 + col];
+  }
+
+  Registry registry_;
+  MockRenderSystemImpl* render_system_ = nullptr;
+  RigSystem* rig_system_ = nullptr;
+  bool hidden_ = false;
+  int num_uploads_ = 0;
+  std::vector<float> palette_;
+};
+
+TEST_F(RigSystemTest, InterpolatesThrottledPoses) {
+  RigSystem::Lod lod;
+  lod.update_interval = 2;
+  rig_system_->SetLod(kEntity, lod);
+
+  const PoseVector pose0(kNumBones, CreateTransform(0.f, 0.f));
+  const PoseVector pose90(kNumBones, CreateTransform(90.f, 4.f));
+  rig_system_->SetPose(kEntity, pose0);
+  EXPECT_THAT(GetUploaded(0, 0, 0), FloatNear(1.f, kEpsilon));
+
+  // The first pose after an evaluated one is skipped, but still returned by
+  // GetPose().
+  rig_system_->SetPose(kEntity, pose90);
+  EXPECT_THAT(GetUploaded(0, 0, 0), FloatNear(1.f, kEpsilon));
+  EXPECT_THAT(GetUploaded(0, 0, 3), FloatNear(0.f, kEpsilon));
+  const RigSystem::Pose pose = rig_system_->GetPose(kEntity);
+  EXPECT_THAT(pose[0][3], FloatNear(4.f, kEpsilon));
+
+  // The next pose is evaluated, and the palette moves halfway towards it.  The
+  // bone is rotated by 45 degrees without being scaled down.
+  const float kCos45 = 0.70710678f;
+  rig_system_->SetPose(kEntity, pose90);
+  for (int bone = 0; bone < kNumBones; ++bone) {
+    EXPECT_THAT(GetUploaded(bone, 0, 0), FloatNear(kCos45, kEpsilon));
+    EXPECT_THAT(GetUploaded(bone, 1, 0), FloatNear(kCos45, kEpsilon));
+    EXPECT_THAT(GetUploaded(bone, 0, 3), FloatNear(2.f, kEpsilon));
+  }
+
+  // The skipped pose after it completes the interpolation.
+  rig_system_->SetPose(kEntity, pose90);
+  EXPECT_THAT(GetUploaded(0, 0, 0), FloatNear(0.f, kEpsilon));
+  EXPECT_THAT(GetUploaded(0, 1, 0), FloatNear(1.f, kEpsilon));
+  EXPECT_THAT(GetUploaded(0, 0, 3), FloatNear(4.f, kEpsilon));
+}
+
+TEST_F(RigSystemTest, CollapsesBonesBelowMaxBoneDepth) {
+  PoseVector pose(kNumBones);
+  pose[0] = CreateTransform(0.f, 1.f);
+  pose[1] = CreateTransform(0.f, 2.f);
+  pose[2] = CreateTransform(0.f, 3.f);
+
+  RigSystem::Lod lod;
+  lod.max_bone_depth = 0;
+  rig_system_->SetLod(kEntity, lod);
+  rig_system_->SetPose(kEntity, pose);
+  EXPECT_THAT(GetUploaded(0, 0, 3), FloatNear(1.f, kEpsilon));
+  EXPECT_THAT(GetUploaded(1, 0, 3), FloatNear(1.f, kEpsilon));
+  EXPECT_THAT(GetUploaded(2, 0, 3), FloatNear(1.f, kEpsilon));
+
+  lod.max_bone_depth = 1;
+  rig_system_->SetLod(kEntity, lod);
+  rig_system_->SetPose(kEntity, pose);
+  EXPECT_THAT(GetUploaded(0, 0, 3), FloatNear(1.f, kEpsilon));
+  EXPECT_THAT(GetUploaded(1, 0, 3), FloatNear(2.f, kEpsilon));
+  EXPECT_THAT(GetUploaded(2, 0, 3), FloatNear(2.f, kEpsilon));
+
+  rig_system_->SetLod(kEntity, RigSystem::Lod());
+  rig_system_->SetPose(kEntity, pose);
+  EXPECT_THAT(GetUploaded(2, 0, 3), FloatNear(3.f, kEpsilon));
+}
+
+TEST_F(RigSystemTest, SkipsHiddenRigs) {
+  const PoseVector pose1(kNumBones, CreateTransform(0.f, 1.f));
+  const PoseVector pose2(kNumBones, CreateTransform(0.f, 2.f));
+  rig_system_->SetPose(kEntity, pose1);
+  num_uploads_ = 0;
+
+  // Hidden rigs don't upload anything, but still keep the pose.
+  hidden_ = true;
+  rig_system_->SetPose(kEntity, pose2);
+  EXPECT_THAT(num_uploads_, Eq(0));
+  EXPECT_THAT(rig_system_->GetPose(kEntity)[0][3], FloatNear(2.f, kEpsilon));
+
+  // Throttled rigs snap to the pose when shown again.
+  RigSystem::Lod lod;
+  lod.update_interval = 4;
+  rig_system_->SetLod(kEntity, lod);
+  hidden_ = false;
+  rig_system_->SetPose(kEntity, pose2);
+  EXPECT_THAT(num_uploads_, Eq(1));
+  EXPECT_THAT(GetUploaded(0, 0, 3), FloatNear(2.f, kEpsilon));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,177 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/systems/shape/shape_system.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/render/mesh_factory.h"
+#include "lullaby/systems/render/render_system.h"
+#include "lullaby/systems/render/testing/mesh.h"
+#include "lullaby/systems/render/testing/mock_render_system_impl.h"
+#include "lullaby/util/registry.h"
+#include "lullaby/generated/shape_def_generated.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Invoke;
+using ::testing::Return;
+using ::testing::_;
+
+const HashValue kPassA = ConstHash("PassA");
+const HashValue kPassB = ConstHash("PassB");
+
+// A MeshFactory that counts the number of meshes it has created.
+class CountingMeshFactory : public MeshFactory {
+ public:
+  explicit CountingMeshFactory(int* num_created) : num_created_(num_created) {}
+
+  void CacheMesh(HashValue name, const MeshPtr& mesh) override {}
+  MeshPtr GetMesh(HashValue name) const override { return nullptr; }
+  void ReleaseMesh(HashValue name) override {}
+  MeshPtr CreateMesh(MeshData mesh_data) override {
+    ++*num_created_;
+    return std::make_shared<Mesh>();
+  }
+  MeshPtr CreateMesh(HashValue name, MeshData mesh_data) override {
+    return CreateMesh(std::move(mesh_data));
+  }
+  MeshPtr EmptyMesh() override { return std::make_shared<Mesh>(); }
+
+ private:
+  int* num_created_;
+};
+
+class ShapeSystemTest : public ::testing::Test {
+ protected:
+  ShapeSystemTest() {
+    entity_factory_ = registry_.Create<EntityFactory>(&registry_);
+    render_system_ = entity_factory_->CreateSystem<RenderSystem>()->GetImpl();
+    entity_factory_->CreateSystem<ShapeSystem>();
+    entity_factory_->Initialize();
+  }
+
+  void UseMeshFactory(const std::vector<HashValue>& passes = {kPassA}) {
+    registry_.Register(std::unique_ptr<MeshFactory>(
+        new CountingMeshFactory(&num_meshes_created_)));
+    ON_CALL(*render_system_, GetRenderPasses(_)).WillByDefault(Return(passes));
+    ON_CALL(*render_system_, SetMesh(_, _, _))
+        .WillByDefault(Invoke([this](Entity, HashValue pass, MeshPtr mesh) {
+          passes_.push_back(pass);
+          meshes_.push_back(mesh);
+        }));
+  }
+
+  Entity CreateSphere(float radius) {
+    SphereDefT sphere;
+    sphere.radius = radius;
+    sphere.num_parallels = 4;
+    sphere.num_meridians = 4;
+    Blueprint blueprint;
+    blueprint.Write(&sphere);
+    return entity_factory_->Create(&blueprint);
+  }
+
+  Entity CreateRect(float size) {
+    RectMeshDefT quad;
+    quad.size_x = size;
+    quad.size_y = size;
+    quad.verts_x = 2;
+    quad.verts_y = 2;
+    Blueprint blueprint;
+    blueprint.Write(&quad);
+    return entity_factory_->Create(&blueprint);
+  }
+
+  Registry registry_;
+  EntityFactory* entity_factory_ = nullptr;
+  MockRenderSystemImpl* render_system_ = nullptr;
+  int num_meshes_created_ = 0;
+  // The passes given to each SetMesh() call.
+  std::vector<HashValue> passes_;
+  // Stands in for the render components holding references to the meshes.
+  std::vector<MeshPtr> meshes_;
+};
+
+TEST_F(ShapeSystemTest, SharesIdenticalShapes) {
+  UseMeshFactory();
+  EXPECT_CALL(*render_system_, SetMesh(_, _, _)).Times(6);
+
+  for (int i = 0; i < 3; ++i) {
+    CreateSphere(1.f);
+    CreateRect(1.f);
+  }
+
+  EXPECT_THAT(num_meshes_created_, Eq(2));
+  EXPECT_THAT(meshes_[0], Eq(meshes_[2]));
+  EXPECT_THAT(meshes_[0], Eq(meshes_[4]));
+  EXPECT_THAT(meshes_[1], Eq(meshes_[3]));
+  EXPECT_THAT(meshes_[1], Eq(meshes_[5]));
+}
+
+TEST_F(ShapeSystemTest, DistinguishesParameters) {
+  UseMeshFactory();
+  EXPECT_CALL(*render_system_, SetMesh(_, _, _)).Times(4);
+
+  CreateSphere(1.f);
+  CreateSphere(2.f);
+  CreateRect(1.f);
+  CreateRect(2.f);
+
+  EXPECT_THAT(num_meshes_created_, Eq(4));
+}
+
+TEST_F(ShapeSystemTest, RegeneratesReleasedShapes) {
+  UseMeshFactory();
+  EXPECT_CALL(*render_system_, SetMesh(_, _, _)).Times(3);
+
+  CreateSphere(1.f);
+  CreateSphere(1.f);
+  EXPECT_THAT(num_meshes_created_, Eq(1));
+
+  meshes_.clear();
+  CreateSphere(1.f);
+  EXPECT_THAT(num_meshes_created_, Eq(2));
+}
+
+TEST_F(ShapeSystemTest, SetsMeshInEveryPass) {
+  UseMeshFactory({kPassA, kPassB});
+  EXPECT_CALL(*render_system_, SetMesh(_, _, _)).Times(2);
+
+  CreateSphere(1.f);
+
+  EXPECT_THAT(num_meshes_created_, Eq(1));
+  EXPECT_THAT(passes_, ElementsAre(kPassA, kPassB));
+  EXPECT_THAT(meshes_[0], Eq(meshes_[1]));
+}
+
+TEST_F(ShapeSystemTest, SetsMeshDataWithoutMeshFactory) {
+  EXPECT_CALL(*render_system_, SetMesh(_, ::testing::A<const MeshData&>()))
+      .Times(2);
+  EXPECT_CALL(*render_system_, SetMesh(_, _, _)).Times(0);
+
+  CreateSphere(1.f);
+  CreateSphere(1.f);
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,164 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/ecs/component.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/render/detail/render_pool_map.h"
+#include "lullaby/systems/render/detail/sort_order.h"
+#include "lullaby/systems/transform/transform_system.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+using detail::EntityIdPair;
+using detail::RenderPoolMap;
+using detail::SortOrderManager;
+
+struct TestComponent : Component {
+  explicit TestComponent(Entity e) : Component(e) {}
+
+  RenderSortOrder sort_order = 0;
+};
+
+// Number of children at each level of the UI tree: 10 screens, each with 10
+// panels, each with 10 cards, each with 10 elements (11110 nodes in total).
+constexpr int kBranching = 10;
+constexpr int kDepth = 4;
+
+// A UI tree hanging off one of two roots, along with the entities at each
+// level of the hierarchy.
+struct UiTree {
+  explicit UiTree(Registry* registry) : components(registry) {
+    registry->Create<EntityFactory>(registry)->CreateSystem<TransformSystem>();
+    transform_system = registry->Get<TransformSystem>();
+
+    roots[0] = CreateEntity();
+    roots[1] = CreateEntity();
+    levels.resize(kDepth);
+    std::vector<Entity> parents = {roots[0]};
+    for (int depth = 0; depth < kDepth; ++depth) {
+      for (Entity parent : parents) {
+        for (int i = 0; i < kBranching; ++i) {
+          const Entity child = CreateEntity();
+          transform_system->AddChild(parent, child);
+          levels[depth].push_back(child);
+        }
+      }
+      parents = levels[depth];
+    }
+  }
+
+  Entity CreateEntity() {
+    const Entity entity = ++last_entity;
+    transform_system->Create(entity, Sqt());
+    components.EmplaceComponent(entity, RenderPass_Main);
+    return entity;
+  }
+
+  // Moves every screen to the other root and reverses the order of all panels
+  // and cards.  |on_change| is called for each entity whose parent or child
+  // index changed, mirroring the ParentChangedEvent and ChildIndexChangedEvent
+  // sent by the TransformSystem.
+  template <typename Fn>
+  void Rearrange(const Fn& on_change) {
+    current_root = 1 - current_root;
+    for (Entity screen : levels[0]) {
+      transform_system->AddChild(roots[current_root], screen);
+      on_change(screen);
+    }
+    for (int depth = 1; depth < kDepth - 1; ++depth) {
+      for (Entity entity : levels[depth]) {
+        transform_system->MoveChild(entity, 0);
+        on_change(entity);
+      }
+    }
+  }
+
+  TransformSystem* transform_system = nullptr;
+  RenderPoolMap<TestComponent> components;
+  Entity roots[2];
+  int current_root = 0;
+  std::vector<std::vector<Entity>> levels;
+  Entity last_entity = kNullEntity;
+};
+
+// Recalculates the affected subtree for every hierarchy change, which is how
+// the RenderSystem used to respond to hierarchy events.
+static void BM_ReparentUiTreeImmediate(benchmark::State& state) {
+  Registry registry;
+  UiTree tree(&registry);
+  SortOrderManager manager(&registry);
+  const auto get_component = [&](EntityIdPair entity_id_pair) {
+    return tree.components.GetComponent(entity_id_pair.entity);
+  };
+
+  while (state.KeepRunning()) {
+    tree.Rearrange(
+        [&](Entity entity) { manager.UpdateSortOrder(entity, get_component); });
+  }
+}
+BENCHMARK(BM_ReparentUiTreeImmediate);
+
+// Flags hierarchy changes as dirty and recalculates them in a single pass.
+static void BM_ReparentUiTreeBatched(benchmark::State& state) {
+  Registry registry;
+  UiTree tree(&registry);
+  SortOrderManager manager(&registry);
+  const auto get_component = [&](EntityIdPair entity_id_pair) {
+    return tree.components.GetComponent(entity_id_pair.entity);
+  };
+
+  while (state.KeepRunning()) {
+    tree.Rearrange([&](Entity entity) { manager.MarkDirty(entity); });
+    manager.ProcessDirty(get_component);
+  }
+}
+BENCHMARK(BM_ReparentUiTreeBatched);
+
+// This test verifies that both benchmarked paths produce the same sort orders.
+TEST(SortOrderBenchmarkTest, BenchmarkTestVerification) {
+  Registry immediate_registry;
+  UiTree immediate_tree(&immediate_registry);
+  SortOrderManager immediate_manager(&immediate_registry);
+  immediate_tree.Rearrange([&](Entity entity) {
+    immediate_manager.UpdateSortOrder(entity, [&](EntityIdPair entity_id_pair) {
+      return immediate_tree.components.GetComponent(entity_id_pair.entity);
+    });
+  });
+
+  Registry batched_registry;
+  UiTree batched_tree(&batched_registry);
+  SortOrderManager batched_manager(&batched_registry);
+  batched_tree.Rearrange(
+      [&](Entity entity) { batched_manager.MarkDirty(entity); });
+  batched_manager.ProcessDirty([&](EntityIdPair entity_id_pair) {
+    return batched_tree.components.GetComponent(entity_id_pair.entity);
+  });
+
+  for (Entity entity = 1; entity <= immediate_tree.last_entity; ++entity) {
+    EXPECT_THAT(batched_tree.components.GetComponent(entity)->sort_order,
+                Eq(immediate_tree.components.GetComponent(entity)->sort_order));
+  }
+}
+
+}  // namespace
+}  // namespace lull
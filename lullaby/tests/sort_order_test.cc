@@ -307,5 +307,65 @@ TEST(SortOrderTest, UpdateSortOrder) {
   EXPECT_THAT(component_map.GetComponent(5)->sort_order, Eq(kDefaultSortOrder));
 }
 
+// Tests that dirty subtrees are only updated by ProcessDirty, and that dirty
+// descendants of a dirty entity produce the same result as a direct update.
+TEST(SortOrderTest, ProcessDirty) {
+  Registry registry;
+  SortOrderManager manager(&registry);
+  RenderPoolMap<TestComponent> component_map(&registry);
+
+  const int kNumHierarchyEntities = 4;
+  const int kNumEntities = kNumHierarchyEntities + 1;
+  auto* transform_system = CreateTransformSystemWithEntities(
+      &registry, kNumEntities, &component_map);
+
+  for (Entity i = 1; i < kNumHierarchyEntities; ++i) {
+    transform_system->AddChild(i, i + 1);
+  }
+
+  const auto get_component = [&](detail::EntityIdPair entity_id_pair) {
+    return component_map.GetComponent(entity_id_pair.entity);
+  };
+
+  manager.MarkDirty(3);
+  manager.MarkDirty(2);
+  EXPECT_TRUE(manager.HasDirty());
+
+  // Nothing is updated until the dirty entities are processed.
+  for (Entity i = 1; i <= kNumEntities; ++i) {
+    EXPECT_THAT(component_map.GetComponent(i)->sort_order,
+                Eq(kDefaultSortOrder));
+  }
+
+  manager.ProcessDirty(get_component);
+  EXPECT_FALSE(manager.HasDirty());
+
+  EXPECT_THAT(component_map.GetComponent(2)->sort_order.ToHexString(),
+              Eq("0x11000000000000000000000000000000"));
+  EXPECT_THAT(component_map.GetComponent(3)->sort_order.ToHexString(),
+              Eq("0x11100000000000000000000000000000"));
+  EXPECT_THAT(component_map.GetComponent(4)->sort_order.ToHexString(),
+              Eq("0x11110000000000000000000000000000"));
+  EXPECT_THAT(component_map.GetComponent(1)->sort_order, Eq(kDefaultSortOrder));
+  EXPECT_THAT(component_map.GetComponent(5)->sort_order, Eq(kDefaultSortOrder));
+}
+
+// Tests that entities destroyed after being flagged as dirty are not updated.
+TEST(SortOrderTest, ProcessDirtyAfterDestroy) {
+  Registry registry;
+  SortOrderManager manager(&registry);
+  RenderPoolMap<TestComponent> component_map(&registry);
+  CreateTransformSystemWithEntities(&registry, 1, &component_map);
+
+  manager.MarkDirty(1);
+  manager.Destroy(1);
+  EXPECT_FALSE(manager.HasDirty());
+
+  manager.ProcessDirty([&](detail::EntityIdPair entity_id_pair) {
+    return component_map.GetComponent(entity_id_pair.entity);
+  });
+  EXPECT_THAT(component_map.GetComponent(1)->sort_order, Eq(kDefaultSortOrder));
+}
+
 }  // namespace
 }  // namespace lull
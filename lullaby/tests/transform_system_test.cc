@@ -1112,6 +1112,54 @@ TEST_F(TransformSystemTest, Parenting) {
   EXPECT_FALSE(transform_system->IsAncestorOf(parent, grand_child));
 }
 
+TEST_F(TransformSystemTest, WorldRevision) {
+  const Entity parent = 1;
+  const Entity child = 2;
+  const Entity grand_child = 3;
+  const Entity other = 4;
+  CreateDefaultTransform(parent);
+  CreateDefaultTransform(child);
+  CreateDefaultTransform(grand_child);
+  CreateDefaultTransform(other);
+
+  auto* transform_system = registry_.Get<TransformSystem>();
+  transform_system->AddChild(parent, child);
+  transform_system->AddChild(child, grand_child);
+  EXPECT_THAT(transform_system->GetWorldRevision(kNullEntity), Eq(0u));
+
+  const uint64_t parent_revision = transform_system->GetWorldRevision(parent);
+  const uint64_t child_revision = transform_system->GetWorldRevision(child);
+  const uint64_t grand_child_revision =
+      transform_system->GetWorldRevision(grand_child);
+  const uint64_t other_revision = transform_system->GetWorldRevision(other);
+  EXPECT_GT(parent_revision, 0u);
+  EXPECT_GT(grand_child_revision, 0u);
+
+  // Moving the parent changes the world matrices of all its descendants.
+  transform_system->SetLocalTranslation(parent, mathfu::vec3(1.f, 2.f, 3.f));
+  EXPECT_GT(transform_system->GetWorldRevision(parent), parent_revision);
+  EXPECT_GT(transform_system->GetWorldRevision(child), child_revision);
+  EXPECT_GT(transform_system->GetWorldRevision(grand_child),
+            grand_child_revision);
+  EXPECT_THAT(transform_system->GetWorldRevision(other), Eq(other_revision));
+  EXPECT_THAT(transform_system->GetWorldRevision(),
+              Eq(transform_system->GetWorldRevision(grand_child)));
+
+  // Moving the grand child doesn't affect its ancestors.
+  const uint64_t moved_parent_revision =
+      transform_system->GetWorldRevision(parent);
+  const uint64_t moved_child_revision =
+      transform_system->GetWorldRevision(child);
+  transform_system->SetLocalTranslation(grand_child,
+                                        mathfu::vec3(1.f, 0.f, 0.f));
+  EXPECT_THAT(transform_system->GetWorldRevision(parent),
+              Eq(moved_parent_revision));
+  EXPECT_THAT(transform_system->GetWorldRevision(child),
+              Eq(moved_child_revision));
+  EXPECT_THAT(transform_system->GetWorldRevision(grand_child),
+              Eq(transform_system->GetWorldRevision()));
+}
+
 TEST_F(TransformSystemTest, ParentingWithNullParents) {
   SetupEventHandlers();
 
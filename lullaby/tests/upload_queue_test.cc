@@ -0,0 +1,180 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#include "lullaby/systems/render/next/upload_queue.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+
+class UploadQueueTest : public ::testing::Test {
+ protected:
+  UploadQueueTest() : queue_(Budget(0, 0), [this]() { return now_; }) {}
+
+  static UploadQueue::Budget Budget(size_t max_bytes, int max_millis) {
+    UploadQueue::Budget budget;
+    budget.max_bytes_per_frame = max_bytes;
+    budget.max_time_per_frame = std::chrono::milliseconds(max_millis);
+    return budget;
+  }
+
+  // Queues an upload that records |id| when it runs and advances the clock by
+  // |millis|.
+  void Enqueue(int id, size_t num_bytes, int millis = 0,
+               int priority = UploadQueue::kDefaultPriority) {
+    const void* resource = &resources_[id];
+    queue_.Enqueue(resource, num_bytes, [this, id, millis]() {
+      uploaded_.push_back(id);
+      now_ += std::chrono::milliseconds(millis);
+    }, priority);
+  }
+
+  bool Prioritize(int id) { return queue_.Prioritize(&resources_[id]); }
+
+  Clock::time_point now_;
+  UploadQueue queue_;
+  int resources_[8] = {0};
+  std::vector<int> uploaded_;
+};
+
+TEST_F(UploadQueueTest, RunsInQueueOrder) {
+  Enqueue(0, 10);
+  Enqueue(1, 10);
+  Enqueue(2, 10);
+  EXPECT_EQ(queue_.GetNumPendingUploads(), size_t(3));
+  EXPECT_EQ(queue_.GetNumPendingBytes(), size_t(30));
+
+  EXPECT_EQ(queue_.ProcessUploads(), size_t(3));
+  EXPECT_THAT(uploaded_, ElementsAre(0, 1, 2));
+  EXPECT_EQ(queue_.GetNumPendingUploads(), size_t(0));
+  EXPECT_EQ(queue_.GetNumPendingBytes(), size_t(0));
+}
+
+TEST_F(UploadQueueTest, RunsHigherPriorityFirst) {
+  Enqueue(0, 10);
+  Enqueue(1, 10, 0, UploadQueue::kVisiblePriority);
+  Enqueue(2, 10);
+  Enqueue(3, 10, 0, UploadQueue::kVisiblePriority);
+
+  queue_.ProcessUploads();
+  EXPECT_THAT(uploaded_, ElementsAre(1, 3, 0, 2));
+}
+
+TEST_F(UploadQueueTest, ByteBudget) {
+  queue_.SetBudget(Budget(25, 0));
+  Enqueue(0, 10);
+  Enqueue(1, 10);
+  Enqueue(2, 10);
+  Enqueue(3, 10);
+
+  EXPECT_EQ(queue_.ProcessUploads(), size_t(2));
+  EXPECT_THAT(uploaded_, ElementsAre(0, 1));
+  EXPECT_EQ(queue_.GetNumPendingBytes(), size_t(20));
+
+  EXPECT_EQ(queue_.ProcessUploads(), size_t(2));
+  EXPECT_THAT(uploaded_, ElementsAre(0, 1, 2, 3));
+  EXPECT_EQ(queue_.ProcessUploads(), size_t(0));
+}
+
+TEST_F(UploadQueueTest, RunsOneUploadLargerThanBudget) {
+  queue_.SetBudget(Budget(25, 0));
+  Enqueue(0, 100);
+  Enqueue(1, 10);
+
+  EXPECT_EQ(queue_.ProcessUploads(), size_t(1));
+  EXPECT_THAT(uploaded_, ElementsAre(0));
+  EXPECT_EQ(queue_.ProcessUploads(), size_t(1));
+  EXPECT_THAT(uploaded_, ElementsAre(0, 1));
+}
+
+TEST_F(UploadQueueTest, TimeBudget) {
+  queue_.SetBudget(Budget(0, 5));
+  Enqueue(0, 10, 2);
+  Enqueue(1, 10, 2);
+  Enqueue(2, 10, 2);
+  Enqueue(3, 10, 2);
+
+  // The budget is checked after each upload, so the third upload runs and
+  // overshoots it.
+  EXPECT_EQ(queue_.ProcessUploads(), size_t(3));
+  EXPECT_THAT(uploaded_, ElementsAre(0, 1, 2));
+  EXPECT_EQ(queue_.ProcessUploads(), size_t(1));
+  EXPECT_THAT(uploaded_, ElementsAre(0, 1, 2, 3));
+}
+
+TEST_F(UploadQueueTest, Prioritize) {
+  queue_.SetBudget(Budget(10, 0));
+  Enqueue(0, 10);
+  Enqueue(1, 10);
+  Enqueue(2, 10);
+
+  EXPECT_TRUE(Prioritize(2));
+  EXPECT_FALSE(Prioritize(3));
+
+  queue_.ProcessUploads();
+  EXPECT_THAT(uploaded_, ElementsAre(2));
+  queue_.ProcessUploads();
+  queue_.ProcessUploads();
+  EXPECT_THAT(uploaded_, ElementsAre(2, 0, 1));
+
+  EXPECT_FALSE(Prioritize(2));
+}
+
+TEST_F(UploadQueueTest, PrioritizeNeverLowersPriority) {
+  Enqueue(0, 10);
+  Enqueue(1, 10, 0, UploadQueue::kVisiblePriority + 1);
+
+  EXPECT_TRUE(Prioritize(1));
+  queue_.ProcessUploads();
+  EXPECT_THAT(uploaded_, ElementsAre(1, 0));
+}
+
+TEST_F(UploadQueueTest, FlushIgnoresBudget) {
+  queue_.SetBudget(Budget(10, 1));
+  Enqueue(0, 10, 1);
+  Enqueue(1, 10, 1);
+  Enqueue(2, 10, 1);
+
+  EXPECT_EQ(queue_.Flush(), size_t(3));
+  EXPECT_THAT(uploaded_, ElementsAre(0, 1, 2));
+  EXPECT_EQ(queue_.GetNumPendingUploads(), size_t(0));
+}
+
+TEST_F(UploadQueueTest, UploadsCanEnqueueUploads) {
+  queue_.Enqueue(&resources_[0], 10, [this]() {
+    uploaded_.push_back(0);
+    Enqueue(1, 10);
+  });
+
+  EXPECT_EQ(queue_.Flush(), size_t(2));
+  EXPECT_THAT(uploaded_, ElementsAre(0, 1));
+}
+
+TEST_F(UploadQueueTest, IgnoresEmptyTasks) {
+  queue_.Enqueue(&resources_[0], 10, nullptr);
+  EXPECT_EQ(queue_.GetNumPendingUploads(), size_t(0));
+  EXPECT_EQ(queue_.GetNumPendingBytes(), size_t(0));
+}
+
+}  // namespace
+}  // namespace lull
@@ -75,5 +75,48 @@ TEST(UTF8StringTest, Simple) {
   EXPECT_EQ(tos, cats);
 }
 
+TEST(UTF8StringTest, EditsInTheMiddle) {
+  UTF8String utf8_string(bar);
+
+  // Edit at positions on either side of the previous edit so that the
+  // character to byte mapping has to be walked in both directions.
+  utf8_string.Insert(3, foo);
+  EXPECT_EQ(static_cast<size_t>(15), utf8_string.CharSize());
+  EXPECT_EQ("\xC3\x8E", utf8_string.CharAt(3));
+  EXPECT_EQ("\x72", utf8_string.CharAt(2));
+  EXPECT_EQ("\xF0\xAF\xA5\x80", utf8_string.CharAt(11));
+
+  utf8_string.DeleteChars(3, 9);
+  EXPECT_EQ(UTF8String(bar), utf8_string);
+
+  utf8_string.Insert(1, "ab");
+  utf8_string.Insert(8, "c");
+  utf8_string.Insert(0, "d");
+  EXPECT_EQ(std::string("d\xC3\x8E" "ab" "\xC3\xA9\x72\xC3\xB1\xC3\xA5"
+                        "\xE1\x82\xA0" "c"),
+            utf8_string.str());
+  EXPECT_EQ("\xC3\xA9\x72", utf8_string.Substr(4, 2));
+  EXPECT_EQ("c", utf8_string.Substr(9, 5));
+  EXPECT_EQ("", utf8_string.Substr(10, 1));
+
+  // Out of range edits are no-ops.
+  EXPECT_EQ(static_cast<size_t>(0), utf8_string.Insert(11, "e"));
+  utf8_string.DeleteChars(10, 1);
+  EXPECT_EQ(static_cast<size_t>(10), utf8_string.CharSize());
+
+  utf8_string.Set("xyz");
+  EXPECT_EQ("xyz", utf8_string.str());
+  EXPECT_EQ(static_cast<size_t>(3), utf8_string.CharSize());
+}
+
+TEST(UTF8StringTest, TruncatedCharacter) {
+  // A truncated multi-byte character shouldn't read past the end of the
+  // string.
+  UTF8String utf8_string("a\xE1\x82");
+  EXPECT_EQ(static_cast<size_t>(2), utf8_string.CharSize());
+  EXPECT_EQ(static_cast<size_t>(3), utf8_string.ByteSize());
+  EXPECT_EQ("\xE1\x82", utf8_string.CharAt(1));
+}
+
 }  // namespace
 }  // namespace lull
@@ -0,0 +1,217 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "flatbuffers/flatbuffers.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/contrib/visibility/visibility_system.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+
+constexpr int kNumGroups = 4;
+constexpr int kNumMovingContents = 16;
+
+// A scene of window groups, each with a single window and a row of contents
+// of which half are inside the window.
+struct VisibilityScene {
+  explicit VisibilityScene(int num_contents_per_group) {
+    dispatcher = registry.Create<Dispatcher>();
+    transform_system = registry.Create<TransformSystem>(&registry);
+    visibility_system = registry.Create<VisibilitySystem>(&registry);
+
+    BuildDefs();
+    enter_connection = dispatcher->Connect(
+        Hash("Enter"), [this](const EventWrapper&) { ++num_enters; });
+    exit_connection = dispatcher->Connect(
+        Hash("Exit"), [this](const EventWrapper&) { ++num_exits; });
+
+    for (int i = 0; i < kNumGroups; ++i) {
+      const Entity group = CreateEntity(mathfu::kZeros3f);
+      visibility_system->Create(group, ConstHash("VisibilityWindowGroupDef"),
+                                group_def);
+      groups.push_back(group);
+
+      for (int j = 0; j < num_contents_per_group; ++j) {
+        const Entity content = CreateEntity(GetPosition(j, false));
+        visibility_system->Create(content, ConstHash("VisibilityContentDef"),
+                                  content_def);
+        transform_system->AddChild(group, content);
+        contents.push_back(content);
+      }
+    }
+  }
+
+  void BuildDefs() {
+    const AabbDef bounds(Vec3(-1.f, -1.f, -1.f), Vec3(1.f, 1.f, 1.f));
+    const flatbuffers::Offset<EventDef> enter =
+        CreateEventDefDirect(group_fbb, "Enter", false, true);
+    const flatbuffers::Offset<EventDef> exit =
+        CreateEventDefDirect(group_fbb, "Exit", false, true);
+    const flatbuffers::Offset<VisibilityWindowDef> window =
+        CreateVisibilityWindowDef(group_fbb, &bounds,
+                                  group_fbb.CreateVector(&enter, 1),
+                                  group_fbb.CreateVector(&exit, 1));
+    group_fbb.Finish(CreateVisibilityWindowGroupDef(
+        group_fbb, group_fbb.CreateVector(&window, 1)));
+    group_def = flatbuffers::GetRoot<VisibilityWindowGroupDef>(
+        group_fbb.GetBufferPointer());
+
+    content_fbb.Finish(CreateVisibilityContentDef(content_fbb));
+    content_def = flatbuffers::GetRoot<VisibilityContentDef>(
+        content_fbb.GetBufferPointer());
+  }
+
+  Entity CreateEntity(const mathfu::vec3& position) {
+    const Entity entity = ++last_entity;
+    Sqt sqt;
+    sqt.translation = position;
+    transform_system->Create(entity, sqt);
+    return entity;
+  }
+
+  // Even contents are inside the window, odd ones outside.  |toggled| swaps
+  // them.
+  static mathfu::vec3 GetPosition(int index, bool toggled) {
+    const bool inside = (index % 2 == 0) != toggled;
+    return mathfu::vec3(inside ? 0.5f : 1.5f, 0.f, 0.f);
+  }
+
+  // Moves the first few contents of every group across the window edge.
+  void MoveSomeContents() {
+    toggled = !toggled;
+    const size_t num_per_group = contents.size() / groups.size();
+    for (size_t i = 0; i < groups.size(); ++i) {
+      for (int j = 0; j < kNumMovingContents; ++j) {
+        transform_system->SetLocalTranslation(
+            contents[i * num_per_group + j], GetPosition(j, toggled));
+      }
+    }
+  }
+
+  // Moves every group, which changes the world transforms of all contents
+  // without changing whether they are inside their windows.
+  void MoveGroups() {
+    group_offset = 1.f - group_offset;
+    for (Entity group : groups) {
+      transform_system->SetLocalTranslation(
+          group, mathfu::vec3(group_offset, 0.f, 0.f));
+    }
+  }
+
+  Registry registry;
+  Dispatcher* dispatcher = nullptr;
+  TransformSystem* transform_system = nullptr;
+  VisibilitySystem* visibility_system = nullptr;
+  flatbuffers::FlatBufferBuilder group_fbb;
+  flatbuffers::FlatBufferBuilder content_fbb;
+  const VisibilityWindowGroupDef* group_def = nullptr;
+  const VisibilityContentDef* content_def = nullptr;
+  Dispatcher::ScopedConnection enter_connection;
+  Dispatcher::ScopedConnection exit_connection;
+  std::vector<Entity> groups;
+  std::vector<Entity> contents;
+  Entity last_entity = kNullEntity;
+  bool toggled = false;
+  float group_offset = 0.f;
+  int num_enters = 0;
+  int num_exits = 0;
+};
+
+// Nothing moves, so no content needs to be re-tested.
+static void BM_UpdateIdle(benchmark::State& state) {
+  VisibilityScene scene(static_cast<int>(state.range(0)));
+  scene.visibility_system->Update();
+
+  while (state.KeepRunning()) {
+    scene.visibility_system->Update();
+  }
+}
+BENCHMARK(BM_UpdateIdle)->Arg(256)->Arg(4096);
+
+// A fixed number of contents move each frame, regardless of population.
+static void BM_UpdateSomeMoving(benchmark::State& state) {
+  VisibilityScene scene(static_cast<int>(state.range(0)));
+  scene.visibility_system->Update();
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    scene.MoveSomeContents();
+    state.ResumeTiming();
+    scene.visibility_system->Update();
+  }
+}
+BENCHMARK(BM_UpdateSomeMoving)->Arg(256)->Arg(4096);
+
+// Every content's world transform changes each frame, so every content is
+// re-tested, as was previously done every frame.
+static void BM_UpdateAllMoving(benchmark::State& state) {
+  VisibilityScene scene(static_cast<int>(state.range(0)));
+  scene.visibility_system->Update();
+
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    scene.MoveGroups();
+    state.ResumeTiming();
+    scene.visibility_system->Update();
+  }
+}
+BENCHMARK(BM_UpdateAllMoving)->Arg(256)->Arg(4096);
+
+// This test verifies that incremental updates send the same events as testing
+// every content each frame would.
+TEST(VisibilitySystemBenchmarkTest, BenchmarkTestVerification) {
+  const int kNumContentsPerGroup = 64;
+  const int kNumContents = kNumGroups * kNumContentsPerGroup;
+  VisibilityScene scene(kNumContentsPerGroup);
+
+  // The starting state is unknown, so every content gets an event.
+  scene.visibility_system->Update();
+  EXPECT_THAT(scene.num_enters, Eq(kNumContents / 2));
+  EXPECT_THAT(scene.num_exits, Eq(kNumContents / 2));
+
+  scene.num_enters = 0;
+  scene.num_exits = 0;
+  scene.visibility_system->Update();
+  scene.MoveGroups();
+  scene.visibility_system->Update();
+  EXPECT_THAT(scene.num_enters, Eq(0));
+  EXPECT_THAT(scene.num_exits, Eq(0));
+
+  scene.MoveSomeContents();
+  scene.visibility_system->Update();
+  EXPECT_THAT(scene.num_enters, Eq(kNumGroups * kNumMovingContents / 2));
+  EXPECT_THAT(scene.num_exits, Eq(kNumGroups * kNumMovingContents / 2));
+
+  // Resetting a window re-tests all of its contents.
+  scene.num_enters = 0;
+  scene.num_exits = 0;
+  scene.visibility_system->ResetWindow(scene.groups[0]);
+  scene.visibility_system->Update();
+  EXPECT_THAT(scene.num_enters + scene.num_exits, Eq(kNumContentsPerGroup));
+}
+
+}  // namespace
+}  // namespace lull
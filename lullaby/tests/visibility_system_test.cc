@@ -0,0 +1,157 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/contrib/visibility/visibility_system.h"
+
+#include "flatbuffers/flatbuffers.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/util/hash.h"
+#include "lullaby/util/registry.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+
+const mathfu::vec3 kInside(0.5f, 0.f, 0.f);
+const mathfu::vec3 kOutside(1.5f, 0.f, 0.f);
+
+class VisibilitySystemTest : public ::testing::Test {
+ protected:
+  VisibilitySystemTest() {
+    auto* dispatcher = registry_.Create<Dispatcher>();
+    transform_system_ = registry_.Create<TransformSystem>(&registry_);
+    visibility_system_ = registry_.Create<VisibilitySystem>(&registry_);
+
+    enter_connection_ = dispatcher->Connect(
+        Hash("Enter"), [this](const EventWrapper&) { ++num_enters_; });
+    exit_connection_ = dispatcher->Connect(
+        Hash("Exit"), [this](const EventWrapper&) { ++num_exits_; });
+
+    // A group with a single window covering [-1, 1] on every axis.
+    const AabbDef bounds(Vec3(-1.f, -1.f, -1.f), Vec3(1.f, 1.f, 1.f));
+    const flatbuffers::Offset<EventDef> enter =
+        CreateEventDefDirect(group_fbb_, "Enter", false, true);
+    const flatbuffers::Offset<EventDef> exit =
+        CreateEventDefDirect(group_fbb_, "Exit", false, true);
+    const flatbuffers::Offset<VisibilityWindowDef> window =
+        CreateVisibilityWindowDef(group_fbb_, &bounds,
+                                  group_fbb_.CreateVector(&enter, 1),
+                                  group_fbb_.CreateVector(&exit, 1));
+    group_fbb_.Finish(CreateVisibilityWindowGroupDef(
+        group_fbb_, group_fbb_.CreateVector(&window, 1)));
+    content_fbb_.Finish(CreateVisibilityContentDef(content_fbb_));
+
+    group_ = CreateEntity(mathfu::kZeros3f);
+    visibility_system_->Create(
+        group_, ConstHash("VisibilityWindowGroupDef"),
+        flatbuffers::GetRoot<VisibilityWindowGroupDef>(
+            group_fbb_.GetBufferPointer()));
+    content_ = CreateEntity(kInside);
+    visibility_system_->Create(content_, ConstHash("VisibilityContentDef"),
+                               flatbuffers::GetRoot<VisibilityContentDef>(
+                                   content_fbb_.GetBufferPointer()));
+    transform_system_->AddChild(group_, content_);
+  }
+
+  Entity CreateEntity(const mathfu::vec3& position) {
+    const Entity entity = ++last_entity_;
+    Sqt sqt;
+    sqt.translation = position;
+    transform_system_->Create(entity, sqt);
+    return entity;
+  }
+
+  Registry registry_;
+  TransformSystem* transform_system_ = nullptr;
+  VisibilitySystem* visibility_system_ = nullptr;
+  flatbuffers::FlatBufferBuilder group_fbb_;
+  flatbuffers::FlatBufferBuilder content_fbb_;
+  Dispatcher::ScopedConnection enter_connection_;
+  Dispatcher::ScopedConnection exit_connection_;
+  Entity last_entity_ = kNullEntity;
+  Entity group_ = kNullEntity;
+  Entity content_ = kNullEntity;
+  int num_enters_ = 0;
+  int num_exits_ = 0;
+};
+
+TEST_F(VisibilitySystemTest, EntersAndExits) {
+  visibility_system_->Update();
+  EXPECT_THAT(num_enters_, Eq(1));
+  EXPECT_THAT(num_exits_, Eq(0));
+
+  // Nothing changes without movement.
+  visibility_system_->Update();
+  EXPECT_THAT(num_enters_, Eq(1));
+  EXPECT_THAT(num_exits_, Eq(0));
+
+  transform_system_->SetLocalTranslation(content_, kOutside);
+  visibility_system_->Update();
+  EXPECT_THAT(num_enters_, Eq(1));
+  EXPECT_THAT(num_exits_, Eq(1));
+}
+
+TEST_F(VisibilitySystemTest, DetectsChangesAcrossSkippedUpdates) {
+  visibility_system_->Update();
+  EXPECT_THAT(num_enters_, Eq(1));
+
+  // The content moves out and something else moves on a frame without an
+  // Update(), so the world revision has moved on by more than one change.
+  const Entity other = CreateEntity(mathfu::kZeros3f);
+  transform_system_->SetLocalTranslation(content_, kOutside);
+  transform_system_->SetLocalTranslation(other, kOutside);
+  visibility_system_->Update();
+  EXPECT_THAT(num_exits_, Eq(1));
+}
+
+TEST_F(VisibilitySystemTest, DetectsChangesWhileGroupDisabled) {
+  visibility_system_->Update();
+  EXPECT_THAT(num_enters_, Eq(1));
+
+  // The group is skipped while disabled, so the content's move is only
+  // detected once it is enabled again.
+  transform_system_->Disable(group_);
+  transform_system_->SetLocalTranslation(content_, kOutside);
+  visibility_system_->Update();
+  EXPECT_THAT(num_exits_, Eq(0));
+
+  transform_system_->Enable(group_);
+  visibility_system_->Update();
+  EXPECT_THAT(num_exits_, Eq(1));
+}
+
+TEST_F(VisibilitySystemTest, DetectsChangesWhenGroupMoves) {
+  visibility_system_->Update();
+  EXPECT_THAT(num_enters_, Eq(1));
+
+  // Moving the group moves the content out of the window in world space,
+  // but not relative to the window.
+  transform_system_->SetLocalTranslation(group_, kOutside);
+  visibility_system_->Update();
+  EXPECT_THAT(num_exits_, Eq(0));
+
+  // Moving the window's content relative to the group is still detected.
+  transform_system_->SetLocalTranslation(content_, kOutside);
+  visibility_system_->Update();
+  EXPECT_THAT(num_exits_, Eq(1));
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,133 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/modules/ecs/world_snapshot.h"
+#include "lullaby/systems/name/name_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+
+namespace lull {
+namespace {
+
+using ::testing::Eq;
+
+// The world consists of 100 groups, each with 199 children, for a total of
+// 20000 entities.  Every entity has a transform and a unique name.
+constexpr int kNumGroups = 100;
+constexpr int kNumChildrenPerGroup = 199;
+constexpr int kNumEntities = kNumGroups * (kNumChildrenPerGroup + 1);
+
+struct World {
+  World() {
+    registry.Create<Dispatcher>();
+    entity_factory = registry.Create<EntityFactory>(&registry);
+    transform_system = entity_factory->CreateSystem<TransformSystem>();
+    name_system = entity_factory->CreateSystem<NameSystem>();
+    entity_factory->Initialize();
+
+    snapshot = registry.Create<WorldSnapshot>(&registry);
+    snapshot->RegisterSystem<TransformSystem>(1);
+    snapshot->RegisterSystem<NameSystem>(1);
+  }
+
+  // Creates all the entities one at a time, which is the work done when the
+  // world is recreated from blueprints (minus loading and parsing them).
+  void Populate() {
+    for (int i = 0; i < kNumGroups; ++i) {
+      const Entity group = CreateEntity(i, 0.f);
+      for (int j = 0; j < kNumChildrenPerGroup; ++j) {
+        const Entity child = CreateEntity(j, 1.f);
+        transform_system->AddChild(group, child);
+      }
+    }
+  }
+
+  Entity CreateEntity(int index, float depth) {
+    const Entity entity = entity_factory->Create();
+    const Sqt sqt(mathfu::vec3(static_cast<float>(index), depth, 0.f),
+                  mathfu::quat::identity, mathfu::kOnes3f);
+    transform_system->Create(entity, sqt);
+    name_system->SetName(entity, "entity_" + std::to_string(entity));
+    return entity;
+  }
+
+  Registry registry;
+  EntityFactory* entity_factory = nullptr;
+  TransformSystem* transform_system = nullptr;
+  NameSystem* name_system = nullptr;
+  WorldSnapshot* snapshot = nullptr;
+};
+
+static void BM_RebuildWorld(benchmark::State& state) {
+  while (state.KeepRunning()) {
+    World world;
+    world.Populate();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumEntities);
+}
+BENCHMARK(BM_RebuildWorld);
+
+static void BM_SaveWorldSnapshot(benchmark::State& state) {
+  World world;
+  world.Populate();
+  size_t size = 0;
+  while (state.KeepRunning()) {
+    size = world.snapshot->Save().size();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumEntities);
+  state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_SaveWorldSnapshot);
+
+static void BM_RestoreWorldSnapshot(benchmark::State& state) {
+  World original;
+  original.Populate();
+  const WorldSnapshot::Buffer buffer = original.snapshot->Save();
+  while (state.KeepRunning()) {
+    World world;
+    world.snapshot->Restore(buffer);
+  }
+  state.SetItemsProcessed(state.iterations() * kNumEntities);
+  state.SetBytesProcessed(state.iterations() * buffer.size());
+}
+BENCHMARK(BM_RestoreWorldSnapshot);
+
+// This test verifies that the restored world matches the original one.
+TEST(WorldSnapshotBenchmarkTest, BenchmarkTestVerification) {
+  World original;
+  original.Populate();
+  const WorldSnapshot::Buffer buffer = original.snapshot->Save();
+
+  World restored;
+  EXPECT_TRUE(restored.snapshot->Restore(buffer));
+  for (Entity entity = 1; entity <= static_cast<Entity>(kNumEntities);
+       ++entity) {
+    EXPECT_THAT(restored.transform_system->GetParent(entity),
+                Eq(original.transform_system->GetParent(entity)));
+    EXPECT_THAT(restored.name_system->GetName(entity),
+                Eq(original.name_system->GetName(entity)));
+  }
+}
+
+}  // namespace
+}  // namespace lull
@@ -0,0 +1,157 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/modules/ecs/world_snapshot.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lullaby/modules/dispatcher/dispatcher.h"
+#include "lullaby/modules/ecs/entity_factory.h"
+#include "lullaby/systems/name/name_system.h"
+#include "lullaby/systems/transform/transform_system.h"
+#include "lullaby/tests/mathfu_matchers.h"
+
+namespace lull {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::IsNull;
+using ::testing::NotNull;
+using testing::EqualsMathfu;
+using testing::EqualsMathfuVec3;
+
+constexpr uint32_t kTransformVersion = 1;
+constexpr uint32_t kNameVersion = 1;
+
+// A minimal world with the Systems that participate in snapshots.
+struct World {
+  World() {
+    registry.Create<Dispatcher>();
+    entity_factory = registry.Create<EntityFactory>(&registry);
+    transform_system = entity_factory->CreateSystem<TransformSystem>();
+    name_system = entity_factory->CreateSystem<NameSystem>();
+    entity_factory->Initialize();
+
+    snapshot = registry.Create<WorldSnapshot>(&registry);
+    snapshot->RegisterSystem<TransformSystem>(kTransformVersion);
+    snapshot->RegisterSystem<NameSystem>(kNameVersion);
+  }
+
+  Registry registry;
+  EntityFactory* entity_factory = nullptr;
+  TransformSystem* transform_system = nullptr;
+  NameSystem* name_system = nullptr;
+  WorldSnapshot* snapshot = nullptr;
+};
+
+TEST(WorldSnapshotTest, SaveAndRestore) {
+  World original;
+  const Entity parent = original.entity_factory->Create();
+  const Entity child1 = original.entity_factory->Create();
+  const Entity child2 = original.entity_factory->Create();
+  original.transform_system->Create(
+      parent, Sqt(mathfu::vec3(1.f, 2.f, 3.f), mathfu::quat::identity,
+                  mathfu::kOnes3f));
+  original.transform_system->Create(
+      child1, Sqt(mathfu::vec3(0.f, 1.f, 0.f), mathfu::quat::identity,
+                  mathfu::vec3(2.f, 2.f, 2.f)));
+  original.transform_system->Create(child2, Sqt());
+  original.transform_system->AddChild(parent, child1);
+  original.transform_system->AddChild(parent, child2);
+  original.transform_system->SetAabb(
+      child1, Aabb(mathfu::vec3(-1.f, -1.f, -1.f), mathfu::kOnes3f));
+  original.transform_system->Disable(child2);
+  original.name_system->SetName(parent, "parent");
+  original.name_system->SetName(child1, "child1");
+
+  const WorldSnapshot::Buffer buffer = original.snapshot->Save();
+
+  World restored;
+  EXPECT_TRUE(restored.snapshot->Restore(buffer));
+
+  TransformSystem* transform_system = restored.transform_system;
+  EXPECT_THAT(transform_system->GetParent(child1), Eq(parent));
+  EXPECT_THAT(transform_system->GetParent(child2), Eq(parent));
+  ASSERT_THAT(transform_system->GetChildren(parent), NotNull());
+  EXPECT_THAT(*transform_system->GetChildren(parent),
+              ElementsAre(child1, child2));
+  EXPECT_THAT(transform_system->GetLocalScale(child1),
+              EqualsMathfuVec3(mathfu::vec3(2.f, 2.f, 2.f)));
+  EXPECT_THAT(*transform_system->GetWorldFromEntityMatrix(child1),
+              EqualsMathfu(*original.transform_system->GetWorldFromEntityMatrix(
+                  child1)));
+  EXPECT_THAT(transform_system->GetAabb(child1)->max,
+              EqualsMathfuVec3(mathfu::kOnes3f));
+  EXPECT_TRUE(transform_system->IsEnabled(child1));
+  EXPECT_FALSE(transform_system->IsEnabled(child2));
+
+  EXPECT_THAT(restored.name_system->FindEntity("parent"), Eq(parent));
+  EXPECT_THAT(restored.name_system->GetName(child1), Eq("child1"));
+
+  // Entity IDs continue from where the original world left off.
+  EXPECT_THAT(restored.entity_factory->Create(), Eq(child2 + 1));
+
+  // The restored hierarchy is fully functional.
+  transform_system->SetLocalTranslation(parent, mathfu::kZeros3f);
+  EXPECT_THAT(
+      transform_system->GetWorldFromEntityMatrix(child1)->TranslationVector3D(),
+      EqualsMathfuVec3(mathfu::vec3(0.f, 1.f, 0.f)));
+}
+
+TEST(WorldSnapshotTest, VersionMismatch) {
+  World original;
+  const Entity entity = original.entity_factory->Create();
+  original.transform_system->Create(entity, Sqt());
+  const WorldSnapshot::Buffer buffer = original.snapshot->Save();
+
+  World restored;
+  restored.snapshot->Unregister(GetTypeId<TransformSystem>());
+  restored.snapshot->RegisterSystem<TransformSystem>(kTransformVersion + 1);
+  EXPECT_FALSE(restored.snapshot->Restore(buffer));
+  EXPECT_THAT(restored.transform_system->GetSqt(entity), IsNull());
+}
+
+TEST(WorldSnapshotTest, TruncatedBuffer) {
+  World original;
+  const Entity entity = original.entity_factory->Create();
+  original.transform_system->Create(entity, Sqt());
+  original.name_system->SetName(entity, "entity");
+  WorldSnapshot::Buffer buffer = original.snapshot->Save();
+  buffer.resize(buffer.size() - 1);
+
+  World restored;
+  EXPECT_FALSE(restored.snapshot->Restore(buffer));
+  EXPECT_FALSE(restored.snapshot->Restore(WorldSnapshot::Buffer()));
+  EXPECT_THAT(restored.transform_system->GetSqt(entity), IsNull());
+}
+
+TEST(WorldSnapshotTest, SkipsUnregisteredSections) {
+  World original;
+  const Entity entity = original.entity_factory->Create();
+  original.transform_system->Create(entity, Sqt());
+  original.name_system->SetName(entity, "entity");
+  const WorldSnapshot::Buffer buffer = original.snapshot->Save();
+
+  World restored;
+  restored.snapshot->Unregister(GetTypeId<NameSystem>());
+  EXPECT_TRUE(restored.snapshot->Restore(buffer));
+  EXPECT_THAT(restored.transform_system->GetSqt(entity), NotNull());
+  EXPECT_THAT(restored.name_system->FindEntity("entity"), Eq(kNullEntity));
+}
+
+}  // namespace
+}  // namespace lull
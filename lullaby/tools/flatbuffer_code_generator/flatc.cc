@@ -16,6 +16,7 @@ limitations under the License.
 
 #include "flatbuffers/flatc.h"
 #include <iostream>
+#include <set>
 #include <string>
 #include "flatbuffers/code_generators.h"
 // Generates Lullaby-specific classes from flatbuffer schemas.
@@ -43,6 +44,11 @@ limitations under the License.
 //   std::unique_ptr.  This is useful for supporting cyclical data dependencies
 //   (eg. Table X has a field of table X) and is the same as the default
 //   flatbuffer gen-object-api support.
+// * Types also get Pack() and Unpack() functions that convert directly to and
+//   from the flatc generated types.  These are straight-line code that avoid
+//   the per-field dispatch of the SerializeFlatbuffer() visitor, and are used
+//   by the FlatbufferReader and FlatbufferWriter (and so by Blueprints and Def
+//   conversion) whenever a type has them.
 class CodeGenerator : public flatbuffers::BaseGenerator {
  public:
   CodeGenerator(const flatbuffers::Parser& parser, const std::string& path,
@@ -72,6 +78,10 @@ class CodeGenerator : public flatbuffers::BaseGenerator {
   void GenerateEnumFunctions(const flatbuffers::EnumDef& def);
   void GenerateStructFunctions(const flatbuffers::StructDef& def);
   void GenerateMemberSerialize(const flatbuffers::FieldDef& field);
+  void GenerateStructPackFunctions(const flatbuffers::StructDef& def);
+  void GenerateMemberUnpack(const flatbuffers::FieldDef& field, bool fixed);
+  void GenerateMemberPackOffset(const flatbuffers::FieldDef& field);
+  void GenerateMemberPackAdd(const flatbuffers::FieldDef& field);
 
   flatbuffers::CodeWriter code_;
   flatbuffers::Namespace root_namespace_;
@@ -261,6 +271,76 @@ std::string CodeGenerator::GetType(const flatbuffers::Type& type,
   }
 }
 
+bool SupportsDirectPack(const flatbuffers::StructDef& def,
+                        std::set<const flatbuffers::StructDef*>* visited);
+
+// Returns true if the union can be converted by the generated Pack() and
+// Unpack() functions.  Unions with a "native_type" are only supported by the
+// SerializeFlatbuffer() path.
+bool SupportsDirectPack(const flatbuffers::EnumDef& def,
+                        std::set<const flatbuffers::StructDef*>* visited) {
+  if (GetAttribute(def, "native_type")) {
+    return false;
+  }
+  for (const auto& value : def.vals.vec) {
+    const auto* struct_def = value->union_type.struct_def;
+    if (struct_def && !SupportsDirectPack(*struct_def, visited)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if the type can be converted by the generated Pack() and
+// Unpack() functions.  Tables with a "native_type" are only supported by the
+// SerializeFlatbuffer() path.
+bool SupportsDirectPack(const flatbuffers::Type& type,
+                        std::set<const flatbuffers::StructDef*>* visited) {
+  switch (type.base_type) {
+    case flatbuffers::BASE_TYPE_STRUCT: {
+      const flatbuffers::StructDef& def = *type.struct_def;
+      if (def.fixed) {
+        return true;
+      } else if (GetAttribute(def, "native_type")) {
+        return false;
+      }
+      return SupportsDirectPack(def, visited);
+    }
+    case flatbuffers::BASE_TYPE_UNION:
+      return SupportsDirectPack(*type.enum_def, visited);
+    case flatbuffers::BASE_TYPE_VECTOR:
+      return SupportsDirectPack(type.VectorType(), visited);
+    default:
+      return true;
+  }
+}
+
+bool SupportsDirectPack(const flatbuffers::StructDef& def,
+                        std::set<const flatbuffers::StructDef*>* visited) {
+  // A type that is already being checked (eg. through a "dynamic" field that
+  // refers back to its own table) is assumed to be supported; if it isn't, the
+  // check further up the stack will fail.
+  if (!visited->insert(&def).second) {
+    return true;
+  }
+  for (const auto& field : def.fields.vec) {
+    if (!field->deprecated && !SupportsDirectPack(field->value.type, visited)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SupportsDirectPack(const flatbuffers::StructDef& def) {
+  std::set<const flatbuffers::StructDef*> visited;
+  return SupportsDirectPack(def, &visited);
+}
+
+bool SupportsDirectPack(const flatbuffers::EnumDef& def) {
+  std::set<const flatbuffers::StructDef*> visited;
+  return SupportsDirectPack(def, &visited);
+}
+
 // Generates the declaration for a native StructDef class.
 void CodeGenerator::GenerateStructMember(const flatbuffers::FieldDef& field) {
   if (field.deprecated) {
@@ -356,6 +436,16 @@ void CodeGenerator::GenerateStructDecl(const flatbuffers::StructDef& def) {
   code_ += "";
   code_ += "  template <typename Archive>";
   code_ += "  void SerializeFlatbuffer(Archive archive);";
+  if (SupportsDirectPack(def)) {
+    code_ += "";
+    code_ += "  void Unpack(const FlatBufferType* src);";
+    if (def.fixed) {
+      code_ += "  FlatBufferType Pack() const;";
+    } else {
+      code_ += "  flatbuffers::Offset<FlatBufferType> Pack(";
+      code_ += "      flatbuffers::FlatBufferBuilder* fbb) const;";
+    }
+  }
   code_ += "};";
   code_ += "";
 }
@@ -403,6 +493,12 @@ void CodeGenerator::GenerateEnumDecl(const flatbuffers::EnumDef& def) {
   code_ += "";
   code_ += "  template <typename Archive>";
   code_ += "  void SerializeFlatbuffer(FlatBufferType type, Archive archive);";
+  if (SupportsDirectPack(def)) {
+    code_ += "";
+    code_ += "  void Unpack(FlatBufferType type, const void* src);";
+    code_ += "  flatbuffers::Offset<void> Pack(";
+    code_ += "      flatbuffers::FlatBufferBuilder* fbb) const;";
+  }
   code_ += "";
   code_ += " private:";
   code_ += "  void assign(const {{DEF_NAME}}& rhs);";
@@ -522,6 +618,47 @@ void CodeGenerator::GenerateEnumFunctions(const flatbuffers::EnumDef& def) {
   code_ += "  }";
   code_ += "}";
   code_ += "";
+
+  if (!SupportsDirectPack(def)) {
+    return;
+  }
+
+  code_ += "inline void {{DEF_NAME}}::Unpack(FlatBufferType type, const void* src) {";
+  code_ += "  switch (type) {";
+  for (const auto& value : def.vals.vec) {
+    if (value->name != "NONE") {
+      const flatbuffers::StructDef& struct_def = *value->union_type.struct_def;
+      code_.SetValue("KEY_TYPE", NativeFullName(struct_def));
+      code_.SetValue("KEY_FB_TYPE", WrapInNameSpace(struct_def));
+      code_.SetValue("KEY", value->name);
+      code_ += "    case {{FB_TYPE}}_{{KEY}}: {";
+      code_ += "      set<{{KEY_TYPE}}>()->Unpack(static_cast<const {{KEY_FB_TYPE}}*>(src));";
+      code_ += "      break;";
+      code_ += "    }";
+    }
+  }
+  code_ += "    default:";
+  code_ += "      reset();";
+  code_ += "      break;";
+  code_ += "  }";
+  code_ += "}";
+  code_ += "";
+  code_ += "inline flatbuffers::Offset<void> {{DEF_NAME}}::Pack(";
+  code_ += "    flatbuffers::FlatBufferBuilder* fbb) const {";
+  code_ += "  switch (type_) {";
+  for (const auto& value : def.vals.vec) {
+    if (value->name != "NONE") {
+      code_.SetValue("KEY_TYPE", NativeFullName(*value->union_type.struct_def));
+      code_.SetValue("KEY", value->name);
+      code_ += "    case {{FB_TYPE}}_{{KEY}}:";
+      code_ += "      return get<{{KEY_TYPE}}>()->Pack(fbb).Union();";
+    }
+  }
+  code_ += "    default:";
+  code_ += "      return flatbuffers::Offset<void>();";
+  code_ += "  }";
+  code_ += "}";
+  code_ += "";
 }
 
 bool IsDynamicField(const flatbuffers::FieldDef& field) {
@@ -581,6 +718,365 @@ void CodeGenerator::GenerateStructFunctions(const flatbuffers::StructDef& def) {
   }
   code_ += "}";
   code_ += "";
+
+  if (SupportsDirectPack(def)) {
+    GenerateStructPackFunctions(def);
+  }
+}
+
+// Generates the function implementations for the Pack() and Unpack() functions
+// for StructDef types.
+void CodeGenerator::GenerateStructPackFunctions(
+    const flatbuffers::StructDef& def) {
+  code_.SetValue("FB_TYPE", def.name);
+  code_.SetValue("DEF_NAME", NativeName(def.name));
+
+  code_ += "inline void {{DEF_NAME}}::Unpack(const FlatBufferType* src) {";
+  for (const auto& field : def.fields.vec) {
+    GenerateMemberUnpack(*field, def.fixed);
+  }
+  code_ += "}";
+  code_ += "";
+
+  if (def.fixed) {
+    // Structs are built in a single call to the flatc generated constructor
+    // which takes every field in declaration order.
+    std::string args;
+    for (const auto& field : def.fields.vec) {
+      const flatbuffers::Type& type = field->value.type;
+      std::string arg = field->name;
+      if (type.base_type == flatbuffers::BASE_TYPE_STRUCT) {
+        const auto* native_type = GetAttribute(*type.struct_def, "native_type");
+        if (native_type) {
+          arg = "lull::WriteNativeStruct<" + WrapInNameSpace(*type.struct_def) +
+                ">(" + field->name + ")";
+        } else {
+          arg = field->name + ".Pack()";
+        }
+      }
+      args += args.empty() ? arg : ", " + arg;
+    }
+    code_.SetValue("ARGS", args);
+    code_ += "inline {{FB_TYPE}} {{DEF_NAME}}::Pack() const {";
+    code_ += "  return {{FB_TYPE}}({{ARGS}});";
+    code_ += "}";
+    code_ += "";
+    return;
+  }
+
+  // Tables need all their strings, vectors and sub-tables to be added to the
+  // builder before the table itself is started.
+  code_ += "inline flatbuffers::Offset<{{FB_TYPE}}> {{DEF_NAME}}::Pack(";
+  code_ += "    flatbuffers::FlatBufferBuilder* fbb) const {";
+  for (const auto& field : def.fields.vec) {
+    if (!field->deprecated && IsDynamicField(*field)) {
+      GenerateMemberPackOffset(*field);
+    }
+  }
+  code_ += "  {{FB_TYPE}}Builder builder(*fbb);";
+  for (const auto& field : def.fields.vec) {
+    GenerateMemberPackAdd(*field);
+  }
+  code_ += "  return builder.Finish();";
+  code_ += "}";
+  code_ += "";
+}
+
+// Returns the type used to store the elements of the given scalar vector type
+// in the flatbuffer.
+std::string GetVectorScalarType(const flatbuffers::Type& vector_type) {
+  if (vector_type.base_type == flatbuffers::BASE_TYPE_BOOL) {
+    return "uint8_t";
+  } else if (vector_type.enum_def) {
+    return GetBasicType(vector_type.enum_def->underlying_type.base_type);
+  } else {
+    return GetBasicType(vector_type.base_type);
+  }
+}
+
+void CodeGenerator::GenerateMemberUnpack(const flatbuffers::FieldDef& field,
+                                         bool fixed) {
+  const flatbuffers::Type& type = field.value.type;
+  if (field.deprecated || type.base_type == flatbuffers::BASE_TYPE_NONE ||
+      type.base_type == flatbuffers::BASE_TYPE_UTYPE) {
+    return;
+  }
+
+  code_.SetValue("FIELD_NAME", field.name);
+  code_.SetValue("FIELD_TYPE", GetType(type, &field));
+
+  switch (type.base_type) {
+    case flatbuffers::BASE_TYPE_BOOL:
+    case flatbuffers::BASE_TYPE_CHAR:
+    case flatbuffers::BASE_TYPE_UCHAR:
+    case flatbuffers::BASE_TYPE_SHORT:
+    case flatbuffers::BASE_TYPE_USHORT:
+    case flatbuffers::BASE_TYPE_INT:
+    case flatbuffers::BASE_TYPE_UINT:
+    case flatbuffers::BASE_TYPE_LONG:
+    case flatbuffers::BASE_TYPE_ULONG:
+    case flatbuffers::BASE_TYPE_FLOAT:
+    case flatbuffers::BASE_TYPE_DOUBLE: {
+      if (type.enum_def) {
+        code_ += "  {{FIELD_NAME}} = static_cast<{{FIELD_TYPE}}>(src->{{FIELD_NAME}}());";
+      } else {
+        code_ += "  {{FIELD_NAME}} = src->{{FIELD_NAME}}();";
+      }
+      break;
+    }
+    case flatbuffers::BASE_TYPE_STRING: {
+      code_ += "  if (const auto* _{{FIELD_NAME}} = src->{{FIELD_NAME}}()) {";
+      code_ += "    {{FIELD_NAME}}.assign(_{{FIELD_NAME}}->c_str(), _{{FIELD_NAME}}->size());";
+      code_ += "  } else {";
+      code_ += "    {{FIELD_NAME}}.clear();";
+      code_ += "  }";
+      break;
+    }
+    case flatbuffers::BASE_TYPE_STRUCT: {
+      const flatbuffers::StructDef& struct_def = *type.struct_def;
+      const auto* native_type = GetAttribute(struct_def, "native_type");
+      code_.SetValue("NATIVE_TYPE",
+                     native_type ? *native_type : NativeFullName(struct_def));
+      if (fixed) {
+        // Structs nested inside structs are returned by reference.
+        if (native_type) {
+          code_ += "  {{FIELD_NAME}} = lull::ReadNativeStruct<{{NATIVE_TYPE}}>(&src->{{FIELD_NAME}}());";
+        } else {
+          code_ += "  {{FIELD_NAME}}.Unpack(&src->{{FIELD_NAME}}());";
+        }
+        break;
+      }
+
+      const bool nullable = GetAttribute(field, "defaults_to_null") != nullptr;
+      const bool dynamic = GetAttribute(field, "dynamic") != nullptr;
+      code_ += "  if (const auto* _{{FIELD_NAME}} = src->{{FIELD_NAME}}()) {";
+      if (native_type && nullable) {
+        code_ += "    {{FIELD_NAME}}.emplace(lull::ReadNativeStruct<{{NATIVE_TYPE}}>(_{{FIELD_NAME}}));";
+      } else if (native_type && dynamic) {
+        code_ += "    {{FIELD_NAME}} = std::make_shared<{{NATIVE_TYPE}}>(";
+        code_ += "        lull::ReadNativeStruct<{{NATIVE_TYPE}}>(_{{FIELD_NAME}}));";
+      } else if (native_type) {
+        code_ += "    {{FIELD_NAME}} = lull::ReadNativeStruct<{{NATIVE_TYPE}}>(_{{FIELD_NAME}});";
+      } else if (nullable) {
+        code_ += "    {{FIELD_NAME}}.emplace();";
+        code_ += "    {{FIELD_NAME}}->Unpack(_{{FIELD_NAME}});";
+      } else if (dynamic) {
+        code_ += "    {{FIELD_NAME}}.reset(new {{NATIVE_TYPE}}());";
+        code_ += "    {{FIELD_NAME}}->Unpack(_{{FIELD_NAME}});";
+      } else {
+        code_ += "    {{FIELD_NAME}}.Unpack(_{{FIELD_NAME}});";
+      }
+      code_ += "  } else {";
+      if (nullable || dynamic) {
+        code_ += "    {{FIELD_NAME}}.reset();";
+      } else {
+        // Absent fields are reset to the default of a newly constructed
+        // object so that no stale data is left behind.
+        const auto* native_default = GetAttribute(field, "native_default");
+        if (native_default == nullptr) {
+          native_default = GetAttribute(struct_def, "native_default");
+        }
+        code_.SetValue("FIELD_DEFAULT", native_default
+                                            ? *native_default
+                                            : GetType(type, &field) + "()");
+        code_ += "    {{FIELD_NAME}} = {{FIELD_DEFAULT}};";
+      }
+      code_ += "  }";
+      break;
+    }
+    case flatbuffers::BASE_TYPE_UNION: {
+      code_ += "  if (const void* _{{FIELD_NAME}} = src->{{FIELD_NAME}}()) {";
+      code_ += "    {{FIELD_NAME}}.Unpack(src->{{FIELD_NAME}}_type(), _{{FIELD_NAME}});";
+      code_ += "  } else {";
+      code_ += "    {{FIELD_NAME}}.reset();";
+      code_ += "  }";
+      break;
+    }
+    case flatbuffers::BASE_TYPE_VECTOR: {
+      const flatbuffers::Type vector_type = type.VectorType();
+      code_ += "  if (const auto* _{{FIELD_NAME}} = src->{{FIELD_NAME}}()) {";
+      if (vector_type.base_type == flatbuffers::BASE_TYPE_STRUCT) {
+        const flatbuffers::StructDef& struct_def = *vector_type.struct_def;
+        const auto* native_type = GetAttribute(struct_def, "native_type");
+        code_.SetValue("NATIVE_TYPE",
+                       native_type ? *native_type : NativeFullName(struct_def));
+        code_ += "    {{FIELD_NAME}}.resize(_{{FIELD_NAME}}->size());";
+        code_ += "    for (flatbuffers::uoffset_t i = 0; i < _{{FIELD_NAME}}->size(); ++i) {";
+        if (struct_def.fixed && native_type) {
+          code_ += "      {{FIELD_NAME}}[i] = lull::ReadNativeStruct<{{NATIVE_TYPE}}>(_{{FIELD_NAME}}->Get(i));";
+        } else {
+          code_ += "      {{FIELD_NAME}}[i].Unpack(_{{FIELD_NAME}}->Get(i));";
+        }
+        code_ += "    }";
+      } else if (vector_type.base_type == flatbuffers::BASE_TYPE_STRING) {
+        code_ += "    {{FIELD_NAME}}.resize(_{{FIELD_NAME}}->size());";
+        code_ += "    for (flatbuffers::uoffset_t i = 0; i < _{{FIELD_NAME}}->size(); ++i) {";
+        code_ += "      const flatbuffers::String* str = _{{FIELD_NAME}}->Get(i);";
+        code_ += "      {{FIELD_NAME}}[i].assign(str->c_str(), str->size());";
+        code_ += "    }";
+      } else if (vector_type.enum_def ||
+                 vector_type.base_type == flatbuffers::BASE_TYPE_BOOL) {
+        // The flatbuffer stores the underlying integral type, so each element
+        // needs to be cast back to the native type.
+        code_.SetValue("VECTOR_TYPE", GetType(vector_type, &field));
+        code_ += "    {{FIELD_NAME}}.resize(_{{FIELD_NAME}}->size());";
+        code_ += "    for (flatbuffers::uoffset_t i = 0; i < _{{FIELD_NAME}}->size(); ++i) {";
+        code_ += "      {{FIELD_NAME}}[i] = static_cast<{{VECTOR_TYPE}}>(_{{FIELD_NAME}}->Get(i));";
+        code_ += "    }";
+      } else {
+        code_ += "    {{FIELD_NAME}}.assign(_{{FIELD_NAME}}->begin(), _{{FIELD_NAME}}->end());";
+      }
+      code_ += "  } else {";
+      code_ += "    {{FIELD_NAME}}.clear();";
+      code_ += "  }";
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void CodeGenerator::GenerateMemberPackOffset(
+    const flatbuffers::FieldDef& field) {
+  const flatbuffers::Type& type = field.value.type;
+  code_.SetValue("FIELD_NAME", field.name);
+
+  switch (type.base_type) {
+    case flatbuffers::BASE_TYPE_STRING: {
+      code_ += "  const auto _{{FIELD_NAME}} = {{FIELD_NAME}}.empty() ?";
+      code_ += "      flatbuffers::Offset<flatbuffers::String>() :";
+      code_ += "      fbb->CreateString({{FIELD_NAME}});";
+      break;
+    }
+    case flatbuffers::BASE_TYPE_STRUCT: {
+      code_.SetValue("FIELD_FB_TYPE", WrapInNameSpace(*type.struct_def));
+      if (GetAttribute(field, "defaults_to_null") ||
+          GetAttribute(field, "dynamic")) {
+        code_ += "  const auto _{{FIELD_NAME}} = {{FIELD_NAME}} ?";
+        code_ += "      {{FIELD_NAME}}->Pack(fbb) :";
+        code_ += "      flatbuffers::Offset<{{FIELD_FB_TYPE}}>();";
+      } else {
+        code_ += "  const auto _{{FIELD_NAME}} = {{FIELD_NAME}}.Pack(fbb);";
+      }
+      break;
+    }
+    case flatbuffers::BASE_TYPE_UNION: {
+      code_ += "  const auto _{{FIELD_NAME}} = {{FIELD_NAME}}.Pack(fbb);";
+      break;
+    }
+    case flatbuffers::BASE_TYPE_VECTOR: {
+      const flatbuffers::Type vector_type = type.VectorType();
+      if (vector_type.base_type == flatbuffers::BASE_TYPE_STRUCT) {
+        const flatbuffers::StructDef& struct_def = *vector_type.struct_def;
+        code_.SetValue("FIELD_FB_TYPE", WrapInNameSpace(struct_def));
+        if (struct_def.fixed) {
+          code_ += "  flatbuffers::Offset<flatbuffers::Vector<const {{FIELD_FB_TYPE}}*>> _{{FIELD_NAME}};";
+          code_ += "  if (!{{FIELD_NAME}}.empty()) {";
+          code_ += "    std::vector<{{FIELD_FB_TYPE}}> structs;";
+          code_ += "    structs.reserve({{FIELD_NAME}}.size());";
+          code_ += "    for (const auto& element : {{FIELD_NAME}}) {";
+          if (GetAttribute(struct_def, "native_type")) {
+            code_ += "      structs.push_back(lull::WriteNativeStruct<{{FIELD_FB_TYPE}}>(element));";
+          } else {
+            code_ += "      structs.push_back(element.Pack());";
+          }
+          code_ += "    }";
+          code_ += "    _{{FIELD_NAME}} = fbb->CreateVectorOfStructs(structs);";
+          code_ += "  }";
+        } else {
+          code_ += "  flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<{{FIELD_FB_TYPE}}>>> _{{FIELD_NAME}};";
+          code_ += "  if (!{{FIELD_NAME}}.empty()) {";
+          code_ += "    std::vector<flatbuffers::Offset<{{FIELD_FB_TYPE}}>> tables;";
+          code_ += "    tables.reserve({{FIELD_NAME}}.size());";
+          code_ += "    for (const auto& element : {{FIELD_NAME}}) {";
+          code_ += "      tables.push_back(element.Pack(fbb));";
+          code_ += "    }";
+          code_ += "    _{{FIELD_NAME}} = fbb->CreateVector(tables);";
+          code_ += "  }";
+        }
+      } else if (vector_type.base_type == flatbuffers::BASE_TYPE_STRING) {
+        code_ += "  flatbuffers::Offset<flatbuffers::Vector<flatbuffers::Offset<flatbuffers::String>>> _{{FIELD_NAME}};";
+        code_ += "  if (!{{FIELD_NAME}}.empty()) {";
+        code_ += "    _{{FIELD_NAME}} = fbb->CreateVectorOfStrings({{FIELD_NAME}});";
+        code_ += "  }";
+      } else {
+        code_.SetValue("BASE_TYPE", GetVectorScalarType(vector_type));
+        code_ += "  flatbuffers::Offset<flatbuffers::Vector<{{BASE_TYPE}}>> _{{FIELD_NAME}};";
+        code_ += "  if (!{{FIELD_NAME}}.empty()) {";
+        if (vector_type.enum_def ||
+            vector_type.base_type == flatbuffers::BASE_TYPE_BOOL) {
+          // The native and flatbuffer element types differ, so the elements
+          // are pushed one at a time (in reverse, as the builder grows
+          // downwards).
+          code_ += "    fbb->StartVector({{FIELD_NAME}}.size(), sizeof({{BASE_TYPE}}));";
+          code_ += "    for (auto iter = {{FIELD_NAME}}.rbegin(); iter != {{FIELD_NAME}}.rend(); ++iter) {";
+          code_ += "      fbb->PushElement(static_cast<{{BASE_TYPE}}>(*iter));";
+          code_ += "    }";
+          code_ += "    _{{FIELD_NAME}} = fbb->EndVector({{FIELD_NAME}}.size());";
+        } else {
+          code_ += "    _{{FIELD_NAME}} = fbb->CreateVector({{FIELD_NAME}});";
+        }
+        code_ += "  }";
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+void CodeGenerator::GenerateMemberPackAdd(const flatbuffers::FieldDef& field) {
+  const flatbuffers::Type& type = field.value.type;
+  if (field.deprecated || type.base_type == flatbuffers::BASE_TYPE_NONE ||
+      type.base_type == flatbuffers::BASE_TYPE_UTYPE) {
+    return;
+  }
+
+  code_.SetValue("FIELD_NAME", field.name);
+
+  switch (type.base_type) {
+    case flatbuffers::BASE_TYPE_STRING:
+    case flatbuffers::BASE_TYPE_VECTOR:
+      code_ += "  builder.add_{{FIELD_NAME}}(_{{FIELD_NAME}});";
+      break;
+    case flatbuffers::BASE_TYPE_UNION:
+      code_ += "  builder.add_{{FIELD_NAME}}_type({{FIELD_NAME}}.type());";
+      code_ += "  builder.add_{{FIELD_NAME}}(_{{FIELD_NAME}});";
+      break;
+    case flatbuffers::BASE_TYPE_STRUCT: {
+      const flatbuffers::StructDef& struct_def = *type.struct_def;
+      if (!struct_def.fixed) {
+        code_ += "  builder.add_{{FIELD_NAME}}(_{{FIELD_NAME}});";
+        break;
+      }
+
+      const bool nullable = GetAttribute(field, "defaults_to_null") ||
+                            GetAttribute(field, "dynamic");
+      const std::string value =
+          nullable ? "(*" + field.name + ")" : field.name;
+      code_.SetValue("FIELD_FB_TYPE", WrapInNameSpace(struct_def));
+      if (GetAttribute(struct_def, "native_type")) {
+        code_.SetValue("FIELD_VALUE", "lull::WriteNativeStruct<" +
+                                          WrapInNameSpace(struct_def) + ">(" +
+                                          value + ")");
+      } else {
+        code_.SetValue("FIELD_VALUE", value + ".Pack()");
+      }
+      if (nullable) {
+        code_ += "  if ({{FIELD_NAME}}) {";
+        code_ += "    const {{FIELD_FB_TYPE}} _{{FIELD_NAME}} = {{FIELD_VALUE}};";
+        code_ += "    builder.add_{{FIELD_NAME}}(&_{{FIELD_NAME}});";
+        code_ += "  }";
+      } else {
+        code_ += "  const {{FIELD_FB_TYPE}} _{{FIELD_NAME}} = {{FIELD_VALUE}};";
+        code_ += "  builder.add_{{FIELD_NAME}}(&_{{FIELD_NAME}});";
+      }
+      break;
+    }
+    default:
+      code_ += "  builder.add_{{FIELD_NAME}}({{FIELD_NAME}});";
+      break;
+  }
 }
 
 void CodeGenerator::GenerateMemberSerialize(
@@ -752,6 +1248,7 @@ bool CodeGenerator::generate() {
   code_ += "#include \"{{INCLUDE_FILE}}\"";
   code_ += "#include \"lullaby/util/color.h\"";
   code_ += "#include \"lullaby/util/common_types.h\"";
+  code_ += "#include \"lullaby/util/flatbuffer_native_types.h\"";
   code_ += "#include \"lullaby/util/math.h\"";
   code_ += "#include \"lullaby/util/optional.h\"";
   code_ += "#include \"lullaby/util/typeid.h\"";
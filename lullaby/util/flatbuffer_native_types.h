@@ -281,6 +281,23 @@ struct FlatbufferNativeType<lull::Color4ub> {
   }
 };
 
+// Reads the native type T from the flatbuffer struct at |src|.  Used by the
+// generated Unpack() functions.
+template <typename T>
+T ReadNativeStruct(const void* src) {
+  return FlatbufferNativeType<T>::Read(
+      src, FlatbufferNativeType<T>::kFlatbufferStructSize);
+}
+
+// Converts the native |value| into its FlatBufferType struct.  Used by the
+// generated Pack() functions.
+template <typename FlatBufferType, typename T>
+FlatBufferType WriteNativeStruct(const T& value) {
+  FlatBufferType result;
+  FlatbufferNativeType<T>::Write(value, &result, sizeof(result));
+  return result;
+}
+
 }  // namespace lull
 
 #endif  // LULLABY_UTIL_FLATBUFFER_NATIVE_TYPES_H_
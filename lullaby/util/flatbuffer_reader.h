@@ -29,9 +29,19 @@ namespace lull {
 // by the Lullaby flatc code generator.
 class FlatbufferReader {
  public:
-  // Reads data from the flatbuffer::Table into the specified object.
+  // Reads data from the flatbuffer::Table into the specified object.  Types
+  // with a generated Unpack() function are read directly with it, bypassing the
+  // per-field SerializeFlatbuffer() visitor.
   template <typename T>
   static void SerializeObject(T* obj, const flatbuffers::Table* table) {
+    UnpackTable(obj, table, 0);
+  }
+
+  // Reads data from the flatbuffer::Table into the specified object using the
+  // SerializeFlatbuffer() visitor, even if the type has an Unpack() function.
+  template <typename T>
+  static void SerializeObjectWithVisitor(T* obj,
+                                         const flatbuffers::Table* table) {
     SerializeTable(obj, table);
   }
 
@@ -278,6 +288,20 @@ class FlatbufferReader {
 
   explicit FlatbufferReader(const uint8_t* data) { data_ = data; }
 
+  template <typename T>
+  static auto UnpackTable(T* dst, const flatbuffers::Table* src, int)
+      -> decltype(dst->Unpack(
+          static_cast<const typename T::FlatBufferType*>(nullptr))) {
+    if (src && dst) {
+      dst->Unpack(reinterpret_cast<const typename T::FlatBufferType*>(src));
+    }
+  }
+
+  template <typename T>
+  static void UnpackTable(T* dst, const flatbuffers::Table* src, long) {
+    SerializeTable(dst, src);
+  }
+
   template <typename T>
   static void SerializeTable(T* dst, const flatbuffers::Table* src) {
     if (src && dst) {
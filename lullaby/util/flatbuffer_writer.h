@@ -62,9 +62,20 @@ namespace lull {
 // the data to "high" memory and adding a reference field to "low" memory.
 class FlatbufferWriter {
  public:
+  // Writes |obj| as a flatbuffer into |buffer|.  Types with a generated Pack()
+  // function are built directly with it, bypassing the per-field
+  // SerializeFlatbuffer() visitor.
   template <typename T>
   static void* SerializeObject(T* obj, InwardBuffer* buffer,
                                const char* file_identifier = nullptr) {
+    return PackObject(obj, buffer, file_identifier, 0);
+  }
+
+  // Writes |obj| as a flatbuffer into |buffer| using the SerializeFlatbuffer()
+  // visitor, even if the type has a Pack() function.
+  template <typename T>
+  static void* SerializeObjectWithVisitor(
+      T* obj, InwardBuffer* buffer, const char* file_identifier = nullptr) {
     const size_t start = buffer->FrontSize();
 
     // Write the obj to the buffer as a flatbuffer table.
@@ -373,6 +384,43 @@ class FlatbufferWriter {
   }
 
  private:
+  // Builds the flatbuffer with the generated Pack() function and copies the
+  // finished buffer into the high memory of |buffer|.
+  template <typename T>
+  static auto PackObject(T* obj, InwardBuffer* buffer,
+                         const char* file_identifier, int)
+      -> decltype(obj->Pack(static_cast<flatbuffers::FlatBufferBuilder*>(
+                      nullptr)),
+                  static_cast<void*>(nullptr)) {
+    // The builder aligns its data relative to the end of its buffer, so keep
+    // the end of the copy aligned to the largest alignment it may use.
+    FlatbufferWriter writer(buffer);
+    writer.Prealign(kMaxAlignment);
+
+    flatbuffers::FlatBufferBuilder* fbb = GetPackBuilder();
+    const auto root = obj->Pack(fbb);
+    fbb->Finish(root,
+                file_identifier ? file_identifier : T::FileIdentifier());
+    buffer->WriteBack(fbb->GetBufferPointer(), fbb->GetSize());
+    fbb->Clear();
+
+    // Return a pointer to the finished flatbuffer.
+    return buffer->BackAt(buffer->BackSize());
+  }
+
+  template <typename T>
+  static void* PackObject(T* obj, InwardBuffer* buffer,
+                          const char* file_identifier, long) {
+    return SerializeObjectWithVisitor(obj, buffer, file_identifier);
+  }
+
+  // Returns the builder used by PackObject().  It is kept per thread so that
+  // its memory is reused across calls.
+  static flatbuffers::FlatBufferBuilder* GetPackBuilder() {
+    static thread_local flatbuffers::FlatBufferBuilder fbb;
+    return &fbb;
+  }
+
   void Prealign(size_t alignment) {
     CHECK(alignment <= kMaxAlignment);
     while ((buffer_->BackSize()) % alignment != 0) {
@@ -0,0 +1,200 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "lullaby/util/frame_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "lullaby/util/aligned_alloc.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+struct FrameAllocator::Arena {
+  std::thread::id thread;
+  uint8_t* data = nullptr;
+  size_t capacity = 0;
+  // Offset of the first free byte.
+  size_t offset = 0;
+  // Offset of the most recent allocation, used to roll it back.
+  size_t last_offset = 0;
+  // The highest |offset| reached this frame.
+  size_t high_water = 0;
+  // Heap blocks allocated this frame because the arena was full.
+  std::vector<void*> overflow_blocks;
+  size_t overflow_bytes = 0;
+};
+
+namespace {
+
+// Each thread caches the arena it last used so that the common case of a
+// single FrameAllocator does not need to take a lock.  The cache is tagged with
+// the unique id of the owning allocator rather than its address since a new
+// allocator may be created at the address of a destroyed one.
+struct ArenaCache {
+  uint64_t owner = 0;
+  void* arena = nullptr;
+};
+
+thread_local ArenaCache tls_arena_cache;
+
+uint64_t GenerateAllocatorId() {
+  static std::atomic<uint64_t> next_id(1);
+  return next_id++;
+}
+
+}  // namespace
+
+FrameAllocator::FrameAllocator(size_t arena_size)
+    : arena_size_(arena_size), id_(GenerateAllocatorId()) {}
+
+FrameAllocator::~FrameAllocator() {
+  for (auto& arena : arenas_) {
+    for (void* block : arena->overflow_blocks) {
+      AlignedFree(block);
+    }
+    AlignedFree(arena->data);
+  }
+}
+
+FrameAllocator::Arena* FrameAllocator::FindArena() const {
+  if (tls_arena_cache.owner == id_) {
+    return static_cast<Arena*>(tls_arena_cache.arena);
+  }
+
+  const std::thread::id thread = std::this_thread::get_id();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const auto& arena : arenas_) {
+    if (arena->thread == thread) {
+      return arena.get();
+    }
+  }
+  return nullptr;
+}
+
+FrameAllocator::Arena* FrameAllocator::GetArena() {
+  Arena* arena = FindArena();
+  if (arena == nullptr) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    arena = new Arena();
+    arena->thread = std::this_thread::get_id();
+    arena->capacity = arena_size_;
+    arena->data = static_cast<uint8_t*>(
+        AlignedAlloc(arena_size_, alignof(std::max_align_t)));
+    arenas_.emplace_back(arena);
+  }
+  tls_arena_cache.owner = id_;
+  tls_arena_cache.arena = arena;
+  return arena;
+}
+
+void* FrameAllocator::Allocate(size_t size, size_t align) {
+  Arena* arena = GetArena();
+
+  const uintptr_t base = reinterpret_cast<uintptr_t>(arena->data);
+  const uintptr_t aligned =
+      (base + arena->offset + align - 1) & ~(static_cast<uintptr_t>(align) - 1);
+  const size_t offset = static_cast<size_t>(aligned - base);
+  if (offset + size <= arena->capacity) {
+    arena->last_offset = offset;
+    arena->offset = offset + size;
+    arena->high_water = std::max(arena->high_water, arena->offset);
+    return reinterpret_cast<void*>(aligned);
+  }
+
+  void* block = AlignedAlloc(size, align);
+  arena->overflow_blocks.push_back(block);
+  arena->overflow_bytes += size;
+  return block;
+}
+
+void FrameAllocator::Deallocate(void* ptr, size_t size) {
+  Arena* arena = FindArena();
+  if (arena == nullptr || ptr == nullptr) {
+    return;
+  }
+  // Roll back the most recent allocation so that short-lived temporaries do not
+  // consume the arena.
+  const uint8_t* bytes = static_cast<const uint8_t*>(ptr);
+  if (bytes == arena->data + arena->last_offset &&
+      arena->last_offset + size == arena->offset) {
+    arena->offset = arena->last_offset;
+  }
+}
+
+void FrameAllocator::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  size_t frame_usage = 0;
+  for (auto& arena : arenas_) {
+    frame_usage += arena->high_water;
+
+    if (!arena->overflow_blocks.empty()) {
+      const size_t required = arena->high_water + arena->overflow_bytes;
+      const size_t capacity = std::max(arena->capacity * 2, required);
+      LOG(WARNING) << "FrameAllocator arena overflowed by "
+                   << arena->overflow_bytes << " bytes in "
+                   << arena->overflow_blocks.size()
+                   << " allocations, growing from " << arena->capacity
+                   << " to " << capacity << " bytes.";
+
+      frame_usage += arena->overflow_bytes;
+      num_overflows_ += arena->overflow_blocks.size();
+      overflow_bytes_ += arena->overflow_bytes;
+      for (void* block : arena->overflow_blocks) {
+        AlignedFree(block);
+      }
+      arena->overflow_blocks.clear();
+      arena->overflow_bytes = 0;
+
+      AlignedFree(arena->data);
+      arena->data = static_cast<uint8_t*>(
+          AlignedAlloc(capacity, alignof(std::max_align_t)));
+      arena->capacity = capacity;
+    }
+
+    arena->offset = 0;
+    arena->last_offset = 0;
+    arena->high_water = 0;
+  }
+  peak_usage_ = std::max(peak_usage_, frame_usage);
+}
+
+size_t FrameAllocator::GetCurrentUsage() const {
+  const Arena* arena = FindArena();
+  return arena ? arena->offset + arena->overflow_bytes : 0;
+}
+
+size_t FrameAllocator::GetPeakUsage() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return peak_usage_;
+}
+
+FrameAllocator::Stats FrameAllocator::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats;
+  for (const auto& arena : arenas_) {
+    stats.capacity += arena->capacity;
+  }
+  stats.peak_usage = peak_usage_;
+  stats.num_overflows = num_overflows_;
+  stats.overflow_bytes = overflow_bytes_;
+  return stats;
+}
+
+}  // namespace lull
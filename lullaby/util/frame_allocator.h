@@ -0,0 +1,168 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_FRAME_ALLOCATOR_H_
+#define LULLABY_UTIL_FRAME_ALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include "lullaby/util/typeid.h"
+
+namespace lull {
+
+/// A linear (bump) allocator for transient data that only needs to live until
+/// the end of the current frame.
+///
+/// Each thread that allocates from the FrameAllocator is given its own arena so
+/// that allocations never contend on a lock.  Allocating simply advances an
+/// offset into the arena and deallocating is a no-op (except for the most
+/// recent allocation, which is rolled back).  All arenas are rewound by calling
+/// Reset() once per frame, at which point any memory handed out during the
+/// previous frame is invalid.
+///
+/// If an arena runs out of space the allocation falls back to the heap and the
+/// block is freed on the next Reset().  The overflow is reported by Reset(),
+/// which also grows the arena to fit the frame's peak demand so that subsequent
+/// frames do not overflow.
+///
+/// Containers can use the FrameAllocator through the FrameAllocatorAdapter,
+/// eg. FrameVector<Entity> entities(registry_->Get<FrameAllocator>());
+class FrameAllocator {
+ public:
+  /// Usage information aggregated across all threads.
+  struct Stats {
+    /// Total capacity of all arenas.
+    size_t capacity = 0;
+    /// Highest number of bytes used by all arenas in a single frame.
+    size_t peak_usage = 0;
+    /// Number of allocations that did not fit in an arena.
+    size_t num_overflows = 0;
+    /// Total bytes of all allocations that did not fit in an arena.
+    size_t overflow_bytes = 0;
+  };
+
+  static const size_t kDefaultArenaSize = 256 * 1024;
+
+  /// Creates the allocator where each thread's arena starts with |arena_size|
+  /// bytes.
+  explicit FrameAllocator(size_t arena_size = kDefaultArenaSize);
+  ~FrameAllocator();
+
+  FrameAllocator(const FrameAllocator&) = delete;
+  FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+  /// Returns a block of |size| bytes aligned to |align| that is valid until the
+  /// next call to Reset().
+  void* Allocate(size_t size, size_t align = alignof(std::max_align_t));
+
+  /// Releases the block returned by Allocate().  Only the most recent block
+  /// allocated on the calling thread is actually reclaimed, other blocks are
+  /// reclaimed in bulk by Reset().
+  void Deallocate(void* ptr, size_t size);
+
+  /// Rewinds all arenas.  Must be called at a point in the frame where no
+  /// thread is holding onto frame memory, typically at the start of the frame.
+  void Reset();
+
+  /// Returns the number of bytes currently allocated from the calling thread's
+  /// arena.
+  size_t GetCurrentUsage() const;
+
+  /// Returns the highest number of bytes used in a single frame, as of the last
+  /// call to Reset().
+  size_t GetPeakUsage() const;
+
+  /// Returns the usage information for all arenas, as of the last call to
+  /// Reset().
+  Stats GetStats() const;
+
+ private:
+  struct Arena;
+
+  Arena* FindArena() const;
+  Arena* GetArena();
+
+  const size_t arena_size_;
+  const uint64_t id_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<Arena>> arenas_;
+  size_t peak_usage_ = 0;
+  size_t num_overflows_ = 0;
+  size_t overflow_bytes_ = 0;
+};
+
+/// An std::allocator compatible wrapper around the FrameAllocator.  If no
+/// FrameAllocator is provided, memory is allocated from the heap instead so
+/// that code using it continues to work in apps that do not create one.
+template <typename T>
+class FrameAllocatorAdapter {
+ public:
+  using value_type = T;
+
+  FrameAllocatorAdapter() {}
+  FrameAllocatorAdapter(FrameAllocator* allocator) : allocator_(allocator) {}
+
+  template <typename U>
+  FrameAllocatorAdapter(const FrameAllocatorAdapter<U>& rhs)
+      : allocator_(rhs.GetFrameAllocator()) {}
+
+  T* allocate(size_t n) {
+    if (allocator_) {
+      return static_cast<T*>(allocator_->Allocate(n * sizeof(T), alignof(T)));
+    }
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) {
+    if (allocator_) {
+      allocator_->Deallocate(ptr, n * sizeof(T));
+    } else {
+      ::operator delete(ptr);
+    }
+  }
+
+  FrameAllocator* GetFrameAllocator() const { return allocator_; }
+
+ private:
+  FrameAllocator* allocator_ = nullptr;
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocatorAdapter<T>& lhs,
+                const FrameAllocatorAdapter<U>& rhs) {
+  return lhs.GetFrameAllocator() == rhs.GetFrameAllocator();
+}
+
+template <typename T, typename U>
+bool operator!=(const FrameAllocatorAdapter<T>& lhs,
+                const FrameAllocatorAdapter<U>& rhs) {
+  return !(lhs == rhs);
+}
+
+/// A vector whose storage is only valid until the end of the current frame.
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocatorAdapter<T>>;
+
+}  // namespace lull
+
+LULLABY_SETUP_TYPEID(lull::FrameAllocator);
+
+#endif  // LULLABY_UTIL_FRAME_ALLOCATOR_H_
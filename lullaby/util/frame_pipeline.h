@@ -0,0 +1,301 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_FRAME_PIPELINE_H_
+#define LULLABY_UTIL_FRAME_PIPELINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "lullaby/util/clock.h"
+#include "lullaby/util/logging.h"
+
+namespace lull {
+
+/// Statistics collected by a FramePipeline.
+struct FramePipelineStats {
+  /// Number of frames submitted by the producer.
+  uint64_t frames_written = 0;
+  /// Number of distinct frames returned by |BeginRead|.
+  uint64_t frames_read = 0;
+  /// Number of frames that were submitted but never read.
+  uint64_t frames_dropped = 0;
+  /// Number of times |BeginRead| returned a frame that was already read.
+  uint64_t frames_repeated = 0;
+  /// Time between the last read frame being submitted and read.
+  Clock::duration last_latency = Clock::duration::zero();
+  /// Largest time between a frame being submitted and read.
+  Clock::duration max_latency = Clock::duration::zero();
+};
+
+/// A FramePipeline hands per-frame data of type |T| from a producer thread (eg.
+/// simulation) to a consumer thread (eg. rendering) through a configurable
+/// number of slots.
+///
+/// Like BufferedData, the producer fills a slot between |BeginWrite| and
+/// |EndWrite|, and the consumer processes one between |BeginRead| and
+/// |EndRead|.  Unlike BufferedData:
+///
+/// - Every written frame is numbered, and either side can fence on the other:
+///   |WaitForWrite| blocks the consumer until a frame has been submitted, and
+///   |WaitForRead| blocks the producer until a frame has been picked up, which
+///   bounds how far the producer runs ahead.
+///
+/// - |BeginRead| always returns the newest submitted frame.  Older frames that
+///   were never read are dropped, and if no new frame was submitted since the
+///   last read the last frame is returned again.
+///
+/// - Statistics about dropped and repeated frames and the latency between
+///   submitting and reading a frame are collected.
+///
+/// Slots are never destroyed, so |T| should be cleared (rather than recreated)
+/// by the producer to reuse its allocations from frame to frame.
+///
+/// With a depth of 3, the producer can write a frame while the consumer
+/// processes the previous one, and still have the frame after that pending
+/// without dropping it.  A depth of 1 only supports using the pipeline from a
+/// single thread.
+template <typename T>
+class FramePipeline {
+ public:
+  /// Frames are numbered from 1, so kInvalidFrame is never a valid frame.
+  using FrameId = uint64_t;
+  static const FrameId kInvalidFrame = 0;
+
+  using Stats = FramePipelineStats;
+
+  explicit FramePipeline(size_t depth) : slots_(depth) {
+    DCHECK_GT(depth, 0u) << "FramePipeline cannot have 0 slots!";
+  }
+
+  FramePipeline(const FramePipeline&) = delete;
+  FramePipeline& operator=(const FramePipeline&) = delete;
+
+  /// Returns the number of slots.
+  size_t GetDepth() const { return slots_.size(); }
+
+  /// Locks and returns a slot for the producer to write the next frame into.
+  /// This is a free slot if there is one, otherwise the last read frame if a
+  /// newer one is pending, otherwise the oldest pending frame, which is then
+  /// dropped.  Returns nullptr only if the depth is 1 and the consumer is
+  /// reading the only slot.
+  T* BeginWrite() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DCHECK_EQ(write_slot_, kNone) << "Write slot already locked.";
+
+    size_t slot = Find(kFree);
+    if (slot == kNone) {
+      slot = Find(kDisplayed);
+    }
+    if (slot == kNone) {
+      slot = FindOldestPending();
+      if (slot != kNone) {
+        ++stats_.frames_dropped;
+      }
+    }
+    if (slot == kNone) {
+      return nullptr;
+    }
+    slots_[slot].state = kWriting;
+    write_slot_ = slot;
+    return &slots_[slot].data;
+  }
+
+  /// Submits the slot locked by |BeginWrite| and returns its frame number.
+  FrameId EndWrite() {
+    FrameId frame = kInvalidFrame;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      DCHECK_NE(write_slot_, kNone) << "Write slot was not locked!";
+      Slot& slot = slots_[write_slot_];
+      frame = ++last_written_frame_;
+      slot.state = kPending;
+      slot.frame = frame;
+      slot.submit_time = Clock::now();
+      write_slot_ = kNone;
+      ++stats_.frames_written;
+    }
+    condition_.notify_all();
+    return frame;
+  }
+
+  /// Locks and returns the newest submitted frame for the consumer, or
+  /// nullptr if no frame was ever submitted.
+  T* BeginRead() {
+    T* data = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      DCHECK_EQ(read_slot_, kNone) << "Read slot already locked.";
+
+      size_t newest = kNone;
+      for (size_t i = 0; i < slots_.size(); ++i) {
+        if (slots_[i].state == kPending &&
+            (newest == kNone || slots_[i].frame > slots_[newest].frame)) {
+          newest = i;
+        }
+      }
+
+      if (newest == kNone) {
+        read_slot_ = Find(kDisplayed);
+        if (read_slot_ == kNone) {
+          return nullptr;
+        }
+        ++stats_.frames_repeated;
+      } else {
+        // Only the newest frame is read, so retire all the others.
+        for (Slot& slot : slots_) {
+          if (slot.state == kDisplayed ||
+              (slot.state == kPending && slot.frame < slots_[newest].frame)) {
+            if (slot.state == kPending) {
+              ++stats_.frames_dropped;
+            }
+            slot.state = kFree;
+          }
+        }
+        read_slot_ = newest;
+        Slot& slot = slots_[newest];
+        last_read_frame_ = slot.frame;
+        ++stats_.frames_read;
+        stats_.last_latency = Clock::now() - slot.submit_time;
+        if (stats_.last_latency > stats_.max_latency) {
+          stats_.max_latency = stats_.last_latency;
+        }
+      }
+      slots_[read_slot_].state = kReading;
+      data = &slots_[read_slot_].data;
+    }
+    condition_.notify_all();
+    return data;
+  }
+
+  /// Returns the number of the frame locked by |BeginRead|, or kInvalidFrame.
+  FrameId GetReadFrame() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return read_slot_ != kNone ? slots_[read_slot_].frame : kInvalidFrame;
+  }
+
+  /// Unlocks the slot locked by |BeginRead|.  It is kept to be read again
+  /// until a newer frame is read.
+  void EndRead() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    DCHECK_NE(read_slot_, kNone) << "Read slot was not locked!";
+    slots_[read_slot_].state = kDisplayed;
+    read_slot_ = kNone;
+  }
+
+  /// Blocks until |frame| has been submitted, or until |timeout| elapses.
+  /// Returns true if the frame was submitted.
+  bool WaitForWrite(FrameId frame, Clock::duration timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return condition_.wait_for(lock, timeout, [this, frame]() {
+      return last_written_frame_ >= frame;
+    });
+  }
+
+  /// Blocks until |frame| (or a newer frame that replaced it) has been picked
+  /// up by |BeginRead|, or until |timeout| elapses.  Returns true if the frame
+  /// was picked up.  Calling this for the frame before the one just submitted
+  /// keeps the producer at most one frame ahead of the consumer.
+  bool WaitForRead(FrameId frame, Clock::duration timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return condition_.wait_for(lock, timeout, [this, frame]() {
+      return last_read_frame_ >= frame;
+    });
+  }
+
+  /// Returns the number of the last submitted frame, or kInvalidFrame.
+  FrameId GetLastWrittenFrame() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_written_frame_;
+  }
+
+  /// Returns the number of the last frame picked up by |BeginRead|, or
+  /// kInvalidFrame.
+  FrameId GetLastReadFrame() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return last_read_frame_;
+  }
+
+  Stats GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+ private:
+  enum State {
+    /// Holds no frame.
+    kFree,
+    /// Locked by the producer.
+    kWriting,
+    /// Submitted but not read yet.
+    kPending,
+    /// Locked by the consumer.
+    kReading,
+    /// Read, and kept to be read again if no newer frame is submitted.
+    kDisplayed,
+  };
+
+  struct Slot {
+    T data;
+    State state = kFree;
+    FrameId frame = kInvalidFrame;
+    Clock::time_point submit_time;
+  };
+
+  static const size_t kNone = static_cast<size_t>(-1);
+
+  size_t Find(State state) const {
+    for (size_t i = 0; i < slots_.size(); ++i) {
+      if (slots_[i].state == state) {
+        return i;
+      }
+    }
+    return kNone;
+  }
+
+  size_t FindOldestPending() const {
+    size_t oldest = kNone;
+    for (size_t i = 0; i < slots_.size(); ++i) {
+      if (slots_[i].state == kPending &&
+          (oldest == kNone || slots_[i].frame < slots_[oldest].frame)) {
+        oldest = i;
+      }
+    }
+    return oldest;
+  }
+
+  std::vector<Slot> slots_;
+  mutable std::mutex mutex_;
+  std::condition_variable condition_;
+  size_t write_slot_ = kNone;
+  size_t read_slot_ = kNone;
+  FrameId last_written_frame_ = kInvalidFrame;
+  FrameId last_read_frame_ = kInvalidFrame;
+  Stats stats_;
+};
+
+template <typename T>
+const typename FramePipeline<T>::FrameId FramePipeline<T>::kInvalidFrame;
+
+template <typename T>
+const size_t FramePipeline<T>::kNone;
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_FRAME_PIPELINE_H_
@@ -0,0 +1,137 @@
+/*
+Copyright 2017 Google Inc. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS-IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef LULLABY_UTIL_GAP_BUFFER_H_
+#define LULLABY_UTIL_GAP_BUFFER_H_
+
+#include <assert.h>
+#include <algorithm>
+#include <vector>
+
+namespace lull {
+
+// A sequence container optimized for edits that are clustered around a single
+// position, such as the caret in a text field.
+//
+// The elements are stored in a single array with a "gap" of unused elements at
+// the edit position.  Inserting or erasing at the gap only touches the
+// elements being inserted or erased.  Moving the gap to a new position costs
+// time proportional to the distance moved, so a sequence of edits near each
+// other never shifts the rest of the buffer.
+//
+// Elements are addressed by their logical index, ie. ignoring the gap.  Only
+// trivially copyable types are supported.
+template <typename T>
+class GapBuffer {
+ public:
+  GapBuffer() {}
+
+  // Returns the number of elements in the buffer.
+  size_t size() const { return buffer_.size() - (gap_end_ - gap_start_); }
+
+  // Returns true if the buffer contains no elements.
+  bool empty() const { return size() == 0; }
+
+  // Returns the logical index of the gap, ie. the number of elements before it.
+  size_t GetGapPosition() const { return gap_start_; }
+
+  // Returns the element at logical |index|.
+  const T& operator[](size_t index) const {
+    assert(index < size());
+    return index < gap_start_ ? buffer_[index]
+                              : buffer_[index + gap_end_ - gap_start_];
+  }
+
+  // Moves the gap so that it is before the element at logical |index|.
+  void MoveGap(size_t index) {
+    assert(index <= size());
+    if (index < gap_start_) {
+      const size_t count = gap_start_ - index;
+      std::copy_backward(buffer_.begin() + index, buffer_.begin() + gap_start_,
+                         buffer_.begin() + gap_end_);
+      gap_start_ -= count;
+      gap_end_ -= count;
+    } else if (index > gap_start_) {
+      const size_t count = index - gap_start_;
+      std::copy(buffer_.begin() + gap_end_, buffer_.begin() + gap_end_ + count,
+                buffer_.begin() + gap_start_);
+      gap_start_ += count;
+      gap_end_ += count;
+    }
+  }
+
+  // Inserts |count| |values| at the gap.  The gap ends up after the inserted
+  // values so that consecutive inserts append to each other.
+  void Insert(const T* values, size_t count) {
+    Reserve(count);
+    std::copy(values, values + count, buffer_.begin() + gap_start_);
+    gap_start_ += count;
+  }
+
+  // Inserts a single |value| at the gap.
+  void Insert(const T& value) { Insert(&value, 1); }
+
+  // Erases the |count| elements immediately after the gap.
+  void EraseAfterGap(size_t count) {
+    assert(count <= buffer_.size() - gap_end_);
+    gap_end_ += count;
+  }
+
+  // Erases the |count| elements immediately before the gap.
+  void EraseBeforeGap(size_t count) {
+    assert(count <= gap_start_);
+    gap_start_ -= count;
+  }
+
+  // Removes all elements.  The allocated memory is retained.
+  void Clear() {
+    gap_start_ = 0;
+    gap_end_ = buffer_.size();
+  }
+
+  // Appends all elements, in order, to |out|, which can be any container that
+  // supports append(const T*, size_t) such as std::string.
+  template <typename Container>
+  void AppendTo(Container* out) const {
+    out->append(buffer_.data(), gap_start_);
+    out->append(buffer_.data() + gap_end_, buffer_.size() - gap_end_);
+  }
+
+ private:
+  static const size_t kMinGapSize = 16;
+
+  // Ensures the gap can hold at least |count| elements.
+  void Reserve(size_t count) {
+    if (gap_end_ - gap_start_ >= count) {
+      return;
+    }
+    const size_t tail = buffer_.size() - gap_end_;
+    const size_t capacity =
+        std::max(buffer_.size() * 2, size() + count + kMinGapSize);
+    buffer_.resize(capacity);
+    std::copy_backward(buffer_.begin() + gap_end_,
+                       buffer_.begin() + gap_end_ + tail, buffer_.end());
+    gap_end_ = capacity - tail;
+  }
+
+  std::vector<T> buffer_;
+  size_t gap_start_ = 0;
+  size_t gap_end_ = 0;
+};
+
+}  // namespace lull
+
+#endif  // LULLABY_UTIL_GAP_BUFFER_H_
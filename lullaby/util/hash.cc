@@ -81,6 +81,14 @@ HashValue Hash(HashValue prefix, string_view suffix) {
 
 HashValue Hash(string_view str) { return Hash(str.data(), str.length()); }
 
+HashValue HashBytes(HashValue hash, const void* data, size_t size) {
+  const auto* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kHashPrimeMultiplier;
+  }
+  return hash;
+}
+
 HashValue HashCaseInsensitive(const char* str, size_t len) {
   if (str == nullptr || *str == 0 || len == 0) {
     return 0;
@@ -44,6 +44,16 @@ HashValue Hash(string_view str);
 HashValue Hash(HashValue prefix, string_view suffix);
 HashValue HashCaseInsensitive(const char* str, size_t len);
 
+// Folds the |size| bytes at |data| into |hash|.  Unlike Hash(), it doesn't stop
+// at zero bytes, so it can be used to build keys from binary data.
+HashValue HashBytes(HashValue hash, const void* data, size_t size);
+
+// Folds the bytes of |value|, which should have no padding, into |hash|.
+template <typename T>
+HashValue HashBytes(HashValue hash, const T& value) {
+  return HashBytes(hash, &value, sizeof(T));
+}
+
 namespace detail {
 
 // Helper function for performing the recursion for the compile time hash.
@@ -522,9 +522,21 @@ float CheckRayAABBCollision(const Ray& ray, const Aabb& aabb,
 
 float CheckRayOBBCollision(const Ray& ray, const mathfu::mat4& world_mat,
                            const Aabb& aabb, bool collision_on_exit) {
+  mathfu::mat4 inverse_world_mat;
+  if (!world_mat.InverseWithDeterminantCheck(&inverse_world_mat)) {
+    return kNoHitDistance;
+  }
+  return CheckRayOBBCollision(ray, world_mat, inverse_world_mat, aabb,
+                              collision_on_exit);
+}
+
+float CheckRayOBBCollision(const Ray& ray, const mathfu::mat4& world_mat,
+                           const mathfu::mat4& inverse_world_mat,
+                           const Aabb& aabb, bool collision_on_exit) {
+  const Ray local = TransformRay(inverse_world_mat, ray);
   mathfu::vec3 local_collision;
-  if (!ComputeLocalRayOBBCollision(ray, world_mat, aabb, collision_on_exit,
-                                   &local_collision)) {
+  if (!ComputeLocalRayAABBCollision(local, aabb, collision_on_exit,
+                                    &local_collision)) {
     return kNoHitDistance;
   }
   const mathfu::vec3 world_collision = world_mat * local_collision;
@@ -331,6 +331,13 @@ float CheckRayAABBCollision(const Ray& ray, const Aabb& aabb,
 float CheckRayOBBCollision(const Ray& ray, const mathfu::mat4& world_transform,
                            const Aabb& aabb, bool collision_on_exit = false);
 
+// Same as above, but uses the precomputed inverse of |world_transform| so that
+// multiple rays can be tested against the same OBB while only inverting its
+// matrix once.
+float CheckRayOBBCollision(const Ray& ray, const mathfu::mat4& world_transform,
+                           const mathfu::mat4& inverse_world_transform,
+                           const Aabb& aabb, bool collision_on_exit = false);
+
 // Returns true if a |point| lies within |aabb|. Transforms the point into local
 // space prior to performing the check.
 bool CheckPointOBBCollision(const mathfu::vec3& point,
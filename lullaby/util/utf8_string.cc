@@ -22,13 +22,9 @@ namespace lull {
 
 UTF8String::UTF8String() {}
 
-UTF8String::UTF8String(const char* cstr) : string_(cstr) {
-  AppendOffsets(0, cstr);
-}
+UTF8String::UTF8String(const char* cstr) { Insert(0, cstr); }
 
-UTF8String::UTF8String(std::string str) : string_(std::move(str)) {
-  AppendOffsets(0, string_.c_str());
-}
+UTF8String::UTF8String(std::string str) { Set(std::move(str)); }
 
 size_t UTF8String::OneCharLen(const char* p) {
   if (0xfc == (0xfe & *p)) {
@@ -45,20 +41,50 @@ size_t UTF8String::OneCharLen(const char* p) {
   return 1;
 }
 
-void UTF8String::AppendOffsets(size_t offset, const char* cstr) {
-  const char* p = cstr;
-  while (*p) {
-    char_offsets_.push_back(offset + p - cstr);
-    p += OneCharLen(p);
+size_t UTF8String::ByteOffset(size_t index) const {
+  // Walk from whichever of the start, the gap or the end is closest to
+  // |index|.  Edits are usually close to the gap, which keeps this cheap.
+  const size_t size = CharSize();
+  const size_t gap = char_lengths_.GetGapPosition();
+  size_t offset = 0;
+  if (index < gap) {
+    if (index < gap - index) {
+      for (size_t i = 0; i < index; ++i) {
+        offset += char_lengths_[i];
+      }
+    } else {
+      offset = bytes_.GetGapPosition();
+      for (size_t i = index; i < gap; ++i) {
+        offset -= char_lengths_[i];
+      }
+    }
+  } else {
+    if (size - index < index - gap) {
+      offset = ByteSize();
+      for (size_t i = index; i < size; ++i) {
+        offset -= char_lengths_[i];
+      }
+    } else {
+      offset = bytes_.GetGapPosition();
+      for (size_t i = gap; i < index; ++i) {
+        offset += char_lengths_[i];
+      }
+    }
   }
+  return offset;
+}
+
+void UTF8String::MoveGap(size_t index) {
+  bytes_.MoveGap(ByteOffset(index));
+  char_lengths_.MoveGap(index);
 }
 
 size_t UTF8String::CharSize() const {
-  return char_offsets_.size();
+  return char_lengths_.size();
 }
 
 size_t UTF8String::ByteSize() const {
-  return string_.size();
+  return bytes_.size();
 }
 
 void UTF8String::DeleteChars(size_t index, size_t count) {
@@ -66,27 +92,15 @@ void UTF8String::DeleteChars(size_t index, size_t count) {
   if (index >= size) {
     return;
   }
-  const size_t start = char_offsets_[index];
-  size_t utf8_index = index;
-  size_t num_utf8_chars = 0;
+  count = std::min(count, size - index);
+  MoveGap(index);
   size_t num_bytes = 0;
-  while (utf8_index < size && num_utf8_chars < count) {
-    const size_t offset = char_offsets_[utf8_index];
-    num_bytes += OneCharLen(string_.c_str() + offset);
-    ++num_utf8_chars;
-    ++utf8_index;
-  }
-  string_.erase(start, num_bytes);
-  // Remove the char offsets for the deleted characters and shift any offsets
-  // after those that are being removed.
-  const size_t delta_end_index =
-      std::min(index + num_utf8_chars, char_offsets_.size() - 1);
-  const size_t delta = char_offsets_[delta_end_index] - char_offsets_[index];
-  for (size_t i = index + num_utf8_chars; i < char_offsets_.size(); ++i) {
-    char_offsets_[i] -= delta;
+  for (size_t i = index; i < index + count; ++i) {
+    num_bytes += char_lengths_[i];
   }
-  char_offsets_.erase(char_offsets_.begin() + index,
-                      char_offsets_.begin() + index + num_utf8_chars);
+  bytes_.EraseAfterGap(num_bytes);
+  char_lengths_.EraseAfterGap(count);
+  string_dirty_ = true;
 }
 
 size_t UTF8String::Insert(size_t index, const std::string& str) {
@@ -95,21 +109,18 @@ size_t UTF8String::Insert(size_t index, const std::string& str) {
     return 0;
   }
 
-  const size_t start_offset = index < size ? char_offsets_[index] : ByteSize();
-  size_t utf8_index = index;
-
-  // Insert new offsets.
+  MoveGap(index);
   const char* p = str.c_str();
-  while (*p) {
-    char_offsets_.insert(char_offsets_.begin() + utf8_index++,
-                         start_offset + p - str.c_str());
-    p += OneCharLen(p);
-  }
-  // Shift values after |str| insertion.
-  while (utf8_index < char_offsets_.size()) {
-    char_offsets_[utf8_index++] += str.size();
+  const char* end = p + str.size();
+  while (p < end) {
+    // Clamp the length of truncated characters to the end of |str|.
+    const size_t len =
+        std::min(OneCharLen(p), static_cast<size_t>(end - p));
+    char_lengths_.Insert(static_cast<uint8_t>(len));
+    p += len;
   }
-  string_.insert(start_offset, str);
+  bytes_.Insert(str.data(), str.size());
+  string_dirty_ = true;
 
   return CharSize() - size;
 }
@@ -118,43 +129,60 @@ void UTF8String::DeleteLast() {
   if (CharSize() == 0) {
     return;
   }
-  const size_t offset = char_offsets_[CharSize() - 1];
-  string_.resize(offset);
-  char_offsets_.pop_back();
+  DeleteChars(CharSize() - 1, 1);
 }
 
 void UTF8String::Append(const std::string& str) {
-  const size_t byte_len = ByteSize();
-  string_.append(str);
-  AppendOffsets(byte_len, str.c_str());
+  Insert(CharSize(), str);
 }
 
 void UTF8String::Set(std::string str) {
+  bytes_.Clear();
+  char_lengths_.Clear();
+  Insert(0, str);
   string_ = std::move(str);
-  char_offsets_.clear();
-  AppendOffsets(0, string_.c_str());
+  string_dirty_ = false;
 }
 
 std::string UTF8String::CharAt(size_t index) const {
-  if (index >= CharSize()) {
+  return Substr(index, 1);
+}
+
+std::string UTF8String::Substr(size_t index, size_t count) const {
+  const size_t size = CharSize();
+  if (index >= size) {
     return "";
   }
+  count = std::min(count, size - index);
 
-  size_t start = char_offsets_[index];
-  size_t end = index == CharSize() - 1 ? ByteSize() : char_offsets_[index + 1];
-  return string_.substr(start, end - start);
+  const size_t start = ByteOffset(index);
+  size_t num_bytes = 0;
+  for (size_t i = index; i < index + count; ++i) {
+    num_bytes += char_lengths_[i];
+  }
+  std::string result;
+  result.reserve(num_bytes);
+  for (size_t i = start; i < start + num_bytes; ++i) {
+    result.push_back(bytes_[i]);
+  }
+  return result;
 }
 
 const char* UTF8String::c_str() const {
-  return string_.c_str();
+  return str().c_str();
 }
 
 const std::string& UTF8String::str() const {
+  if (string_dirty_) {
+    string_.clear();
+    bytes_.AppendTo(&string_);
+    string_dirty_ = false;
+  }
   return string_;
 }
 
 const bool UTF8String::empty() const {
-  return string_.empty();
+  return bytes_.empty();
 }
 
 }  // namespace lull
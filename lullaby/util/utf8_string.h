@@ -17,28 +17,29 @@ limitations under the License.
 #ifndef LULLABY_UTIL_UTF8_STRING_H_
 #define LULLABY_UTIL_UTF8_STRING_H_
 
+#include <stdint.h>
 #include <string>
-#include <vector>
+
+#include "lullaby/util/gap_buffer.h"
 
 namespace lull {
 
 // Some helper classes for working with UTF8 strings, making it easier to
 // process the strings as character sequences, rather than byte sequences.
-// UTF8String basically contains a string and a vector of character
-// start positions.
+// UTF8String stores the bytes and the byte length of each character in gap
+// buffers that are kept at the same (character) position, so edits only cost
+// time proportional to the size of the edit and the distance from the previous
+// edit rather than to the length of the string.  The contiguous std::string is
+// only assembled when requested by str() or c_str().
 class UTF8String {
  public:
   UTF8String();
   explicit UTF8String(const char* cstr);
   explicit UTF8String(std::string str);
 
-  bool operator==(const UTF8String& rhs) const {
-    return string_ == rhs.string_;
-  }
+  bool operator==(const UTF8String& rhs) const { return str() == rhs.str(); }
 
-  bool operator!=(const UTF8String& rhs) const {
-    return string_ != rhs.string_;
-  }
+  bool operator!=(const UTF8String& rhs) const { return str() != rhs.str(); }
 
   // Gets UTF8 character count.
   size_t CharSize() const;
@@ -59,18 +60,28 @@ class UTF8String {
   // Gets a given UTF8 character at a given index. Returns empty if index is
   // out of bounds.
   std::string CharAt(size_t index) const;
+  // Gets the UTF8 characters in the range [index, index + count). The range is
+  // clamped to the end of the string.
+  std::string Substr(size_t index, size_t count) const;
   // Returns raw bytes of underlying string.
   const char* c_str() const;
-  // Returns underlying std string.
+  // Returns underlying std string.  The string is assembled lazily, so the
+  // returned reference is not updated by subsequent edits.
   const std::string& str() const;
   // Returns true if empty.
   const bool empty() const;
 
  private:
-  std::string string_;
-  std::vector<size_t> char_offsets_;
+  // Returns the byte offset of the character at |index|.
+  size_t ByteOffset(size_t index) const;
+  // Moves the gap of both buffers to before the character at |index|.
+  void MoveGap(size_t index);
+
+  GapBuffer<char> bytes_;
+  GapBuffer<uint8_t> char_lengths_;
+  mutable std::string string_;
+  mutable bool string_dirty_ = false;
 
-  void AppendOffsets(size_t offset, const char* cstr);
   static size_t OneCharLen(const char* s);
 };
 